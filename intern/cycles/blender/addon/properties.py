@@ -387,6 +387,26 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=0.01,
     )
 
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights to sample based on their estimated contribution at the shading point. "
+        "Converges faster in scenes with many lights or emissive triangles",
+        default=False,
+    )
+
+    use_guiding: BoolProperty(
+        name="Path Guiding",
+        description="Learn the distribution of incident light during the first samples, and use it to sample bounces on "
+        "diffuse surfaces and in volumes. Converges faster for difficult indirect lighting. Only supported on the CPU",
+        default=False,
+    )
+    guiding_training_samples: IntProperty(
+        name="Training Samples",
+        description="Number of samples used to learn the distribution of incident light for path guiding",
+        min=1, max=(1 << 24),
+        default=128,
+    )
+
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
         description="Automatically reduce the number of samples per pixel based on estimated noise level",
@@ -794,6 +814,19 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=8, max=8192,
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Load image textures on demand in tiles while rendering, instead of loading full images before rendering starts. Only used for CPU rendering",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by loaded texture tiles, in megabytes",
+        default=4096,
+        min=64, max=1048576,
+        subtype='UNSIGNED',
+    )
+
     # Various fine-tuning debug flags
 
     def _devices_update_callback(self, context):
@@ -811,6 +844,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_bvh_layouts,
         default='EMBREE',
     )
+    debug_use_cpu_wavefront: BoolProperty(
+        name="Wavefront",
+        description="Trace paths in batches one kernel at a time, sorted by shader, instead of tracing every path to completion",
+        default=False,
+    )
 
     debug_use_cuda_adaptive_compile: BoolProperty(name="Adaptive Compile", default=False)
 
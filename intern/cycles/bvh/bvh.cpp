@@ -70,10 +70,15 @@ BVHLayout BVHParams::best_bvh_layout(BVHLayout requested_layout, BVHLayoutMask s
 BVH::BVH(const BVHParams &params_,
          const vector<Geometry *> &geometry_,
          const vector<Object *> &objects_)
-    : params(params_), geometry(geometry_), objects(objects_)
+    : params(params_), geometry(geometry_), objects(objects_), num_refits(0)
 {
 }
 
+bool BVH::refit_quality_degraded() const
+{
+  return num_refits >= BVH_MAX_REFITS;
+}
+
 BVH *BVH::create(const BVHParams &params,
                  const vector<Geometry *> &geometry,
                  const vector<Object *> &objects,
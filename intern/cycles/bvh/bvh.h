@@ -24,6 +24,8 @@ class Progress;
 class Stats;
 
 #define BVH_ALIGN 4096
+/* Maximum number of refits before the BVH is built again. */
+#define BVH_MAX_REFITS 32
 #define TRI_NODE_SIZE 3
 /* Packed BVH
  *
@@ -66,6 +68,9 @@ class BVH {
   vector<Geometry *> geometry;
   vector<Object *> objects;
 
+  /* Number of times the BVH was refitted since it was last built. */
+  int num_refits;
+
   static BVH *create(const BVHParams &params,
                      const vector<Geometry *> &geometry,
                      const vector<Object *> &objects,
@@ -74,6 +79,10 @@ class BVH {
   {
   }
 
+  /* Refitting keeps the topology of the tree, so its quality degrades as primitives move.
+   * Returns true when the tree is better built again instead of refitted. */
+  virtual bool refit_quality_degraded() const;
+
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
@@ -27,6 +27,18 @@ int BVHStackEntry::encodeIdx() const
   return (node->is_leaf()) ? ~idx : idx;
 }
 
+/* Refitted trees with more node area than this, relative to the built tree, are built again. */
+static const float BVH_REFIT_MAX_NODE_AREA_RATIO = 1.5f;
+
+static float bvh_node_area_sum(const BVHNode *node)
+{
+  float area = node->bounds.safe_area();
+  for (int i = 0; i < node->num_children(); i++) {
+    area += bvh_node_area_sum(node->get_child(i));
+  }
+  return area;
+}
+
 BVH2::BVH2(const BVHParams &params_,
            const vector<Geometry *> &geometry_,
            const vector<Object *> &objects_)
@@ -82,20 +94,41 @@ void BVH2::build(Progress &progress, Stats *)
   progress.set_substatus("Packing BVH nodes");
   pack_nodes(root);
 
+  const float root_area = root->bounds.safe_area();
+  build_node_area_ratio = (root_area > 0.0f) ? bvh_node_area_sum(root) / root_area : 0.0f;
+  refit_node_area_ratio = build_node_area_ratio;
+  num_refits = 0;
+
   /* free build nodes */
   root->deleteSubtree();
 }
 
 void BVH2::refit(Progress &progress)
 {
+  /* In the top level BVH, the primitives of instances are packed again by refit_instances(). */
   progress.set_substatus("Packing BVH primitives");
   pack_primitives();
 
   if (progress.get_cancel())
     return;
 
+  if (params.top_level) {
+    progress.set_substatus("Refitting instance BVH nodes");
+    refit_instances();
+  }
+
   progress.set_substatus("Refitting BVH nodes");
   refit_nodes();
+  num_refits++;
+}
+
+bool BVH2::refit_quality_degraded() const
+{
+  if (BVH::refit_quality_degraded()) {
+    return true;
+  }
+  return build_node_area_ratio > 0.0f &&
+         refit_node_area_ratio > build_node_area_ratio * BVH_REFIT_MAX_NODE_AREA_RATIO;
 }
 
 BVHNode *BVH2::widen_children_nodes(const BVHNode *root)
@@ -303,14 +336,16 @@ void BVH2::pack_nodes(const BVHNode *root)
 
 void BVH2::refit_nodes()
 {
-  assert(!params.top_level);
-
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float node_area = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility, node_area);
+
+  const float root_area = bbox.safe_area();
+  refit_node_area_ratio = (root_area > 0.0f) ? node_area / root_area : 0.0f;
 }
 
-void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility, float &node_area)
 {
   if (leaf) {
     /* refit leaf node */
@@ -319,7 +354,13 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c0 = data[0].x;
     const int c1 = data[0].y;
 
-    refit_primitives(c0, c1, bbox, visibility);
+    if (c0 < 0) {
+      /* Object instance in the top level BVH, see pack_leaf(). */
+      refit_primitives(~c0, ~c0 + 1, bbox, visibility);
+    }
+    else {
+      refit_primitives(c0, c1, bbox, visibility);
+    }
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
     float4 leaf_data[BVH_NODE_LEAF_SIZE];
@@ -340,8 +381,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
     uint visibility0 = 0, visibility1 = 0;
 
-    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
-    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
+    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0, node_area);
+    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1, node_area);
 
     if (is_unaligned) {
       Transform aligned_space = transform_identity();
@@ -356,6 +397,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
   }
+
+  node_area += bbox.safe_area();
 }
 
 /* Refitting */
@@ -490,13 +533,12 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
 
   /* clear array that gives the node indexes for instanced objects */
   pack.object_node.clear();
+  packed_instances.clear();
 
   /* reserve */
   size_t prim_index_size = pack.prim_index.size();
 
   size_t pack_prim_index_offset = prim_index_size;
-  size_t pack_nodes_offset = nodes_size;
-  size_t pack_leaf_nodes_offset = leaf_nodes_size;
   size_t object_offset = 0;
 
   foreach (Geometry *geom, geometry) {
@@ -525,10 +567,6 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
   int *pack_prim_index = (pack.prim_index.size()) ? &pack.prim_index[0] : NULL;
   int *pack_prim_type = (pack.prim_type.size()) ? &pack.prim_type[0] : NULL;
   int *pack_prim_object = (pack.prim_object.size()) ? &pack.prim_object[0] : NULL;
-  uint *pack_prim_visibility = (pack.prim_visibility.size()) ? &pack.prim_visibility[0] : NULL;
-  int4 *pack_nodes = (pack.nodes.size()) ? &pack.nodes[0] : NULL;
-  int4 *pack_leaf_nodes = (pack.leaf_nodes.size()) ? &pack.leaf_nodes[0] : NULL;
-  float2 *pack_prim_time = (pack.prim_time.size()) ? &pack.prim_time[0] : NULL;
 
   unordered_map<Geometry *, int> geometry_map;
 
@@ -573,75 +611,119 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
       size_t bvh_prim_index_size = bvh->pack.prim_index.size();
       int *bvh_prim_index = &bvh->pack.prim_index[0];
       int *bvh_prim_type = &bvh->pack.prim_type[0];
-      uint *bvh_prim_visibility = &bvh->pack.prim_visibility[0];
-      float2 *bvh_prim_time = bvh->pack.prim_time.size() ? &bvh->pack.prim_time[0] : NULL;
 
       for (size_t i = 0; i < bvh_prim_index_size; i++) {
         pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + geom_prim_offset;
         pack_prim_type[pack_prim_index_offset] = bvh_prim_type[i];
-        pack_prim_visibility[pack_prim_index_offset] = bvh_prim_visibility[i];
         pack_prim_object[pack_prim_index_offset] = 0;  // unused for instances
-        if (bvh_prim_time != NULL) {
-          pack_prim_time[pack_prim_index_offset] = bvh_prim_time[i];
-        }
         pack_prim_index_offset++;
       }
     }
 
-    /* merge nodes */
-    if (bvh->pack.leaf_nodes.size()) {
-      int4 *leaf_nodes_offset = &bvh->pack.leaf_nodes[0];
-      size_t leaf_nodes_offset_size = bvh->pack.leaf_nodes.size();
-      for (size_t i = 0, j = 0; i < leaf_nodes_offset_size; i += BVH_NODE_LEAF_SIZE, j++) {
-        int4 data = leaf_nodes_offset[i];
-        data.x += prim_offset;
-        data.y += prim_offset;
-        pack_leaf_nodes[pack_leaf_nodes_offset] = data;
-        for (int j = 1; j < BVH_NODE_LEAF_SIZE; ++j) {
-          pack_leaf_nodes[pack_leaf_nodes_offset + j] = leaf_nodes_offset[i + j];
-        }
-        pack_leaf_nodes_offset += BVH_NODE_LEAF_SIZE;
+    /* merge visibility, time and nodes */
+    pack_instance_primitives(bvh, prim_offset);
+    pack_instance_nodes(bvh, nodes_offset, nodes_leaf_offset, prim_offset);
+    packed_instances.push_back({geom, nodes_offset, nodes_leaf_offset, prim_offset});
+
+    nodes_offset += bvh->pack.nodes.size();
+    nodes_leaf_offset += bvh->pack.leaf_nodes.size();
+    prim_offset += bvh->pack.prim_index.size();
+  }
+}
+
+void BVH2::pack_instance_primitives(const BVH2 *bvh, size_t prim_offset)
+{
+  const size_t bvh_prim_index_size = bvh->pack.prim_index.size();
+  if (bvh_prim_index_size == 0) {
+    return;
+  }
+
+  const uint *bvh_prim_visibility = &bvh->pack.prim_visibility[0];
+  const float2 *bvh_prim_time = bvh->pack.prim_time.size() ? &bvh->pack.prim_time[0] : NULL;
+  uint *pack_prim_visibility = &pack.prim_visibility[prim_offset];
+  float2 *pack_prim_time = pack.prim_time.size() ? &pack.prim_time[prim_offset] : NULL;
+
+  for (size_t i = 0; i < bvh_prim_index_size; i++) {
+    pack_prim_visibility[i] = bvh_prim_visibility[i];
+    if (bvh_prim_time != NULL && pack_prim_time != NULL) {
+      pack_prim_time[i] = bvh_prim_time[i];
+    }
+  }
+}
+
+void BVH2::pack_instance_nodes(const BVH2 *bvh,
+                               size_t nodes_offset,
+                               size_t leaf_nodes_offset,
+                               size_t prim_offset)
+{
+  const int noffset = nodes_offset;
+  const int noffset_leaf = leaf_nodes_offset;
+
+  if (bvh->pack.leaf_nodes.size()) {
+    int4 *pack_leaf_nodes = &pack.leaf_nodes[0];
+    const int4 *bvh_leaf_nodes = &bvh->pack.leaf_nodes[0];
+    size_t bvh_leaf_nodes_size = bvh->pack.leaf_nodes.size();
+    for (size_t i = 0; i < bvh_leaf_nodes_size; i += BVH_NODE_LEAF_SIZE) {
+      int4 data = bvh_leaf_nodes[i];
+      data.x += prim_offset;
+      data.y += prim_offset;
+      pack_leaf_nodes[leaf_nodes_offset] = data;
+      for (int j = 1; j < BVH_NODE_LEAF_SIZE; ++j) {
+        pack_leaf_nodes[leaf_nodes_offset + j] = bvh_leaf_nodes[i + j];
       }
+      leaf_nodes_offset += BVH_NODE_LEAF_SIZE;
     }
+  }
 
-    if (bvh->pack.nodes.size()) {
-      int4 *bvh_nodes = &bvh->pack.nodes[0];
-      size_t bvh_nodes_size = bvh->pack.nodes.size();
+  if (bvh->pack.nodes.size()) {
+    int4 *pack_nodes = &pack.nodes[0];
+    const int4 *bvh_nodes = &bvh->pack.nodes[0];
+    size_t bvh_nodes_size = bvh->pack.nodes.size();
 
-      for (size_t i = 0, j = 0; i < bvh_nodes_size; j++) {
-        size_t nsize, nsize_bbox;
-        if (bvh_nodes[i].x & PATH_RAY_NODE_UNALIGNED) {
-          nsize = BVH_UNALIGNED_NODE_SIZE;
-          nsize_bbox = 0;
-        }
-        else {
-          nsize = BVH_NODE_SIZE;
-          nsize_bbox = 0;
-        }
+    for (size_t i = 0; i < bvh_nodes_size;) {
+      size_t nsize, nsize_bbox;
+      if (bvh_nodes[i].x & PATH_RAY_NODE_UNALIGNED) {
+        nsize = BVH_UNALIGNED_NODE_SIZE;
+        nsize_bbox = 0;
+      }
+      else {
+        nsize = BVH_NODE_SIZE;
+        nsize_bbox = 0;
+      }
 
-        memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, nsize_bbox * sizeof(int4));
+      memcpy(pack_nodes + nodes_offset, bvh_nodes + i, nsize_bbox * sizeof(int4));
 
-        /* Modify offsets into arrays */
-        int4 data = bvh_nodes[i + nsize_bbox];
-        data.z += (data.z < 0) ? -noffset_leaf : noffset;
-        data.w += (data.w < 0) ? -noffset_leaf : noffset;
-        pack_nodes[pack_nodes_offset + nsize_bbox] = data;
+      /* Modify offsets into arrays */
+      int4 data = bvh_nodes[i + nsize_bbox];
+      data.z += (data.z < 0) ? -noffset_leaf : noffset;
+      data.w += (data.w < 0) ? -noffset_leaf : noffset;
+      pack_nodes[nodes_offset + nsize_bbox] = data;
 
-        /* Usually this copies nothing, but we better
-         * be prepared for possible node size extension.
-         */
-        memcpy(&pack_nodes[pack_nodes_offset + nsize_bbox + 1],
-               &bvh_nodes[i + nsize_bbox + 1],
-               sizeof(int4) * (nsize - (nsize_bbox + 1)));
+      /* Usually this copies nothing, but we better
+       * be prepared for possible node size extension.
+       */
+      memcpy(&pack_nodes[nodes_offset + nsize_bbox + 1],
+             &bvh_nodes[i + nsize_bbox + 1],
+             sizeof(int4) * (nsize - (nsize_bbox + 1)));
 
-        pack_nodes_offset += nsize;
-        i += nsize;
-      }
+      nodes_offset += nsize;
+      i += nsize;
     }
+  }
+}
 
-    nodes_offset += bvh->pack.nodes.size();
-    nodes_leaf_offset += bvh->pack.leaf_nodes.size();
-    prim_offset += bvh->pack.prim_index.size();
+void BVH2::refit_instances()
+{
+  /* Refitting keeps the topology of the instance BVH's, so their primitives and nodes are copied
+   * to the same location as when they were merged. */
+  for (const PackedInstance &instance : packed_instances) {
+    const BVH2 *bvh = static_cast<const BVH2 *>(instance.geom->bvh);
+    assert(instance.nodes_offset + bvh->pack.nodes.size() <= pack.nodes.size());
+    assert(instance.leaf_nodes_offset + bvh->pack.leaf_nodes.size() <= pack.leaf_nodes.size());
+    assert(instance.prim_offset + bvh->pack.prim_index.size() <= pack.prim_index.size());
+    pack_instance_primitives(bvh, instance.prim_offset);
+    pack_instance_nodes(
+        bvh, instance.nodes_offset, instance.leaf_nodes_offset, instance.prim_offset);
   }
 }
 
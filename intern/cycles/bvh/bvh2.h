@@ -35,6 +35,8 @@ class BVH2 : public BVH {
   void build(Progress &progress, Stats *stats);
   void refit(Progress &progress);
 
+  virtual bool refit_quality_degraded() const override;
+
   PackedBVH pack;
 
  protected:
@@ -79,7 +81,7 @@ class BVH2 : public BVH {
 
   /* refit */
   void refit_nodes();
-  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility, float &node_area);
 
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
@@ -90,6 +92,31 @@ class BVH2 : public BVH {
 
   /* merge instance BVH's */
   void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
+  void pack_instance_primitives(const BVH2 *bvh, size_t prim_offset);
+  void pack_instance_nodes(const BVH2 *bvh,
+                           size_t nodes_offset,
+                           size_t leaf_nodes_offset,
+                           size_t prim_offset);
+
+  /* Copy primitive visibility, time and nodes of refitted instance BVH's into the top level
+   * BVH. */
+  void refit_instances();
+
+  /* Location of the nodes of instanced geometry in the top level BVH, which are copies of the
+   * nodes of the BVH of the geometry. */
+  struct PackedInstance {
+    Geometry *geom;
+    size_t nodes_offset;
+    size_t leaf_nodes_offset;
+    size_t prim_offset;
+  };
+  vector<PackedInstance> packed_instances;
+
+  /* Surface area of all nodes relative to the root, after building and after the last refit.
+   * This is proportional to the traversal cost, and increases when refitting makes nodes overlap
+   * more. */
+  float build_node_area_ratio = 0.0f;
+  float refit_node_area_ratio = 0.0f;
 };
 
 CCL_NAMESPACE_END
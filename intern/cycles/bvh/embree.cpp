@@ -388,6 +388,8 @@ void BVHEmbree::build(Progress &progress, Stats *stats, RTCDevice rtc_device_)
   const bool dynamic = params.bvh_type == BVH_TYPE_DYNAMIC;
   const bool compact = params.use_compact_structure;
 
+  num_refits = 0;
+
   scene = rtcNewScene(rtc_device);
   const RTCSceneFlags scene_flags = (dynamic ? RTC_SCENE_FLAG_DYNAMIC : RTC_SCENE_FLAG_NONE) |
                                     (compact ? RTC_SCENE_FLAG_COMPACT : RTC_SCENE_FLAG_NONE) |
@@ -817,10 +819,19 @@ void BVHEmbree::refit(Progress &progress)
 {
   progress.set_substatus("Refitting BVH nodes");
 
+  /* Dynamic scenes keep a BVH per geometry, which can be refitted when only vertices move
+   * instead of being built again. */
+  const bool use_refit_quality = params.bvh_type == BVH_TYPE_DYNAMIC;
+
   /* Update all vertex buffers, then tell Embree to rebuild/-fit the BVHs. */
   unsigned geom_id = 0;
   foreach (Object *ob, objects) {
-    if (!params.top_level || (ob->is_traceable() && !ob->get_geometry()->is_instanced())) {
+    if (params.top_level && ob->is_traceable() && ob->get_geometry()->is_instanced()) {
+      /* The instanced scene was refitted on its own, committing the instance makes Embree
+       * update its bounds in this scene. */
+      rtcCommitGeometry(rtcGetGeometry(scene, geom_id));
+    }
+    else if (!params.top_level || ob->is_traceable()) {
       Geometry *geom = ob->get_geometry();
 
       if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
@@ -829,6 +840,9 @@ void BVHEmbree::refit(Progress &progress)
           RTCGeometry geom = rtcGetGeometry(scene, geom_id);
           set_tri_vertex_buffer(geom, mesh, true);
           rtcSetGeometryUserData(geom, (void *)mesh->prim_offset);
+          if (use_refit_quality) {
+            rtcSetGeometryBuildQuality(geom, RTC_BUILD_QUALITY_REFIT);
+          }
           rtcCommitGeometry(geom);
         }
       }
@@ -854,6 +868,7 @@ void BVHEmbree::refit(Progress &progress)
   }
 
   rtcCommitScene(scene);
+  num_refits++;
 }
 
 CCL_NAMESPACE_END
@@ -21,4 +21,14 @@ BVHMulti::~BVHMulti()
   }
 }
 
+bool BVHMulti::refit_quality_degraded() const
+{
+  foreach (BVH *bvh, sub_bvhs) {
+    if (bvh && bvh->refit_quality_degraded()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 CCL_NAMESPACE_END
@@ -13,6 +13,8 @@ class BVHMulti : public BVH {
  public:
   vector<BVH *> sub_bvhs;
 
+  virtual bool refit_quality_degraded() const override;
+
  protected:
   friend class BVH;
   BVHMulti(const BVHParams &params,
@@ -29,6 +29,8 @@ CPUKernels::CPUKernels()
       REGISTER_KERNEL(integrator_shade_light),
       REGISTER_KERNEL(integrator_shade_shadow),
       REGISTER_KERNEL(integrator_shade_surface),
+      REGISTER_KERNEL(integrator_shade_surface_raytrace),
+      REGISTER_KERNEL(integrator_shade_surface_mnee),
       REGISTER_KERNEL(integrator_shade_volume),
       REGISTER_KERNEL(integrator_megakernel),
       /* Shader evaluation. */
@@ -0,0 +1,218 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#include "integrator/guiding.h"
+
+#include "util/log.h"
+#include "util/math.h"
+#include "util/string.h"
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __PATH_GUIDING__
+
+/* Leaves are split when they have more records than this times the square root of the number of
+ * samples in the iteration, same as the spatial threshold of the paper. */
+static const float guiding_split_records_factor = 12000.0f;
+
+/* Limit the depth of the tree, so that leaves do not get arbitrarily small. */
+static const int guiding_max_depth = 24;
+
+GuidingField::GuidingField()
+    : training_samples_(0), trained_samples_(0), peak_training_memory_(0), num_leaves_(0)
+{
+  memset(&kernel_field_, 0, sizeof(kernel_field_));
+}
+
+void GuidingField::reset(const BoundBox &bounds, const int training_samples)
+{
+  bounds_ = bounds;
+  if (!bounds_.valid()) {
+    bounds_ = BoundBox(make_float3(-1.0f, -1.0f, -1.0f), make_float3(1.0f, 1.0f, 1.0f));
+  }
+
+  /* Enlarge the bounds a bit, so that points on the boundary of the scene end up inside. */
+  const float3 margin = max(bounds_.size(), make_float3(1.0f, 1.0f, 1.0f)) * 1e-3f;
+  bounds_.min -= margin;
+  bounds_.max += margin;
+
+  training_samples_ = training_samples;
+  trained_samples_ = 0;
+
+  /* Start with a single leaf covering the whole scene. */
+  nodes_.clear();
+  nodes_.push_back({-1, 0});
+  num_leaves_ = 1;
+
+  sampling_cdf_.free_memory();
+  training_radiance_.clear();
+  training_radiance_.resize(GUIDING_DIRECTIONAL_BINS, 0.0f);
+  training_records_.clear();
+  training_records_.resize(1, 0);
+  peak_training_memory_ = get_training_memory();
+
+  update_kernel_field();
+}
+
+void GuidingField::update(const int num_samples)
+{
+  if (!is_training() || num_samples == 0) {
+    return;
+  }
+
+  update_distributions();
+
+  trained_samples_ += num_samples;
+
+  if (is_training()) {
+    refine_tree(num_samples);
+
+    training_radiance_.clear();
+    training_radiance_.resize(num_leaves_ * GUIDING_DIRECTIONAL_BINS, 0.0f);
+    training_records_.clear();
+    training_records_.resize(num_leaves_, 0);
+    peak_training_memory_ = max(peak_training_memory_, get_training_memory());
+  }
+  else {
+    training_radiance_.free_memory();
+    training_records_.free_memory();
+  }
+
+  update_kernel_field();
+
+  VLOG(3) << "Path guiding trained with " << trained_samples_ << " samples, " << num_leaves_
+          << " leaves, training memory " << string_human_readable_size(get_training_memory())
+          << ", sampling memory " << string_human_readable_size(get_sampling_memory());
+}
+
+size_t GuidingField::get_training_memory() const
+{
+  return training_radiance_.size() * sizeof(float) + training_records_.size() * sizeof(uint);
+}
+
+size_t GuidingField::get_sampling_memory() const
+{
+  return nodes_.size() * sizeof(KernelGuidingNode) + sampling_cdf_.size() * sizeof(float);
+}
+
+void GuidingField::update_distributions()
+{
+  /* Leaves without records keep the distribution they had, new fields start out empty. */
+  if (sampling_cdf_.size() != training_radiance_.size()) {
+    sampling_cdf_.clear();
+    sampling_cdf_.resize(training_radiance_.size(), 0.0f);
+  }
+
+  for (int leaf = 0; leaf < num_leaves_; leaf++) {
+    const float *radiance = &training_radiance_[leaf * GUIDING_DIRECTIONAL_BINS];
+    float *cdf = &sampling_cdf_[leaf * GUIDING_DIRECTIONAL_BINS];
+
+    float total = 0.0f;
+    for (int bin = 0; bin < GUIDING_DIRECTIONAL_BINS; bin++) {
+      total += radiance[bin];
+    }
+    if (!(total > 0.0f) || !isfinite_safe(total)) {
+      continue;
+    }
+
+    const float inv_total = 1.0f / total;
+    float sum = 0.0f;
+    for (int bin = 0; bin < GUIDING_DIRECTIONAL_BINS; bin++) {
+      sum += radiance[bin];
+      cdf[bin] = sum * inv_total;
+    }
+    cdf[GUIDING_DIRECTIONAL_BINS - 1] = 1.0f;
+  }
+}
+
+void GuidingField::refine_tree(const int num_samples)
+{
+  const float split_threshold = guiding_split_records_factor * sqrtf((float)num_samples);
+
+  vector<KernelGuidingNode> new_nodes;
+  vector<float> new_sampling_cdf;
+  new_nodes.reserve(nodes_.size());
+  new_sampling_cdf.reserve(sampling_cdf_.size());
+
+  new_nodes.resize(1);
+  num_leaves_ = 0;
+  refine_node(nodes_, 0, 0, 0, split_threshold, new_nodes, new_sampling_cdf);
+
+  nodes_.swap(new_nodes);
+  sampling_cdf_.swap(new_sampling_cdf);
+}
+
+void GuidingField::refine_node(const vector<KernelGuidingNode> &nodes,
+                               const int node_index,
+                               const int new_node_index,
+                               const int depth,
+                               const float split_threshold,
+                               vector<KernelGuidingNode> &new_nodes,
+                               vector<float> &new_sampling_cdf)
+{
+  const KernelGuidingNode &node = nodes[node_index];
+
+  if (node.axis == -1) {
+    split_leaf(node.child,
+               training_records_[node.child],
+               new_node_index,
+               depth,
+               split_threshold,
+               new_nodes,
+               new_sampling_cdf);
+    return;
+  }
+
+  /* Children are stored next to each other, so allocate both before descending. */
+  const int child = new_nodes.size();
+  new_nodes.resize(child + 2);
+  new_nodes[new_node_index] = {node.axis, child};
+
+  refine_node(
+      nodes, node.child, child, depth + 1, split_threshold, new_nodes, new_sampling_cdf);
+  refine_node(
+      nodes, node.child + 1, child + 1, depth + 1, split_threshold, new_nodes, new_sampling_cdf);
+}
+
+void GuidingField::split_leaf(const int leaf,
+                              const float num_records,
+                              const int new_node_index,
+                              const int depth,
+                              const float split_threshold,
+                              vector<KernelGuidingNode> &new_nodes,
+                              vector<float> &new_sampling_cdf)
+{
+  /* Split in the middle along the axes in turn, assuming the records are spread evenly over the
+   * children. Children start out with the distribution of the leaf they were split from. */
+  if (num_records > split_threshold && depth < guiding_max_depth) {
+    const int child = new_nodes.size();
+    new_nodes.resize(child + 2);
+    new_nodes[new_node_index] = {depth % 3, child};
+
+    const float child_records = 0.5f * num_records;
+    split_leaf(
+        leaf, child_records, child, depth + 1, split_threshold, new_nodes, new_sampling_cdf);
+    split_leaf(
+        leaf, child_records, child + 1, depth + 1, split_threshold, new_nodes, new_sampling_cdf);
+    return;
+  }
+
+  new_nodes[new_node_index] = {-1, num_leaves_++};
+
+  const float *cdf = &sampling_cdf_[leaf * GUIDING_DIRECTIONAL_BINS];
+  new_sampling_cdf.insert(new_sampling_cdf.end(), cdf, cdf + GUIDING_DIRECTIONAL_BINS);
+}
+
+void GuidingField::update_kernel_field()
+{
+  kernel_field_.bounds_min = bounds_.min;
+  kernel_field_.bounds_max = bounds_.max;
+  kernel_field_.nodes = nodes_.data();
+  kernel_field_.sampling_cdf = (sampling_cdf_.empty()) ? nullptr : sampling_cdf_.data();
+  kernel_field_.training_radiance = (is_training()) ? training_radiance_.data() : nullptr;
+  kernel_field_.training_records = (is_training()) ? training_records_.data() : nullptr;
+}
+
+#endif /* __PATH_GUIDING__ */
+
+CCL_NAMESPACE_END
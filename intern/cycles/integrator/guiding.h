@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#pragma once
+
+#include "kernel/types.h"
+
+#include "util/boundbox.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class GuidingParams {
+ public:
+  bool use = false;
+
+  /* Number of samples per pixel during which the field is trained. */
+  int training_samples = 128;
+
+  /* Bounds of the scene, covered by the spatial tree of the field. */
+  BoundBox bounds = BoundBox::empty;
+
+  bool modified(const GuidingParams &other) const
+  {
+    return !(use == other.use && training_samples == other.training_samples &&
+             bounds.min == other.bounds.min && bounds.max == other.bounds.max);
+  }
+};
+
+#ifdef __PATH_GUIDING__
+
+/* Guiding Field
+ *
+ * Learned distribution of incident radiance used for path guiding, similar to "Practical Path
+ * Guiding for Efficient Light-Transport Simulation" by Müller et al. A spatial binary tree is
+ * subdivided where many path vertices are recorded, and every leaf has a histogram over
+ * directions.
+ *
+ * Training happens in iterations which are the render passes of the first samples: the kernels
+ * record radiance while rendering, and the field is updated in between. The distributions used
+ * for sampling are the ones learned in the last finished iteration. */
+class GuidingField {
+ public:
+  GuidingField();
+
+  /* Discard everything learned, and start training again for the given scene bounds. */
+  void reset(const BoundBox &bounds, int training_samples);
+
+  /* Update the sampling distributions from the records of the iteration which rendered the
+   * given number of samples, and refine the spatial tree for the next iteration. */
+  void update(int num_samples);
+
+  bool is_training() const
+  {
+    return trained_samples_ < training_samples_;
+  }
+
+  /* Field as accessed by the kernels. The address stays the same during the lifetime of the
+   * field, the pointers in it change with every update. */
+  const KernelGuidingField *get_kernel_field() const
+  {
+    return &kernel_field_;
+  }
+
+  int get_trained_samples() const
+  {
+    return trained_samples_;
+  }
+
+  int get_num_leaves() const
+  {
+    return num_leaves_;
+  }
+
+  /* Memory used for the records of the current training iteration, and the most used by any
+   * iteration since the last reset. */
+  size_t get_training_memory() const;
+  size_t get_peak_training_memory() const
+  {
+    return peak_training_memory_;
+  }
+
+  /* Memory used by the spatial tree and the sampling distributions. */
+  size_t get_sampling_memory() const;
+
+ protected:
+  void update_distributions();
+  void refine_tree(int num_samples);
+  void refine_node(const vector<KernelGuidingNode> &nodes,
+                   int node_index,
+                   int new_node_index,
+                   int depth,
+                   float split_threshold,
+                   vector<KernelGuidingNode> &new_nodes,
+                   vector<float> &new_sampling_cdf);
+  void split_leaf(int leaf,
+                  float num_records,
+                  int new_node_index,
+                  int depth,
+                  float split_threshold,
+                  vector<KernelGuidingNode> &new_nodes,
+                  vector<float> &new_sampling_cdf);
+  void update_kernel_field();
+
+  BoundBox bounds_;
+  int training_samples_;
+  int trained_samples_;
+  size_t peak_training_memory_;
+
+  vector<KernelGuidingNode> nodes_;
+  int num_leaves_;
+
+  vector<float> sampling_cdf_;
+  vector<float> training_radiance_;
+  vector<uint> training_records_;
+
+  KernelGuidingField kernel_field_;
+};
+
+#endif /* __PATH_GUIDING__ */
+
+CCL_NAMESPACE_END
@@ -15,6 +15,7 @@
 #include "util/algorithm.h"
 #include "util/log.h"
 #include "util/progress.h"
+#include "util/string.h"
 #include "util/tbb.h"
 #include "util/time.h"
 
@@ -179,6 +180,8 @@ void PathTrace::render_pipeline(RenderWork render_work)
     return;
   }
 
+  guiding_update(render_work);
+
   adaptive_sample(render_work);
   if (render_cancel_.is_requested) {
     return;
@@ -357,6 +360,14 @@ void PathTrace::path_trace(RenderWork &render_work)
 
   thread_capture_fp_settings();
 
+#ifdef __PATH_GUIDING__
+  const KernelGuidingField *guiding_field = (guiding_field_) ? guiding_field_->get_kernel_field() :
+                                                               nullptr;
+  for (auto &&path_trace_work : path_trace_works_) {
+    path_trace_work->guiding_init_kernel_globals(guiding_field);
+  }
+#endif
+
   parallel_for(0, num_works, [&](int i) {
     const double work_start_time = time_dt();
     const int num_samples = render_work.path_trace.num_samples;
@@ -478,6 +489,47 @@ void PathTrace::set_adaptive_sampling(const AdaptiveSampling &adaptive_sampling)
   render_scheduler_.set_adaptive_sampling(adaptive_sampling);
 }
 
+void PathTrace::set_guiding_params(const GuidingParams &params, const bool reset)
+{
+  const bool params_modified = guiding_params_.modified(params);
+  guiding_params_ = params;
+
+#ifdef __PATH_GUIDING__
+  /* The kernels record into host memory, which is only possible when rendering on the CPU. */
+  if (!guiding_params_.use || device_->info.type != DEVICE_CPU) {
+    guiding_field_.reset();
+    return;
+  }
+
+  if (!guiding_field_) {
+    guiding_field_ = make_unique<GuidingField>();
+  }
+  else if (!params_modified && !reset) {
+    return;
+  }
+
+  VLOG(3) << "Reset path guiding field, training with " << guiding_params_.training_samples
+          << " samples.";
+  guiding_field_->reset(guiding_params_.bounds, guiding_params_.training_samples);
+#else
+  (void)params_modified;
+  (void)reset;
+#endif
+}
+
+void PathTrace::guiding_update(const RenderWork &render_work)
+{
+#ifdef __PATH_GUIDING__
+  if (!guiding_field_ || !guiding_field_->is_training()) {
+    return;
+  }
+
+  guiding_field_->update(render_work.path_trace.num_samples);
+#else
+  (void)render_work;
+#endif
+}
+
 void PathTrace::cryptomatte_postprocess(const RenderWork &render_work)
 {
   if (!render_work.cryptomatte.postprocess) {
@@ -1202,12 +1254,33 @@ static string denoiser_device_report(const Denoiser *denoiser)
   return device_info_list_report("Denoising on", denoiser_device->info);
 }
 
+#ifdef __PATH_GUIDING__
+static string guiding_report(const GuidingField *guiding_field)
+{
+  if (!guiding_field) {
+    return "";
+  }
+
+  return string_printf(
+      "\nPath guiding: trained with %d samples, %d leaves\n"
+      "  Training memory: %s peak\n"
+      "  Sampling memory: %s\n",
+      guiding_field->get_trained_samples(),
+      guiding_field->get_num_leaves(),
+      string_human_readable_size(guiding_field->get_peak_training_memory()).c_str(),
+      string_human_readable_size(guiding_field->get_sampling_memory()).c_str());
+}
+#endif
+
 string PathTrace::full_report() const
 {
   string result = "\nFull path tracing report\n";
 
   result += path_trace_devices_report(path_trace_works_);
   result += denoiser_device_report(denoiser_.get());
+#ifdef __PATH_GUIDING__
+  result += guiding_report(guiding_field_.get());
+#endif
 
   /* Report from the render scheduler, which includes:
    * - Render mode (interactive, offline, headless)
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "integrator/denoiser.h"
+#include "integrator/guiding.h"
 #include "integrator/pass_accessor.h"
 #include "integrator/path_trace_work.h"
 #include "integrator/work_balancer.h"
@@ -89,6 +90,11 @@ class PathTrace {
    * Use this to configure the adaptive sampler before rendering any samples. */
   void set_adaptive_sampling(const AdaptiveSampling &adaptive_sampling);
 
+  /* Set parameters used for path guiding.
+   * The field is trained again from scratch when the parameters changed or reset is requested,
+   * for example when the scene changed. */
+  void set_guiding_params(const GuidingParams &params, bool reset);
+
   /* Sets output driver for render buffer output. */
   void set_output_driver(unique_ptr<OutputDriver> driver);
 
@@ -199,6 +205,7 @@ class PathTrace {
   void path_trace(RenderWork &render_work);
   void adaptive_sample(RenderWork &render_work);
   void denoise(const RenderWork &render_work);
+  void guiding_update(const RenderWork &render_work);
   void cryptomatte_postprocess(const RenderWork &render_work);
   void update_display(const RenderWork &render_work);
   void rebalance(const RenderWork &render_work);
@@ -261,6 +268,13 @@ class PathTrace {
   /* Denoiser which takes care of denoising the big tile. */
   unique_ptr<Denoiser> denoiser_;
 
+  /* Path guiding field, trained during the first samples. Only used when path tracing on the
+   * CPU. */
+  GuidingParams guiding_params_;
+#ifdef __PATH_GUIDING__
+  unique_ptr<GuidingField> guiding_field_;
+#endif
+
   /* State which is common for all the steps of the render work.
    * Is brought up to date in the `render()` call and is accessed from all the steps involved into
    * rendering the work. */
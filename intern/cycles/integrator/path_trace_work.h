@@ -60,6 +60,12 @@ class PathTraceWork {
    * to an every call of the `render_samples()`. */
   virtual void init_execution() = 0;
 
+#ifdef __PATH_GUIDING__
+  /* Set the path guiding field used by the kernels, or nullptr to disable guiding. Must be
+   * called after `init_execution()`. Guiding is only supported on the CPU. */
+  virtual void guiding_init_kernel_globals(const KernelGuidingField * /*guiding_field*/){};
+#endif
+
   /* Render given number of samples as a synchronous blocking call.
    * The samples are added to the render buffer associated with this work. */
   virtual void render_samples(RenderStatistics &statistics,
@@ -15,9 +15,12 @@
 #include "session/buffers.h"
 
 #include "util/atomic.h"
+#include "util/debug.h"
 #include "util/log.h"
 #include "util/tbb.h"
 
+#include <algorithm>
+
 CCL_NAMESPACE_BEGIN
 
 /* Create TBB arena for execution of path tracing and rendering tasks. */
@@ -40,6 +43,19 @@ static inline CPUKernelThreadGlobals *kernel_thread_globals_get(
   return &kernel_thread_globals[thread_index];
 }
 
+/* Size of the tiles rendered by a single thread in the wavefront mode. The integrator state is
+ * large on the CPU, mostly due to the intersections of transparent shadows, which are only touched
+ * when used. */
+static constexpr int wavefront_tile_size = 16;
+
+/* Kernels which are executed for paths sorted by shader. */
+static inline bool wavefront_kernel_uses_sorting(const DeviceKernel kernel)
+{
+  return (kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE ||
+          kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE ||
+          kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE);
+}
+
 PathTraceWorkCPU::PathTraceWorkCPU(Device *device,
                                    Film *film,
                                    DeviceScene *device_scene,
@@ -54,7 +70,17 @@ void PathTraceWorkCPU::init_execution()
 {
   /* Cache per-thread kernel globals. */
   device_->get_cpu_kernel_thread_globals(kernel_thread_globals_);
+  wavefront_thread_states_.resize(kernel_thread_globals_.size());
+}
+
+#ifdef __PATH_GUIDING__
+void PathTraceWorkCPU::guiding_init_kernel_globals(const KernelGuidingField *guiding_field)
+{
+  for (CPUKernelThreadGlobals &kernel_globals : kernel_thread_globals_) {
+    kernel_globals.guiding_field = guiding_field;
+  }
 }
+#endif
 
 void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
                                       int start_sample,
@@ -72,31 +98,70 @@ void PathTraceWorkCPU::render_samples(RenderStatistics &statistics,
   }
 
   tbb::task_arena local_arena = local_tbb_arena_create(device_);
-  local_arena.execute([&]() {
-    parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
-      if (is_cancel_requested()) {
-        return;
-      }
 
-      const int y = work_index / image_width;
-      const int x = work_index - y * image_width;
+  if (DebugFlags().cpu.wavefront) {
+    /* Render tiles of pixels, so that every thread has a batch of paths to sort. */
+    const int64_t num_tiles_x = divide_up(image_width, wavefront_tile_size);
+    const int64_t num_tiles_y = divide_up(image_height, wavefront_tile_size);
 
-      KernelWorkTile work_tile;
-      work_tile.x = effective_buffer_params_.full_x + x;
-      work_tile.y = effective_buffer_params_.full_y + y;
-      work_tile.w = 1;
-      work_tile.h = 1;
-      work_tile.start_sample = start_sample;
-      work_tile.sample_offset = sample_offset;
-      work_tile.num_samples = 1;
-      work_tile.offset = effective_buffer_params_.offset;
-      work_tile.stride = effective_buffer_params_.stride;
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), num_tiles_x * num_tiles_y, [&](int64_t work_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
 
-      CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(kernel_thread_globals_);
+        const int tile_y = work_index / num_tiles_x;
+        const int tile_x = work_index - tile_y * num_tiles_x;
+        const int x = tile_x * wavefront_tile_size;
+        const int y = tile_y * wavefront_tile_size;
+
+        KernelWorkTile work_tile;
+        work_tile.x = effective_buffer_params_.full_x + x;
+        work_tile.y = effective_buffer_params_.full_y + y;
+        work_tile.w = min(wavefront_tile_size, int(image_width - x));
+        work_tile.h = min(wavefront_tile_size, int(image_height - y));
+        work_tile.start_sample = start_sample;
+        work_tile.sample_offset = sample_offset;
+        work_tile.num_samples = 1;
+        work_tile.offset = effective_buffer_params_.offset;
+        work_tile.stride = effective_buffer_params_.stride;
+
+        CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(
+            kernel_thread_globals_);
+
+        render_samples_wavefront(kernel_globals, work_tile, samples_num);
+      });
+    });
+  }
+  else {
+    local_arena.execute([&]() {
+      parallel_for(int64_t(0), total_pixels_num, [&](int64_t work_index) {
+        if (is_cancel_requested()) {
+          return;
+        }
 
-      render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+        const int y = work_index / image_width;
+        const int x = work_index - y * image_width;
+
+        KernelWorkTile work_tile;
+        work_tile.x = effective_buffer_params_.full_x + x;
+        work_tile.y = effective_buffer_params_.full_y + y;
+        work_tile.w = 1;
+        work_tile.h = 1;
+        work_tile.start_sample = start_sample;
+        work_tile.sample_offset = sample_offset;
+        work_tile.num_samples = 1;
+        work_tile.offset = effective_buffer_params_.offset;
+        work_tile.stride = effective_buffer_params_.stride;
+
+        CPUKernelThreadGlobals *kernel_globals = kernel_thread_globals_get(
+            kernel_thread_globals_);
+
+        render_samples_full_pipeline(kernel_globals, work_tile, samples_num);
+      });
     });
-  });
+  }
+
   if (device_->profiler.active()) {
     for (CPUKernelThreadGlobals &kernel_globals : kernel_thread_globals_) {
       kernel_globals.stop_profiling();
@@ -153,6 +218,207 @@ void PathTraceWorkCPU::render_samples_full_pipeline(KernelGlobalsCPU *kernel_glo
   }
 }
 
+void PathTraceWorkCPU::render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                                const KernelWorkTile &work_tile,
+                                                const int samples_num)
+{
+  const bool has_bake = device_scene_->data.bake.use;
+  const int num_paths = work_tile.w * work_tile.h;
+
+  /* Like in the megakernel, the shadow catcher path is split off into the state which follows
+   * the main path state. */
+  const int states_per_path = device_scene_->data.integrator.has_shadow_catcher ? 2 : 1;
+  const int num_states = num_paths * states_per_path;
+
+  IntegratorStateCPU *integrator_states = wavefront_thread_states_get(num_states);
+
+  vector<KernelWorkTile> path_work_tiles(num_paths, work_tile);
+  vector<bool> path_active(num_paths, true);
+  for (int i = 0; i < num_paths; i++) {
+    path_work_tiles[i].x = work_tile.x + i % work_tile.w;
+    path_work_tiles[i].y = work_tile.y + i / work_tile.w;
+    path_work_tiles[i].w = 1;
+    path_work_tiles[i].h = 1;
+  }
+
+  float *render_buffer = buffers_->buffer.data();
+
+  for (int sample = 0; sample < samples_num; ++sample) {
+    if (is_cancel_requested()) {
+      break;
+    }
+
+    /* Initialize a path for every pixel which did not converge yet. */
+    int num_active_paths = 0;
+    for (int i = 0; i < num_paths; i++) {
+      IntegratorStateCPU *state = &integrator_states[i * states_per_path];
+      for (int j = 0; j < states_per_path; j++) {
+        path_state_init_queues(state + j);
+      }
+
+      if (!path_active[i]) {
+        continue;
+      }
+
+      KernelWorkTile *path_work_tile = &path_work_tiles[i];
+      const bool path_initialized =
+          has_bake ? kernels_.integrator_init_from_bake(
+                         kernel_globals, state, path_work_tile, render_buffer) :
+                     kernels_.integrator_init_from_camera(
+                         kernel_globals, state, path_work_tile, render_buffer);
+      if (!path_initialized) {
+        path_active[i] = false;
+        continue;
+      }
+
+      ++path_work_tile->start_sample;
+      ++num_active_paths;
+    }
+
+    if (num_active_paths == 0) {
+      break;
+    }
+
+    wavefront_execute(kernel_globals, integrator_states, num_states, render_buffer);
+  }
+}
+
+IntegratorStateCPU *PathTraceWorkCPU::wavefront_thread_states_get(const int num_states)
+{
+  const int thread_index = tbb::this_task_arena::current_thread_index();
+  DCHECK_GE(thread_index, 0);
+  DCHECK_LT(thread_index, wavefront_thread_states_.size());
+
+  WavefrontThreadStates &thread_states = wavefront_thread_states_[thread_index];
+  if (thread_states.num_states < num_states) {
+    /* Not zero initialized, so that memory which is never used is not touched. */
+    thread_states.states.reset(new IntegratorStateCPU[num_states]);
+    thread_states.num_states = num_states;
+  }
+  return thread_states.states.get();
+}
+
+void PathTraceWorkCPU::wavefront_execute(KernelGlobalsCPU *kernel_globals,
+                                         IntegratorStateCPU *states,
+                                         const int num_states,
+                                         float *render_buffer)
+{
+  vector<IntegratorStateCPU *> queued_states;
+  queued_states.reserve(num_states);
+
+  while (true) {
+    /* Kernels on the main path reuse the shadow states of the path, so any shadow paths are
+     * handled first, same as in the megakernel. */
+    wavefront_execute_shadow(kernel_globals, states, num_states, render_buffer);
+
+    /* Execute the kernel which is queued for the most paths. */
+    int num_queued[DEVICE_KERNEL_INTEGRATOR_NUM] = {0};
+    for (int i = 0; i < num_states; i++) {
+      num_queued[states[i].path.queued_kernel]++;
+    }
+
+    int max_num_queued = 0;
+    DeviceKernel kernel = DEVICE_KERNEL_NUM;
+    for (int i = 1; i < DEVICE_KERNEL_INTEGRATOR_NUM; i++) {
+      if (num_queued[i] > max_num_queued) {
+        kernel = (DeviceKernel)i;
+        max_num_queued = num_queued[i];
+      }
+    }
+
+    if (kernel == DEVICE_KERNEL_NUM) {
+      break;
+    }
+
+    queued_states.clear();
+    for (int i = 0; i < num_states; i++) {
+      if (states[i].path.queued_kernel == kernel) {
+        queued_states.push_back(&states[i]);
+      }
+    }
+
+    if (wavefront_kernel_uses_sorting(kernel)) {
+      /* Stable sort to keep neighboring pixels together for the same shader. */
+      std::stable_sort(queued_states.begin(),
+                       queued_states.end(),
+                       [](const IntegratorStateCPU *a, const IntegratorStateCPU *b) {
+                         return a->path.shader_sort_key < b->path.shader_sort_key;
+                       });
+    }
+
+    for (IntegratorStateCPU *state : queued_states) {
+      switch (kernel) {
+        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_CLOSEST:
+          kernels_.integrator_intersect_closest(kernel_globals, state, render_buffer);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_SHADE_BACKGROUND:
+          kernels_.integrator_shade_background(kernel_globals, state, render_buffer);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE:
+          kernels_.integrator_shade_surface(kernel_globals, state, render_buffer);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_SHADE_VOLUME:
+          kernels_.integrator_shade_volume(kernel_globals, state, render_buffer);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_RAYTRACE:
+          kernels_.integrator_shade_surface_raytrace(kernel_globals, state, render_buffer);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_SHADE_SURFACE_MNEE:
+          kernels_.integrator_shade_surface_mnee(kernel_globals, state, render_buffer);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_SHADE_LIGHT:
+          kernels_.integrator_shade_light(kernel_globals, state, render_buffer);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_SUBSURFACE:
+          kernels_.integrator_intersect_subsurface(kernel_globals, state);
+          break;
+        case DEVICE_KERNEL_INTEGRATOR_INTERSECT_VOLUME_STACK:
+          kernels_.integrator_intersect_volume_stack(kernel_globals, state);
+          break;
+        default:
+          LOG(FATAL) << "Unhandled kernel " << device_kernel_as_string(kernel)
+                     << " used for path iteration, should never happen.";
+          return;
+      }
+    }
+  }
+}
+
+void PathTraceWorkCPU::wavefront_execute_shadow(KernelGlobalsCPU *kernel_globals,
+                                                IntegratorStateCPU *states,
+                                                const int num_states,
+                                                float *render_buffer)
+{
+  /* Intersect all shadow rays at once, then shade all of them. Shading may queue another
+   * intersection for transparent shadows with many hits. */
+  while (true) {
+    bool has_queued = false;
+
+    for (int i = 0; i < num_states; i++) {
+      for (IntegratorShadowStateCPU *shadow_state : {&states[i].shadow, &states[i].ao}) {
+        if (shadow_state->shadow_path.queued_kernel ==
+            DEVICE_KERNEL_INTEGRATOR_INTERSECT_SHADOW) {
+          kernels_.integrator_intersect_shadow(kernel_globals, shadow_state);
+          has_queued = true;
+        }
+      }
+    }
+
+    for (int i = 0; i < num_states; i++) {
+      for (IntegratorShadowStateCPU *shadow_state : {&states[i].shadow, &states[i].ao}) {
+        if (shadow_state->shadow_path.queued_kernel == DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW) {
+          kernels_.integrator_shade_shadow(kernel_globals, shadow_state, render_buffer);
+          has_queued = true;
+        }
+      }
+    }
+
+    if (!has_queued) {
+      break;
+    }
+  }
+}
+
 void PathTraceWorkCPU::copy_to_display(PathTraceDisplay *display,
                                        PassMode pass_mode,
                                        int num_samples)
@@ -10,12 +10,15 @@
 
 #include "integrator/path_trace_work.h"
 
+#include "util/unique_ptr.h"
 #include "util/vector.h"
 
 CCL_NAMESPACE_BEGIN
 
 struct KernelWorkTile;
 struct KernelGlobalsCPU;
+struct IntegratorStateCPU;
+struct IntegratorShadowStateCPU;
 
 class CPUKernels;
 
@@ -33,6 +36,10 @@ class PathTraceWorkCPU : public PathTraceWork {
 
   virtual void init_execution() override;
 
+#ifdef __PATH_GUIDING__
+  virtual void guiding_init_kernel_globals(const KernelGuidingField *guiding_field) override;
+#endif
+
   virtual void render_samples(RenderStatistics &statistics,
                               int start_sample,
                               int samples_num,
@@ -56,6 +63,26 @@ class PathTraceWorkCPU : public PathTraceWork {
                                     const KernelWorkTile &work_tile,
                                     const int samples_num);
 
+  /* Wavefront path tracing routine. Renders all pixels of the given work tile at once, executing
+   * one kernel at a time for all paths which are queued for it, sorted by shader. */
+  void render_samples_wavefront(KernelGlobalsCPU *kernel_globals,
+                                const KernelWorkTile &work_tile,
+                                const int samples_num);
+
+  /* Execute queued kernels of the given states until all of their paths are terminated. */
+  void wavefront_execute(KernelGlobalsCPU *kernel_globals,
+                         IntegratorStateCPU *states,
+                         const int num_states,
+                         float *render_buffer);
+  void wavefront_execute_shadow(KernelGlobalsCPU *kernel_globals,
+                                IntegratorStateCPU *states,
+                                const int num_states,
+                                float *render_buffer);
+
+  /* Get integrator states of the current thread for wavefront path tracing, with room for at
+   * least the given number of states. */
+  IntegratorStateCPU *wavefront_thread_states_get(const int num_states);
+
   /* CPU kernels. */
   const CPUKernels &kernels_;
 
@@ -65,6 +92,14 @@ class PathTraceWorkCPU : public PathTraceWork {
    * accessing it, but some "localization" is required to decouple from kernel globals stored
    * on the device level. */
   vector<CPUKernelThreadGlobals> kernel_thread_globals_;
+
+  /* Integrator states of each thread used by the wavefront path tracing. They are reused for all
+   * tiles and samples, and only reallocated when a tile needs more states. */
+  struct WavefrontThreadStates {
+    unique_ptr<IntegratorStateCPU[]> states;
+    int num_states = 0;
+  };
+  vector<WavefrontThreadStates> wavefront_thread_states_;
 };
 
 CCL_NAMESPACE_END
@@ -36,6 +36,11 @@ typedef struct KernelGlobalsCPU {
   OSLThreadData *osl_tdata;
 #endif
 
+#ifdef __PATH_GUIDING__
+  /* Path guiding field, owned by the path tracer. NULL when guiding is not used. */
+  const KernelGuidingField *guiding_field = nullptr;
+#endif
+
   /* **** Run-time data ****  */
 
   ProfilingState profiler;
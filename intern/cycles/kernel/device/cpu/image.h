@@ -731,7 +731,10 @@ template<typename TexT, typename OutT = float4> struct NanoVDBInterpolator {
 
 #undef SET_CUBIC_SPLINE_WEIGHTS
 
-ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, float y)
+/* The derivatives of the texture coordinates with respect to screen space are only used to filter
+ * images in the texture cache, other images are always sampled at full resolution. */
+ccl_device float4 kernel_tex_image_interp(
+    KernelGlobals kg, int id, float x, float y, float2 duv_dx, float2 duv_dy)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
@@ -764,6 +767,12 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
       return TextureInterpolator<ushort4>::interp(info, x, y);
     case IMAGE_DATA_TYPE_FLOAT4:
       return TextureInterpolator<float4>::interp(info, x, y);
+    case IMAGE_DATA_TYPE_CACHED: {
+      const TextureCacheImage *texture = (const TextureCacheImage *)info.data;
+      float rgba[4];
+      texture->lookup(texture, x, y, duv_dx, duv_dy, rgba);
+      return make_float4(rgba[0], rgba[1], rgba[2], rgba[3]);
+    }
     default:
       assert(0);
       return make_float4(
@@ -771,6 +780,11 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
   }
 }
 
+ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, float y)
+{
+  return kernel_tex_image_interp(kg, id, x, y, zero_float2(), zero_float2());
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals kg,
                                              int id,
                                              float3 P,
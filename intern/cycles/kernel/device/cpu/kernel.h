@@ -17,6 +17,7 @@ CCL_NAMESPACE_BEGIN
 #define KERNEL_FUNCTION_FULL_NAME(name) KERNEL_NAME_EVAL(KERNEL_ARCH, name)
 
 struct IntegratorStateCPU;
+struct IntegratorShadowStateCPU;
 struct KernelGlobalsCPU;
 struct KernelData;
 
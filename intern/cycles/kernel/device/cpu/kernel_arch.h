@@ -16,6 +16,15 @@
                                                     IntegratorStateCPU *state, \
                                                     ccl_global float *render_buffer)
 
+#define KERNEL_INTEGRATOR_SHADOW_FUNCTION(name) \
+  void KERNEL_FUNCTION_FULL_NAME(integrator_##name)(const KernelGlobalsCPU *ccl_restrict kg, \
+                                                    IntegratorShadowStateCPU *state)
+
+#define KERNEL_INTEGRATOR_SHADOW_SHADE_FUNCTION(name) \
+  void KERNEL_FUNCTION_FULL_NAME(integrator_##name)(const KernelGlobalsCPU *ccl_restrict kg, \
+                                                    IntegratorShadowStateCPU *state, \
+                                                    ccl_global float *render_buffer)
+
 #define KERNEL_INTEGRATOR_INIT_FUNCTION(name) \
   bool KERNEL_FUNCTION_FULL_NAME(integrator_##name)(const KernelGlobalsCPU *ccl_restrict kg, \
                                                     IntegratorStateCPU *state, \
@@ -25,19 +34,23 @@
 KERNEL_INTEGRATOR_INIT_FUNCTION(init_from_camera);
 KERNEL_INTEGRATOR_INIT_FUNCTION(init_from_bake);
 KERNEL_INTEGRATOR_SHADE_FUNCTION(intersect_closest);
-KERNEL_INTEGRATOR_FUNCTION(intersect_shadow);
+KERNEL_INTEGRATOR_SHADOW_FUNCTION(intersect_shadow);
 KERNEL_INTEGRATOR_FUNCTION(intersect_subsurface);
 KERNEL_INTEGRATOR_FUNCTION(intersect_volume_stack);
 KERNEL_INTEGRATOR_SHADE_FUNCTION(shade_background);
 KERNEL_INTEGRATOR_SHADE_FUNCTION(shade_light);
-KERNEL_INTEGRATOR_SHADE_FUNCTION(shade_shadow);
+KERNEL_INTEGRATOR_SHADOW_SHADE_FUNCTION(shade_shadow);
 KERNEL_INTEGRATOR_SHADE_FUNCTION(shade_surface);
+KERNEL_INTEGRATOR_SHADE_FUNCTION(shade_surface_raytrace);
+KERNEL_INTEGRATOR_SHADE_FUNCTION(shade_surface_mnee);
 KERNEL_INTEGRATOR_SHADE_FUNCTION(shade_volume);
 KERNEL_INTEGRATOR_SHADE_FUNCTION(megakernel);
 
 #undef KERNEL_INTEGRATOR_FUNCTION
 #undef KERNEL_INTEGRATOR_INIT_FUNCTION
 #undef KERNEL_INTEGRATOR_SHADE_FUNCTION
+#undef KERNEL_INTEGRATOR_SHADOW_FUNCTION
+#undef KERNEL_INTEGRATOR_SHADOW_SHADE_FUNCTION
 
 #define KERNEL_FILM_CONVERT_FUNCTION(name) \
   void KERNEL_FUNCTION_FULL_NAME(film_convert_##name)(const KernelFilmConvert *kfilm_convert, \
@@ -210,6 +210,13 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals kg, int id, float x, flo
   }
 }
 
+/* Derivatives are only used by images in the texture cache, which is not supported on the GPU. */
+ccl_device float4 kernel_tex_image_interp(
+    KernelGlobals kg, int id, float x, float y, float2 duv_dx, float2 duv_dy)
+{
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals kg,
                                              int id,
                                              float3 P,
@@ -0,0 +1,267 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+/* Path Guiding
+ *
+ * At diffuse surfaces and in volumes, directions are sampled from either the BSDF or phase
+ * function, or from a learned distribution of incident radiance, combined with one-sample MIS.
+ * The distribution is a spatial binary tree with directional histograms in the leaves, see
+ * #GuidingField.
+ *
+ * While training, the directional bin sampled at the last guided vertex is kept in the path
+ * state. Everything the path contributes to the render buffer afterwards, including direct light
+ * of later vertices, is recorded as radiance incident at that vertex. Records go directly into
+ * host memory, so guiding is only available on the CPU. */
+
+#pragma once
+
+CCL_NAMESPACE_BEGIN
+
+#ifdef __PATH_GUIDING__
+
+/* Probability of sampling the BSDF or phase function rather than the guiding field. */
+#  define GUIDING_BSDF_SAMPLING_FRACTION 0.5f
+
+/* Index of the leaf of the spatial tree containing P. */
+ccl_device_inline int guiding_leaf(ccl_global const KernelGuidingField *field, const float3 P)
+{
+  float3 bounds_min = field->bounds_min;
+  float3 bounds_max = field->bounds_max;
+  int node_index = 0;
+
+  while (true) {
+    ccl_global const KernelGuidingNode *node = &field->nodes[node_index];
+    if (node->axis == -1) {
+      return node->child;
+    }
+
+    const int axis = node->axis;
+    const float middle = 0.5f * (bounds_min[axis] + bounds_max[axis]);
+    if (P[axis] < middle) {
+      bounds_max[axis] = middle;
+      node_index = node->child;
+    }
+    else {
+      bounds_min[axis] = middle;
+      node_index = node->child + 1;
+    }
+  }
+}
+
+/* Equal area mapping of directions to bins, with cos(theta) along x and phi along y. */
+ccl_device_inline int guiding_direction_to_bin(const float3 D)
+{
+  const float u = 0.5f * (D.z + 1.0f);
+  const float v = (atan2f(D.y, D.x) + M_PI_F) * M_1_2PI_F;
+  const int x = clamp((int)(u * GUIDING_DIRECTIONAL_RESOLUTION),
+                      0,
+                      GUIDING_DIRECTIONAL_RESOLUTION - 1);
+  const int y = clamp((int)(v * GUIDING_DIRECTIONAL_RESOLUTION),
+                      0,
+                      GUIDING_DIRECTIONAL_RESOLUTION - 1);
+  return y * GUIDING_DIRECTIONAL_RESOLUTION + x;
+}
+
+/* Guiding is only used where the BSDF is smooth, so that sampling the incident radiance alone is
+ * a reasonable approximation of the product with the BSDF. Other surfaces are sampled as before,
+ * but still pass on the records of earlier vertices, so that for example caustics through glass
+ * are learned at the diffuse vertex in front of it. */
+ccl_device_inline bool guiding_surface_is_guided(KernelGlobals kg,
+                                                 ccl_private const ShaderData *sd)
+{
+  if (kg->guiding_field == NULL || (sd->flag & (SD_BSDF | SD_BSSRDF)) != SD_BSDF) {
+    return false;
+  }
+
+  for (int i = 0; i < sd->num_closure; i++) {
+    const ClosureType type = sd->closure[i].type;
+    if (CLOSURE_IS_BSDF(type) && !CLOSURE_IS_BSDF_DIFFUSE(type)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+ccl_device_inline bool guiding_volume_is_guided(KernelGlobals kg)
+{
+  return kg->guiding_field != NULL;
+}
+
+/* Cumulative distribution over the directional bins at P, or NULL when nothing was learned
+ * there yet. */
+ccl_device_inline ccl_global const float *guiding_distribution(KernelGlobals kg, const float3 P)
+{
+  ccl_global const KernelGuidingField *field = kg->guiding_field;
+  if (field == NULL || field->sampling_cdf == NULL) {
+    return NULL;
+  }
+
+  ccl_global const float *cdf = field->sampling_cdf +
+                                guiding_leaf(field, P) * GUIDING_DIRECTIONAL_BINS;
+  return (cdf[GUIDING_DIRECTIONAL_BINS - 1] > 0.0f) ? cdf : NULL;
+}
+
+ccl_device_inline float guiding_distribution_pdf(ccl_global const float *cdf, const float3 D)
+{
+  const int bin = guiding_direction_to_bin(D);
+  const float probability = cdf[bin] - ((bin > 0) ? cdf[bin - 1] : 0.0f);
+  return probability * (GUIDING_DIRECTIONAL_BINS / M_4PI_F);
+}
+
+/* Sample a direction by picking a bin with the cumulative distribution, and a uniformly
+ * distributed direction inside of it. Returns the pdf of the direction. */
+ccl_device float guiding_distribution_sample(ccl_global const float *cdf,
+                                             const float randu,
+                                             const float randv,
+                                             ccl_private float3 *D)
+{
+  int low = 0;
+  int high = GUIDING_DIRECTIONAL_BINS - 1;
+  while (low < high) {
+    const int middle = (low + high) / 2;
+    if (cdf[middle] <= randu) {
+      low = middle + 1;
+    }
+    else {
+      high = middle;
+    }
+  }
+
+  const int bin = low;
+  const float cdf_low = (bin > 0) ? cdf[bin - 1] : 0.0f;
+  const float probability = cdf[bin] - cdf_low;
+  const float bin_u = clamp((randu - cdf_low) / probability, 0.0f, 1.0f);
+
+  const float u = ((bin % GUIDING_DIRECTIONAL_RESOLUTION) + bin_u) *
+                  (1.0f / GUIDING_DIRECTIONAL_RESOLUTION);
+  const float v = ((bin / GUIDING_DIRECTIONAL_RESOLUTION) + randv) *
+                  (1.0f / GUIDING_DIRECTIONAL_RESOLUTION);
+
+  const float cos_theta = 2.0f * u - 1.0f;
+  const float sin_theta = safe_sqrtf(1.0f - cos_theta * cos_theta);
+  const float phi = M_2PI_F * v - M_PI_F;
+  *D = make_float3(sin_theta * cosf(phi), sin_theta * sinf(phi), cos_theta);
+
+  return probability * (GUIDING_DIRECTIONAL_BINS / M_4PI_F);
+}
+
+/* Pdf of the one-sample MIS combination of BSDF and guiding field sampling. */
+ccl_device_inline float guiding_mis_pdf(const float bsdf_pdf, const float guiding_pdf)
+{
+  return GUIDING_BSDF_SAMPLING_FRACTION * bsdf_pdf +
+         (1.0f - GUIDING_BSDF_SAMPLING_FRACTION) * guiding_pdf;
+}
+
+/* Pdf of sampling direction D at a surface or volume vertex, for MIS with light sampling. */
+ccl_device_inline float guiding_bsdf_pdf(KernelGlobals kg,
+                                         const bool is_guided,
+                                         const float3 P,
+                                         const float3 D,
+                                         const float bsdf_pdf)
+{
+  if (!is_guided) {
+    return bsdf_pdf;
+  }
+
+  ccl_global const float *cdf = guiding_distribution(kg, P);
+  return (cdf) ? guiding_mis_pdf(bsdf_pdf, guiding_distribution_pdf(cdf, D)) : bsdf_pdf;
+}
+
+/* Start recording radiance incident at a new guided vertex, from direction D sampled with the
+ * given pdf. Throughput is the path throughput after the vertex. */
+ccl_device_inline void guiding_record_vertex(KernelGlobals kg,
+                                             IntegratorState state,
+                                             const float3 P,
+                                             const float3 D,
+                                             const float3 throughput,
+                                             const float pdf)
+{
+  ccl_global const KernelGuidingField *field = kg->guiding_field;
+  if (field->training_radiance == NULL) {
+    return;
+  }
+
+  const int leaf = guiding_leaf(field, P);
+  atomic_fetch_and_add_uint32(&field->training_records[leaf], 1);
+
+  INTEGRATOR_STATE_WRITE(state, guiding, record_index) = leaf * GUIDING_DIRECTIONAL_BINS +
+                                                         guiding_direction_to_bin(D);
+  INTEGRATOR_STATE_WRITE(state, guiding, record_weight) = throughput * pdf;
+}
+
+ccl_device_inline void guiding_record(ccl_global const KernelGuidingField *field,
+                                      const uint32_t record_index,
+                                      const float3 record_weight,
+                                      const float3 contribution)
+{
+  /* The contribution is the throughput after the vertex times the radiance coming in from the
+   * sampled direction, dividing by the record weight gives incident radiance over pdf. */
+  const float radiance = average(safe_divide_float3_float3(contribution, record_weight));
+  if (radiance > 0.0f && isfinite_safe(radiance)) {
+    atomic_add_and_fetch_float(&field->training_radiance[record_index], radiance);
+  }
+}
+
+#endif /* __PATH_GUIDING__ */
+
+/* Record a contribution of the main path to the render buffer. */
+ccl_device_inline void guiding_record_radiance(KernelGlobals kg,
+                                               ConstIntegratorState state,
+                                               const float3 contribution)
+{
+#ifdef __PATH_GUIDING__
+  ccl_global const KernelGuidingField *field = kg->guiding_field;
+  if (field == NULL || field->training_radiance == NULL) {
+    return;
+  }
+
+  const uint32_t record_index = INTEGRATOR_STATE(state, guiding, record_index);
+  if (record_index != GUIDING_RECORD_NONE) {
+    guiding_record(
+        field, record_index, INTEGRATOR_STATE(state, guiding, record_weight), contribution);
+  }
+#endif
+}
+
+/* Pass the record of the main path on to a shadow path for direct light. */
+ccl_device_inline void guiding_record_copy_to_shadow(KernelGlobals kg,
+                                                     IntegratorShadowState shadow_state,
+                                                     ConstIntegratorState state)
+{
+#ifdef __PATH_GUIDING__
+  if (kg->guiding_field == NULL || kg->guiding_field->training_radiance == NULL) {
+    return;
+  }
+
+  INTEGRATOR_STATE_WRITE(shadow_state, shadow_path, guiding_record_index) = INTEGRATOR_STATE(
+      state, guiding, record_index);
+  INTEGRATOR_STATE_WRITE(shadow_state, shadow_path, guiding_record_weight) = INTEGRATOR_STATE(
+      state, guiding, record_weight);
+#endif
+}
+
+/* Record the contribution of an unoccluded shadow path for direct light. */
+ccl_device_inline void guiding_record_light(KernelGlobals kg, ConstIntegratorShadowState state)
+{
+#ifdef __PATH_GUIDING__
+  ccl_global const KernelGuidingField *field = kg->guiding_field;
+  if (field == NULL || field->training_radiance == NULL) {
+    return;
+  }
+
+  if (INTEGRATOR_STATE(state, shadow_path, flag) & PATH_RAY_SHADOW_FOR_AO) {
+    return;
+  }
+
+  const uint32_t record_index = INTEGRATOR_STATE(state, shadow_path, guiding_record_index);
+  if (record_index != GUIDING_RECORD_NONE) {
+    guiding_record(field,
+                   record_index,
+                   INTEGRATOR_STATE(state, shadow_path, guiding_record_weight),
+                   INTEGRATOR_STATE(state, shadow_path, throughput));
+  }
+#endif
+}
+
+CCL_NAMESPACE_END
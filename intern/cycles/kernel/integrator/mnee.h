@@ -111,6 +111,7 @@ ccl_device_inline float mat22_inverse(const float4 m, ccl_private float4 &m_inve
 /* Update light sample */
 ccl_device_forceinline void mnee_update_light_sample(KernelGlobals kg,
                                                      const float3 P,
+                                                     const float pdf_selection,
                                                      ccl_private LightSample *ls)
 {
   /* correct light sample position/direction and pdf
@@ -141,7 +142,7 @@ ccl_device_forceinline void mnee_update_light_sample(KernelGlobals kg,
     ls->pdf = fabsf(klight->area.invarea);
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= pdf_selection;
 }
 
 /* Manifold vertex setup from ray and intersection data */
@@ -804,8 +805,9 @@ ccl_device_forceinline bool mnee_path_contribution(KernelGlobals kg,
   shader_bsdf_eval(kg, sd, wo, false, throughput, ls->shader);
 
   /* Update light sample with new position / direct.ion
-   * and keep pdf in vertex area measure */
-  mnee_update_light_sample(kg, vertices[vertex_count - 1].p, ls);
+   * and keep pdf in vertex area measure. The light was picked from the shading point. */
+  const float pdf_selection = light_distribution_pdf_lamp(kg, ls->lamp, sd->P);
+  mnee_update_light_sample(kg, vertices[vertex_count - 1].p, pdf_selection, ls);
 
   /* Save state path bounce info in case a light path node is used in the refractive interface or
    * light shader graph. */
@@ -61,6 +61,12 @@ ccl_device_inline void path_state_init_integrator(KernelGlobals kg,
   INTEGRATOR_STATE_WRITE(state, path, mnee) = 0;
 #endif
 
+#ifdef __PATH_GUIDING__
+  if (kernel_data.kernel_features & KERNEL_FEATURE_PATH_GUIDING) {
+    INTEGRATOR_STATE_WRITE(state, guiding, record_index) = GUIDING_RECORD_NONE;
+  }
+#endif
+
   INTEGRATOR_STATE_WRITE(state, isect, object) = OBJECT_NONE;
   INTEGRATOR_STATE_WRITE(state, isect, prim) = PRIM_NONE;
 
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "kernel/film/accumulate.h"
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/shader_eval.h"
 #include "kernel/light/light.h"
 #include "kernel/light/sample.h"
@@ -129,6 +130,7 @@ ccl_device_inline void integrate_background(KernelGlobals kg,
 
   /* Write to render buffer. */
   kernel_accum_background(kg, state, L, transparent, is_transparent_background_ray, render_buffer);
+  guiding_record_radiance(kg, state, INTEGRATOR_STATE(state, path, throughput) * L);
 }
 
 ccl_device_inline void integrate_distant_lights(KernelGlobals kg,
@@ -188,6 +190,7 @@ ccl_device_inline void integrate_distant_lights(KernelGlobals kg,
       const float3 throughput = INTEGRATOR_STATE(state, path, throughput);
       kernel_accum_emission(
           kg, state, throughput * light_eval, render_buffer, kernel_data.background.lightgroup);
+      guiding_record_radiance(kg, state, throughput * light_eval);
     }
   }
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "kernel/film/accumulate.h"
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/shader_eval.h"
 #include "kernel/light/light.h"
 #include "kernel/light/sample.h"
@@ -79,6 +80,7 @@ ccl_device_inline void integrate_light(KernelGlobals kg,
   /* Write to render buffer. */
   const float3 throughput = INTEGRATOR_STATE(state, path, throughput);
   kernel_accum_emission(kg, state, throughput * light_eval, render_buffer, ls.group);
+  guiding_record_radiance(kg, state, throughput * light_eval);
 }
 
 ccl_device void integrator_shade_light(KernelGlobals kg,
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/shade_volume.h"
 #include "kernel/integrator/shader_eval.h"
 #include "kernel/integrator/volume_stack.h"
@@ -171,6 +172,7 @@ ccl_device void integrator_shade_shadow(KernelGlobals kg,
   }
   else {
     kernel_accum_light(kg, state, render_buffer);
+    guiding_record_light(kg, state);
     INTEGRATOR_SHADOW_PATH_TERMINATE(DEVICE_KERNEL_INTEGRATOR_SHADE_SHADOW);
     return;
   }
@@ -8,6 +8,7 @@
 
 #include "kernel/integrator/mnee.h"
 
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/path_state.h"
 #include "kernel/integrator/shader_eval.h"
 #include "kernel/integrator/subsurface.h"
@@ -81,7 +82,9 @@ ccl_device_forceinline void integrate_surface_emission(KernelGlobals kg,
 
     /* Multiple importance sampling, get triangle light pdf,
      * and compute weight with respect to BSDF pdf. */
-    float pdf = triangle_light_pdf(kg, sd, t);
+    const float pdf_triangles = light_distribution_pdf_triangle(
+        kg, sd->object, sd->prim, sd->P + sd->I * t);
+    float pdf = triangle_light_pdf(kg, sd, t, pdf_triangles);
     float mis_weight = light_sample_mis_weight_forward(kg, bsdf_pdf, pdf);
     L *= mis_weight;
   }
@@ -89,6 +92,7 @@ ccl_device_forceinline void integrate_surface_emission(KernelGlobals kg,
   const float3 throughput = INTEGRATOR_STATE(state, path, throughput);
   kernel_accum_emission(
       kg, state, throughput * L, render_buffer, object_lightgroup(kg, sd->object));
+  guiding_record_radiance(kg, state, throughput * L);
 }
 #endif /* __EMISSION__ */
 
@@ -169,9 +173,13 @@ ccl_device_forceinline void integrate_surface_direct_light(KernelGlobals kg,
     }
 
     /* Evaluate BSDF. */
-    const float bsdf_pdf = shader_bsdf_eval(kg, sd, ls.D, is_transmission, &bsdf_eval, ls.shader);
+    float bsdf_pdf = shader_bsdf_eval(kg, sd, ls.D, is_transmission, &bsdf_eval, ls.shader);
     bsdf_eval_mul3(&bsdf_eval, light_eval / ls.pdf);
 
+#  ifdef __PATH_GUIDING__
+    bsdf_pdf = guiding_bsdf_pdf(kg, guiding_surface_is_guided(kg, sd), sd->P, ls.D, bsdf_pdf);
+#  endif
+
     if (ls.shader & SHADER_USE_MIS) {
       const float mis_weight = light_sample_mis_weight_nee(kg, ls.pdf, bsdf_pdf);
       bsdf_eval_mul(&bsdf_eval, mis_weight);
@@ -283,6 +291,8 @@ ccl_device_forceinline void integrate_surface_direct_light(KernelGlobals kg,
       shadow_state, shadow_path, lightgroup) = (ls.type != LIGHT_BACKGROUND) ?
                                                    ls.group + 1 :
                                                    kernel_data.background.lightgroup + 1;
+
+  guiding_record_copy_to_shadow(kg, shadow_state, state);
 }
 #endif
 
@@ -316,8 +326,34 @@ ccl_device_forceinline int integrate_surface_bsdf_bssrdf_bounce(
   differential3 bsdf_domega_in ccl_optional_struct_init;
   int label;
 
-  label = shader_bsdf_sample_closure(
-      kg, sd, sc, bsdf_u, bsdf_v, &bsdf_eval, &bsdf_omega_in, &bsdf_domega_in, &bsdf_pdf);
+#ifdef __PATH_GUIDING__
+  const bool is_guided = guiding_surface_is_guided(kg, sd);
+  ccl_global const float *guiding_cdf = (is_guided) ? guiding_distribution(kg, sd->P) : NULL;
+
+  if (guiding_cdf && bsdf_u >= GUIDING_BSDF_SAMPLING_FRACTION) {
+    /* Sample direction from the guiding field, and evaluate all BSDFs for it. */
+    bsdf_u = (bsdf_u - GUIDING_BSDF_SAMPLING_FRACTION) / (1.0f - GUIDING_BSDF_SAMPLING_FRACTION);
+    const float guiding_pdf = guiding_distribution_sample(
+        guiding_cdf, bsdf_u, bsdf_v, &bsdf_omega_in);
+    const bool is_transmission = shader_bsdf_is_transmission(sd, bsdf_omega_in);
+    bsdf_pdf = shader_bsdf_eval(kg, sd, bsdf_omega_in, is_transmission, &bsdf_eval, 0);
+    bsdf_pdf = guiding_mis_pdf(bsdf_pdf, guiding_pdf);
+    bsdf_domega_in = differential3_zero();
+    label = LABEL_DIFFUSE | ((is_transmission) ? LABEL_TRANSMIT : LABEL_REFLECT);
+  }
+  else if (guiding_cdf) {
+    /* Sample direction from the BSDF, with the pdf of both strategies for MIS. */
+    bsdf_u = bsdf_u / GUIDING_BSDF_SAMPLING_FRACTION;
+    label = shader_bsdf_sample_closure(
+        kg, sd, sc, bsdf_u, bsdf_v, &bsdf_eval, &bsdf_omega_in, &bsdf_domega_in, &bsdf_pdf);
+    bsdf_pdf = guiding_mis_pdf(bsdf_pdf, guiding_distribution_pdf(guiding_cdf, bsdf_omega_in));
+  }
+  else
+#endif
+  {
+    label = shader_bsdf_sample_closure(
+        kg, sd, sc, bsdf_u, bsdf_v, &bsdf_eval, &bsdf_omega_in, &bsdf_domega_in, &bsdf_pdf);
+  }
 
   if (bsdf_pdf == 0.0f || bsdf_eval_is_zero(&bsdf_eval)) {
     return LABEL_NONE;
@@ -339,6 +375,12 @@ ccl_device_forceinline int integrate_surface_bsdf_bssrdf_bounce(
   throughput *= bsdf_eval_sum(&bsdf_eval) / bsdf_pdf;
   INTEGRATOR_STATE_WRITE(state, path, throughput) = throughput;
 
+#ifdef __PATH_GUIDING__
+  if (is_guided) {
+    guiding_record_vertex(kg, state, sd->P, normalize(bsdf_omega_in), throughput, bsdf_pdf);
+  }
+#endif
+
   if (kernel_data.kernel_features & KERNEL_FEATURE_LIGHT_PASSES) {
     if (INTEGRATOR_STATE(state, path, bounce) == 0) {
       INTEGRATOR_STATE_WRITE(state, path, pass_diffuse_weight) = bsdf_eval_pass_diffuse_weight(
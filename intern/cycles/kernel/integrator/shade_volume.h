@@ -6,6 +6,7 @@
 #include "kernel/film/accumulate.h"
 #include "kernel/film/passes.h"
 
+#include "kernel/integrator/guiding.h"
 #include "kernel/integrator/intersect_closest.h"
 #include "kernel/integrator/path_state.h"
 #include "kernel/integrator/shader_eval.h"
@@ -655,6 +656,7 @@ ccl_device_forceinline void volume_integrate_heterogeneous(
   if (!is_zero(accum_emission)) {
     kernel_accum_emission(
         kg, state, accum_emission, render_buffer, object_lightgroup(kg, sd->object));
+    guiding_record_radiance(kg, state, accum_emission);
   }
 
 #  ifdef __DENOISING_FEATURES__
@@ -753,7 +755,11 @@ ccl_device_forceinline void integrate_volume_direct_light(
 
   /* Evaluate BSDF. */
   BsdfEval phase_eval ccl_optional_struct_init;
-  const float phase_pdf = shader_volume_phase_eval(kg, sd, phases, ls->D, &phase_eval);
+  float phase_pdf = shader_volume_phase_eval(kg, sd, phases, ls->D, &phase_eval);
+
+#    ifdef __PATH_GUIDING__
+  phase_pdf = guiding_bsdf_pdf(kg, guiding_volume_is_guided(kg), P, ls->D, phase_pdf);
+#    endif
 
   if (ls->shader & SHADER_USE_MIS) {
     float mis_weight = light_sample_mis_weight_nee(kg, ls->pdf, phase_pdf);
@@ -840,6 +846,8 @@ ccl_device_forceinline void integrate_volume_direct_light(
                                                    ls->group + 1 :
                                                    kernel_data.background.lightgroup + 1;
 
+  guiding_record_copy_to_shadow(kg, shadow_state, state);
+
   integrator_state_copy_volume_stack_to_shadow(kg, shadow_state, state);
 }
 #  endif
@@ -862,16 +870,50 @@ ccl_device_forceinline bool integrate_volume_phase_scatter(
   BsdfEval phase_eval ccl_optional_struct_init;
   float3 phase_omega_in ccl_optional_struct_init;
   differential3 phase_domega_in ccl_optional_struct_init;
-
-  const int label = shader_volume_phase_sample(kg,
-                                               sd,
-                                               phases,
-                                               phase_u,
-                                               phase_v,
-                                               &phase_eval,
-                                               &phase_omega_in,
-                                               &phase_domega_in,
-                                               &phase_pdf);
+  int label;
+
+#  ifdef __PATH_GUIDING__
+  const bool is_guided = guiding_volume_is_guided(kg);
+  ccl_global const float *guiding_cdf = (is_guided) ? guiding_distribution(kg, sd->P) : NULL;
+
+  if (guiding_cdf && phase_u >= GUIDING_BSDF_SAMPLING_FRACTION) {
+    /* Sample direction from the guiding field, and evaluate the phase functions for it. */
+    phase_u = (phase_u - GUIDING_BSDF_SAMPLING_FRACTION) /
+              (1.0f - GUIDING_BSDF_SAMPLING_FRACTION);
+    const float guiding_pdf = guiding_distribution_sample(
+        guiding_cdf, phase_u, phase_v, &phase_omega_in);
+    phase_pdf = shader_volume_phase_eval(kg, sd, phases, phase_omega_in, &phase_eval);
+    phase_pdf = guiding_mis_pdf(phase_pdf, guiding_pdf);
+    phase_domega_in = differential3_zero();
+    label = LABEL_VOLUME_SCATTER;
+  }
+  else if (guiding_cdf) {
+    /* Sample direction from the phase function, with the pdf of both strategies for MIS. */
+    phase_u = phase_u / GUIDING_BSDF_SAMPLING_FRACTION;
+    label = shader_volume_phase_sample(kg,
+                                       sd,
+                                       phases,
+                                       phase_u,
+                                       phase_v,
+                                       &phase_eval,
+                                       &phase_omega_in,
+                                       &phase_domega_in,
+                                       &phase_pdf);
+    phase_pdf = guiding_mis_pdf(phase_pdf, guiding_distribution_pdf(guiding_cdf, phase_omega_in));
+  }
+  else
+#  endif
+  {
+    label = shader_volume_phase_sample(kg,
+                                       sd,
+                                       phases,
+                                       phase_u,
+                                       phase_v,
+                                       &phase_eval,
+                                       &phase_omega_in,
+                                       &phase_domega_in,
+                                       &phase_pdf);
+  }
 
   if (phase_pdf == 0.0f || bsdf_eval_is_zero(&phase_eval)) {
     return false;
@@ -894,6 +936,13 @@ ccl_device_forceinline bool integrate_volume_phase_scatter(
   const float3 throughput_phase = throughput * bsdf_eval_sum(&phase_eval) / phase_pdf;
   INTEGRATOR_STATE_WRITE(state, path, throughput) = throughput_phase;
 
+#  ifdef __PATH_GUIDING__
+  if (is_guided) {
+    guiding_record_vertex(
+        kg, state, sd->P, normalize(phase_omega_in), throughput_phase, phase_pdf);
+  }
+#  endif
+
   if (kernel_data.kernel_features & KERNEL_FEATURE_LIGHT_PASSES) {
     INTEGRATOR_STATE_WRITE(state, path, pass_diffuse_weight) = one_float3();
     INTEGRATOR_STATE_WRITE(state, path, pass_glossy_weight) = zero_float3();
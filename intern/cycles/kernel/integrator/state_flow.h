@@ -92,12 +92,14 @@ CCL_NAMESPACE_BEGIN
 
 #else
 
+/* The sort key is stored so that the CPU wavefront can group paths by shader, see
+ * PathTraceWorkCPU. */
 #  define INTEGRATOR_PATH_INIT(next_kernel) \
     INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel;
 #  define INTEGRATOR_PATH_INIT_SORTED(next_kernel, key) \
     { \
       INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel; \
-      (void)key; \
+      INTEGRATOR_STATE_WRITE(state, path, shader_sort_key) = key; \
     }
 #  define INTEGRATOR_PATH_NEXT(current_kernel, next_kernel) \
     { \
@@ -112,7 +114,7 @@ CCL_NAMESPACE_BEGIN
 #  define INTEGRATOR_PATH_NEXT_SORTED(current_kernel, next_kernel, key) \
     { \
       INTEGRATOR_STATE_WRITE(state, path, queued_kernel) = next_kernel; \
-      (void)key; \
+      INTEGRATOR_STATE_WRITE(state, path, shader_sort_key) = key; \
       (void)current_kernel; \
     }
 
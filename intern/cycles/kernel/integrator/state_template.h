@@ -90,6 +90,15 @@ KERNEL_STRUCT_MEMBER(subsurface, float, anisotropy, KERNEL_FEATURE_SUBSURFACE)
 KERNEL_STRUCT_MEMBER(subsurface, packed_float3, Ng, KERNEL_FEATURE_SUBSURFACE)
 KERNEL_STRUCT_END(subsurface)
 
+/******************************** Path Guiding ********************************/
+
+KERNEL_STRUCT_BEGIN(guiding)
+/* Training record of the directional bin sampled at the last guided vertex. */
+KERNEL_STRUCT_MEMBER(guiding, uint32_t, record_index, KERNEL_FEATURE_PATH_GUIDING)
+/* Throughput after the last guided vertex times the pdf of the sampled direction. */
+KERNEL_STRUCT_MEMBER(guiding, packed_float3, record_weight, KERNEL_FEATURE_PATH_GUIDING)
+KERNEL_STRUCT_END(guiding)
+
 /********************************** Volume Stack ******************************/
 
 KERNEL_STRUCT_BEGIN(volume_stack)
@@ -5,6 +5,7 @@
 
 #include "kernel/geom/geom.h"
 #include "kernel/light/background.h"
+#include "kernel/light/tree.h"
 #include "kernel/sample/mapping.h"
 
 CCL_NAMESPACE_BEGIN
@@ -27,6 +28,46 @@ typedef struct LightSample {
   LightType type; /* type of light */
 } LightSample;
 
+/* Light Selection */
+
+/* Probability of picking the lamp for next event estimation from position P. */
+ccl_device_inline float light_distribution_pdf_lamp(KernelGlobals kg,
+                                                    const int lamp,
+                                                    const float3 P)
+{
+  if (kernel_data.integrator.use_light_tree) {
+    const int emitter = kernel_tex_fetch(__light_to_tree, lamp);
+    if (emitter == -1) {
+      return 0.0f;
+    }
+    return light_tree_pdf(kg, P, emitter);
+  }
+  return kernel_data.integrator.pdf_lights;
+}
+
+/* Probability of picking the triangle for next event estimation from position P, divided by the
+ * area of the triangle. */
+ccl_device_inline float light_distribution_pdf_triangle(KernelGlobals kg,
+                                                        const int object,
+                                                        const int prim,
+                                                        const float3 P)
+{
+  if (kernel_data.integrator.use_light_tree) {
+    const int2 object_to_tree = kernel_tex_fetch(__object_to_tree, object);
+    if (object_to_tree.x == -1) {
+      return 0.0f;
+    }
+    const int emitter = kernel_tex_fetch(__triangle_to_tree,
+                                         object_to_tree.x + prim - object_to_tree.y);
+    if (emitter == -1) {
+      return 0.0f;
+    }
+    const float area = kernel_tex_fetch(__light_tree_emitters, emitter).area;
+    return (area > 0.0f) ? light_tree_pdf(kg, P, emitter) / area : 0.0f;
+  }
+  return kernel_data.integrator.pdf_triangles;
+}
+
 /* Regular Light */
 
 template<bool in_volume_segment>
@@ -36,6 +77,7 @@ ccl_device_inline bool light_sample(KernelGlobals kg,
                                     const float randv,
                                     const float3 P,
                                     const uint32_t path_flag,
+                                    const float pdf_selection,
                                     ccl_private LightSample *ls)
 {
   const ccl_global KernelLight *klight = &kernel_tex_fetch(__lights, lamp);
@@ -222,7 +264,7 @@ ccl_device_inline bool light_sample(KernelGlobals kg,
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= pdf_selection;
 
   return in_volume_segment || (ls->pdf > 0.0f);
 }
@@ -550,7 +592,7 @@ ccl_device bool light_sample_from_intersection(KernelGlobals kg,
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= light_distribution_pdf_lamp(kg, lamp, ray_P);
 
   return true;
 }
@@ -587,12 +629,12 @@ ccl_device_inline bool triangle_world_space_vertices(
   return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals kg,
+ccl_device_inline float triangle_light_pdf_area(const float pdf_triangles,
                                                 const float3 Ng,
                                                 const float3 I,
                                                 float t)
 {
-  float pdf = kernel_data.integrator.pdf_triangles;
+  float pdf = pdf_triangles;
   float cos_pi = fabsf(dot(Ng, I));
 
   if (cos_pi == 0.0f)
@@ -603,7 +645,8 @@ ccl_device_inline float triangle_light_pdf_area(KernelGlobals kg,
 
 ccl_device_forceinline float triangle_light_pdf(KernelGlobals kg,
                                                 ccl_private const ShaderData *sd,
-                                                float t)
+                                                float t,
+                                                const float pdf_triangles)
 {
   /* A naive heuristic to decide between costly solid angle sampling
    * and simple area sampling, comparing the distance to the triangle plane
@@ -650,12 +693,12 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals kg,
       else {
         area = 0.5f * len(N);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_triangles;
       return pdf / solid_angle;
     }
   }
   else {
-    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+    float pdf = triangle_light_pdf_area(pdf_triangles, sd->Ng, sd->I, t);
     if (has_motion) {
       const float area = 0.5f * len(N);
       if (UNLIKELY(area == 0.0f)) {
@@ -679,6 +722,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals kg,
                                                   float randu,
                                                   float randv,
                                                   float time,
+                                                  const float pdf_triangles,
                                                   ccl_private LightSample *ls,
                                                   const float3 P)
 {
@@ -793,7 +837,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals kg,
         triangle_world_space_vertices(kg, object, prim, -1.0f, V);
         area = triangle_area(V[0], V[1], V[2]);
       }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
+      const float pdf = area * pdf_triangles;
       ls->pdf = pdf / solid_angle;
     }
   }
@@ -815,7 +859,7 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals kg,
     ls->P = u * V[0] + v * V[1] + t * V[2];
     /* compute incoming direction, distance and pdf */
     ls->D = normalize_len(ls->P - P, &ls->t);
-    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
+    ls->pdf = triangle_light_pdf_area(pdf_triangles, ls->Ng, -ls->D, ls->t);
     if (has_motion && area != 0.0f) {
       /* scale the PDF.
        * area = the area the sample was taken from
@@ -884,15 +928,39 @@ ccl_device_noinline bool light_distribution_sample(KernelGlobals kg,
                                                    const uint32_t path_flag,
                                                    ccl_private LightSample *ls)
 {
-  /* Sample light index from distribution. */
-  const int index = light_distribution_sample(kg, &randu);
-  ccl_global const KernelLightDistribution *kdistribution = &kernel_tex_fetch(__light_distribution,
-                                                                              index);
-  const int prim = kdistribution->prim;
+  int prim, object, shader_flag;
+  float pdf_triangles, pdf_lights;
+
+  if (kernel_data.integrator.use_light_tree) {
+    /* Pick light from the tree, based on the estimated contribution at P. */
+    int emitter;
+    const float pdf_selection = light_tree_sample(kg, P, &randu, &emitter);
+    if (pdf_selection == 0.0f) {
+      return false;
+    }
+
+    ccl_global const KernelLightTreeEmitter *kemitter = &kernel_tex_fetch(__light_tree_emitters,
+                                                                          emitter);
+    prim = kemitter->prim;
+    object = kemitter->object_id;
+    shader_flag = kemitter->shader_flag;
+    pdf_triangles = (kemitter->area > 0.0f) ? pdf_selection / kemitter->area : 0.0f;
+    pdf_lights = pdf_selection;
+  }
+  else {
+    /* Sample light index from distribution. */
+    const int index = light_distribution_sample(kg, &randu);
+    ccl_global const KernelLightDistribution *kdistribution = &kernel_tex_fetch(
+        __light_distribution, index);
+    prim = kdistribution->prim;
+    object = kdistribution->mesh_light.object_id;
+    shader_flag = kdistribution->mesh_light.shader_flag;
+    pdf_triangles = kernel_data.integrator.pdf_triangles;
+    pdf_lights = kernel_data.integrator.pdf_lights;
+  }
 
   if (prim >= 0) {
     /* Mesh light. */
-    const int object = kdistribution->mesh_light.object_id;
 
     /* Exclude synthetic meshes from shadow catcher pass. */
     if ((path_flag & PATH_RAY_SHADOW_CATCHER_PASS) &&
@@ -900,8 +968,8 @@ ccl_device_noinline bool light_distribution_sample(KernelGlobals kg,
       return false;
     }
 
-    const int shader_flag = kdistribution->mesh_light.shader_flag;
-    triangle_light_sample<in_volume_segment>(kg, prim, object, randu, randv, time, ls, P);
+    triangle_light_sample<in_volume_segment>(
+        kg, prim, object, randu, randv, time, pdf_triangles, ls, P);
     ls->shader |= shader_flag;
     return (ls->pdf > 0.0f);
   }
@@ -912,7 +980,7 @@ ccl_device_noinline bool light_distribution_sample(KernelGlobals kg,
     return false;
   }
 
-  return light_sample<in_volume_segment>(kg, lamp, randu, randv, P, path_flag, ls);
+  return light_sample<in_volume_segment>(kg, lamp, randu, randv, P, path_flag, pdf_lights, ls);
 }
 
 ccl_device_inline bool light_distribution_sample_from_volume_segment(KernelGlobals kg,
@@ -948,11 +1016,14 @@ ccl_device_inline bool light_distribution_sample_new_position(KernelGlobals kg,
 {
   /* Sample a new position on the same light, for volume sampling. */
   if (ls->type == LIGHT_TRIANGLE) {
-    triangle_light_sample<false>(kg, ls->prim, ls->object, randu, randv, time, ls, P);
+    const float pdf_triangles = light_distribution_pdf_triangle(kg, ls->object, ls->prim, P);
+    triangle_light_sample<false>(
+        kg, ls->prim, ls->object, randu, randv, time, pdf_triangles, ls, P);
     return (ls->pdf > 0.0f);
   }
   else {
-    return light_sample<false>(kg, ls->lamp, randu, randv, P, 0, ls);
+    const float pdf_lights = light_distribution_pdf_lamp(kg, ls->lamp, P);
+    return light_sample<false>(kg, ls->lamp, randu, randv, P, 0, pdf_lights, ls);
   }
 }
 
@@ -0,0 +1,221 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+/* Light Tree
+ *
+ * Picks a light proportional to an estimate of its contribution at the shading point, by
+ * stochastically traversing a bounding volume hierarchy over the emitters. Nodes store the
+ * bounds, orientation and energy of the emitters inside them, see "Importance Sampling of Many
+ * Lights with Adaptive Tree Splitting" by Conty and Kulla.
+ *
+ * The estimate only depends on the position of the shading point, so that the probability of
+ * picking a light can be computed again for multiple importance sampling of paths that hit it. */
+
+#pragma once
+
+CCL_NAMESPACE_BEGIN
+
+/* Estimated contribution of the emitters in the bounds to position P. */
+ccl_device float light_tree_importance(const float3 P,
+                                       ccl_global const KernelLightTreeBounds *bounds)
+{
+  if (bounds->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 bbox_min = make_float3(
+      bounds->bounding_box_min[0], bounds->bounding_box_min[1], bounds->bounding_box_min[2]);
+  const float3 bbox_max = make_float3(
+      bounds->bounding_box_max[0], bounds->bounding_box_max[1], bounds->bounding_box_max[2]);
+  const float3 axis = make_float3(bounds->axis[0], bounds->axis[1], bounds->axis[2]);
+
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius_squared = 0.25f * len_squared(bbox_max - bbox_min);
+  float distance;
+  const float3 point_to_centroid = normalize_len(centroid - P, &distance);
+  const float distance_squared = distance * distance;
+
+  /* Angle between the axis and the direction to P, minus the spread of the normals and the angle
+   * the bounding sphere subtends. The emitters can not light P when the remaining angle is
+   * outside of the emission spread. */
+  float cos_theta_prime = 1.0f;
+  if (distance_squared > radius_squared) {
+    const float theta = safe_acosf(dot(axis, -point_to_centroid));
+    const float theta_u = safe_asinf(sqrtf(radius_squared / distance_squared));
+    const float theta_prime = theta - bounds->theta_o - theta_u;
+    if (theta_prime >= bounds->theta_e) {
+      return 0.0f;
+    }
+    cos_theta_prime = (theta_prime > 0.0f) ? cosf(theta_prime) : 1.0f;
+  }
+
+  /* Inside the bounds the distance to the emitters is unknown, clamp it to the bounds size. */
+  return bounds->energy * cos_theta_prime / max(distance_squared, max(radius_squared, 1e-8f));
+}
+
+/* Pick one of the two children of an inner node, rescaling the random number for reuse.
+ * Returns the probability of the picked child. */
+ccl_device_inline float light_tree_pick_child(KernelGlobals kg,
+                                              const float3 P,
+                                              const int node_index,
+                                              ccl_private float *randu,
+                                              ccl_private int *r_child_index)
+{
+  const int left_index = node_index + 1;
+  const int right_index = kernel_tex_fetch(__light_tree_nodes, node_index).child_index;
+
+  const float left_importance = light_tree_importance(
+      P, &kernel_tex_fetch(__light_tree_nodes, left_index).bounds);
+  const float right_importance = light_tree_importance(
+      P, &kernel_tex_fetch(__light_tree_nodes, right_index).bounds);
+  const float total_importance = left_importance + right_importance;
+  if (total_importance == 0.0f) {
+    return 0.0f;
+  }
+
+  const float left_probability = left_importance / total_importance;
+  if (*randu < left_probability) {
+    *randu = *randu / left_probability;
+    *r_child_index = left_index;
+    return left_probability;
+  }
+
+  *randu = (*randu - left_probability) / (1.0f - left_probability);
+  *r_child_index = right_index;
+  return 1.0f - left_probability;
+}
+
+/* Pick an emitter in a leaf node, proportional to the importance of every emitter. */
+ccl_device_inline float light_tree_pick_emitter(KernelGlobals kg,
+                                                const float3 P,
+                                                ccl_global const KernelLightTreeNode *knode,
+                                                ccl_private float *randu,
+                                                ccl_private int *r_emitter)
+{
+  float total_importance = 0.0f;
+  for (int i = 0; i < knode->num_prims; i++) {
+    const int emitter = knode->child_index + i;
+    total_importance += light_tree_importance(
+        P, &kernel_tex_fetch(__light_tree_emitters, emitter).bounds);
+  }
+  if (total_importance == 0.0f) {
+    return 0.0f;
+  }
+
+  /* Walk over the emitters again to find the one corresponding to the random number. The last
+   * emitter with importance is used in case of float precision issues. */
+  const float r = *randu * total_importance;
+  float cdf = 0.0f;
+  float emitter_importance = 0.0f;
+  for (int i = 0; i < knode->num_prims; i++) {
+    const int emitter = knode->child_index + i;
+    const float importance = light_tree_importance(
+        P, &kernel_tex_fetch(__light_tree_emitters, emitter).bounds);
+    if (importance == 0.0f) {
+      continue;
+    }
+    *randu = clamp((r - cdf) / importance, 0.0f, 1.0f - FLT_EPSILON);
+    *r_emitter = emitter;
+    emitter_importance = importance;
+    if (r < cdf + importance) {
+      break;
+    }
+    cdf += importance;
+  }
+
+  return emitter_importance / total_importance;
+}
+
+/* Pick an emitter to sample from position P. Returns the probability of having picked it, or
+ * zero when no emitter can contribute to P. */
+ccl_device float light_tree_sample(KernelGlobals kg,
+                                   const float3 P,
+                                   ccl_private float *randu,
+                                   ccl_private int *r_emitter)
+{
+  /* Distant lights keep the probability they have in the light distribution, the remaining
+   * probability goes to the tree. */
+  const int num_distant_lights = kernel_data.integrator.num_distant_lights;
+  const float distant_probability = num_distant_lights * kernel_data.integrator.pdf_lights;
+
+  if (*randu < distant_probability) {
+    const float r = *randu / distant_probability * num_distant_lights;
+    const int index = min((int)r, num_distant_lights - 1);
+    *randu = clamp(r - index, 0.0f, 1.0f - FLT_EPSILON);
+    *r_emitter = kernel_data.integrator.distant_lights_offset + index;
+    return kernel_data.integrator.pdf_lights;
+  }
+
+  if (kernel_data.integrator.distant_lights_offset == 0) {
+    return 0.0f;
+  }
+
+  *randu = (*randu - distant_probability) / (1.0f - distant_probability);
+  float pdf = 1.0f - distant_probability;
+
+  int node_index = 0;
+  while (kernel_tex_fetch(__light_tree_nodes, node_index).num_prims == 0) {
+    pdf *= light_tree_pick_child(kg, P, node_index, randu, &node_index);
+    if (pdf == 0.0f) {
+      return 0.0f;
+    }
+  }
+
+  return pdf * light_tree_pick_emitter(
+                   kg, P, &kernel_tex_fetch(__light_tree_nodes, node_index), randu, r_emitter);
+}
+
+/* Probability of picking the emitter with #light_tree_sample from position P. */
+ccl_device float light_tree_pdf(KernelGlobals kg, const float3 P, const int emitter)
+{
+  if (emitter >= kernel_data.integrator.distant_lights_offset) {
+    return kernel_data.integrator.pdf_lights;
+  }
+
+  const float distant_probability = kernel_data.integrator.num_distant_lights *
+                                    kernel_data.integrator.pdf_lights;
+  float pdf = 1.0f - distant_probability;
+
+  /* Follow the path to the leaf of the emitter. */
+  uint bit_trail = kernel_tex_fetch(__light_tree_emitters, emitter).bit_trail;
+  int node_index = 0;
+  while (kernel_tex_fetch(__light_tree_nodes, node_index).num_prims == 0) {
+    const int left_index = node_index + 1;
+    const int right_index = kernel_tex_fetch(__light_tree_nodes, node_index).child_index;
+
+    const float left_importance = light_tree_importance(
+        P, &kernel_tex_fetch(__light_tree_nodes, left_index).bounds);
+    const float right_importance = light_tree_importance(
+        P, &kernel_tex_fetch(__light_tree_nodes, right_index).bounds);
+    const float total_importance = left_importance + right_importance;
+    if (total_importance == 0.0f) {
+      return 0.0f;
+    }
+
+    if (bit_trail & 1) {
+      pdf *= right_importance / total_importance;
+      node_index = right_index;
+    }
+    else {
+      pdf *= left_importance / total_importance;
+      node_index = left_index;
+    }
+    bit_trail >>= 1;
+  }
+
+  ccl_global const KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  float total_importance = 0.0f;
+  for (int i = 0; i < knode->num_prims; i++) {
+    total_importance += light_tree_importance(
+        P, &kernel_tex_fetch(__light_tree_emitters, knode->child_index + i).bounds);
+  }
+  if (total_importance == 0.0f) {
+    return 0.0f;
+  }
+
+  const float importance = light_tree_importance(
+      P, &kernel_tex_fetch(__light_tree_emitters, emitter).bounds);
+  return pdf * importance / total_importance;
+}
+
+CCL_NAMESPACE_END
@@ -59,6 +59,11 @@ KERNEL_TEX(KernelLightDistribution, __light_distribution)
 KERNEL_TEX(KernelLight, __lights)
 KERNEL_TEX(float2, __light_background_marginal_cdf)
 KERNEL_TEX(float2, __light_background_conditional_cdf)
+KERNEL_TEX(KernelLightTreeNode, __light_tree_nodes)
+KERNEL_TEX(KernelLightTreeEmitter, __light_tree_emitters)
+KERNEL_TEX(int, __light_to_tree)
+KERNEL_TEX(int2, __object_to_tree)
+KERNEL_TEX(int, __triangle_to_tree)
 
 /* particles */
 KERNEL_TEX(KernelParticle, __particles)
@@ -97,6 +97,7 @@ CCL_NAMESPACE_BEGIN
 #    define __OSL__
 #  endif
 #  define __VOLUME_RECORD_ALL__
+#  define __PATH_GUIDING__
 #endif /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_GPU_RAYTRACING__
@@ -1288,8 +1289,13 @@ typedef struct KernelIntegrator {
   /* MIS debugging. */
   int direct_light_sampling_type;
 
+  /* Light tree, distant lights are stored after the emitters in the tree. */
+  int use_light_tree;
+  int num_distant_lights;
+  int distant_lights_offset;
+
   /* padding */
-  int pad1;
+  int pad1, pad2;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1485,6 +1491,83 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Bounds of the emitters in a light tree node or of a single emitter, see #OrientationBounds. */
+typedef struct KernelLightTreeBounds {
+  float bounding_box_min[3];
+  float energy;
+  float bounding_box_max[3];
+  float theta_o;
+  float axis[3];
+  float theta_e;
+} KernelLightTreeBounds;
+
+typedef struct KernelLightTreeNode {
+  KernelLightTreeBounds bounds;
+
+  /* Leaf nodes have num_prims emitters starting at child_index. Inner nodes have no emitters,
+   * their first child directly follows them and the second one is at child_index. */
+  int child_index;
+  int num_prims;
+
+  int pad1, pad2;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
+typedef struct KernelLightTreeEmitter {
+  KernelLightTreeBounds bounds;
+
+  /* Same as in the light distribution. */
+  int prim;
+  int shader_flag;
+  int object_id;
+
+  /* Path from the root to the leaf containing the emitter, one bit per level. */
+  uint bit_trail;
+
+  /* Area of triangles in world space. */
+  float area;
+
+  float pad1, pad2, pad3;
+} KernelLightTreeEmitter;
+static_assert_align(KernelLightTreeEmitter, 16);
+
+#ifdef __PATH_GUIDING__
+
+/* Path guiding field: a spatial binary tree over the scene bounds, with a distribution of
+ * incident radiance over directional bins in every leaf. The bins are an equal area mapping of
+ * the sphere, with cos(theta) along one axis and phi along the other. */
+
+#  define GUIDING_DIRECTIONAL_RESOLUTION 16
+#  define GUIDING_DIRECTIONAL_BINS \
+    (GUIDING_DIRECTIONAL_RESOLUTION * GUIDING_DIRECTIONAL_RESOLUTION)
+#  define GUIDING_RECORD_NONE (~0u)
+
+typedef struct KernelGuidingNode {
+  /* Axis the bounds of the node are split along in the middle, or -1 for leaves. */
+  int axis;
+  /* Index of the first of the two consecutive children for inner nodes, leaf index for leaves. */
+  int child;
+} KernelGuidingNode;
+
+/* The field lives in host memory, so that the kernels can write training records directly. */
+typedef struct KernelGuidingField {
+  float3 bounds_min;
+  float3 bounds_max;
+
+  const KernelGuidingNode *nodes;
+
+  /* Per leaf, cumulative distribution over the directional bins, all zero for leaves without
+   * any records. NULL until the first training iteration finished. */
+  const float *sampling_cdf;
+
+  /* Per leaf, sum of the incident radiance over pdf recorded in every directional bin, and the
+   * number of path vertices recorded. NULL once training finished. */
+  float *training_radiance;
+  uint *training_records;
+} KernelGuidingField;
+
+#endif /* __PATH_GUIDING__ */
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -1693,6 +1776,9 @@ enum KernelFeatureFlag : uint32_t {
 
   /* MNEE. */
   KERNEL_FEATURE_MNEE = (1U << 27U),
+
+  /* Path guiding, CPU only. */
+  KERNEL_FEATURE_PATH_GUIDING = (1U << 28U),
 };
 
 /* Shader node feature mask, to specialize shader evaluation for kernels. */
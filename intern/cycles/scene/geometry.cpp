@@ -214,7 +214,7 @@ void Geometry::compute_bvh(Device *device,
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    if (bvh && !need_update_rebuild && !bvh->refit_quality_degraded()) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->geometry = geometry;
@@ -1267,14 +1267,47 @@ void GeometryManager::device_update_mesh(Device *,
   }
 }
 
+/* Whether the scene BVH can be refitted to new positions of primitives instead of being built
+ * again, for BVH layouts where the build happens on the host. */
+static bool scene_bvh_can_refit_on_host(const BVH *bvh,
+                                        const Scene *scene,
+                                        const BVHParams &bparams,
+                                        const uint32_t update_flags,
+                                        const bool need_rebuild)
+{
+  if (bparams.bvh_layout != BVH_LAYOUT_BVH2 && bparams.bvh_layout != BVH_LAYOUT_EMBREE) {
+    return false;
+  }
+
+  /* Only done for dynamic BVHs, final renders get the full build quality. */
+  if (need_rebuild || bparams.bvh_type != BVH_TYPE_DYNAMIC ||
+      bvh->params.bvh_layout != bparams.bvh_layout) {
+    return false;
+  }
+
+  /* Visibility changes which objects are in the BVH. Embree does not update transforms of
+   * instances when refitting. */
+  if (update_flags & GeometryManager::VISIBILITY_MODIFIED) {
+    return false;
+  }
+  if (bparams.bvh_layout == BVH_LAYOUT_EMBREE &&
+      (update_flags & GeometryManager::TRANSFORM_MODIFIED)) {
+    return false;
+  }
+
+  if (bvh->objects != scene->objects || bvh->geometry != scene->geometry) {
+    return false;
+  }
+
+  return !bvh->refit_quality_degraded();
+}
+
 void GeometryManager::device_update_bvh(Device *device,
                                         DeviceScene *dscene,
                                         Scene *scene,
-                                        Progress &progress)
+                                        Progress &progress,
+                                        const bool need_rebuild)
 {
-  /* bvh build */
-  progress.set_status("Updating Scene BVH", "Building");
-
   BVHParams bparams;
   bparams.top_level = true;
   bparams.bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
@@ -1290,23 +1323,48 @@ void GeometryManager::device_update_bvh(Device *device,
 
   VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
-  const bool can_refit = scene->bvh != nullptr &&
-                         (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX ||
-                          bparams.bvh_layout == BVHLayout::BVH_LAYOUT_METAL);
+  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
+
+  bool can_refit = scene->bvh != nullptr &&
+                   (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX ||
+                    bparams.bvh_layout == BVHLayout::BVH_LAYOUT_METAL ||
+                    scene_bvh_can_refit_on_host(
+                        scene->bvh, scene, bparams, update_flags, need_rebuild));
+
+  if (can_refit && has_bvh2_layout) {
+    /* The packed BVH was moved to the device arrays after the last update, move it back for
+     * refitting. */
+    BVH2 *bvh2 = static_cast<BVH2 *>(scene->bvh);
+    dscene->bvh_nodes.give_data(bvh2->pack.nodes);
+    dscene->bvh_leaf_nodes.give_data(bvh2->pack.leaf_nodes);
+    dscene->object_node.give_data(bvh2->pack.object_node);
+    dscene->prim_type.give_data(bvh2->pack.prim_type);
+    dscene->prim_visibility.give_data(bvh2->pack.prim_visibility);
+    dscene->prim_index.give_data(bvh2->pack.prim_index);
+    dscene->prim_object.give_data(bvh2->pack.prim_object);
+    dscene->prim_time.give_data(bvh2->pack.prim_time);
+
+    /* Device arrays may have been freed in the meantime. */
+    if (bvh2->pack.prim_index.size() == 0 ||
+        (bvh2->pack.nodes.size() == 0 && bvh2->pack.leaf_nodes.size() == 0)) {
+      can_refit = false;
+    }
+  }
 
   BVH *bvh = scene->bvh;
   if (!scene->bvh) {
     bvh = scene->bvh = BVH::create(bparams, scene->geometry, scene->objects, device);
   }
 
+  VLOG(1) << (can_refit ? "Refitting" : "Building") << " scene BVH.";
+  progress.set_status("Updating Scene BVH", can_refit ? "Refitting" : "Building");
+
   device->build_bvh(bvh, progress, can_refit);
 
   if (progress.get_cancel()) {
     return;
   }
 
-  const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
-
   PackedBVH pack;
   if (has_bvh2_layout) {
     pack = std::move(static_cast<BVH2 *>(bvh)->pack);
@@ -2016,6 +2074,7 @@ void GeometryManager::device_update(Device *device,
    * change. */
   bool need_update_scene_bvh = (scene->bvh == nullptr ||
                                 (update_flags & (TRANSFORM_MODIFIED | VISIBILITY_MODIFIED)) != 0);
+  bool need_rebuild_scene_bvh = false;
   {
     scoped_callback_timer timer([scene](double time) {
       if (scene->update_stats) {
@@ -2028,6 +2087,13 @@ void GeometryManager::device_update(Device *device,
     foreach (Geometry *geom, scene->geometry) {
       if (geom->is_modified() || geom->need_update_bvh_for_offset) {
         need_update_scene_bvh = true;
+        /* The scene BVH can only be refitted when primitives moved. BVH2 also contains copies of
+         * the nodes of instanced geometry, which are refitted in place unless the BVH of the
+         * geometry is built again. */
+        need_rebuild_scene_bvh |= geom->need_update_rebuild || geom->need_update_bvh_for_offset ||
+                                  (bvh_layout == BVH_LAYOUT_BVH2 &&
+                                   geom->need_build_bvh(bvh_layout) &&
+                                   (geom->bvh == nullptr || geom->bvh->refit_quality_degraded()));
         pool.push(function_bind(
             &Geometry::compute_bvh, geom, device, dscene, &scene->params, &progress, i, num_bvh));
         if (geom->need_build_bvh(bvh_layout)) {
@@ -2072,7 +2138,7 @@ void GeometryManager::device_update(Device *device,
         scene->update_stats->geometry.times.add_entry({"device_update (build scene BVH)", time});
       }
     });
-    device_update_bvh(device, dscene, scene, progress);
+    device_update_bvh(device, dscene, scene, progress, need_rebuild_scene_bvh);
     if (progress.get_cancel()) {
       return;
     }
@@ -240,7 +240,11 @@ class GeometryManager {
                                 Scene *scene,
                                 Progress &progress);
 
-  void device_update_bvh(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
+  void device_update_bvh(Device *device,
+                         DeviceScene *dscene,
+                         Scene *scene,
+                         Progress &progress,
+                         const bool need_rebuild);
 
   void device_update_displacement_images(Device *device, Scene *scene, Progress &progress);
 
@@ -8,6 +8,7 @@
 #include "scene/image_vdb.h"
 #include "scene/scene.h"
 #include "scene/stats.h"
+#include "scene/texture_cache.h"
 
 #include "util/foreach.h"
 #include "util/image.h"
@@ -64,6 +65,8 @@ const char *name_from_type(ImageDataType type)
       return "nanovdb_float";
     case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
       return "nanovdb_float3";
+    case IMAGE_DATA_TYPE_CACHED:
+      return "cached";
     case IMAGE_DATA_NUM_TYPES:
       assert(!"System enumerator type, should never be used");
       return "";
@@ -291,6 +294,9 @@ ImageManager::ImageManager(const DeviceInfo &info)
 
   /* Set image limits */
   features.has_nanovdb = info.has_nanovdb;
+
+  /* Cached images are looked up by the host, so only the CPU device supports them. */
+  supports_texture_cache = (info.type == DEVICE_CPU);
 }
 
 ImageManager::~ImageManager()
@@ -299,6 +305,18 @@ ImageManager::~ImageManager()
     assert(!images[slot]);
 }
 
+void ImageManager::set_texture_cache(const int max_memory_mb)
+{
+  if (supports_texture_cache) {
+    texture_cache = make_unique<TextureCache>(max_memory_mb);
+  }
+}
+
+bool ImageManager::has_texture_cache() const
+{
+  return texture_cache != nullptr;
+}
+
 void ImageManager::set_osl_texture_system(void *texture_system)
 {
   osl_texture_system = texture_system;
@@ -648,6 +666,13 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   load_image_metadata(img);
   ImageDataType type = img->metadata.type;
 
+  /* Look up images through the cache instead of loading them, when possible. Simplify needs
+   * images to be scaled down while loading them. */
+  TextureCacheImage cached_texture;
+  if (texture_cache && texture_limit == 0 && texture_cache->get_texture(img, cached_texture)) {
+    type = IMAGE_DATA_TYPE_CACHED;
+  }
+
   /* Name for debugging. */
   img->mem_name = string_printf("__tex_image_%s_%03d", name_from_type(type), slot);
 
@@ -748,6 +773,11 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
       pixels[0] = TEX_IMAGE_MISSING_R;
     }
   }
+  else if (type == IMAGE_DATA_TYPE_CACHED) {
+    thread_scoped_lock device_lock(device_mutex);
+    void *texture = img->mem->alloc(sizeof(TextureCacheImage), 0);
+    memcpy(texture, &cached_texture, sizeof(TextureCacheImage));
+  }
 #ifdef WITH_NANOVDB
   else if (type == IMAGE_DATA_TYPE_NANOVDB_FLOAT || type == IMAGE_DATA_TYPE_NANOVDB_FLOAT3) {
     thread_scoped_lock device_lock(device_mutex);
@@ -885,6 +915,10 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    texture_cache->collect_statistics(&stats->image);
+  }
 }
 
 void ImageManager::tag_update()
@@ -18,6 +18,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceInfo;
+class TextureCache;
 class ImageHandle;
 class ImageKey;
 class ImageMetaData;
@@ -177,6 +178,10 @@ class ImageManager {
   void device_load_builtin(Device *device, Scene *scene, Progress &progress);
   void device_free_builtin(Device *device);
 
+  /* Load tiles of image files on demand while rendering, instead of loading the full images
+   * before rendering starts. Only supported on the CPU device. */
+  void set_texture_cache(const int max_memory_mb);
+  bool has_texture_cache() const;
   void set_osl_texture_system(void *texture_system);
   bool set_animation_frame_update(int frame);
 
@@ -215,6 +220,9 @@ class ImageManager {
   vector<Image *> images;
   void *osl_texture_system;
 
+  bool supports_texture_cache;
+  unique_ptr<TextureCache> texture_cache;
+
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
   void remove_image_user(int slot);
@@ -85,6 +85,10 @@ NODE_DEFINE(Integrator)
   SOCKET_INT(adaptive_min_samples, "Adaptive Min Samples", 0);
 
   SOCKET_FLOAT(light_sampling_threshold, "Light Sampling Threshold", 0.01f);
+  SOCKET_BOOLEAN(use_light_tree, "Use Light Tree", false);
+
+  SOCKET_BOOLEAN(use_guiding, "Use Guiding", false);
+  SOCKET_INT(guiding_training_samples, "Guiding Training Samples", 128);
 
   static NodeEnum sampling_pattern_enum;
   sampling_pattern_enum.insert("sobol", SAMPLING_PATTERN_SOBOL);
@@ -313,9 +317,13 @@ void Integrator::tag_update(Scene *scene, uint32_t flag)
     scene->object_manager->tag_update(scene, ObjectManager::MOTION_BLUR_MODIFIED);
     scene->camera->tag_modified();
   }
+
+  if (use_light_tree_is_modified()) {
+    scene->light_manager->tag_update(scene, LightManager::UPDATE_ALL);
+  }
 }
 
-uint Integrator::get_kernel_features() const
+uint Integrator::get_kernel_features(const Scene *scene) const
 {
   uint kernel_features = 0;
 
@@ -323,6 +331,11 @@ uint Integrator::get_kernel_features() const
     kernel_features |= KERNEL_FEATURE_AO_ADDITIVE;
   }
 
+  /* Path guiding is only implemented on the CPU. */
+  if (use_guiding && scene->device->info.type == DEVICE_CPU) {
+    kernel_features |= KERNEL_FEATURE_PATH_GUIDING;
+  }
+
   return kernel_features;
 }
 
@@ -387,4 +400,22 @@ DenoiseParams Integrator::get_denoise_params() const
   return denoise_params;
 }
 
+GuidingParams Integrator::get_guiding_params(const Scene *scene) const
+{
+  GuidingParams guiding_params;
+
+  guiding_params.use = use_guiding;
+  if (!guiding_params.use) {
+    return guiding_params;
+  }
+
+  guiding_params.training_samples = max(1, guiding_training_samples);
+
+  foreach (const Object *object, scene->objects) {
+    guiding_params.bounds.grow(object->bounds);
+  }
+
+  return guiding_params;
+}
+
 CCL_NAMESPACE_END
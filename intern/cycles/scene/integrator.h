@@ -9,6 +9,7 @@
 #include "device/denoise.h" /* For the parameters and type enum. */
 #include "graph/node.h"
 #include "integrator/adaptive_sampling.h"
+#include "integrator/guiding.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -68,6 +69,10 @@ class Integrator : public Node {
   NODE_SOCKET_API(int, start_sample)
 
   NODE_SOCKET_API(float, light_sampling_threshold)
+  NODE_SOCKET_API(bool, use_light_tree)
+
+  NODE_SOCKET_API(bool, use_guiding)
+  NODE_SOCKET_API(int, guiding_training_samples)
 
   NODE_SOCKET_API(bool, use_adaptive_sampling)
   NODE_SOCKET_API(int, adaptive_min_samples)
@@ -101,10 +106,11 @@ class Integrator : public Node {
 
   void tag_update(Scene *scene, uint32_t flag);
 
-  uint get_kernel_features() const;
+  uint get_kernel_features(const Scene *scene) const;
 
   AdaptiveSampling get_adaptive_sampling() const;
   DenoiseParams get_denoise_params() const;
+  GuidingParams get_guiding_params(const Scene *scene) const;
 };
 
 CCL_NAMESPACE_END
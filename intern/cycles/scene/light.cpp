@@ -7,6 +7,7 @@
 #include "scene/film.h"
 #include "scene/integrator.h"
 #include "scene/light.h"
+#include "scene/light_tree.h"
 #include "scene/mesh.h"
 #include "scene/object.h"
 #include "scene/scene.h"
@@ -261,7 +262,33 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
-void LightManager::device_update_distribution(Device *,
+static int object_light_shader_flag(Object *object)
+{
+  int shader_flag = 0;
+
+  if (!(object->get_visibility() & PATH_RAY_CAMERA)) {
+    shader_flag |= SHADER_EXCLUDE_CAMERA;
+  }
+  if (!(object->get_visibility() & PATH_RAY_DIFFUSE)) {
+    shader_flag |= SHADER_EXCLUDE_DIFFUSE;
+  }
+  if (!(object->get_visibility() & PATH_RAY_GLOSSY)) {
+    shader_flag |= SHADER_EXCLUDE_GLOSSY;
+  }
+  if (!(object->get_visibility() & PATH_RAY_TRANSMIT)) {
+    shader_flag |= SHADER_EXCLUDE_TRANSMIT;
+  }
+  if (!(object->get_visibility() & PATH_RAY_VOLUME_SCATTER)) {
+    shader_flag |= SHADER_EXCLUDE_SCATTER;
+  }
+  if (!(object->get_is_shadow_catcher())) {
+    shader_flag |= SHADER_EXCLUDE_SHADOW_CATCHER;
+  }
+
+  return shader_flag;
+}
+
+void LightManager::device_update_distribution(Device *device,
                                               DeviceScene *dscene,
                                               Scene *scene,
                                               Progress &progress)
@@ -332,26 +359,7 @@ void LightManager::device_update_distribution(Device *,
     bool transform_applied = mesh->transform_applied;
     Transform tfm = object->get_tfm();
     int object_id = j;
-    int shader_flag = 0;
-
-    if (!(object->get_visibility() & PATH_RAY_CAMERA)) {
-      shader_flag |= SHADER_EXCLUDE_CAMERA;
-    }
-    if (!(object->get_visibility() & PATH_RAY_DIFFUSE)) {
-      shader_flag |= SHADER_EXCLUDE_DIFFUSE;
-    }
-    if (!(object->get_visibility() & PATH_RAY_GLOSSY)) {
-      shader_flag |= SHADER_EXCLUDE_GLOSSY;
-    }
-    if (!(object->get_visibility() & PATH_RAY_TRANSMIT)) {
-      shader_flag |= SHADER_EXCLUDE_TRANSMIT;
-    }
-    if (!(object->get_visibility() & PATH_RAY_VOLUME_SCATTER)) {
-      shader_flag |= SHADER_EXCLUDE_SCATTER;
-    }
-    if (!(object->get_is_shadow_catcher())) {
-      shader_flag |= SHADER_EXCLUDE_SHADOW_CATCHER;
-    }
+    int shader_flag = object_light_shader_flag(object);
 
     size_t mesh_num_triangles = mesh->num_triangles();
     for (size_t i = 0; i < mesh_num_triangles; i++) {
@@ -480,8 +488,17 @@ void LightManager::device_update_distribution(Device *,
     if (num_background_lights < num_lights)
       kfilm->pass_shadow_scale /= (float)(num_lights - num_background_lights) / (float)num_lights;
 
-    /* CDF */
-    dscene->light_distribution.copy_to_device();
+    kintegrator->use_light_tree = scene->integrator->get_use_light_tree();
+
+    if (kintegrator->use_light_tree) {
+      /* The tree replaces the CDF, but keeps the same probabilities for distant lights. */
+      dscene->light_distribution.free();
+      device_update_tree(device, dscene, scene, progress);
+    }
+    else {
+      /* CDF */
+      dscene->light_distribution.copy_to_device();
+    }
 
     /* Portals */
     if (num_portals > 0) {
@@ -506,6 +523,7 @@ void LightManager::device_update_distribution(Device *,
     kintegrator->pdf_triangles = 0.0f;
     kintegrator->pdf_lights = 0.0f;
     kintegrator->use_lamp_mis = false;
+    kintegrator->use_light_tree = false;
 
     kbackground->num_portals = 0;
     kbackground->portal_offset = 0;
@@ -517,6 +535,249 @@ void LightManager::device_update_distribution(Device *,
   }
 }
 
+static LightTreePrimitive light_tree_lamp_primitive(const Light *light, const int light_index)
+{
+  LightTreePrimitive prim;
+  prim.prim_id = ~light_index;
+  prim.object_id = OBJECT_NONE;
+  prim.shader_flag = 0;
+  prim.area = 0.0f;
+
+  /* Estimated power of the lamp, matching the normalization of its emission in the kernel. */
+  const float3 co = light->get_co();
+  const float strength = average(fabs(light->get_strength()));
+  const float radius = light->get_size();
+
+  if (light->get_light_type() == LIGHT_AREA) {
+    const float3 axisu = light->get_axisu() * (light->get_sizeu() * light->get_size());
+    const float3 axisv = light->get_axisv() * (light->get_sizev() * light->get_size());
+    prim.bbox = BoundBox::empty;
+    prim.bbox.grow(co - 0.5f * axisu - 0.5f * axisv);
+    prim.bbox.grow(co + 0.5f * axisu - 0.5f * axisv);
+    prim.bbox.grow(co - 0.5f * axisu + 0.5f * axisv);
+    prim.bbox.grow(co + 0.5f * axisu + 0.5f * axisv);
+    prim.bcone = OrientationBounds(safe_normalize(light->get_dir()), 0.0f, M_PI_2_F);
+    prim.energy = M_PI_4_F * strength;
+  }
+  else {
+    prim.bbox = BoundBox(co - make_float3(radius), co + make_float3(radius));
+    if (light->get_light_type() == LIGHT_SPOT) {
+      prim.bcone = OrientationBounds(safe_normalize(light->get_dir()),
+                                     0.0f,
+                                     min(0.5f * light->get_spot_angle(), M_PI_2_F));
+    }
+    else {
+      prim.bcone = OrientationBounds(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+    }
+    prim.energy = strength;
+  }
+
+  return prim;
+}
+
+static void light_tree_bounds_to_kernel(const BoundBox &bbox,
+                                        const OrientationBounds &bcone,
+                                        const float energy,
+                                        KernelLightTreeBounds &kbounds)
+{
+  kbounds.bounding_box_min[0] = bbox.min.x;
+  kbounds.bounding_box_min[1] = bbox.min.y;
+  kbounds.bounding_box_min[2] = bbox.min.z;
+  kbounds.bounding_box_max[0] = bbox.max.x;
+  kbounds.bounding_box_max[1] = bbox.max.y;
+  kbounds.bounding_box_max[2] = bbox.max.z;
+  kbounds.axis[0] = bcone.axis.x;
+  kbounds.axis[1] = bcone.axis.y;
+  kbounds.axis[2] = bcone.axis.z;
+  kbounds.theta_o = bcone.theta_o;
+  kbounds.theta_e = bcone.theta_e;
+  kbounds.energy = energy;
+}
+
+void LightManager::device_update_tree(Device *,
+                                      DeviceScene *dscene,
+                                      Scene *scene,
+                                      Progress &progress)
+{
+  progress.set_status("Updating Lights", "Building light tree");
+
+  vector<LightTreePrimitive> prims;
+  vector<int> distant_lights;
+
+  /* Lamps, distant and background lights have no position and are sampled separately. */
+  int num_lights = 0;
+  int num_all_lights = 0;
+  foreach (Light *light, scene->lights) {
+    if (light->is_enabled || light->is_portal) {
+      num_all_lights++;
+    }
+    if (!light->is_enabled) {
+      continue;
+    }
+    if (light->get_light_type() == LIGHT_DISTANT || light->get_light_type() == LIGHT_BACKGROUND) {
+      distant_lights.push_back(num_lights);
+    }
+    else {
+      prims.push_back(light_tree_lamp_primitive(light, num_lights));
+    }
+    num_lights++;
+  }
+
+  /* Emissive triangles. Lookups from triangles to emitters are stored per object, with the
+   * offset of its triangles in the lookup table and the primitive offset of its mesh. */
+  int2 *object_to_tree = dscene->object_to_tree.alloc(scene->objects.size());
+  int num_triangle_lookups = 0;
+  unordered_map<Shader *, float> shader_emission;
+
+  for (size_t object_id = 0; object_id < scene->objects.size(); object_id++) {
+    if (progress.get_cancel()) {
+      return;
+    }
+
+    Object *object = scene->objects[object_id];
+    if (!object_usable_as_light(object)) {
+      object_to_tree[object_id] = make_int2(-1, 0);
+      continue;
+    }
+
+    Mesh *mesh = static_cast<Mesh *>(object->get_geometry());
+    object_to_tree[object_id] = make_int2(num_triangle_lookups, mesh->prim_offset);
+    num_triangle_lookups += mesh->num_triangles();
+
+    const bool transform_applied = mesh->transform_applied;
+    const Transform &tfm = object->get_tfm();
+    const int shader_flag = object_light_shader_flag(object);
+
+    const size_t mesh_num_triangles = mesh->num_triangles();
+    for (size_t i = 0; i < mesh_num_triangles; i++) {
+      int shader_index = mesh->get_shader()[i];
+      Shader *shader = (shader_index < mesh->get_used_shaders().size()) ?
+                           static_cast<Shader *>(mesh->get_used_shaders()[shader_index]) :
+                           scene->default_surface;
+
+      if (!(shader->get_use_mis() && shader->has_surface_emission)) {
+        continue;
+      }
+
+      /* Emission of textured shaders is unknown, assume unit strength for them. */
+      auto emission_it = shader_emission.find(shader);
+      if (emission_it == shader_emission.end()) {
+        float3 emission;
+        const float strength = shader->is_constant_emission(&emission) ?
+                                   average(fabs(emission)) :
+                                   1.0f;
+        emission_it = shader_emission.insert({shader, strength}).first;
+      }
+
+      LightTreePrimitive prim;
+      prim.prim_id = i + mesh->prim_offset;
+      prim.object_id = object_id;
+      prim.shader_flag = shader_flag;
+
+      Mesh::Triangle t = mesh->get_triangle(i);
+      if (t.valid(&mesh->get_verts()[0])) {
+        float3 p1 = mesh->get_verts()[t.v[0]];
+        float3 p2 = mesh->get_verts()[t.v[1]];
+        float3 p3 = mesh->get_verts()[t.v[2]];
+
+        if (!transform_applied) {
+          p1 = transform_point(&tfm, p1);
+          p2 = transform_point(&tfm, p2);
+          p3 = transform_point(&tfm, p3);
+        }
+
+        prim.bbox = BoundBox(p1);
+        prim.bbox.grow(p2);
+        prim.bbox.grow(p3);
+        prim.area = triangle_area(p1, p2, p3);
+        /* Triangles emit on both sides. */
+        prim.bcone = OrientationBounds(
+            safe_normalize(cross(p2 - p1, p3 - p1)), M_PI_F, M_PI_2_F);
+        prim.energy = M_2PI_F * prim.area * emission_it->second;
+      }
+      else {
+        /* Degenerate triangles are never picked, but keep them to find their emitter. */
+        prim.bbox = BoundBox(object->bounds.center());
+        prim.area = 0.0f;
+        prim.bcone = OrientationBounds(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+        prim.energy = 0.0f;
+      }
+
+      prims.push_back(prim);
+    }
+  }
+
+  VLOG(1) << "Building light tree with " << prims.size() << " emitters and "
+          << distant_lights.size() << " distant lights.";
+
+  /* The build reorders the primitives. */
+  LightTree light_tree(prims, 8);
+  const vector<LightTreeNode> &nodes = light_tree.get_nodes();
+
+  KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(max(nodes.size(), (size_t)1));
+  KernelLightTreeEmitter *kemitters = dscene->light_tree_emitters.alloc(
+      max(prims.size() + distant_lights.size(), (size_t)1));
+  /* Portals come after the lights in the kernel lights array, and are never picked. */
+  int *light_to_tree = dscene->light_to_tree.alloc(max(num_all_lights, 1));
+  for (int i = 0; i < max(num_all_lights, 1); i++) {
+    light_to_tree[i] = -1;
+  }
+  int *triangle_to_tree = dscene->triangle_to_tree.alloc(max(num_triangle_lookups, 1));
+  for (int i = 0; i < num_triangle_lookups; i++) {
+    triangle_to_tree[i] = -1;
+  }
+
+  for (size_t node_index = 0; node_index < nodes.size(); node_index++) {
+    const LightTreeNode &node = nodes[node_index];
+    KernelLightTreeNode &knode = knodes[node_index];
+    light_tree_bounds_to_kernel(node.bbox, node.bcone, node.energy, knode.bounds);
+    knode.num_prims = node.num_prims;
+    knode.child_index = node.is_leaf() ? node.first_prim_index : node.child_index;
+
+    if (!node.is_leaf()) {
+      continue;
+    }
+
+    for (int i = node.first_prim_index; i < node.first_prim_index + node.num_prims; i++) {
+      const LightTreePrimitive &prim = prims[i];
+      KernelLightTreeEmitter &kemitter = kemitters[i];
+      light_tree_bounds_to_kernel(prim.bbox, prim.bcone, prim.energy, kemitter.bounds);
+      kemitter.prim = prim.prim_id;
+      kemitter.object_id = prim.object_id;
+      kemitter.shader_flag = prim.shader_flag;
+      kemitter.bit_trail = node.bit_trail;
+      kemitter.area = prim.area;
+
+      if (prim.prim_id >= 0) {
+        const int2 lookup = object_to_tree[prim.object_id];
+        triangle_to_tree[lookup.x + prim.prim_id - lookup.y] = i;
+      }
+      else {
+        light_to_tree[~prim.prim_id] = i;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < distant_lights.size(); i++) {
+    const int emitter = prims.size() + i;
+    KernelLightTreeEmitter &kemitter = kemitters[emitter];
+    memset(&kemitter, 0, sizeof(kemitter));
+    kemitter.prim = ~distant_lights[i];
+    kemitter.object_id = OBJECT_NONE;
+    light_to_tree[distant_lights[i]] = emitter;
+  }
+
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->num_distant_lights = distant_lights.size();
+  kintegrator->distant_lights_offset = prims.size();
+
+  dscene->light_tree_nodes.copy_to_device();
+  dscene->light_tree_emitters.copy_to_device();
+  dscene->light_to_tree.copy_to_device();
+  dscene->object_to_tree.copy_to_device();
+  dscene->triangle_to_tree.copy_to_device();
+}
+
 static void background_cdf(
     int start, int end, int res_x, int res_y, const vector<float3> *pixels, float2 *cond_cdf)
 {
@@ -1008,6 +1269,11 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_background)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitters.free();
+  dscene->light_to_tree.free();
+  dscene->object_to_tree.free();
+  dscene->triangle_to_tree.free();
   dscene->lights.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
@@ -0,0 +1,205 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#include "scene/light_tree.h"
+
+#include "util/math.h"
+
+#include <algorithm>
+
+CCL_NAMESPACE_BEGIN
+
+float OrientationBounds::calculate_measure() const
+{
+  const float theta_w = min(M_PI_F, theta_o + theta_e);
+  const float cos_theta_o = cosf(theta_o);
+  const float sin_theta_o = sinf(theta_o);
+
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(theta_o - 2.0f * theta_w) -
+                     2.0f * theta_o * sin_theta_o + cos_theta_o);
+}
+
+OrientationBounds merge(const OrientationBounds &cone_a, const OrientationBounds &cone_b)
+{
+  /* Make sure cone A is the wider one. */
+  const bool a_is_wider = (cone_a.theta_o >= cone_b.theta_o);
+  const OrientationBounds &a = a_is_wider ? cone_a : cone_b;
+  const OrientationBounds &b = a_is_wider ? cone_b : cone_a;
+
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  const float theta_e = max(a.theta_e, b.theta_e);
+
+  /* Cone A already contains cone B. */
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return OrientationBounds(a.axis, a.theta_o, theta_e);
+  }
+
+  /* Otherwise the new cone spans both, rotate the axis of A towards B to its center. */
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  const float3 ortho = b.axis - dot(a.axis, b.axis) * a.axis;
+  if (theta_o >= M_PI_F || len_squared(ortho) < 1e-12f) {
+    return OrientationBounds(a.axis, M_PI_F, theta_e);
+  }
+
+  const float theta_r = theta_o - a.theta_o;
+  const float3 axis = cosf(theta_r) * a.axis + sinf(theta_r) * normalize(ortho);
+  return OrientationBounds(normalize(axis), theta_o, theta_e);
+}
+
+/* Bucket of primitives for evaluating split candidates. */
+struct LightTreeBucket {
+  BoundBox bbox = BoundBox::empty;
+  OrientationBounds bcone = OrientationBounds(make_float3(0.0f, 0.0f, 1.0f), 0.0f, 0.0f);
+  float energy = 0.0f;
+  int count = 0;
+
+  void add(const LightTreePrimitive &prim)
+  {
+    bbox.grow(prim.bbox);
+    bcone = (count == 0) ? prim.bcone : merge(bcone, prim.bcone);
+    energy += prim.energy;
+    count++;
+  }
+
+  void add(const LightTreeBucket &other)
+  {
+    if (other.count == 0) {
+      return;
+    }
+    bbox.grow(other.bbox);
+    bcone = (count == 0) ? other.bcone : merge(bcone, other.bcone);
+    energy += other.energy;
+    count += other.count;
+  }
+
+  /* Surface area orientation heuristic cost of the bucket. */
+  float cost() const
+  {
+    return energy * bbox.safe_area() * bcone.calculate_measure();
+  }
+};
+
+LightTree::LightTree(vector<LightTreePrimitive> &prims, const int max_prims_in_leaf)
+    : prims(prims), max_prims_in_leaf(max_prims_in_leaf)
+{
+  if (prims.empty()) {
+    return;
+  }
+
+  nodes.reserve(prims.size() * 2);
+  recursive_build(0, prims.size(), 0, 0);
+  nodes.shrink_to_fit();
+}
+
+int LightTree::recursive_build(const int start,
+                               const int end,
+                               const uint bit_trail,
+                               const int depth)
+{
+  LightTreeBucket node_bounds;
+  BoundBox centroid_bbox = BoundBox::empty;
+  for (int i = start; i < end; i++) {
+    node_bounds.add(prims[i]);
+    centroid_bbox.grow(prims[i].centroid());
+  }
+
+  const int node_index = nodes.size();
+  nodes.emplace_back();
+  LightTreeNode &node = nodes[node_index];
+  node.bbox = node_bounds.bbox;
+  node.bcone = node_bounds.bcone;
+  node.energy = node_bounds.energy;
+  node.bit_trail = bit_trail;
+
+  int middle;
+  if (end - start <= max_prims_in_leaf || depth >= max_depth ||
+      !find_split(start, end, centroid_bbox, middle)) {
+    node.num_prims = end - start;
+    node.first_prim_index = start;
+    return node_index;
+  }
+
+  /* Note that the node reference is invalidated by adding the children. */
+  recursive_build(start, middle, bit_trail, depth + 1);
+  const int child_index = recursive_build(middle, end, bit_trail | (1u << depth), depth + 1);
+  nodes[node_index].num_prims = 0;
+  nodes[node_index].child_index = child_index;
+  return node_index;
+}
+
+bool LightTree::find_split(const int start,
+                           const int end,
+                           const BoundBox &centroid_bbox,
+                           int &r_middle)
+{
+  const int num_buckets = 12;
+  const float3 extent = centroid_bbox.size();
+  const float max_extent = max(max(extent.x, extent.y), extent.z);
+  float min_cost = FLT_MAX;
+  int min_axis = -1;
+  int min_bucket = 0;
+
+  for (int axis = 0; axis < 3 && max_extent > 0.0f; axis++) {
+    if (!(extent[axis] > 0.0f)) {
+      continue;
+    }
+
+    LightTreeBucket buckets[num_buckets];
+    const float inv_extent = 1.0f / extent[axis];
+    for (int i = start; i < end; i++) {
+      const float offset = (prims[i].centroid()[axis] - centroid_bbox.min[axis]) * inv_extent;
+      const int bucket = clamp((int)(offset * num_buckets), 0, num_buckets - 1);
+      buckets[bucket].add(prims[i]);
+    }
+
+    /* Sweep from the right to get the cost of every right side, then from the left. */
+    float right_costs[num_buckets];
+    LightTreeBucket right;
+    for (int i = num_buckets - 1; i > 0; i--) {
+      right.add(buckets[i]);
+      right_costs[i] = right.cost();
+    }
+
+    /* Regularization factor against thin boxes. */
+    const float regularization = max_extent * inv_extent;
+
+    LightTreeBucket left;
+    for (int i = 0; i < num_buckets - 1; i++) {
+      left.add(buckets[i]);
+      if (left.count == 0 || left.count == end - start) {
+        continue;
+      }
+      const float cost = regularization * (left.cost() + right_costs[i + 1]);
+      if (cost < min_cost) {
+        min_cost = cost;
+        min_axis = axis;
+        min_bucket = i;
+      }
+    }
+  }
+
+  if (min_axis == -1) {
+    /* All centroids coincide or no split reduces the cost. Split in the middle anyway so leaves
+     * do not get arbitrarily large. */
+    if (end - start > max_prims_in_leaf * 4) {
+      r_middle = (start + end) / 2;
+      return true;
+    }
+    return false;
+  }
+
+  const float inv_extent = 1.0f / extent[min_axis];
+  const LightTreePrimitive *middle = std::partition(
+      prims.data() + start, prims.data() + end, [&](const LightTreePrimitive &prim) {
+        const float offset = (prim.centroid()[min_axis] - centroid_bbox.min[min_axis]) *
+                             inv_extent;
+        const int bucket = clamp((int)(offset * num_buckets), 0, num_buckets - 1);
+        return bucket <= min_bucket;
+      });
+  r_middle = middle - prims.data();
+
+  return r_middle > start && r_middle < end;
+}
+
+CCL_NAMESPACE_END
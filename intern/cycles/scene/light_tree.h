@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "util/boundbox.h"
+#include "util/types.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Orientation Bounds
+ *
+ * Cone of directions around an axis which contains the normals of all emitters in a node
+ * (theta_o), together with the maximum angle around those normals light is emitted in (theta_e).
+ * See "Importance Sampling of Many Lights with Adaptive Tree Splitting" by Conty and Kulla. */
+struct OrientationBounds {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  OrientationBounds() = default;
+
+  OrientationBounds(const float3 &axis, const float theta_o, const float theta_e)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e)
+  {
+  }
+
+  /* Measure of the solid angle the node emits into, used for the split heuristic. */
+  float calculate_measure() const;
+};
+
+OrientationBounds merge(const OrientationBounds &a, const OrientationBounds &b);
+
+/* Light Tree Primitive
+ *
+ * Triangle or lamp which is put into the tree. Distant and background lights have no position,
+ * and are sampled separately. */
+struct LightTreePrimitive {
+  /* Triangle index, or lamp index encoded as ~index, like in the light distribution. */
+  int prim_id;
+  int object_id;
+  int shader_flag;
+  /* Area of the triangle in world space, zero for lamps. */
+  float area;
+
+  BoundBox bbox;
+  OrientationBounds bcone;
+  float energy;
+
+  float3 centroid() const
+  {
+    return bbox.center();
+  }
+};
+
+/* Light Tree Node
+ *
+ * Inner nodes have two children: the first one directly follows the node in the nodes array, the
+ * second one is at #child_index. Leaf nodes contain #num_prims primitives starting at
+ * #first_prim_index. */
+struct LightTreeNode {
+  BoundBox bbox;
+  OrientationBounds bcone;
+  float energy;
+  /* Path from the root to the node, one bit per level, set when the second child was taken. */
+  uint bit_trail;
+  int num_prims;
+  union {
+    int first_prim_index;
+    int child_index;
+  };
+
+  bool is_leaf() const
+  {
+    return num_prims > 0;
+  }
+};
+
+/* Light Tree
+ *
+ * Bounding volume hierarchy over the emitters in the scene, used to pick lights proportional to
+ * their estimated contribution at the shading point. The primitives are reordered during the
+ * build, so that those of every leaf are stored consecutively. */
+class LightTree {
+ public:
+  /* Depth is limited by the number of bits in the bit trail. */
+  static const int max_depth = 32;
+
+  LightTree(vector<LightTreePrimitive> &prims, const int max_prims_in_leaf);
+
+  const vector<LightTreeNode> &get_nodes() const
+  {
+    return nodes;
+  }
+
+ protected:
+  int recursive_build(int start, int end, uint bit_trail, int depth);
+  bool find_split(int start, int end, const BoundBox &centroid_bbox, int &r_middle);
+
+  vector<LightTreePrimitive> &prims;
+  vector<LightTreeNode> nodes;
+  int max_prims_in_leaf;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
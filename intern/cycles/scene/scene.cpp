@@ -71,6 +71,11 @@ DeviceScene::DeviceScene(Device *device)
       lights(device, "__lights", MEM_GLOBAL),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_GLOBAL),
       light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_GLOBAL),
+      light_tree_nodes(device, "__light_tree_nodes", MEM_GLOBAL),
+      light_tree_emitters(device, "__light_tree_emitters", MEM_GLOBAL),
+      light_to_tree(device, "__light_to_tree", MEM_GLOBAL),
+      object_to_tree(device, "__object_to_tree", MEM_GLOBAL),
+      triangle_to_tree(device, "__triangle_to_tree", MEM_GLOBAL),
       particles(device, "__particles", MEM_GLOBAL),
       svm_nodes(device, "__svm_nodes", MEM_GLOBAL),
       shaders(device, "__shaders", MEM_GLOBAL),
@@ -109,6 +114,9 @@ Scene::Scene(const SceneParams &params_, Device *device)
   geometry_manager = new GeometryManager();
   object_manager = new ObjectManager();
   image_manager = new ImageManager(device->info);
+  if (params.use_texture_cache) {
+    image_manager->set_texture_cache(params.texture_cache_size);
+  }
   particle_system_manager = new ParticleSystemManager();
   bake_manager = new BakeManager();
   procedural_manager = new ProceduralManager();
@@ -558,7 +566,7 @@ void Scene::update_kernel_features()
   }
 
   kernel_features |= film->get_kernel_features(this);
-  kernel_features |= integrator->get_kernel_features();
+  kernel_features |= integrator->get_kernel_features(this);
 
   dscene.data.kernel_features = kernel_features;
 
@@ -615,6 +623,8 @@ static void log_kernel_features(const uint features)
           << string_from_bool(features & KERNEL_FEATURE_PATCH_EVALUATION) << "\n";
   VLOG(2) << "Use Shadow Catcher " << string_from_bool(features & KERNEL_FEATURE_SHADOW_CATCHER)
           << "\n";
+  VLOG(2) << "Use Path Guiding " << string_from_bool(features & KERNEL_FEATURE_PATH_GUIDING)
+          << "\n";
 }
 
 bool Scene::load_kernels(Progress &progress, bool lock_scene)
@@ -336,6 +336,42 @@ void ImageTextureNode::cull_tiles(Scene *scene, ShaderGraph *graph)
   tiles.steal_data(new_tiles);
 }
 
+/* Images in the texture cache are filtered using the derivatives of the texture coordinates.
+ * These are only known when the vector comes directly from a UV map. */
+int ImageTextureNode::uv_derivatives_attribute(SVMCompiler &compiler)
+{
+  if (!compiler.scene->image_manager->has_texture_cache()) {
+    return ATTR_STD_NOT_FOUND;
+  }
+  if (projection != NODE_IMAGE_PROJ_FLAT || !tex_mapping.skip()) {
+    return ATTR_STD_NOT_FOUND;
+  }
+
+  ShaderInput *vector_in = input("Vector");
+  if (vector_in->link == nullptr) {
+    return ATTR_STD_NOT_FOUND;
+  }
+  ShaderNode *node = vector_in->link->parent;
+  if (node->type == UVMapNode::get_node_type()) {
+    UVMapNode *uvmap = (UVMapNode *)node;
+    if (uvmap->get_from_dupli()) {
+      return ATTR_STD_NOT_FOUND;
+    }
+    if (uvmap->get_attribute() != "") {
+      return compiler.attribute(uvmap->get_attribute());
+    }
+    return compiler.attribute(ATTR_STD_UV);
+  }
+  if (node->type == TextureCoordinateNode::get_node_type()) {
+    TextureCoordinateNode *texco = (TextureCoordinateNode *)node;
+    if (vector_in->link != node->output("UV") || texco->get_from_dupli()) {
+      return ATTR_STD_NOT_FOUND;
+    }
+    return compiler.attribute(ATTR_STD_UV);
+  }
+  return ATTR_STD_NOT_FOUND;
+}
+
 void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attributes)
 {
 #ifdef WITH_PTEX
@@ -394,6 +430,11 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
       num_nodes = divide_up(handle.num_tiles(), 2);
     }
 
+    const int uv_attr = uv_derivatives_attribute(compiler);
+    if (uv_attr != ATTR_STD_NOT_FOUND) {
+      flags |= NODE_IMAGE_UV_DERIVATIVES;
+    }
+
     compiler.add_node(NODE_TEX_IMAGE,
                       num_nodes,
                       compiler.encode_uchar4(vector_offset,
@@ -402,6 +443,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                              flags),
                       projection);
 
+    if (uv_attr != ATTR_STD_NOT_FOUND) {
+      compiler.add_node(uv_attr, 0, 0, 0);
+    }
+
     if (num_nodes > 0) {
       for (int i = 0; i < num_nodes; i++) {
         int4 node;
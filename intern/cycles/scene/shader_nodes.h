@@ -119,6 +119,7 @@ class ImageTextureNode : public ImageSlotTextureNode {
 
  protected:
   void cull_tiles(Scene *scene, ShaderGraph *graph);
+  int uv_derivatives_attribute(SVMCompiler &compiler);
 };
 
 class EnvironmentTextureNode : public ImageSlotTextureNode {
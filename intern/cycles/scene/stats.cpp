@@ -228,6 +228,11 @@ string MeshStats::full_report(int indent_level)
 /* Image statistics. */
 
 ImageStats::ImageStats()
+    : has_texture_cache(false),
+      texture_cache_memory(0),
+      texture_cache_max_memory(0),
+      texture_cache_lookups(0),
+      texture_cache_misses(0)
 {
 }
 
@@ -236,6 +241,21 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (has_texture_cache) {
+    const string item_indent((indent_level + 1) * kIndentNumSpaces, ' ');
+    result += indent + "Texture cache:\n";
+    result += string_printf("%sMemory: %s of %s\n",
+                            item_indent.c_str(),
+                            string_human_readable_size(texture_cache_memory).c_str(),
+                            string_human_readable_size(texture_cache_max_memory).c_str());
+    result += string_printf("%sTile lookups: %s, hits: %s, misses: %s\n",
+                            item_indent.c_str(),
+                            string_human_readable_number(texture_cache_lookups).c_str(),
+                            string_human_readable_number(texture_cache_lookups -
+                                                         texture_cache_misses)
+                                .c_str(),
+                            string_human_readable_number(texture_cache_misses).c_str());
+  }
   return result;
 }
 
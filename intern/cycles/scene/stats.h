@@ -158,6 +158,13 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+
+  /* Tiles loaded on demand by the image cache, when it is used. */
+  bool has_texture_cache;
+  size_t texture_cache_memory;
+  size_t texture_cache_max_memory;
+  uint64_t texture_cache_lookups;
+  uint64_t texture_cache_misses;
 };
 
 /* Render process statistics. */
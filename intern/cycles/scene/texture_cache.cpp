@@ -0,0 +1,181 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#include "scene/texture_cache.h"
+#include "scene/colorspace.h"
+#include "scene/stats.h"
+
+#include "util/color.h"
+#include "util/log.h"
+
+#include <OpenImageIO/texture.h>
+
+CCL_NAMESPACE_BEGIN
+
+static TextureOpt::Wrap texture_cache_wrap(const ExtensionType extension)
+{
+  switch (extension) {
+    case EXTENSION_REPEAT:
+      return TextureOpt::WrapPeriodic;
+    case EXTENSION_EXTEND:
+      return TextureOpt::WrapClamp;
+    case EXTENSION_CLIP:
+    case EXTENSION_NUM_TYPES:
+      break;
+  }
+  return TextureOpt::WrapBlack;
+}
+
+static TextureOpt::InterpMode texture_cache_interpolation(const InterpolationType interpolation)
+{
+  switch (interpolation) {
+    case INTERPOLATION_CLOSEST:
+      return TextureOpt::InterpClosest;
+    case INTERPOLATION_CUBIC:
+      return TextureOpt::InterpBicubic;
+    case INTERPOLATION_SMART:
+      return TextureOpt::InterpSmartBicubic;
+    case INTERPOLATION_NONE:
+    case INTERPOLATION_LINEAR:
+    case INTERPOLATION_NUM_TYPES:
+      break;
+  }
+  return TextureOpt::InterpBilinear;
+}
+
+/* Called from the kernel for every lookup of a cached image. The pixels are converted the same
+ * way #ImageManager::file_load_image converts fully loaded images. */
+static void texture_cache_lookup(const TextureCacheImage *texture,
+                                 float x,
+                                 float y,
+                                 float2 duv_dx,
+                                 float2 duv_dy,
+                                 float *r_rgba)
+{
+  TextureSystem *ts = (TextureSystem *)texture->texture_system;
+
+  TextureOpt options;
+  options.swrap = (TextureOpt::Wrap)texture->wrap;
+  options.twrap = (TextureOpt::Wrap)texture->wrap;
+  options.interpmode = (TextureOpt::InterpMode)texture->interpolation;
+  /* Missing channels of gray and RGB images are opaque alpha. */
+  options.fill = 1.0f;
+
+  /* Images are flipped vertically compared to the kernel texture space. Without derivatives the
+   * finest MIP level is used. */
+  if (!ts->texture((TextureSystem::TextureHandle *)texture->handle,
+                   ts->get_perthread_info(),
+                   options,
+                   x,
+                   1.0f - y,
+                   duv_dx.x,
+                   -duv_dx.y,
+                   duv_dy.x,
+                   -duv_dy.y,
+                   4,
+                   r_rgba)) {
+    r_rgba[0] = TEX_IMAGE_MISSING_R;
+    r_rgba[1] = TEX_IMAGE_MISSING_G;
+    r_rgba[2] = TEX_IMAGE_MISSING_B;
+    r_rgba[3] = TEX_IMAGE_MISSING_A;
+    return;
+  }
+
+  if (texture->colorspace_processor) {
+    ColorSpaceManager::to_scene_linear(
+        (ColorSpaceProcessor *)texture->colorspace_processor, r_rgba, 4);
+    if (texture->compress_as_srgb) {
+      /* The kernel converts these back to linear, as it does for fully loaded images. */
+      r_rgba[0] = color_linear_to_srgb(r_rgba[0]);
+      r_rgba[1] = color_linear_to_srgb(r_rgba[1]);
+      r_rgba[2] = color_linear_to_srgb(r_rgba[2]);
+    }
+  }
+
+  /* Make sure we don't have buggy values. */
+  if (!isfinite(r_rgba[0]) || !isfinite(r_rgba[1]) || !isfinite(r_rgba[2]) ||
+      !isfinite(r_rgba[3])) {
+    r_rgba[0] = 0.0f;
+    r_rgba[1] = 0.0f;
+    r_rgba[2] = 0.0f;
+    r_rgba[3] = 0.0f;
+  }
+}
+
+TextureCache::TextureCache(const int max_memory_mb) : max_memory_mb(max_memory_mb)
+{
+  TextureSystem *ts = TextureSystem::create(false);
+  ts->attribute("automip", 1);
+  ts->attribute("autotile", 64);
+  ts->attribute("gray_to_rgb", 1);
+  ts->attribute("max_memory_MB", (float)max_memory_mb);
+  texture_system = ts;
+}
+
+TextureCache::~TextureCache()
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  ts->invalidate_all(true);
+  TextureSystem::destroy(ts);
+}
+
+bool TextureCache::get_texture(const ImageManager::Image *img, TextureCacheImage &r_texture)
+{
+  const ImageMetaData &metadata = img->metadata;
+  const ustring filepath = img->loader->osl_filepath();
+
+  /* Only 2D images read from files are supported. */
+  if (filepath.empty() || !(metadata.channels > 0) || metadata.depth > 1 ||
+      metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT ||
+      metadata.type == IMAGE_DATA_TYPE_NANOVDB_FLOAT3) {
+    return false;
+  }
+
+  /* The cache associates alpha, images which alpha is to be left untouched are fully loaded. */
+  const bool has_alpha = (metadata.channels == 2 || metadata.channels == 4);
+  if (has_alpha && (ColorSpaceManager::colorspace_is_data(img->params.colorspace) ||
+                    img->params.alpha_type == IMAGE_ALPHA_IGNORE ||
+                    img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED)) {
+    return false;
+  }
+
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  TextureSystem::TextureHandle *handle = ts->get_texture_handle(filepath);
+  int exists = 0;
+  if (handle == nullptr ||
+      !ts->get_texture_info(filepath, 0, ustring("exists"), TypeDesc::TypeInt, &exists) ||
+      !exists) {
+    VLOG(1) << "Image " << img->loader->name() << " can not be read from the texture cache.";
+    return false;
+  }
+
+  memset(&r_texture, 0, sizeof(r_texture));
+  r_texture.lookup = texture_cache_lookup;
+  r_texture.texture_system = ts;
+  r_texture.handle = handle;
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    r_texture.colorspace_processor = ColorSpaceManager::get_processor(metadata.colorspace);
+  }
+  r_texture.wrap = texture_cache_wrap(img->params.extension);
+  r_texture.interpolation = texture_cache_interpolation(img->params.interpolation);
+  r_texture.compress_as_srgb = metadata.compress_as_srgb;
+  return true;
+}
+
+void TextureCache::collect_statistics(ImageStats *stats)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  int64_t memory_used = 0, tile_lookups = 0;
+  int tile_misses = 0;
+  ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+  ts->getattribute("stat:find_tile_calls", TypeDesc::INT64, &tile_lookups);
+  ts->getattribute("stat:find_tile_cache_misses", TypeDesc::TypeInt, &tile_misses);
+
+  stats->has_texture_cache = true;
+  stats->texture_cache_memory = memory_used;
+  stats->texture_cache_max_memory = (size_t)max_memory_mb * 1024 * 1024;
+  stats->texture_cache_lookups = tile_lookups;
+  stats->texture_cache_misses = tile_misses;
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#ifndef __TEXTURE_CACHE_H__
+#define __TEXTURE_CACHE_H__
+
+#include "scene/image.h"
+
+#include "util/texture.h"
+
+CCL_NAMESPACE_BEGIN
+
+class ImageStats;
+
+/* Texture Cache
+ *
+ * Loads tiles of image files on demand while rendering on the CPU, instead of loading the full
+ * images into texture memory before rendering starts. Tiles are loaded by an OpenImageIO texture
+ * system, which creates MIP levels as needed and keeps the memory used by loaded tiles below the
+ * given limit. */
+class TextureCache {
+ public:
+  explicit TextureCache(const int max_memory_mb);
+  ~TextureCache();
+
+  /* Check whether the image can be looked up through the cache, and fill in the texture memory
+   * for the kernel if so. */
+  bool get_texture(const ImageManager::Image *img, TextureCacheImage &r_texture);
+
+  void collect_statistics(ImageStats *stats);
+
+ protected:
+  void *texture_system;
+  int max_memory_mb;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __TEXTURE_CACHE_H__ */
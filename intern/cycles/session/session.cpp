@@ -370,6 +370,10 @@ RenderWork Session::run_update_for_next_iteration()
     if (update_scene(width, height)) {
       profiler.reset(scene->shaders.size(), scene->objects.size());
     }
+
+    /* Update path guiding after the scene, so that the field covers the current scene bounds. */
+    path_trace_->set_guiding_params(scene->integrator->get_guiding_params(scene), did_reset);
+
     progress.add_skip_time(update_timer, params.background);
   }
 
@@ -0,0 +1,153 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh2.h"
+#include "bvh/params.h"
+
+#include "scene/mesh.h"
+#include "scene/object.h"
+
+#include "util/progress.h"
+#include "util/transform.h"
+#include "util/vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Grid of separate triangles, so that the BVH has inner nodes. */
+static Mesh *create_triangle_grid_mesh(const int size)
+{
+  Mesh *mesh = new Mesh();
+  mesh->reserve_mesh(size * size * 3, size * size);
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      const int v = mesh->get_verts().size();
+      mesh->add_vertex(make_float3(x, y, 0.0f));
+      mesh->add_vertex(make_float3(x + 0.5f, y, 0.0f));
+      mesh->add_vertex(make_float3(x, y + 0.5f, 0.0f));
+      mesh->add_triangle(v, v + 1, v + 2, 0, false);
+    }
+  }
+  mesh->compute_bounds();
+  return mesh;
+}
+
+static BVH2 *create_bvh2(const vector<Geometry *> &geometry,
+                         const vector<Object *> &objects,
+                         const bool top_level)
+{
+  BVHParams params;
+  params.bvh_layout = BVH_LAYOUT_BVH2;
+  params.bvh_type = BVH_TYPE_DYNAMIC;
+  params.top_level = top_level;
+
+  BVH2 *bvh = static_cast<BVH2 *>(BVH::create(params, geometry, objects, nullptr));
+  Progress progress;
+  bvh->build(progress, nullptr);
+  return bvh;
+}
+
+/* Bounds of the children of a BVH2 inner node together. */
+static BoundBox bvh2_inner_node_bounds(const PackedBVH &pack, const int node_index)
+{
+  EXPECT_GE(node_index, 0);
+  const int4 x = pack.nodes[node_index + 1];
+  const int4 y = pack.nodes[node_index + 2];
+  const int4 z = pack.nodes[node_index + 3];
+  return BoundBox(make_float3(min(__int_as_float(x.x), __int_as_float(x.y)),
+                              min(__int_as_float(y.x), __int_as_float(y.y)),
+                              min(__int_as_float(z.x), __int_as_float(z.y))),
+                  make_float3(max(__int_as_float(x.z), __int_as_float(x.w)),
+                              max(__int_as_float(y.z), __int_as_float(y.w)),
+                              max(__int_as_float(z.z), __int_as_float(z.w))));
+}
+
+static void expect_bounds_contain(const BoundBox &bounds, const float3 &P)
+{
+  EXPECT_LE(bounds.min.x, P.x);
+  EXPECT_LE(bounds.min.y, P.y);
+  EXPECT_LE(bounds.min.z, P.z);
+  EXPECT_GE(bounds.max.x, P.x);
+  EXPECT_GE(bounds.max.y, P.y);
+  EXPECT_GE(bounds.max.z, P.z);
+}
+
+/* Move some of the triangles up, out of the bounds the BVH was built with. */
+static void move_triangles(Mesh *mesh)
+{
+  array<float3> &verts = mesh->get_verts();
+  for (size_t i = 0; i < verts.size(); i += 7) {
+    verts[i].z += 5.0f;
+  }
+  mesh->compute_bounds();
+}
+
+TEST(BVH2, refit_geometry)
+{
+  Mesh *mesh = create_triangle_grid_mesh(8);
+  Object object;
+  object.set_geometry(mesh);
+  object.set_visibility(~0);
+
+  BVH2 *bvh = create_bvh2({mesh}, {&object}, false);
+  mesh->bvh = bvh;
+
+  move_triangles(mesh);
+  Progress progress;
+  bvh->refit(progress);
+
+  EXPECT_EQ(bvh->num_refits, 1);
+  const BoundBox bounds = bvh2_inner_node_bounds(bvh->pack, bvh->pack.root_index);
+  for (const float3 &P : mesh->get_verts()) {
+    expect_bounds_contain(bounds, P);
+  }
+
+  delete mesh;
+}
+
+TEST(BVH2, refit_instances)
+{
+  Mesh *mesh = create_triangle_grid_mesh(8);
+
+  /* Instance BVH, built the same way as in Geometry::compute_bvh(). */
+  Object mesh_object;
+  mesh_object.set_geometry(mesh);
+  mesh_object.set_visibility(~0);
+  BVH2 *mesh_bvh = create_bvh2({mesh}, {&mesh_object}, false);
+  mesh->bvh = mesh_bvh;
+
+  /* Two instances of the mesh, so the root of the top level BVH is an inner node. */
+  Object object1;
+  object1.set_geometry(mesh);
+  object1.compute_bounds(false);
+  Object object2;
+  object2.set_geometry(mesh);
+  object2.set_tfm(transform_translate(20.0f, 0.0f, 0.0f));
+  object2.compute_bounds(false);
+  ASSERT_TRUE(mesh->is_instanced());
+
+  BVH2 *top_bvh = create_bvh2({mesh}, {&object1, &object2}, true);
+
+  move_triangles(mesh);
+  object1.compute_bounds(false);
+  object2.compute_bounds(false);
+  Progress progress;
+  mesh_bvh->refit(progress);
+  top_bvh->refit(progress);
+
+  /* The nodes of the instance are copied into the top level BVH. */
+  const BoundBox instance_bounds = bvh2_inner_node_bounds(top_bvh->pack,
+                                                         top_bvh->pack.object_node[0]);
+  const BoundBox root_bounds = bvh2_inner_node_bounds(top_bvh->pack, top_bvh->pack.root_index);
+  for (const float3 &P : mesh->get_verts()) {
+    expect_bounds_contain(instance_bounds, P);
+    expect_bounds_contain(root_bounds, P);
+    expect_bounds_contain(root_bounds, transform_point(&object2.get_tfm(), P));
+  }
+
+  delete top_bvh;
+  delete mesh;
+}
+
+CCL_NAMESPACE_END
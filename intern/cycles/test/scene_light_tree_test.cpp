@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: Apache-2.0
+ * Copyright 2011-2022 Blender Foundation */
+
+#include "testing/testing.h"
+
+#include "scene/light_tree.h"
+
+#include "util/hash.h"
+#include "util/vector.h"
+
+#include "kernel/device/cpu/compat.h"
+#include "kernel/device/cpu/globals.h"
+
+#include "kernel/light/tree.h"
+
+CCL_NAMESPACE_BEGIN
+
+static void light_tree_bounds_to_kernel(const BoundBox &bbox,
+                                        const OrientationBounds &bcone,
+                                        const float energy,
+                                        KernelLightTreeBounds &kbounds)
+{
+  kbounds.bounding_box_min[0] = bbox.min.x;
+  kbounds.bounding_box_min[1] = bbox.min.y;
+  kbounds.bounding_box_min[2] = bbox.min.z;
+  kbounds.bounding_box_max[0] = bbox.max.x;
+  kbounds.bounding_box_max[1] = bbox.max.y;
+  kbounds.bounding_box_max[2] = bbox.max.z;
+  kbounds.axis[0] = bcone.axis.x;
+  kbounds.axis[1] = bcone.axis.y;
+  kbounds.axis[2] = bcone.axis.z;
+  kbounds.theta_o = bcone.theta_o;
+  kbounds.theta_e = bcone.theta_e;
+  kbounds.energy = energy;
+}
+
+/* Light tree over lamps at pseudo-random positions, and one distant light, packed the same way
+ * as in LightManager::device_update_tree(). */
+class LightTreeTest : public testing::Test {
+ protected:
+  static const int num_lamps = 50;
+
+  virtual void SetUp()
+  {
+    vector<LightTreePrimitive> prims;
+    for (int i = 0; i < num_lamps; i++) {
+      const float3 co = make_float3(hash_uint2_to_float(i, 0) * 10.0f,
+                                    hash_uint2_to_float(i, 1) * 10.0f,
+                                    hash_uint2_to_float(i, 2) * 2.0f);
+      const float radius = 0.1f + hash_uint2_to_float(i, 3) * 0.2f;
+
+      LightTreePrimitive prim;
+      prim.prim_id = ~i;
+      prim.object_id = OBJECT_NONE;
+      prim.shader_flag = 0;
+      prim.area = 0.0f;
+      prim.bbox = BoundBox(co - make_float3(radius), co + make_float3(radius));
+      /* Spot lights pointing down, half of them with a narrow cone. */
+      prim.bcone = OrientationBounds(
+          make_float3(0.0f, 0.0f, -1.0f), 0.0f, (i % 2) ? M_PI_4_F : M_PI_2_F);
+      prim.energy = 1.0f + hash_uint2_to_float(i, 4) * 100.0f;
+      prims.push_back(prim);
+    }
+
+    LightTree light_tree(prims, 4);
+    const vector<LightTreeNode> &nodes = light_tree.get_nodes();
+
+    knodes.resize(nodes.size());
+    kemitters.resize(prims.size() + 1);
+    for (size_t node_index = 0; node_index < nodes.size(); node_index++) {
+      const LightTreeNode &node = nodes[node_index];
+      KernelLightTreeNode &knode = knodes[node_index];
+      light_tree_bounds_to_kernel(node.bbox, node.bcone, node.energy, knode.bounds);
+      knode.num_prims = node.num_prims;
+      knode.child_index = node.is_leaf() ? node.first_prim_index : node.child_index;
+
+      if (!node.is_leaf()) {
+        continue;
+      }
+
+      for (int i = node.first_prim_index; i < node.first_prim_index + node.num_prims; i++) {
+        const LightTreePrimitive &prim = prims[i];
+        KernelLightTreeEmitter &kemitter = kemitters[i];
+        light_tree_bounds_to_kernel(prim.bbox, prim.bcone, prim.energy, kemitter.bounds);
+        kemitter.prim = prim.prim_id;
+        kemitter.object_id = prim.object_id;
+        kemitter.shader_flag = prim.shader_flag;
+        kemitter.bit_trail = node.bit_trail;
+        kemitter.area = prim.area;
+      }
+    }
+
+    /* The distant light comes after the emitters of the tree. */
+    memset(&kemitters[prims.size()], 0, sizeof(KernelLightTreeEmitter));
+    kemitters[prims.size()].prim = ~num_lamps;
+    kemitters[prims.size()].object_id = OBJECT_NONE;
+
+    kg_data.__light_tree_nodes.data = knodes.data();
+    kg_data.__light_tree_nodes.width = knodes.size();
+    kg_data.__light_tree_emitters.data = kemitters.data();
+    kg_data.__light_tree_emitters.width = kemitters.size();
+    kg_data.__data.integrator.num_distant_lights = 1;
+    kg_data.__data.integrator.distant_lights_offset = prims.size();
+    kg_data.__data.integrator.pdf_lights = 1.0f / (num_lamps + 1);
+  }
+
+  vector<KernelLightTreeNode> knodes;
+  vector<KernelLightTreeEmitter> kemitters;
+  KernelGlobalsCPU kg_data;
+};
+
+TEST_F(LightTreeTest, pdf_sums_to_one)
+{
+  KernelGlobals kg = &kg_data;
+  const float3 P = make_float3(4.0f, 6.0f, -1.0f);
+
+  float pdf_sum = 0.0f;
+  for (int emitter = 0; emitter < kemitters.size(); emitter++) {
+    pdf_sum += light_tree_pdf(kg, P, emitter);
+  }
+  EXPECT_NEAR(pdf_sum, 1.0f, 1e-5f);
+}
+
+TEST_F(LightTreeTest, pdf_matches_sampled_distribution)
+{
+  KernelGlobals kg = &kg_data;
+  const float3 positions[] = {make_float3(5.0f, 5.0f, -1.0f),
+                              make_float3(-3.0f, 12.0f, -4.0f),
+                              make_float3(2.0f, 8.0f, 1.0f)};
+  const int num_samples = 1 << 16;
+
+  for (const float3 &P : positions) {
+    vector<int> num_picked(kemitters.size(), 0);
+    for (int i = 0; i < num_samples; i++) {
+      float randu = (i + 0.5f) / num_samples;
+      int emitter = -1;
+      const float pdf = light_tree_sample(kg, P, &randu, &emitter);
+      if (pdf == 0.0f) {
+        continue;
+      }
+      ASSERT_GE(emitter, 0);
+      ASSERT_LT(emitter, kemitters.size());
+      /* The probability returned when sampling is the same as the one for MIS. */
+      EXPECT_NEAR(pdf, light_tree_pdf(kg, P, emitter), 1e-5f * pdf);
+      num_picked[emitter]++;
+    }
+
+    /* Stratified random numbers pick every emitter as often as its probability. */
+    for (int emitter = 0; emitter < kemitters.size(); emitter++) {
+      const float frequency = (float)num_picked[emitter] / num_samples;
+      EXPECT_NEAR(frequency, light_tree_pdf(kg, P, emitter), 1e-3f);
+    }
+  }
+}
+
+CCL_NAMESPACE_END
@@ -13,7 +13,13 @@
 CCL_NAMESPACE_BEGIN
 
 DebugFlags::CPU::CPU()
-    : avx2(true), avx(true), sse41(true), sse3(true), sse2(true), bvh_layout(BVH_LAYOUT_AUTO)
+    : avx2(true),
+      avx(true),
+      sse41(true),
+      sse3(true),
+      sse2(true),
+      bvh_layout(BVH_LAYOUT_AUTO),
+      wavefront(false)
 {
   reset();
 }
@@ -39,6 +45,7 @@ void DebugFlags::CPU::reset()
 #undef CHECK_CPU_FLAGS
 
   bvh_layout = BVH_LAYOUT_AUTO;
+  wavefront = (getenv("CYCLES_CPU_WAVEFRONT") != NULL);
 }
 
 DebugFlags::CUDA::CUDA() : adaptive_compile(false)
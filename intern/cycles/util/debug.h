@@ -66,6 +66,10 @@ class DebugFlags {
      * CPUs and GPUs can be selected here instead.
      */
     BVHLayout bvh_layout;
+
+    /* Trace batches of paths through the integrator kernels one kernel at a time, instead of
+     * tracing every path to completion in the megakernel. */
+    bool wavefront;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
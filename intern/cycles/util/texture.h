@@ -37,6 +37,7 @@ typedef enum ImageDataType {
   IMAGE_DATA_TYPE_USHORT = 7,
   IMAGE_DATA_TYPE_NANOVDB_FLOAT = 8,
   IMAGE_DATA_TYPE_NANOVDB_FLOAT3 = 9,
+  IMAGE_DATA_TYPE_CACHED = 10,
 
   IMAGE_DATA_NUM_TYPES
 } ImageDataType;
@@ -81,6 +82,28 @@ typedef struct TextureInfo {
   Transform transform_3d;
 } TextureInfo;
 
+#ifndef __KERNEL_GPU__
+/* Image which tiles are loaded on demand on the CPU, see #TextureCache. The texture memory of such
+ * images only contains this struct, the pixels are looked up by the host. */
+typedef struct TextureCacheImage {
+  /* Filtered lookup, using the derivatives of the texture coordinates to select MIP levels. */
+  void (*lookup)(const struct TextureCacheImage *texture,
+                 float x,
+                 float y,
+                 float2 duv_dx,
+                 float2 duv_dy,
+                 float *r_rgba);
+  /* Opaque handles of the cache and the image in it. */
+  void *texture_system;
+  void *handle;
+  /* Conversion to scene linear, null if the pixels need no conversion. */
+  void *colorspace_processor;
+  int wrap;
+  int interpolation;
+  bool compress_as_srgb;
+} TextureCacheImage;
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_TEXTURE_H__ */
@@ -238,6 +238,16 @@ void MEM_use_lockfree_allocator(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_guarded_allocator(void);
 
+/* Switch allocator to fast mode with per-thread arenas.
+ *
+ * Small allocations are served from free lists owned by the calling thread, which avoids
+ * contention in the system allocator when many threads allocate at the same time. Tracking is the
+ * same as for the lock-free allocator. Memory of freed small blocks is kept for reuse and not
+ * returned to the system.
+ *
+ * NOTE: The switch between allocator types can only happen before any allocation did happen. */
+void MEM_use_arena_allocator(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -161,3 +161,36 @@ void MEM_use_guarded_allocator(void)
   MEM_name_ptr = MEM_guarded_name_ptr;
 #endif
 }
+
+void MEM_use_arena_allocator(void)
+{
+  assert_for_allocator_change();
+
+  MEM_arena_init();
+
+  MEM_allocN_len = MEM_arena_allocN_len;
+  MEM_freeN = MEM_arena_freeN;
+  MEM_dupallocN = MEM_arena_dupallocN;
+  MEM_reallocN_id = MEM_arena_reallocN_id;
+  MEM_recallocN_id = MEM_arena_recallocN_id;
+  MEM_callocN = MEM_arena_callocN;
+  MEM_calloc_arrayN = MEM_arena_calloc_arrayN;
+  MEM_mallocN = MEM_arena_mallocN;
+  MEM_malloc_arrayN = MEM_arena_malloc_arrayN;
+  MEM_mallocN_aligned = MEM_arena_mallocN_aligned;
+  MEM_printmemlist_pydict = MEM_arena_printmemlist_pydict;
+  MEM_printmemlist = MEM_arena_printmemlist;
+  MEM_callbackmemlist = MEM_arena_callbackmemlist;
+  MEM_printmemlist_stats = MEM_arena_printmemlist_stats;
+  MEM_set_error_callback = MEM_arena_set_error_callback;
+  MEM_consistency_check = MEM_arena_consistency_check;
+  MEM_set_memory_debug = MEM_arena_set_memory_debug;
+  MEM_get_memory_in_use = MEM_arena_get_memory_in_use;
+  MEM_get_memory_blocks_in_use = MEM_arena_get_memory_blocks_in_use;
+  MEM_reset_peak_memory = MEM_arena_reset_peak_memory;
+  MEM_get_peak_memory = MEM_arena_get_peak_memory;
+
+#ifndef NDEBUG
+  MEM_name_ptr = MEM_arena_name_ptr;
+#endif
+}
@@ -0,0 +1,810 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup intern_mem
+ *
+ * Memory allocation with per-thread arenas for small blocks.
+ *
+ * Small blocks (up to #ARENA_BLOCK_SIZE_MAX including the #MemHead) are rounded up to a size
+ * class and served from a free list owned by the calling thread, so the common case does not
+ * touch any shared state: no lock, no atomic operation and no call into the system allocator.
+ *
+ * - Free lists are refilled in batches, either from a central per size class list of batches
+ *   (protected by a mutex, only touched once per #ARENA_BATCH_SIZE allocations) or by carving
+ *   blocks from a chunk owned by the thread.
+ * - Chunks are allocated and first written by the thread that uses them. With the default first
+ *   touch policy of the operating system their pages end up on the NUMA node of that thread.
+ * - Freed blocks go to the free list of the freeing thread. When it grows too long, a batch is
+ *   handed back to the central list, so memory can move between threads.
+ * - Larger and aligned blocks use the system allocator, like the lock-free allocator does.
+ *
+ * Memory and block counters are accumulated per thread and added to the global counters when
+ * they change by more than #ARENA_ACCOUNT_FLUSH_SIZE. #MEM_arena_get_memory_in_use and
+ * #MEM_arena_get_memory_blocks_in_use add the pending per-thread values, so they are exact when
+ * no other thread allocates at the same time. The peak memory is only updated on flush, so it can
+ * be slightly lower than the real peak.
+ *
+ * Chunks are never returned to the system. Memory of freed small blocks stays available for
+ * further small allocations of the same size class.
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h> /* printf */
+#include <stdlib.h>
+#include <string.h> /* memcpy */
+#include <sys/types.h>
+
+#include "MEM_guardedalloc.h"
+
+/* to ensure strict conversions */
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+#include "atomic_ops.h"
+#include "mallocn_intern.h"
+
+typedef struct MemHead {
+  /* Length of allocated memory block. */
+  size_t len;
+} MemHead;
+
+typedef struct MemHeadAligned {
+  short alignment;
+  size_t len;
+} MemHeadAligned;
+
+enum {
+  MEMHEAD_ALIGN_FLAG = 1,
+  /** Block is served from an arena size class, otherwise it is allocated with `malloc`. */
+  MEMHEAD_ARENA_FLAG = 2,
+};
+
+#define MEMHEAD_FLAGS ((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_ARENA_FLAG))
+
+#define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
+#define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
+#define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
+#define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_IS_ARENA(memhead) ((memhead)->len & (size_t)MEMHEAD_ARENA_FLAG)
+
+/* Size classes are multiples of 16 bytes up to 256 bytes, and multiples of 64 bytes above. */
+#define ARENA_BLOCK_SIZE_MAX 1024
+#define ARENA_CLASS_NUM 28
+/** Number of blocks moved between a thread and the central lists at once. */
+#define ARENA_BATCH_SIZE 32
+/** A thread keeps at most this many free blocks per size class. */
+#define ARENA_THREAD_CACHE_MAX (2 * ARENA_BATCH_SIZE)
+#define ARENA_CHUNK_SIZE (256 * 1024)
+#define ARENA_ACCOUNT_FLUSH_SIZE (256 * 1024)
+#define ARENA_ACCOUNT_FLUSH_BLOCKS 256
+
+typedef struct ArenaFreeBlock {
+  struct ArenaFreeBlock *next;
+  /** Only used for the first block of a batch in the central list. */
+  struct ArenaFreeBlock *next_batch;
+} ArenaFreeBlock;
+
+typedef struct ArenaFreeList {
+  ArenaFreeBlock *first;
+  unsigned int len;
+} ArenaFreeList;
+
+typedef struct ArenaCentralList {
+  pthread_mutex_t mutex;
+  ArenaFreeBlock *first_batch;
+} ArenaCentralList;
+
+typedef struct ArenaThread {
+  struct ArenaThread *next;
+  /** False when the thread exited, the struct is reused by the next new thread. */
+  bool in_use;
+
+  ArenaFreeList free_lists[ARENA_CLASS_NUM];
+
+  /** Unused part of the chunk blocks are carved from. */
+  char *chunk_next;
+  char *chunk_end;
+
+  /**
+   * Changes of the memory counters which have not been added to the global counters yet.
+   * Only written by the owning thread. They can become negative when the thread frees memory
+   * that was allocated by other threads.
+   */
+  int64_t mem_in_use_pending;
+  int64_t totblock_pending;
+} ArenaThread;
+
+static unsigned int totblock = 0;
+static size_t mem_in_use = 0, peak_mem = 0;
+static bool malloc_debug_memset = false;
+
+static void (*error_callback)(const char *) = NULL;
+
+static pthread_key_t arena_thread_key;
+static bool arena_initialized = false;
+static ArenaThread *arena_threads = NULL;
+static pthread_mutex_t arena_threads_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ArenaCentralList arena_central_lists[ARENA_CLASS_NUM];
+
+#ifdef __GNUC__
+__attribute__((format(printf, 1, 2)))
+#endif
+static void
+print_error(const char *str, ...)
+{
+  char buf[512];
+  va_list ap;
+
+  va_start(ap, str);
+  vsnprintf(buf, sizeof(buf), str, ap);
+  va_end(ap);
+  buf[sizeof(buf) - 1] = '\0';
+
+  if (error_callback) {
+    error_callback(buf);
+  }
+}
+
+/* -------------------------------------------------------------------- */
+/** \name Size Classes
+ * \{ */
+
+MEM_INLINE size_t arena_class_index(size_t block_size)
+{
+  if (block_size <= 256) {
+    return (block_size + 15) / 16 - 1;
+  }
+  return 16 + (block_size - 256 + 63) / 64 - 1;
+}
+
+MEM_INLINE size_t arena_class_block_size(size_t class_index)
+{
+  if (class_index < 16) {
+    return (class_index + 1) * 16;
+  }
+  return 256 + (class_index - 15) * 64;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Threads
+ * \{ */
+
+static void arena_account_flush(ArenaThread *thread)
+{
+  /* Unsigned wrap-around makes adding negative values work as expected. */
+  const size_t mem_in_use_new = atomic_add_and_fetch_z(&mem_in_use,
+                                                       (size_t)thread->mem_in_use_pending);
+  atomic_add_and_fetch_u(&totblock, (unsigned int)thread->totblock_pending);
+  atomic_fetch_and_update_max_z(&peak_mem, mem_in_use_new);
+  thread->mem_in_use_pending = 0;
+  thread->totblock_pending = 0;
+}
+
+MEM_INLINE void arena_account(ArenaThread *thread, int64_t len, int64_t blocks)
+{
+  thread->mem_in_use_pending += len;
+  thread->totblock_pending += blocks;
+  if (UNLIKELY(thread->mem_in_use_pending > ARENA_ACCOUNT_FLUSH_SIZE ||
+               thread->mem_in_use_pending < -ARENA_ACCOUNT_FLUSH_SIZE ||
+               thread->totblock_pending > ARENA_ACCOUNT_FLUSH_BLOCKS ||
+               thread->totblock_pending < -ARENA_ACCOUNT_FLUSH_BLOCKS))
+  {
+    arena_account_flush(thread);
+  }
+}
+
+static void arena_central_push(size_t class_index, ArenaFreeBlock *batch)
+{
+  ArenaCentralList *central = &arena_central_lists[class_index];
+  pthread_mutex_lock(&central->mutex);
+  batch->next_batch = central->first_batch;
+  central->first_batch = batch;
+  pthread_mutex_unlock(&central->mutex);
+}
+
+static ArenaFreeBlock *arena_central_pop(size_t class_index)
+{
+  ArenaCentralList *central = &arena_central_lists[class_index];
+  pthread_mutex_lock(&central->mutex);
+  ArenaFreeBlock *batch = central->first_batch;
+  if (batch) {
+    central->first_batch = batch->next_batch;
+  }
+  pthread_mutex_unlock(&central->mutex);
+  return batch;
+}
+
+/** Called by pthreads when a thread that used the allocator exits. */
+static void arena_thread_exit(void *thread_v)
+{
+  ArenaThread *thread = (ArenaThread *)thread_v;
+
+  /* Hand all cached blocks to the central lists so other threads can use them. */
+  for (size_t i = 0; i < ARENA_CLASS_NUM; i++) {
+    if (thread->free_lists[i].first) {
+      arena_central_push(i, thread->free_lists[i].first);
+      thread->free_lists[i].first = NULL;
+      thread->free_lists[i].len = 0;
+    }
+  }
+  arena_account_flush(thread);
+
+  /* The remaining chunk is kept, it is used by the next thread that reuses this struct. */
+  pthread_mutex_lock(&arena_threads_mutex);
+  thread->in_use = false;
+  pthread_mutex_unlock(&arena_threads_mutex);
+}
+
+static ArenaThread *arena_thread_create(void)
+{
+  ArenaThread *thread = NULL;
+
+  pthread_mutex_lock(&arena_threads_mutex);
+  for (ArenaThread *thread_iter = arena_threads; thread_iter; thread_iter = thread_iter->next) {
+    if (!thread_iter->in_use) {
+      thread = thread_iter;
+      break;
+    }
+  }
+  if (thread == NULL) {
+    thread = (ArenaThread *)calloc(1, sizeof(ArenaThread));
+    if (thread == NULL) {
+      pthread_mutex_unlock(&arena_threads_mutex);
+      return NULL;
+    }
+    thread->next = arena_threads;
+    arena_threads = thread;
+  }
+  thread->in_use = true;
+  pthread_mutex_unlock(&arena_threads_mutex);
+
+  pthread_setspecific(arena_thread_key, thread);
+  return thread;
+}
+
+MEM_INLINE ArenaThread *arena_thread_get(void)
+{
+  ArenaThread *thread = (ArenaThread *)pthread_getspecific(arena_thread_key);
+  if (UNLIKELY(thread == NULL)) {
+    thread = arena_thread_create();
+  }
+  return thread;
+}
+
+void MEM_arena_init(void)
+{
+  if (arena_initialized) {
+    return;
+  }
+  pthread_key_create(&arena_thread_key, arena_thread_exit);
+  for (size_t i = 0; i < ARENA_CLASS_NUM; i++) {
+    pthread_mutex_init(&arena_central_lists[i].mutex, NULL);
+    arena_central_lists[i].first_batch = NULL;
+  }
+  arena_initialized = true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Small Blocks
+ * \{ */
+
+static bool arena_free_list_refill(ArenaThread *thread, size_t class_index)
+{
+  ArenaFreeList *list = &thread->free_lists[class_index];
+
+  ArenaFreeBlock *batch = arena_central_pop(class_index);
+  if (batch) {
+    unsigned int len = 0;
+    for (ArenaFreeBlock *block = batch; block; block = block->next) {
+      len++;
+    }
+    list->first = batch;
+    list->len = len;
+    return true;
+  }
+
+  const size_t block_size = arena_class_block_size(class_index);
+  if ((size_t)(thread->chunk_end - thread->chunk_next) < block_size) {
+    /* The rest of the previous chunk is too small and stays unused. */
+    char *chunk = (char *)malloc(ARENA_CHUNK_SIZE);
+    if (chunk == NULL) {
+      return false;
+    }
+    thread->chunk_next = chunk;
+    thread->chunk_end = chunk + ARENA_CHUNK_SIZE;
+  }
+
+  size_t blocks_num = (size_t)(thread->chunk_end - thread->chunk_next) / block_size;
+  if (blocks_num > ARENA_BATCH_SIZE) {
+    blocks_num = ARENA_BATCH_SIZE;
+  }
+  /* Link the blocks in address order, so consecutive allocations are adjacent in memory. */
+  ArenaFreeBlock *first = (ArenaFreeBlock *)thread->chunk_next;
+  for (size_t i = 0; i < blocks_num; i++) {
+    ArenaFreeBlock *block = (ArenaFreeBlock *)(thread->chunk_next + i * block_size);
+    block->next = (i + 1 < blocks_num) ? (ArenaFreeBlock *)((char *)block + block_size) : NULL;
+  }
+  thread->chunk_next += blocks_num * block_size;
+  list->first = first;
+  list->len = (unsigned int)blocks_num;
+  return true;
+}
+
+MEM_INLINE MemHead *arena_block_alloc(ArenaThread *thread, size_t class_index)
+{
+  ArenaFreeList *list = &thread->free_lists[class_index];
+  if (UNLIKELY(list->first == NULL)) {
+    if (!arena_free_list_refill(thread, class_index)) {
+      return NULL;
+    }
+  }
+  ArenaFreeBlock *block = list->first;
+  list->first = block->next;
+  list->len--;
+  return (MemHead *)block;
+}
+
+static void arena_free_list_release_batch(ArenaFreeList *list, size_t class_index)
+{
+  ArenaFreeBlock *batch = list->first;
+  ArenaFreeBlock *last = batch;
+  for (int i = 1; i < ARENA_BATCH_SIZE; i++) {
+    last = last->next;
+  }
+  list->first = last->next;
+  list->len -= ARENA_BATCH_SIZE;
+  last->next = NULL;
+  arena_central_push(class_index, batch);
+}
+
+MEM_INLINE void arena_block_free(ArenaThread *thread, MemHead *memh, size_t class_index)
+{
+  ArenaFreeList *list = &thread->free_lists[class_index];
+  ArenaFreeBlock *block = (ArenaFreeBlock *)memh;
+  block->next = list->first;
+  list->first = block;
+  list->len++;
+  if (UNLIKELY(list->len > ARENA_THREAD_CACHE_MAX)) {
+    arena_free_list_release_batch(list, class_index);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Allocator API
+ * \{ */
+
+size_t MEM_arena_allocN_len(const void *vmemh)
+{
+  if (vmemh) {
+    return MEMHEAD_FROM_PTR(vmemh)->len & ~MEMHEAD_FLAGS;
+  }
+
+  return 0;
+}
+
+void MEM_arena_freeN(void *vmemh)
+{
+  if (leak_detector_has_run) {
+    print_error("%s\n", free_after_leak_detection_message);
+  }
+
+  if (vmemh == NULL) {
+    print_error("Attempt to free NULL pointer\n");
+#ifdef WITH_ASSERT_ABORT
+    abort();
+#endif
+    return;
+  }
+
+  MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+  size_t len = MEM_arena_allocN_len(vmemh);
+  ArenaThread *thread = arena_thread_get();
+
+  if (UNLIKELY(malloc_debug_memset && len)) {
+    memset(memh + 1, 255, len);
+  }
+  if (LIKELY(MEMHEAD_IS_ARENA(memh) && thread)) {
+    arena_account(thread, -(int64_t)len, -1);
+    arena_block_free(thread, memh, arena_class_index(len + sizeof(MemHead)));
+    return;
+  }
+
+  if (thread) {
+    arena_account(thread, -(int64_t)len, -1);
+  }
+  else {
+    atomic_sub_and_fetch_u(&totblock, 1);
+    atomic_sub_and_fetch_z(&mem_in_use, len);
+  }
+
+  if (UNLIKELY(MEMHEAD_IS_ARENA(memh))) {
+    /* Only happens when the thread data could not be allocated. The block is leaked, but the
+     * memory counters stay correct. */
+  }
+  else if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+    MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+    aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+  }
+  else {
+    free(memh);
+  }
+}
+
+void *MEM_arena_dupallocN(const void *vmemh)
+{
+  void *newp = NULL;
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    const size_t prev_size = MEM_arena_allocN_len(vmemh);
+    if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_arena_mallocN_aligned(
+          prev_size, (size_t)memh_aligned->alignment, "dupli_malloc");
+    }
+    else {
+      newp = MEM_arena_mallocN(prev_size, "dupli_malloc");
+    }
+    memcpy(newp, vmemh, prev_size);
+  }
+  return newp;
+}
+
+void *MEM_arena_reallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_arena_allocN_len(vmemh);
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_arena_mallocN(len, "realloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_arena_mallocN_aligned(len, (size_t)memh_aligned->alignment, "realloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        /* grow (or remain same size) */
+        memcpy(newp, vmemh, old_len);
+      }
+    }
+
+    MEM_arena_freeN(vmemh);
+  }
+  else {
+    newp = MEM_arena_mallocN(len, str);
+  }
+
+  return newp;
+}
+
+void *MEM_arena_recallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_arena_allocN_len(vmemh);
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_arena_mallocN(len, "recalloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_arena_mallocN_aligned(len, (size_t)memh_aligned->alignment, "recalloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        memcpy(newp, vmemh, old_len);
+
+        if (len > old_len) {
+          /* grow */
+          /* zero new bytes */
+          memset(((char *)newp) + old_len, 0, len - old_len);
+        }
+      }
+    }
+
+    MEM_arena_freeN(vmemh);
+  }
+  else {
+    newp = MEM_arena_callocN(len, str);
+  }
+
+  return newp;
+}
+
+/**
+ * Allocate a block with room for a #MemHead, from the arena when it is small enough.
+ * The returned head has its length and flags set already.
+ */
+MEM_INLINE MemHead *arena_memh_alloc(size_t len, bool clear)
+{
+  const size_t block_size = len + sizeof(MemHead);
+  ArenaThread *thread = arena_thread_get();
+  MemHead *memh = NULL;
+
+  if (LIKELY(block_size <= ARENA_BLOCK_SIZE_MAX && thread)) {
+    memh = arena_block_alloc(thread, arena_class_index(block_size));
+    if (LIKELY(memh)) {
+      if (clear) {
+        memset(memh + 1, 0, len);
+      }
+      memh->len = len | (size_t)MEMHEAD_ARENA_FLAG;
+    }
+  }
+  else {
+    memh = (MemHead *)(clear ? calloc(1, block_size) : malloc(block_size));
+    if (LIKELY(memh)) {
+      memh->len = len;
+    }
+  }
+
+  if (LIKELY(memh)) {
+    if (thread) {
+      arena_account(thread, (int64_t)len, 1);
+    }
+    else {
+      atomic_add_and_fetch_u(&totblock, 1);
+      atomic_add_and_fetch_z(&mem_in_use, len);
+    }
+  }
+  return memh;
+}
+
+void *MEM_arena_callocN(size_t len, const char *str)
+{
+  MemHead *memh;
+
+  len = SIZET_ALIGN_4(len);
+
+  memh = arena_memh_alloc(len, true);
+
+  if (LIKELY(memh)) {
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)mem_in_use);
+  return NULL;
+}
+
+void *MEM_arena_calloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Calloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)mem_in_use);
+    abort();
+    return NULL;
+  }
+
+  return MEM_arena_callocN(total_size, str);
+}
+
+void *MEM_arena_mallocN(size_t len, const char *str)
+{
+  MemHead *memh;
+
+  len = SIZET_ALIGN_4(len);
+
+  memh = arena_memh_alloc(len, false);
+
+  if (LIKELY(memh)) {
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)mem_in_use);
+  return NULL;
+}
+
+void *MEM_arena_malloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Malloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)mem_in_use);
+    abort();
+    return NULL;
+  }
+
+  return MEM_arena_mallocN(total_size, str);
+}
+
+void *MEM_arena_mallocN_aligned(size_t len, size_t alignment, const char *str)
+{
+  /* Huge alignment values doesn't make sense and they wouldn't fit into 'short' used in the
+   * MemHead. */
+  assert(alignment < 1024);
+
+  /* We only support alignments that are a power of two. */
+  assert(IS_POW2(alignment));
+
+  /* Some OS specific aligned allocators require a certain minimal alignment. */
+  if (alignment < ALIGNED_MALLOC_MINIMUM_ALIGNMENT) {
+    alignment = ALIGNED_MALLOC_MINIMUM_ALIGNMENT;
+  }
+
+  /* It's possible that MemHead's size is not properly aligned,
+   * do extra padding to deal with this.
+   *
+   * We only support small alignments which fits into short in
+   * order to save some bits in MemHead structure.
+   */
+  size_t extra_padding = MEMHEAD_ALIGN_PADDING(alignment);
+
+  len = SIZET_ALIGN_4(len);
+
+  MemHeadAligned *memh = (MemHeadAligned *)aligned_malloc(
+      len + extra_padding + sizeof(MemHeadAligned), alignment);
+
+  if (LIKELY(memh)) {
+    /* We keep padding in the beginning of MemHead,
+     * this way it's always possible to get MemHead
+     * from the data pointer.
+     */
+    memh = (MemHeadAligned *)((char *)memh + extra_padding);
+
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+
+    memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
+    memh->alignment = (short)alignment;
+
+    ArenaThread *thread = arena_thread_get();
+    if (thread) {
+      arena_account(thread, (int64_t)len, 1);
+    }
+    else {
+      atomic_add_and_fetch_u(&totblock, 1);
+      atomic_add_and_fetch_z(&mem_in_use, len);
+    }
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)mem_in_use);
+  return NULL;
+}
+
+void MEM_arena_printmemlist_pydict(void)
+{
+}
+
+void MEM_arena_printmemlist(void)
+{
+}
+
+/* unused */
+void MEM_arena_callbackmemlist(void (*func)(void *))
+{
+  (void)func; /* Ignored. */
+}
+
+void MEM_arena_printmemlist_stats(void)
+{
+  unsigned int threads_num = 0;
+  size_t cached_len = 0;
+  pthread_mutex_lock(&arena_threads_mutex);
+  for (ArenaThread *thread = arena_threads; thread; thread = thread->next) {
+    threads_num++;
+    for (size_t i = 0; i < ARENA_CLASS_NUM; i++) {
+      cached_len += thread->free_lists[i].len * arena_class_block_size(i);
+    }
+  }
+  pthread_mutex_unlock(&arena_threads_mutex);
+
+  printf("\ntotal memory len: %.3f MB\n",
+         (double)MEM_arena_get_memory_in_use() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n", (double)peak_mem / (double)(1024 * 1024));
+  printf("arena threads: %u, cached in thread free lists: %.3f MB\n",
+         threads_num,
+         (double)cached_len / (double)(1024 * 1024));
+  printf(
+      "\nFor more detailed per-block statistics run Blender with memory debugging command line "
+      "argument.\n");
+
+#ifdef HAVE_MALLOC_STATS
+  printf("System Statistics:\n");
+  malloc_stats();
+#endif
+}
+
+void MEM_arena_set_error_callback(void (*func)(const char *))
+{
+  error_callback = func;
+}
+
+bool MEM_arena_consistency_check(void)
+{
+  return true;
+}
+
+void MEM_arena_set_memory_debug(void)
+{
+  malloc_debug_memset = true;
+}
+
+size_t MEM_arena_get_memory_in_use(void)
+{
+  int64_t pending = 0;
+  pthread_mutex_lock(&arena_threads_mutex);
+  for (ArenaThread *thread = arena_threads; thread; thread = thread->next) {
+    pending += thread->mem_in_use_pending;
+  }
+  pthread_mutex_unlock(&arena_threads_mutex);
+  return mem_in_use + (size_t)pending;
+}
+
+unsigned int MEM_arena_get_memory_blocks_in_use(void)
+{
+  int64_t pending = 0;
+  pthread_mutex_lock(&arena_threads_mutex);
+  for (ArenaThread *thread = arena_threads; thread; thread = thread->next) {
+    pending += thread->totblock_pending;
+  }
+  pthread_mutex_unlock(&arena_threads_mutex);
+  return totblock + (unsigned int)pending;
+}
+
+void MEM_arena_reset_peak_memory(void)
+{
+  peak_mem = MEM_arena_get_memory_in_use();
+}
+
+size_t MEM_arena_get_peak_memory(void)
+{
+  const size_t mem = MEM_arena_get_memory_in_use();
+  return (mem > peak_mem) ? mem : peak_mem;
+}
+
+#ifndef NDEBUG
+const char *MEM_arena_name_ptr(void *vmemh)
+{
+  if (vmemh) {
+    return "unknown block name ptr";
+  }
+
+  return "MEM_arena_name_ptr(NULL)";
+}
+#endif /* NDEBUG */
+
+/** \} */
@@ -176,6 +176,50 @@ size_t MEM_guarded_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
 const char *MEM_guarded_name_ptr(void *vmemh);
 #endif
 
+/* Prototypes for the allocator with per-thread arenas */
+size_t MEM_arena_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
+void MEM_arena_freeN(void *vmemh);
+void *MEM_arena_dupallocN(const void *vmemh) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void *MEM_arena_reallocN_id(void *vmemh,
+                            size_t len,
+                            const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_arena_recallocN_id(void *vmemh,
+                             size_t len,
+                             const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_arena_callocN(size_t len, const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_arena_calloc_arrayN(size_t len,
+                              size_t size,
+                              const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_arena_mallocN(size_t len, const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_arena_malloc_arrayN(size_t len,
+                              size_t size,
+                              const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_arena_mallocN_aligned(size_t len,
+                                size_t alignment,
+                                const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
+void MEM_arena_printmemlist_pydict(void);
+void MEM_arena_printmemlist(void);
+void MEM_arena_callbackmemlist(void (*func)(void *));
+void MEM_arena_printmemlist_stats(void);
+void MEM_arena_set_error_callback(void (*func)(const char *));
+bool MEM_arena_consistency_check(void);
+void MEM_arena_set_memory_debug(void);
+size_t MEM_arena_get_memory_in_use(void);
+unsigned int MEM_arena_get_memory_blocks_in_use(void);
+void MEM_arena_reset_peak_memory(void);
+size_t MEM_arena_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+#ifndef NDEBUG
+const char *MEM_arena_name_ptr(void *vmemh);
+#endif
+void MEM_arena_init(void);
+
 #ifdef __cplusplus
 }
 #endif
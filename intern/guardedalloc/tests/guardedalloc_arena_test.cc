@@ -0,0 +1,101 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "guardedalloc_test_base.h"
+
+TEST_F(ArenaAllocatorTest, SizesAndAccounting)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+  /* Cover all size classes and the sizes above them. */
+  std::vector<char *> blocks;
+  size_t total_len = 0;
+  for (size_t len = 0; len < 2000; len += 4) {
+    char *block = (char *)MEM_mallocN(len, __func__);
+    EXPECT_EQ(MEM_allocN_len(block), len);
+    memset(block, int(len % 256), len);
+    blocks.push_back(block);
+    total_len += len;
+  }
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use + total_len);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use + blocks.size());
+
+  for (char *block : blocks) {
+    const size_t len = MEM_allocN_len(block);
+    for (size_t i = 0; i < len; i++) {
+      EXPECT_EQ(block[i], char(len % 256));
+    }
+    MEM_freeN(block);
+  }
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+}
+
+TEST_F(ArenaAllocatorTest, CallocAndRealloc)
+{
+  /* Reuse a freed block, so #MEM_callocN has to clear it. */
+  void *block = MEM_mallocN(64, __func__);
+  memset(block, 255, 64);
+  MEM_freeN(block);
+
+  char *zeroed = (char *)MEM_callocN(64, __func__);
+  for (int i = 0; i < 64; i++) {
+    EXPECT_EQ(zeroed[i], 0);
+  }
+  zeroed[0] = 42;
+  zeroed = (char *)MEM_reallocN(zeroed, 4000);
+  EXPECT_EQ(zeroed[0], 42);
+  zeroed = (char *)MEM_recallocN(zeroed, 8);
+  EXPECT_EQ(zeroed[0], 42);
+  EXPECT_EQ(MEM_allocN_len(zeroed), size_t(8));
+  MEM_freeN(zeroed);
+}
+
+TEST_F(ArenaAllocatorTest, FreeOnOtherThread)
+{
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  const unsigned int blocks_in_use = MEM_get_memory_blocks_in_use();
+
+  const int threads_num = 8;
+  const int blocks_per_thread = 10000;
+  std::vector<std::vector<void *>> thread_blocks(threads_num);
+
+  /* Allocate on every thread, then free everything on different threads than it was allocated
+   * on. This moves blocks between the thread free lists through the central lists. */
+  std::vector<std::thread> threads;
+  for (int thread_i = 0; thread_i < threads_num; thread_i++) {
+    threads.emplace_back([&, thread_i]() {
+      for (int i = 0; i < blocks_per_thread; i++) {
+        thread_blocks[thread_i].push_back(MEM_mallocN(size_t(i % 300), __func__));
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use + threads_num * blocks_per_thread);
+
+  for (int thread_i = 0; thread_i < threads_num; thread_i++) {
+    threads.emplace_back([&, thread_i]() {
+      for (void *block : thread_blocks[(thread_i + 1) % threads_num]) {
+        MEM_freeN(block);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(MEM_get_memory_in_use(), mem_in_use);
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), blocks_in_use);
+}
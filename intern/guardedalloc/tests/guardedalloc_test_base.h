@@ -23,4 +23,12 @@ class GuardedAllocatorTest : public ::testing::Test {
   }
 };
 
+class ArenaAllocatorTest : public ::testing::Test {
+ protected:
+  virtual void SetUp()
+  {
+    MEM_use_arena_allocator();
+  }
+};
+
 #endif  // __GUARDEDALLOC_TEST_UTIL_H__
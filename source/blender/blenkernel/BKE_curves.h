@@ -30,6 +30,10 @@ bool BKE_curves_customdata_required(struct Curves *curves, struct CustomDataLaye
 /* Depsgraph */
 
 struct Curves *BKE_curves_copy_for_eval(struct Curves *curves_src, bool reference);
+/**
+ * Copy for evaluation, sharing the custom data layers with the source (see #CD_SHARE).
+ */
+struct Curves *BKE_curves_copy_for_eval_shared(const struct Curves *curves_src);
 
 void BKE_curves_data_update(struct Depsgraph *depsgraph,
                             struct Scene *scene,
@@ -57,6 +57,14 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /**
+   * Share the data of all layers with the source, only allowed if source has same number of
+   * elements. The data is freed when the last layer using it is freed. Shared layers are
+   * handled like referenced layers: they must be made mutable with
+   * #CustomData_duplicate_referenced_layer before they are changed, which copies the data only
+   * when it is still used elsewhere. Referenced source layers are duplicated instead.
+   */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -97,7 +105,7 @@ bool CustomData_has_interp(const struct CustomData *data);
 bool CustomData_bmesh_has_free(const struct CustomData *data);
 
 /**
- * Checks if any of the custom-data layers is referenced.
+ * Checks if any of the custom-data layers is referenced, or shares its data with other layers.
  */
 bool CustomData_has_referenced(const struct CustomData *data);
 
@@ -247,7 +255,8 @@ int CustomData_number_of_layers(const struct CustomData *data, int type);
 int CustomData_number_of_layers_typemask(const struct CustomData *data, CustomDataMask mask);
 
 /**
- * Duplicate data of a layer with flag NOFREE, and remove that flag.
+ * Duplicate data of a layer with flag NOFREE, and remove that flag. Data of a layer that is
+ * shared with other layers (see #CD_SHARE) is duplicated as well, unless this is its last user.
  * \return the layer data.
  */
 void *CustomData_duplicate_referenced_layer(struct CustomData *data, int type, int totelem);
@@ -262,9 +271,15 @@ void *CustomData_duplicate_referenced_layer_named(struct CustomData *data,
 void *CustomData_duplicate_referenced_layer_anonymous(
     CustomData *data, int type, const struct AnonymousAttributeID *anonymous_id, int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
+/**
+ * True when the data of the active layer of this type is shared with other layers (see
+ * #CD_SHARE), so it is copied when it is made mutable.
+ */
+bool CustomData_is_shared_layer(const struct CustomData *data, int type);
 
 /**
  * Duplicate all the layers with flag NOFREE, and remove the flag from duplicated layers.
+ * Shared layers are made mutable as well.
  */
 void CustomData_duplicate_referenced_layers(CustomData *data, int totelem);
 
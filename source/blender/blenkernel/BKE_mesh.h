@@ -151,6 +151,12 @@ void BKE_mesh_eval_delete(struct Mesh *mesh_eval);
  * optional referencing original arrays to reduce memory.
  */
 struct Mesh *BKE_mesh_copy_for_eval(const struct Mesh *source, bool reference);
+/**
+ * Performs copy for use during evaluation, sharing the custom data layers with the source (see
+ * #CD_SHARE). Unlike referencing, the source can be freed before the copy. Shared layers have to
+ * be made mutable with #CustomData_duplicate_referenced_layer before they are changed.
+ */
+struct Mesh *BKE_mesh_copy_for_eval_shared(const struct Mesh *source);
 
 /**
  * These functions construct a new Mesh,
@@ -38,6 +38,10 @@ bool BKE_pointcloud_customdata_required(struct PointCloud *pointcloud,
 struct PointCloud *BKE_pointcloud_new_for_eval(const struct PointCloud *pointcloud_src,
                                                int totpoint);
 struct PointCloud *BKE_pointcloud_copy_for_eval(struct PointCloud *pointcloud_src, bool reference);
+/**
+ * Copy for evaluation, sharing the custom data layers with the source (see #CD_SHARE).
+ */
+struct PointCloud *BKE_pointcloud_copy_for_eval_shared(const struct PointCloud *pointcloud_src);
 
 void BKE_pointcloud_data_update(struct Depsgraph *depsgraph,
                                 struct Scene *scene,
@@ -81,7 +81,9 @@ static void curves_copy_data(Main *UNUSED(bmain), ID *id_dst, const ID *id_src,
   dst.point_size = src.point_size;
   dst.curve_size = src.curve_size;
 
-  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_REFERENCE : CD_DUPLICATE;
+  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_REFERENCE :
+                                  (flag & LIB_ID_COPY_CD_SHARE)     ? CD_SHARE :
+                                                                      CD_DUPLICATE;
   CustomData_copy(&src.point_data, &dst.point_data, CD_MASK_ALL, alloc_type, dst.point_size);
   CustomData_copy(&src.curve_data, &dst.curve_data, CD_MASK_ALL, alloc_type, dst.curve_size);
 
@@ -288,6 +290,12 @@ Curves *BKE_curves_copy_for_eval(Curves *curves_src, bool reference)
   return result;
 }
 
+Curves *BKE_curves_copy_for_eval_shared(const Curves *curves_src)
+{
+  return (Curves *)BKE_id_copy_ex(
+      nullptr, &curves_src->id, nullptr, LIB_ID_COPY_LOCALIZE | LIB_ID_COPY_CD_SHARE);
+}
+
 static void curves_evaluate_modifiers(struct Depsgraph *depsgraph,
                                       struct Scene *scene,
                                       Object *object,
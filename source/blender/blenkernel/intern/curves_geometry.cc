@@ -76,8 +76,9 @@ static void copy_curves_geometry(CurvesGeometry &dst, const CurvesGeometry &src)
   CustomData_free(&dst.curve_data, dst.curve_size);
   dst.point_size = src.point_size;
   dst.curve_size = src.curve_size;
-  CustomData_copy(&src.point_data, &dst.point_data, CD_MASK_ALL, CD_DUPLICATE, dst.point_size);
-  CustomData_copy(&src.curve_data, &dst.curve_data, CD_MASK_ALL, CD_DUPLICATE, dst.curve_size);
+  /* The layers are only copied when they are changed, see #get_mutable_attribute. */
+  CustomData_copy(&src.point_data, &dst.point_data, CD_MASK_ALL, CD_SHARE, dst.point_size);
+  CustomData_copy(&src.curve_data, &dst.curve_data, CD_MASK_ALL, CD_SHARE, dst.curve_size);
 
   MEM_SAFE_FREE(dst.curve_offsets);
   dst.curve_offsets = (int *)MEM_calloc_arrayN(dst.point_size + 1, sizeof(int), __func__);
@@ -218,6 +219,8 @@ static MutableSpan<T> get_mutable_attribute(CurvesGeometry &curves,
   T *data = (T *)CustomData_duplicate_referenced_layer_named(
       &custom_data, type, name.c_str(), size);
   if (data != nullptr) {
+    /* The layer data may have been copied. */
+    curves.update_customdata_pointers();
     return {data, size};
   }
   data = (T *)CustomData_add_layer_named(
@@ -1249,6 +1252,7 @@ static bool layer_matches_name_and_type(const CustomDataLayer &layer,
 void CurvesGeometry::reverse_curves(const IndexMask curves_to_reverse)
 {
   CustomData_duplicate_referenced_layers(&this->point_data, this->points_num());
+  this->update_customdata_pointers();
 
   /* Collect the Bezier handle attributes while iterating through the point custom data layers;
    * they need special treatment later. */
@@ -8,6 +8,8 @@
  * BKE_customdata.h contains the function prototypes for this file.
  */
 
+#include <atomic>
+
 #include "MEM_guardedalloc.h"
 
 /* Since we have versioning code here (CustomData_verify_versions()). */
@@ -51,6 +53,8 @@
 
 #include "CLG_log.h"
 
+#include "atomic_ops.h"
+
 /* only for customdata_data_transfer_interp_normal_normals */
 #include "data_transfer_intern.h"
 
@@ -2194,6 +2198,115 @@ void customData_mask_layers__print(const CustomData_MeshMasks *mask)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Layer Data Sharing
+ *
+ * Layers copied with #CD_SHARE use the same data as their source, so copying a whole
+ * #CustomData only costs a user count increment per layer. The data is owned by a
+ * #CustomDataLayerSharing, and freed together with the last layer using it. Before a shared layer
+ * is changed it has to be made mutable, which copies the data only when it still has other users.
+ * \{ */
+
+struct CustomDataLayerSharing {
+  /** Number of layers using #data. */
+  std::atomic<int> users;
+  /** Layer type and number of elements, needed to free the data. */
+  int type;
+  int totelem;
+  void *data;
+};
+
+/**
+ * Get the sharing info of a layer that owns its data, adding it when the layer does not have one
+ * yet. The layer is the source of a copy, which is done on multiple threads at the same time in
+ * some cases, so the sharing info is added atomically.
+ */
+static CustomDataLayerSharing *customData_layer_sharing_ensure(const CustomDataLayer *layer,
+                                                               const int totelem)
+{
+  BLI_assert(!(layer->flag & CD_FLAG_NOFREE) && layer->data != nullptr);
+  CustomDataLayerSharing *sharing_info = layer->sharing_info;
+  if (sharing_info != nullptr) {
+    return sharing_info;
+  }
+
+  CustomDataLayerSharing *new_sharing_info = MEM_new<CustomDataLayerSharing>(__func__);
+  new_sharing_info->users = 1;
+  new_sharing_info->type = layer->type;
+  new_sharing_info->totelem = totelem;
+  new_sharing_info->data = layer->data;
+
+  /* The sharing info is run-time data, so it can be added to a layer of a const #CustomData. */
+  CustomDataLayer *mutable_layer = const_cast<CustomDataLayer *>(layer);
+  sharing_info = static_cast<CustomDataLayerSharing *>(atomic_cas_ptr(
+      (void **)&mutable_layer->sharing_info, nullptr, new_sharing_info));
+  if (sharing_info != nullptr) {
+    /* Another thread was faster. */
+    MEM_delete(new_sharing_info);
+    return sharing_info;
+  }
+  return new_sharing_info;
+}
+
+static void customData_layer_sharing_add_user(CustomDataLayerSharing *sharing_info)
+{
+  sharing_info->users.fetch_add(1);
+}
+
+/**
+ * Remove a user of the shared data, the data is freed when this was the last user.
+ */
+static void customData_layer_sharing_remove_user(CustomDataLayerSharing *sharing_info)
+{
+  if (sharing_info->users.fetch_sub(1) > 1) {
+    return;
+  }
+  const LayerTypeInfo *typeInfo = layerType_getInfo(sharing_info->type);
+  if (typeInfo->free) {
+    typeInfo->free(sharing_info->data, sharing_info->totelem, typeInfo->size);
+  }
+  MEM_freeN(sharing_info->data);
+  MEM_delete(sharing_info);
+}
+
+static bool customData_layer_is_shared(const CustomDataLayer *layer)
+{
+  return layer->sharing_info != nullptr && layer->sharing_info->users > 1;
+}
+
+/**
+ * Make the layer the only owner of its data again, copying the data when it has other users.
+ */
+static void customData_layer_sharing_ensure_mutable(CustomDataLayer *layer, const int totelem)
+{
+  CustomDataLayerSharing *sharing_info = layer->sharing_info;
+  if (sharing_info == nullptr) {
+    return;
+  }
+  layer->sharing_info = nullptr;
+
+  if (sharing_info->users == 1) {
+    /* Other users have been freed already, no one else can add a user while this layer is
+     * changed, so the data can just be taken over. */
+    MEM_delete(sharing_info);
+    return;
+  }
+
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+  void *new_data = MEM_malloc_arrayN(
+      (size_t)totelem, typeInfo->size, layerType_getName(layer->type));
+  if (typeInfo->copy) {
+    typeInfo->copy(layer->data, new_data, totelem);
+  }
+  else {
+    memcpy(new_data, layer->data, (size_t)totelem * typeInfo->size);
+  }
+  layer->data = new_data;
+  customData_layer_sharing_remove_user(sharing_info);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name CustomData Functions
  * \{ */
@@ -2284,6 +2397,7 @@ bool CustomData_merge(const struct CustomData *source,
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -2295,8 +2409,28 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if (alloctype == CD_SHARE) {
+      if ((flag & CD_FLAG_NOFREE) || data == nullptr) {
+        /* Referenced data may be freed before the new layer, so it can't be shared. */
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_DUPLICATE, data, totelem, layer->name);
+      }
+      else {
+        CustomDataLayerSharing *sharing_info = customData_layer_sharing_ensure(layer, totelem);
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_ASSIGN, data, totelem, layer->name);
+        if (newlayer && newlayer->data == data && newlayer->sharing_info == nullptr) {
+          customData_layer_sharing_add_user(sharing_info);
+          newlayer->sharing_info = sharing_info;
+        }
+      }
+    }
     else {
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
+      if (alloctype == CD_ASSIGN && newlayer && newlayer->data == data) {
+        /* The new layer takes over the user of the source layer as well. */
+        newlayer->sharing_info = layer->sharing_info;
+      }
     }
 
     if (newlayer) {
@@ -2330,6 +2464,27 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (customData_layer_is_shared(layer)) {
+      /* Copy the elements that are kept, the old data is still used elsewhere. */
+      const int old_totelem = layer->sharing_info->totelem;
+      void *new_data = MEM_calloc_arrayN(
+          (size_t)totelem, typeInfo->size, layerType_getName(layer->type));
+      CustomDataLayerSharing *sharing_info = layer->sharing_info;
+      if (typeInfo->copy) {
+        typeInfo->copy(layer->data, new_data, min_ii(old_totelem, totelem));
+      }
+      else {
+        memcpy(new_data, layer->data, (size_t)min_ii(old_totelem, totelem) * typeInfo->size);
+      }
+      layer->data = new_data;
+      layer->sharing_info = nullptr;
+      customData_layer_sharing_remove_user(sharing_info);
+      continue;
+    }
+    if (layer->sharing_info != nullptr) {
+      MEM_delete(layer->sharing_info);
+      layer->sharing_info = nullptr;
+    }
     /* Use calloc to avoid the need to manually initialize new data in layers.
      * Useful for types like #MDeformVert which contain a pointer. */
     layer->data = MEM_recallocN(layer->data, (size_t)totelem * typeInfo->size);
@@ -2359,7 +2514,11 @@ static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
     BKE_anonymous_attribute_id_decrement_weak(layer->anonymous_id);
     layer->anonymous_id = nullptr;
   }
-  if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+  if (layer->sharing_info != nullptr) {
+    customData_layer_sharing_remove_user(layer->sharing_info);
+    layer->sharing_info = nullptr;
+  }
+  else if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
     typeInfo = layerType_getInfo(layer->type);
 
     if (typeInfo->free) {
@@ -2961,6 +3120,9 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
 
     layer->flag &= ~CD_FLAG_NOFREE;
   }
+  else {
+    customData_layer_sharing_ensure_mutable(layer, totelem);
+  }
 
   return layer->data;
 }
@@ -3030,6 +3192,17 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
   return (layer->flag & CD_FLAG_NOFREE) != 0;
 }
 
+bool CustomData_is_shared_layer(const struct CustomData *data, int type)
+{
+  /* get the layer index of the first layer of type */
+  int layer_index = CustomData_get_active_layer_index(data, type);
+  if (layer_index == -1) {
+    return false;
+  }
+
+  return customData_layer_is_shared(&data->layers[layer_index]);
+}
+
 void CustomData_free_temporary(CustomData *data, int totelem)
 {
   int i, j;
@@ -3449,7 +3622,13 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return nullptr;
   }
 
-  data->layers[layer_index].data = ptr;
+  CustomDataLayer *layer = &data->layers[layer_index];
+  if (layer->sharing_info != nullptr) {
+    /* The new data is owned by the layer, the shared data is still used elsewhere. */
+    customData_layer_sharing_remove_user(layer->sharing_info);
+    layer->sharing_info = nullptr;
+  }
+  layer->data = ptr;
 
   return ptr;
 }
@@ -3462,7 +3641,13 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return nullptr;
   }
 
-  data->layers[layer_index].data = ptr;
+  CustomDataLayer *layer = &data->layers[layer_index];
+  if (layer->sharing_info != nullptr) {
+    /* The new data is owned by the layer, the shared data is still used elsewhere. */
+    customData_layer_sharing_remove_user(layer->sharing_info);
+    layer->sharing_info = nullptr;
+  }
+  layer->data = ptr;
 
   return ptr;
 }
@@ -4034,7 +4219,8 @@ bool CustomData_has_interp(const struct CustomData *data)
 bool CustomData_has_referenced(const struct CustomData *data)
 {
   for (int i = 0; i < data->totlayer; i++) {
-    if (data->layers[i].flag & CD_FLAG_NOFREE) {
+    /* Shared data is still used by other layers, which taking ownership of it would change. */
+    if ((data->layers[i].flag & CD_FLAG_NOFREE) || customData_layer_is_shared(&data->layers[i])) {
       return true;
     }
   }
@@ -5322,6 +5508,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing_info = nullptr;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
@@ -0,0 +1,194 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_deform.h"
+
+#include "BLI_index_range.hh"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+static CustomData create_float_custom_data(const int size)
+{
+  CustomData data;
+  CustomData_reset(&data);
+  float *values = (float *)CustomData_add_layer(&data, CD_PROP_FLOAT, CD_CALLOC, nullptr, size);
+  for (const int i : IndexRange(size)) {
+    values[i] = float(i);
+  }
+  return data;
+}
+
+TEST(customdata, ShareCopy)
+{
+  CustomData src = create_float_custom_data(10);
+  EXPECT_FALSE(CustomData_is_shared_layer(&src, CD_PROP_FLOAT));
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_SHARE, 10);
+  EXPECT_EQ(CustomData_get_layer(&src, CD_PROP_FLOAT), CustomData_get_layer(&dst, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_shared_layer(&src, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_is_shared_layer(&dst, CD_PROP_FLOAT));
+
+  /* Making the layer mutable copies it, the source keeps its data. */
+  const float *src_values = (const float *)CustomData_get_layer(&src, CD_PROP_FLOAT);
+  float *dst_values = (float *)CustomData_duplicate_referenced_layer(&dst, CD_PROP_FLOAT, 10);
+  EXPECT_NE(src_values, dst_values);
+  EXPECT_EQ(CustomData_get_layer(&src, CD_PROP_FLOAT), src_values);
+  EXPECT_FALSE(CustomData_is_shared_layer(&src, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_is_shared_layer(&dst, CD_PROP_FLOAT));
+
+  dst_values[3] = -1.0f;
+  EXPECT_EQ(src_values[3], 3.0f);
+  EXPECT_EQ(dst_values[4], 4.0f);
+
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, ShareCopyOutlivesSource)
+{
+  CustomData src = create_float_custom_data(10);
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_SHARE, 10);
+  const void *shared_values = CustomData_get_layer(&dst, CD_PROP_FLOAT);
+  CustomData_free(&src, 10);
+
+  /* The last user takes over the data without copying it. */
+  EXPECT_FALSE(CustomData_is_shared_layer(&dst, CD_PROP_FLOAT));
+  const float *dst_values = (const float *)CustomData_duplicate_referenced_layer(
+      &dst, CD_PROP_FLOAT, 10);
+  EXPECT_EQ(dst_values, shared_values);
+  EXPECT_EQ(dst_values[9], 9.0f);
+
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, ShareCopyChain)
+{
+  CustomData a = create_float_custom_data(10);
+  CustomData b;
+  CustomData c;
+  CustomData_copy(&a, &b, CD_MASK_ALL, CD_SHARE, 10);
+  CustomData_copy(&b, &c, CD_MASK_ALL, CD_SHARE, 10);
+  EXPECT_EQ(CustomData_get_layer(&a, CD_PROP_FLOAT), CustomData_get_layer(&c, CD_PROP_FLOAT));
+
+  CustomData_free(&b, 10);
+  EXPECT_TRUE(CustomData_is_shared_layer(&a, CD_PROP_FLOAT));
+  CustomData_free(&a, 10);
+  EXPECT_FALSE(CustomData_is_shared_layer(&c, CD_PROP_FLOAT));
+  EXPECT_EQ(((const float *)CustomData_get_layer(&c, CD_PROP_FLOAT))[5], 5.0f);
+  CustomData_free(&c, 10);
+}
+
+TEST(customdata, ShareReferencedLayer)
+{
+  CustomData src = create_float_custom_data(10);
+  CustomData reference;
+  CustomData_copy(&src, &reference, CD_MASK_ALL, CD_REFERENCE, 10);
+
+  /* Referenced data may be freed before the copy, so it is duplicated. */
+  CustomData dst;
+  CustomData_copy(&reference, &dst, CD_MASK_ALL, CD_SHARE, 10);
+  EXPECT_NE(CustomData_get_layer(&dst, CD_PROP_FLOAT), CustomData_get_layer(&src, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_is_shared_layer(&src, CD_PROP_FLOAT));
+
+  CustomData_free(&reference, 10);
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, ShareRealloc)
+{
+  CustomData src = create_float_custom_data(10);
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_SHARE, 10);
+
+  CustomData_realloc(&dst, 20);
+  const float *src_values = (const float *)CustomData_get_layer(&src, CD_PROP_FLOAT);
+  const float *dst_values = (const float *)CustomData_get_layer(&dst, CD_PROP_FLOAT);
+  EXPECT_NE(src_values, dst_values);
+  EXPECT_EQ(dst_values[9], 9.0f);
+  EXPECT_EQ(dst_values[19], 0.0f);
+  EXPECT_FALSE(CustomData_is_shared_layer(&src, CD_PROP_FLOAT));
+
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 20);
+}
+
+TEST(customdata, ShareDeformVerts)
+{
+  const int size = 4;
+  CustomData src;
+  CustomData_reset(&src);
+  MDeformVert *dverts = (MDeformVert *)CustomData_add_layer(
+      &src, CD_MDEFORMVERT, CD_CALLOC, nullptr, size);
+  for (const int i : IndexRange(size)) {
+    BKE_defvert_add_index_notest(&dverts[i], i, 0.5f);
+  }
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_SHARE, size);
+  MDeformVert *dst_dverts = (MDeformVert *)CustomData_duplicate_referenced_layer(
+      &dst, CD_MDEFORMVERT, size);
+  /* The weights are copied with the layer, so they can be changed separately. */
+  EXPECT_NE(dst_dverts[2].dw, dverts[2].dw);
+  dst_dverts[2].dw[0].weight = 1.0f;
+  EXPECT_EQ(dverts[2].dw[0].weight, 0.5f);
+
+  CustomData_free(&src, size);
+  CustomData_free(&dst, size);
+}
+
+TEST(customdata, ShareHasReferenced)
+{
+  CustomData src = create_float_custom_data(10);
+  EXPECT_FALSE(CustomData_has_referenced(&src));
+
+  /* Taking ownership of shared data would change it for the other users too. */
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_SHARE, 10);
+  EXPECT_TRUE(CustomData_has_referenced(&src));
+  EXPECT_TRUE(CustomData_has_referenced(&dst));
+
+  CustomData_free(&src, 10);
+  EXPECT_FALSE(CustomData_has_referenced(&dst));
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, ShareCopyMemory)
+{
+  const int size = 100000;
+  CustomData src;
+  CustomData_reset(&src);
+  CustomData_add_layer(&src, CD_MVERT, CD_CALLOC, nullptr, size);
+  CustomData_add_layer(&src, CD_PROP_FLOAT, CD_CALLOC, nullptr, size);
+  CustomData_add_layer(&src, CD_MDEFORMVERT, CD_CALLOC, nullptr, size);
+  const size_t layers_size = size_t(size) * (sizeof(MVert) + sizeof(float) + sizeof(MDeformVert));
+
+  CustomData dst_duplicate;
+  CustomData dst_share;
+  const size_t mem_in_use = MEM_get_memory_in_use();
+  CustomData_copy(&src, &dst_duplicate, CD_MASK_ALL, CD_DUPLICATE, size);
+  EXPECT_GE(MEM_get_memory_in_use() - mem_in_use, layers_size);
+  const size_t mem_in_use_duplicate = MEM_get_memory_in_use();
+  CustomData_copy(&src, &dst_share, CD_MASK_ALL, CD_SHARE, size);
+  /* Only the layer array and the user counts are allocated. */
+  EXPECT_LT(MEM_get_memory_in_use() - mem_in_use_duplicate, size_t(4096));
+
+  CustomData_free(&dst_duplicate, size);
+  CustomData_free(&dst_share, size);
+  CustomData_free(&src, size);
+}
+
+}  // namespace blender::bke::tests
@@ -1556,7 +1556,9 @@ void BKE_mesh_nomain_to_mesh(Mesh *mesh_src,
   /* NOTE(nazgul): maybe some other layers should be copied? */
   if (CustomData_has_layer(&mesh_dst->ldata, CD_MDISPS)) {
     if (totloop == mesh_dst->totloop) {
-      MDisps *mdisps = (MDisps *)CustomData_get_layer(&mesh_dst->ldata, CD_MDISPS);
+      /* Make sure the data isn't shared, when its ownership is transferred below. */
+      MDisps *mdisps = (MDisps *)CustomData_duplicate_referenced_layer(
+          &mesh_dst->ldata, CD_MDISPS, totloop);
       CustomData_add_layer(&tmp.ldata, CD_MDISPS, alloctype, mdisps, totloop);
       if (alloctype == CD_ASSIGN) {
         /* Assign nullptr to prevent double-free. */
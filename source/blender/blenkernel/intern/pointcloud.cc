@@ -75,7 +75,9 @@ static void pointcloud_copy_data(Main *UNUSED(bmain), ID *id_dst, const ID *id_s
   const PointCloud *pointcloud_src = (const PointCloud *)id_src;
   pointcloud_dst->mat = static_cast<Material **>(MEM_dupallocN(pointcloud_src->mat));
 
-  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_REFERENCE : CD_DUPLICATE;
+  const eCDAllocType alloc_type = (flag & LIB_ID_COPY_CD_REFERENCE) ? CD_REFERENCE :
+                                  (flag & LIB_ID_COPY_CD_SHARE)     ? CD_SHARE :
+                                                                      CD_DUPLICATE;
   CustomData_copy(&pointcloud_src->pdata,
                   &pointcloud_dst->pdata,
                   CD_MASK_ALL,
@@ -351,6 +353,12 @@ PointCloud *BKE_pointcloud_copy_for_eval(struct PointCloud *pointcloud_src, bool
   return result;
 }
 
+PointCloud *BKE_pointcloud_copy_for_eval_shared(const PointCloud *pointcloud_src)
+{
+  return (PointCloud *)BKE_id_copy_ex(
+      nullptr, &pointcloud_src->id, nullptr, LIB_ID_COPY_LOCALIZE | LIB_ID_COPY_CD_SHARE);
+}
+
 static void pointcloud_evaluate_modifiers(struct Depsgraph *depsgraph,
                                           struct Scene *scene,
                                           Object *object,
@@ -957,8 +957,9 @@ void BKE_undosys_print(UndoStack *ustack)
   printf("Undo %d Steps (*: active, #=applied, M=memfile-active, S=skip)\n",
          BLI_listbase_count(&ustack->steps));
   int index = 0;
+  size_t data_size_total = 0;
   LISTBASE_FOREACH (UndoStep *, us, &ustack->steps) {
-    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s'\n",
+    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s', size=%.2f MiB\n",
            (us == ustack->step_active) ? '*' : ' ',
            us->is_applied ? '#' : ' ',
            (us == ustack->step_active_memfile) ? 'M' : ' ',
@@ -966,9 +967,12 @@ void BKE_undosys_print(UndoStack *ustack)
            index,
            (void *)us,
            us->type->name,
-           us->name);
+           us->name,
+           (double)us->data_size / (1024.0 * 1024.0));
+    data_size_total += us->data_size;
     index++;
   }
+  printf("Undo total size: %.2f MiB\n", (double)data_size_total / (1024.0 * 1024.0));
 }
 
 /** \} */
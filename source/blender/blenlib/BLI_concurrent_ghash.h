@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * ConcurrentGHash is a thread-safe hash-map with the same callback types as #GHash.
+ *
+ * It is a C wrapper around #blender::ConcurrentMap, see `BLI_concurrent_map.hh`. All functions
+ * can be called from multiple threads at the same time, except for #BLI_concurrent_ghash_free.
+ * Use it instead of a #GHash protected by a single mutex when many threads look up keys.
+ *
+ * Unlike #GHash there is no iterator, because items cannot be visited safely while other threads
+ * change the map. Use #BLI_concurrent_ghash_foreach instead.
+ */
+
+#include "BLI_compiler_attrs.h"
+#include "BLI_ghash.h"
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ConcurrentGHash ConcurrentGHash;
+
+/** Creates the value for a key that is not in the map yet, see #BLI_concurrent_ghash_ensure. */
+typedef void *(*ConcurrentGHashCreateFP)(const void *key, void *user_data);
+typedef void (*ConcurrentGHashForeachFP)(void *key, void *val, void *user_data);
+
+/**
+ * Creates a new, empty ConcurrentGHash.
+ *
+ * \param hashfp: Hash callback.
+ * \param cmpfp: Comparison callback.
+ * \param info: Identifier string for the ConcurrentGHash.
+ */
+ConcurrentGHash *BLI_concurrent_ghash_new(GHashHashFP hashfp,
+                                          GHashCmpFP cmpfp,
+                                          const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+ConcurrentGHash *BLI_concurrent_ghash_ptr_new(const char *info) ATTR_MALLOC
+    ATTR_WARN_UNUSED_RESULT;
+ConcurrentGHash *BLI_concurrent_ghash_str_new(const char *info) ATTR_MALLOC
+    ATTR_WARN_UNUSED_RESULT;
+/**
+ * Frees the ConcurrentGHash and its members. No other thread may access it anymore.
+ *
+ * \param keyfreefp: Optional callback to free the key.
+ * \param valfreefp: Optional callback to free the value.
+ */
+void BLI_concurrent_ghash_free(ConcurrentGHash *cgh,
+                               GHashKeyFreeFP keyfreefp,
+                               GHashValFreeFP valfreefp);
+/**
+ * Remove all members, keeping the ConcurrentGHash itself.
+ */
+void BLI_concurrent_ghash_clear(ConcurrentGHash *cgh,
+                                GHashKeyFreeFP keyfreefp,
+                                GHashValFreeFP valfreefp);
+/**
+ * Insert a key/value pair when the key is not in \a cgh yet.
+ *
+ * \returns true if the key has been added, false if it existed already (nothing is changed).
+ */
+bool BLI_concurrent_ghash_add(ConcurrentGHash *cgh, void *key, void *val);
+/**
+ * Lookup the value of \a key in \a cgh.
+ *
+ * \returns the value for \a key or NULL.
+ */
+void *BLI_concurrent_ghash_lookup(const ConcurrentGHash *cgh,
+                                  const void *key) ATTR_WARN_UNUSED_RESULT;
+/**
+ * Lookup the value of \a key, creating it with \a create_fn when the key is not in \a cgh yet.
+ * When multiple threads ensure the same key at the same time, \a create_fn is only called once
+ * and all threads get the same value.
+ *
+ * \note \a create_fn is called while a lock is held, it must not access \a cgh.
+ * \note \a key is stored in \a cgh when it is added, so it has to stay valid.
+ */
+void *BLI_concurrent_ghash_ensure(ConcurrentGHash *cgh,
+                                  void *key,
+                                  ConcurrentGHashCreateFP create_fn,
+                                  void *user_data);
+/**
+ * Remove \a key from \a cgh.
+ *
+ * \returns true if \a key was in \a cgh.
+ */
+bool BLI_concurrent_ghash_remove(ConcurrentGHash *cgh,
+                                 const void *key,
+                                 GHashKeyFreeFP keyfreefp,
+                                 GHashValFreeFP valfreefp);
+bool BLI_concurrent_ghash_haskey(const ConcurrentGHash *cgh,
+                                 const void *key) ATTR_WARN_UNUSED_RESULT;
+/**
+ * \returns the number of members. Only exact when no other thread changes \a cgh.
+ */
+unsigned int BLI_concurrent_ghash_len(const ConcurrentGHash *cgh) ATTR_WARN_UNUSED_RESULT;
+/**
+ * Call \a fn for every member.
+ *
+ * \note \a fn is called while a lock is held, it must not access \a cgh.
+ */
+void BLI_concurrent_ghash_foreach(const ConcurrentGHash *cgh,
+                                  ConcurrentGHashForeachFP fn,
+                                  void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,292 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A `blender::ConcurrentMap<Key, Value>` is an unordered associative container that can be
+ * accessed from multiple threads at the same time. It is meant to replace the pattern of a single
+ * #GHash or #blender::Map protected by one global mutex, which serializes all threads on that
+ * mutex as soon as lookups become frequent.
+ *
+ * The map is split into `2^ShardBits` shards. Every shard is a regular #blender::Map protected by
+ * its own `std::shared_mutex`. The shard of a key is chosen from the upper bits of its hash, so
+ * threads that access different keys rarely contend on the same lock. Lookups only take a shared
+ * lock, so concurrent readers of the same shard do not block each other either.
+ *
+ * Some noteworthy information:
+ * - Values are returned by copy. References into the map cannot be handed out safely, because
+ *   another thread might grow or modify the shard in the meantime. Use #modify to change a value
+ *   in place while the shard is locked. For large values, store pointers or shared pointers.
+ * - Callbacks passed to #lookup_or_add_cb, #modify and #foreach_item are called while a shard
+ *   lock is held. They must not access the same map again.
+ * - #size and #foreach_item visit one shard after another, so they only give a consistent result
+ *   when no other thread modifies the map at the same time.
+ * - The default of 64 shards is a good fit for up to a few dozen threads. Every shard is aligned
+ *   to a cache line to avoid false sharing between the locks of neighboring shards.
+ */
+
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <utility>
+
+#include "BLI_map.hh"
+
+namespace blender {
+
+template<
+    /** Type of the keys stored in the map. Keys have to be movable and copyable. */
+    typename Key,
+    /** Type of the values stored in the map. Values have to be movable and copyable. */
+    typename Value,
+    /** The map is split into `2^ShardBits` independently locked shards. */
+    int ShardBits = 6,
+    /** The hash function, see BLI_hash.hh. It is used for the shard and for the inner maps. */
+    typename Hash = DefaultHash<Key>,
+    /** The equality operator used to compare keys. */
+    typename IsEqual = DefaultEquality>
+class ConcurrentMap {
+ public:
+  using size_type = int64_t;
+
+  static constexpr int64_t shards_num = int64_t(1) << ShardBits;
+
+ private:
+  static_assert(ShardBits > 0 && ShardBits < 16);
+
+  using ShardMap = Map<Key, Value, 0, DefaultProbingStrategy, Hash, IsEqual>;
+
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex;
+    ShardMap map;
+  };
+
+  Shard shards_[shards_num];
+  Hash hash_;
+
+ public:
+  ConcurrentMap() = default;
+
+  /* Moving or copying would require locking all shards of both maps, which is never needed. */
+  ConcurrentMap(const ConcurrentMap &other) = delete;
+  ConcurrentMap &operator=(const ConcurrentMap &other) = delete;
+
+  /**
+   * Add a key-value-pair to the map. If the key exists already, nothing is changed.
+   * Returns true when the key has been newly added.
+   */
+  bool add(const Key &key, const Value &value)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::unique_lock lock{shard.mutex};
+    return shard.map.add(key, value);
+  }
+  bool add(Key &&key, Value &&value)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::unique_lock lock{shard.mutex};
+    return shard.map.add(std::move(key), std::move(value));
+  }
+
+  /**
+   * Add a key-value-pair to the map. If the key exists already, the value is overwritten.
+   * Returns true when the key has been newly added.
+   */
+  bool add_overwrite(const Key &key, const Value &value)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::unique_lock lock{shard.mutex};
+    return shard.map.add_overwrite(key, value);
+  }
+
+  /**
+   * Returns true when the key is in the map.
+   */
+  bool contains(const Key &key) const
+  {
+    const Shard &shard = this->shard_for_key(key);
+    std::shared_lock lock{shard.mutex};
+    return shard.map.contains(key);
+  }
+
+  /**
+   * Returns a copy of the value that corresponds to the given key, or nothing when the key is not
+   * in the map.
+   */
+  std::optional<Value> lookup_try(const Key &key) const
+  {
+    const Shard &shard = this->shard_for_key(key);
+    std::shared_lock lock{shard.mutex};
+    const Value *value = shard.map.lookup_ptr(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return *value;
+  }
+
+  /**
+   * Returns a copy of the value that corresponds to the given key, or the default value when the
+   * key is not in the map.
+   */
+  Value lookup_default(const Key &key, const Value &default_value) const
+  {
+    const Shard &shard = this->shard_for_key(key);
+    std::shared_lock lock{shard.mutex};
+    const Value *value = shard.map.lookup_ptr(key);
+    return (value == nullptr) ? default_value : *value;
+  }
+
+  /**
+   * Returns a copy of the value that corresponds to the given key. If the key is not in the map
+   * yet, `create_value` is called to create the value first. The callback is called at most once
+   * per key, even when multiple threads ask for the same key at the same time.
+   *
+   * The common case of an existing key only takes a shared lock.
+   */
+  template<typename CreateValueF>
+  Value lookup_or_add_cb(const Key &key, const CreateValueF &create_value)
+  {
+    Shard &shard = this->shard_for_key(key);
+    {
+      std::shared_lock lock{shard.mutex};
+      if (const Value *value = shard.map.lookup_ptr(key)) {
+        return *value;
+      }
+    }
+    std::unique_lock lock{shard.mutex};
+    /* Another thread might have added the key while no lock was held. */
+    return shard.map.lookup_or_add_cb(key, create_value);
+  }
+
+  /**
+   * Call `modify_value(Value &)` on the value that corresponds to the key while the shard is
+   * locked exclusively. Returns false when the key is not in the map.
+   */
+  template<typename ModifyValueF> bool modify(const Key &key, const ModifyValueF &modify_value)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::unique_lock lock{shard.mutex};
+    Value *value = shard.map.lookup_ptr(key);
+    if (value == nullptr) {
+      return false;
+    }
+    modify_value(*value);
+    return true;
+  }
+
+  /**
+   * Remove the key from the map. Returns true when the key has been in the map.
+   */
+  bool remove(const Key &key)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::unique_lock lock{shard.mutex};
+    return shard.map.remove(key);
+  }
+
+  /**
+   * Remove the key from the map and return its value, or nothing when the key is not in the map.
+   */
+  std::optional<Value> pop_try(const Key &key)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::unique_lock lock{shard.mutex};
+    return shard.map.pop_try(key);
+  }
+
+  /**
+   * Remove the key from the map and return the stored key and its value, or nothing when the key
+   * is not in the map. This is useful when the stored key owns memory that has to be freed.
+   */
+  std::optional<std::pair<Key, Value>> pop_item_try(const Key &key)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::unique_lock lock{shard.mutex};
+    const Key *stored_key = shard.map.lookup_key_ptr(key);
+    if (stored_key == nullptr) {
+      return std::nullopt;
+    }
+    Key key_copy = *stored_key;
+    Value value = shard.map.pop(key);
+    return std::pair<Key, Value>(std::move(key_copy), std::move(value));
+  }
+
+  /**
+   * Call `func(const Key &, const Value &)` for every item. Every shard is locked while its items
+   * are visited.
+   */
+  template<typename FuncT> void foreach_item(const FuncT &func) const
+  {
+    for (const Shard &shard : shards_) {
+      std::shared_lock lock{shard.mutex};
+      shard.map.foreach_item(func);
+    }
+  }
+
+  /**
+   * Return the number of key-value-pairs stored in the map.
+   */
+  int64_t size() const
+  {
+    int64_t size = 0;
+    for (const Shard &shard : shards_) {
+      std::shared_lock lock{shard.mutex};
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  /**
+   * Returns true if there are no elements in the map.
+   */
+  bool is_empty() const
+  {
+    return this->size() == 0;
+  }
+
+  /**
+   * Reserve memory for at least n elements in total, spread evenly over all shards.
+   */
+  void reserve(const int64_t n)
+  {
+    const int64_t n_per_shard = (n + shards_num - 1) / shards_num;
+    for (Shard &shard : shards_) {
+      std::unique_lock lock{shard.mutex};
+      shard.map.reserve(n_per_shard);
+    }
+  }
+
+  /**
+   * Removes all key-value-pairs from the map.
+   */
+  void clear()
+  {
+    for (Shard &shard : shards_) {
+      std::unique_lock lock{shard.mutex};
+      shard.map.clear();
+    }
+  }
+
+ private:
+  int64_t shard_index(const Key &key) const
+  {
+    /* Use the upper bits of a multiplicative hash, the inner maps use the lower bits of the hash
+     * to find the slot. This way the keys in one shard still spread over all its slots. */
+    const uint64_t hash = uint64_t(hash_(key)) * 0x9E3779B97F4A7C15ull;
+    return int64_t(hash >> (64 - ShardBits));
+  }
+
+  Shard &shard_for_key(const Key &key)
+  {
+    return shards_[this->shard_index(key)];
+  }
+
+  const Shard &shard_for_key(const Key &key) const
+  {
+    return shards_[this->shard_index(key)];
+  }
+};
+
+}  // namespace blender
@@ -30,12 +30,21 @@ struct FileReader;
 typedef ssize_t (*FileReaderReadFn)(struct FileReader *reader, void *buffer, size_t size);
 typedef off64_t (*FileReaderSeekFn)(struct FileReader *reader, off64_t offset, int whence);
 typedef void (*FileReaderCloseFn)(struct FileReader *reader);
+typedef ssize_t (*FileReaderPReadFn)(struct FileReader *reader,
+                                     void *buffer,
+                                     size_t size,
+                                     off64_t offset);
 
 /** General structure for all #FileReaders, implementations add custom fields at the end. */
 typedef struct FileReader {
   FileReaderReadFn read;
   FileReaderSeekFn seek;
   FileReaderCloseFn close;
+  /**
+   * Optional, read at an absolute offset without changing `offset`.
+   * Unlike `read`, this may be called from multiple threads at the same time.
+   */
+  FileReaderPReadFn pread;
 
   off64_t offset;
 } FileReader;
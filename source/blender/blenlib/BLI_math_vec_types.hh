@@ -11,6 +11,7 @@
 #include <cmath>
 #include <iostream>
 #include <type_traits>
+#include <utility>
 
 #include "BLI_utildefines.h"
 
@@ -20,6 +21,21 @@
 
 namespace blender {
 
+template<typename Fn, int... I> inline void unroll_impl(Fn fn, std::integer_sequence<int, I...>)
+{
+  (fn(I), ...);
+}
+
+/**
+ * Call #fn with every index from 0 to #N - 1. Compilers don't always unroll short loops at the
+ * default optimization level. Small vectors are then written element by element to the stack and
+ * read back as a whole, which makes simple vector math many times slower than necessary.
+ */
+template<int N, typename Fn> inline void unroll(Fn fn)
+{
+  unroll_impl(fn, std::make_integer_sequence<int, N>());
+}
+
 /* clang-format off */
 template<typename T>
 using as_uint_type = std::conditional_t<sizeof(T) == sizeof(uint8_t), uint8_t,
@@ -77,30 +93,22 @@ template<typename T, int Size> struct vec_base : public vec_struct_base<T, Size>
 
   explicit vec_base(uint value)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = static_cast<T>(value);
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = static_cast<T>(value); });
   }
 
   explicit vec_base(int value)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = static_cast<T>(value);
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = static_cast<T>(value); });
   }
 
   explicit vec_base(float value)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = static_cast<T>(value);
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = static_cast<T>(value); });
   }
 
   explicit vec_base(double value)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = static_cast<T>(value);
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = static_cast<T>(value); });
   }
 
 /* Workaround issue with template BLI_ENABLE_IF((Size == 2)) not working. */
@@ -185,9 +193,7 @@ template<typename T, int Size> struct vec_base : public vec_struct_base<T, Size>
   template<typename U, int OtherSize, BLI_ENABLE_IF(OtherSize > Size)>
   explicit vec_base(const vec_base<U, OtherSize> &other)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = static_cast<T>(other[i]);
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = static_cast<T>(other[i]); });
   }
 
 #undef BLI_ENABLE_IF_VEC
@@ -196,17 +202,13 @@ template<typename T, int Size> struct vec_base : public vec_struct_base<T, Size>
 
   vec_base(const T *ptr)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = ptr[i];
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = ptr[i]; });
   }
 
   template<typename U, BLI_ENABLE_IF((std::is_convertible_v<U, T>))>
   explicit vec_base(const U *ptr)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = ptr[i];
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = ptr[i]; });
   }
 
   vec_base(const T (*ptr)[Size]) : vec_base(static_cast<const T *>(ptr[0]))
@@ -217,9 +219,7 @@ template<typename T, int Size> struct vec_base : public vec_struct_base<T, Size>
 
   template<typename U> explicit vec_base(const vec_base<U, Size> &vec)
   {
-    for (int i = 0; i < Size; i++) {
-      (*this)[i] = static_cast<T>(vec[i]);
-    }
+    unroll<Size>([&](const int i) { (*this)[i] = static_cast<T>(vec[i]); });
   }
 
   /** C-style pointer dereference. */
@@ -256,15 +256,11 @@ template<typename T, int Size> struct vec_base : public vec_struct_base<T, Size>
 
 #define BLI_VEC_OP_IMPL(_result, _i, _op) \
   vec_base _result; \
-  for (int _i = 0; _i < Size; _i++) { \
-    _op; \
-  } \
+  unroll<Size>([&](const int _i) { _op; }); \
   return _result;
 
 #define BLI_VEC_OP_IMPL_SELF(_i, _op) \
-  for (int _i = 0; _i < Size; _i++) { \
-    _op; \
-  } \
+  unroll<Size>([&](const int _i) { _op; }); \
   return *this;
 
   /** Arithmetic operators. */
@@ -66,9 +66,7 @@ inline bool almost_equal_relative(const vec_base<T, Size> &a,
 template<typename T, int Size> inline vec_base<T, Size> abs(const vec_base<T, Size> &a)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = a[i] >= 0 ? a[i] : -a[i];
-  }
+  unroll<Size>([&](const int i) { result[i] = a[i] >= 0 ? a[i] : -a[i]; });
   return result;
 }
 
@@ -76,9 +74,7 @@ template<typename T, int Size>
 inline vec_base<T, Size> min(const vec_base<T, Size> &a, const vec_base<T, Size> &b)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = a[i] < b[i] ? a[i] : b[i];
-  }
+  unroll<Size>([&](const int i) { result[i] = a[i] < b[i] ? a[i] : b[i]; });
   return result;
 }
 
@@ -86,9 +82,7 @@ template<typename T, int Size>
 inline vec_base<T, Size> max(const vec_base<T, Size> &a, const vec_base<T, Size> &b)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = a[i] > b[i] ? a[i] : b[i];
-  }
+  unroll<Size>([&](const int i) { result[i] = a[i] > b[i] ? a[i] : b[i]; });
   return result;
 }
 
@@ -98,9 +92,7 @@ inline vec_base<T, Size> clamp(const vec_base<T, Size> &a,
                                const vec_base<T, Size> &max)
 {
   vec_base<T, Size> result = a;
-  for (int i = 0; i < Size; i++) {
-    result[i] = std::clamp(result[i], min[i], max[i]);
-  }
+  unroll<Size>([&](const int i) { result[i] = std::clamp(result[i], min[i], max[i]); });
   return result;
 }
 
@@ -108,9 +100,7 @@ template<typename T, int Size>
 inline vec_base<T, Size> clamp(const vec_base<T, Size> &a, const T &min, const T &max)
 {
   vec_base<T, Size> result = a;
-  for (int i = 0; i < Size; i++) {
-    result[i] = std::clamp(result[i], min, max);
-  }
+  unroll<Size>([&](const int i) { result[i] = std::clamp(result[i], min, max); });
   return result;
 }
 
@@ -118,10 +108,10 @@ template<typename T, int Size, BLI_ENABLE_IF((is_math_float_type<T>))>
 inline vec_base<T, Size> mod(const vec_base<T, Size> &a, const vec_base<T, Size> &b)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
+  unroll<Size>([&](const int i) {
     BLI_assert(b[i] != 0);
     result[i] = std::fmod(a[i], b[i]);
-  }
+  });
   return result;
 }
 
@@ -130,9 +120,7 @@ inline vec_base<T, Size> mod(const vec_base<T, Size> &a, const T &b)
 {
   BLI_assert(b != 0);
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = std::fmod(a[i], b);
-  }
+  unroll<Size>([&](const int i) { result[i] = std::fmod(a[i], b); });
   return result;
 }
 
@@ -140,9 +128,7 @@ template<typename T, int Size, BLI_ENABLE_IF((is_math_float_type<T>))>
 inline T safe_mod(const vec_base<T, Size> &a, const vec_base<T, Size> &b)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = (b[i] != 0) ? std::fmod(a[i], b[i]) : 0;
-  }
+  unroll<Size>([&](const int i) { result[i] = (b[i] != 0) ? std::fmod(a[i], b[i]) : 0; });
   return result;
 }
 
@@ -153,9 +139,7 @@ inline T safe_mod(const vec_base<T, Size> &a, const T &b)
     return vec_base<T, Size>(0);
   }
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = std::fmod(a[i], b);
-  }
+  unroll<Size>([&](const int i) { result[i] = std::fmod(a[i], b); });
   return result;
 }
 
@@ -172,9 +156,7 @@ template<typename T, int Size, BLI_ENABLE_IF((is_math_float_type<T>))>
 inline vec_base<T, Size> safe_divide(const vec_base<T, Size> &a, const vec_base<T, Size> &b)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = (b[i] == 0) ? 0 : a[i] / b[i];
-  }
+  unroll<Size>([&](const int i) { result[i] = (b[i] == 0) ? 0 : a[i] / b[i]; });
   return result;
 }
 
@@ -188,9 +170,7 @@ template<typename T, int Size, BLI_ENABLE_IF((is_math_float_type<T>))>
 inline vec_base<T, Size> floor(const vec_base<T, Size> &a)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = std::floor(a[i]);
-  }
+  unroll<Size>([&](const int i) { result[i] = std::floor(a[i]); });
   return result;
 }
 
@@ -198,9 +178,7 @@ template<typename T, int Size, BLI_ENABLE_IF((is_math_float_type<T>))>
 inline vec_base<T, Size> ceil(const vec_base<T, Size> &a)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = std::ceil(a[i]);
-  }
+  unroll<Size>([&](const int i) { result[i] = std::ceil(a[i]); });
   return result;
 }
 
@@ -208,9 +186,7 @@ template<typename T, int Size, BLI_ENABLE_IF((is_math_float_type<T>))>
 inline vec_base<T, Size> fract(const vec_base<T, Size> &a)
 {
   vec_base<T, Size> result;
-  for (int i = 0; i < Size; i++) {
-    result[i] = a[i] - std::floor(a[i]);
-  }
+  unroll<Size>([&](const int i) { result[i] = a[i] - std::floor(a[i]); });
   return result;
 }
 
@@ -218,18 +194,14 @@ template<typename T, int Size, BLI_ENABLE_IF((is_math_float_type<T>))>
 inline T dot(const vec_base<T, Size> &a, const vec_base<T, Size> &b)
 {
   T result = a[0] * b[0];
-  for (int i = 1; i < Size; i++) {
-    result += a[i] * b[i];
-  }
+  unroll<Size - 1>([&](const int i) { result += a[i + 1] * b[i + 1]; });
   return result;
 }
 
 template<typename T, int Size> inline T length_manhattan(const vec_base<T, Size> &a)
 {
   T result = std::abs(a[0]);
-  for (int i = 1; i < Size; i++) {
-    result += std::abs(a[i]);
-  }
+  unroll<Size - 1>([&](const int i) { result += std::abs(a[i + 1]); });
   return result;
 }
 
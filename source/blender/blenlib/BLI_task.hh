@@ -31,6 +31,7 @@
 #endif
 
 #include "BLI_index_range.hh"
+#include "BLI_task_trace.h"
 #include "BLI_utildefines.h"
 
 namespace blender::threading {
@@ -59,6 +60,7 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
     tbb::parallel_for(
         tbb::blocked_range<int64_t>(range.first(), range.one_after_last(), grain_size),
         [&](const tbb::blocked_range<int64_t> &subrange) {
+          TaskTraceScope trace_scope("parallel_for", "parallel_for");
           function(IndexRange(subrange.begin(), subrange.size()));
         });
     return;
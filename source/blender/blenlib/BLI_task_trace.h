@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Lightweight tracing of tasks, to see how work is distributed over threads.
+ *
+ * When enabled, the begin and end time of task pool tasks, parallel range chunks, task graph
+ * nodes and depsgraph operations are recorded per thread. The result is written as a Chrome
+ * trace JSON file, which can be opened in `chrome://tracing` or https://ui.perfetto.dev.
+ *
+ * Events are stored in buffers owned by the recording thread, so no locks are taken while
+ * recording. When tracing is disabled, recording an event only costs one relaxed atomic load.
+ */
+
+#include "BLI_sys_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Start recording events. They are written to \a filepath by #BLI_task_trace_end.
+ */
+void BLI_task_trace_begin(const char *filepath);
+/**
+ * Stop recording and write all events that have been recorded since #BLI_task_trace_begin.
+ * Must be called when no tasks are running.
+ *
+ * \return false when tracing was not enabled or the file could not be written.
+ */
+bool BLI_task_trace_end(void);
+bool BLI_task_trace_is_enabled(void);
+
+/**
+ * Begin an event on the calling thread, every begin must be followed by an end on the same
+ * thread. Events can be nested.
+ *
+ * \param category: Static string, used to group events, e.g. "task_pool".
+ * \param name: Static string, it is not copied.
+ */
+void BLI_task_trace_event_begin(const char *category, const char *name);
+/**
+ * Same as #BLI_task_trace_event_begin, but \a name is copied, so it can be freed after the call.
+ */
+void BLI_task_trace_event_begin_copy(const char *category, const char *name);
+void BLI_task_trace_event_end(void);
+
+#ifdef __cplusplus
+}
+
+namespace blender::threading {
+
+/**
+ * Record an event for the lifetime of this object, when tracing is enabled.
+ */
+class TaskTraceScope {
+ private:
+  bool is_recording_;
+
+ public:
+  TaskTraceScope(const char *category, const char *name)
+      : is_recording_(BLI_task_trace_is_enabled())
+  {
+    if (is_recording_) {
+      BLI_task_trace_event_begin(category, name);
+    }
+  }
+
+  ~TaskTraceScope()
+  {
+    if (is_recording_) {
+      BLI_task_trace_event_end();
+    }
+  }
+
+  TaskTraceScope(const TaskTraceScope &other) = delete;
+  TaskTraceScope &operator=(const TaskTraceScope &other) = delete;
+};
+
+}  // namespace blender::threading
+
+#endif
@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * C API for #blender::ConcurrentMap, using the #GHash callbacks for hashing and comparison.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_concurrent_ghash.h"
+#include "BLI_concurrent_map.hh"
+
+namespace blender {
+
+/**
+ * The hash is computed once when the key enters the map and stored next to the pointer, so the
+ * (possibly expensive) hash callback is not called again when the inner map grows.
+ */
+struct CGHashKey {
+  const void *key;
+  uint hash;
+  GHashCmpFP cmpfp;
+};
+
+struct CGHashKeyHash {
+  uint64_t operator()(const CGHashKey &key) const
+  {
+    return key.hash;
+  }
+};
+
+struct CGHashKeyEqual {
+  bool operator()(const CGHashKey &a, const CGHashKey &b) const
+  {
+    /* GHash comparison callbacks return false when the keys are equal. */
+    return a.hash == b.hash && !a.cmpfp(a.key, b.key);
+  }
+};
+
+}  // namespace blender
+
+using blender::CGHashKey;
+
+struct ConcurrentGHash {
+  blender::ConcurrentMap<CGHashKey, void *, 6, blender::CGHashKeyHash, blender::CGHashKeyEqual>
+      map;
+  GHashHashFP hashfp;
+  GHashCmpFP cmpfp;
+
+  CGHashKey make_key(const void *key) const
+  {
+    return {key, hashfp(key), cmpfp};
+  }
+};
+
+ConcurrentGHash *BLI_concurrent_ghash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
+{
+  /* The shards are aligned to cache lines, which #MEM_new does not respect. */
+  void *buffer = MEM_mallocN_aligned(sizeof(ConcurrentGHash), alignof(ConcurrentGHash), info);
+  ConcurrentGHash *cgh = new (buffer) ConcurrentGHash();
+  cgh->hashfp = hashfp;
+  cgh->cmpfp = cmpfp;
+  return cgh;
+}
+
+ConcurrentGHash *BLI_concurrent_ghash_ptr_new(const char *info)
+{
+  return BLI_concurrent_ghash_new(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, info);
+}
+
+ConcurrentGHash *BLI_concurrent_ghash_str_new(const char *info)
+{
+  return BLI_concurrent_ghash_new(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, info);
+}
+
+static void concurrent_ghash_free_items(ConcurrentGHash *cgh,
+                                        GHashKeyFreeFP keyfreefp,
+                                        GHashValFreeFP valfreefp)
+{
+  if (keyfreefp || valfreefp) {
+    cgh->map.foreach_item([&](const CGHashKey &key, void *value) {
+      if (keyfreefp) {
+        keyfreefp(const_cast<void *>(key.key));
+      }
+      if (valfreefp) {
+        valfreefp(value);
+      }
+    });
+  }
+}
+
+void BLI_concurrent_ghash_free(ConcurrentGHash *cgh,
+                               GHashKeyFreeFP keyfreefp,
+                               GHashValFreeFP valfreefp)
+{
+  concurrent_ghash_free_items(cgh, keyfreefp, valfreefp);
+  cgh->~ConcurrentGHash();
+  MEM_freeN(cgh);
+}
+
+void BLI_concurrent_ghash_clear(ConcurrentGHash *cgh,
+                                GHashKeyFreeFP keyfreefp,
+                                GHashValFreeFP valfreefp)
+{
+  concurrent_ghash_free_items(cgh, keyfreefp, valfreefp);
+  cgh->map.clear();
+}
+
+bool BLI_concurrent_ghash_add(ConcurrentGHash *cgh, void *key, void *val)
+{
+  return cgh->map.add(cgh->make_key(key), val);
+}
+
+void *BLI_concurrent_ghash_lookup(const ConcurrentGHash *cgh, const void *key)
+{
+  return cgh->map.lookup_default(cgh->make_key(key), nullptr);
+}
+
+void *BLI_concurrent_ghash_ensure(ConcurrentGHash *cgh,
+                                  void *key,
+                                  ConcurrentGHashCreateFP create_fn,
+                                  void *user_data)
+{
+  return cgh->map.lookup_or_add_cb(cgh->make_key(key),
+                                   [&]() { return create_fn(key, user_data); });
+}
+
+bool BLI_concurrent_ghash_remove(ConcurrentGHash *cgh,
+                                 const void *key,
+                                 GHashKeyFreeFP keyfreefp,
+                                 GHashValFreeFP valfreefp)
+{
+  std::optional<std::pair<CGHashKey, void *>> item = cgh->map.pop_item_try(cgh->make_key(key));
+  if (!item.has_value()) {
+    return false;
+  }
+  if (keyfreefp) {
+    keyfreefp(const_cast<void *>(item->first.key));
+  }
+  if (valfreefp) {
+    valfreefp(item->second);
+  }
+  return true;
+}
+
+bool BLI_concurrent_ghash_haskey(const ConcurrentGHash *cgh, const void *key)
+{
+  return cgh->map.contains(cgh->make_key(key));
+}
+
+unsigned int BLI_concurrent_ghash_len(const ConcurrentGHash *cgh)
+{
+  return uint(cgh->map.size());
+}
+
+void BLI_concurrent_ghash_foreach(const ConcurrentGHash *cgh,
+                                  ConcurrentGHashForeachFP fn,
+                                  void *user_data)
+{
+  cgh->map.foreach_item([&](const CGHashKey &key, void *value) {
+    fn(const_cast<void *>(key.key), value, user_data);
+  });
+}
@@ -43,6 +43,15 @@ static off64_t file_seek(FileReader *reader, off64_t offset, int whence)
   return rawfile->reader.offset;
 }
 
+#ifndef WIN32
+static ssize_t file_pread(FileReader *reader, void *buffer, size_t size, off64_t offset)
+{
+  RawFileReader *rawfile = (RawFileReader *)reader;
+  /* Positional reads don't touch the file position, so they can run concurrently. */
+  return pread(rawfile->filedes, buffer, size, offset);
+}
+#endif
+
 static void file_close(FileReader *reader)
 {
   RawFileReader *rawfile = (RawFileReader *)reader;
@@ -59,6 +68,11 @@ FileReader *BLI_filereader_new_file(int filedes)
   rawfile->reader.read = file_read;
   rawfile->reader.seek = file_seek;
   rawfile->reader.close = file_close;
+#ifndef WIN32
+  rawfile->reader.pread = file_pread;
+#else
+  rawfile->reader.pread = NULL;
+#endif
 
   return (FileReader *)rawfile;
 }
@@ -86,6 +86,7 @@ FileReader *BLI_filereader_new_gzip(FileReader *base)
 
   gzip->reader.read = gzip_read;
   gzip->reader.seek = NULL;
+  gzip->reader.pread = NULL;
   gzip->reader.close = gzip_close;
 
   return (FileReader *)gzip;
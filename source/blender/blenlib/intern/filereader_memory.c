@@ -35,6 +35,20 @@ static ssize_t memory_read_raw(FileReader *reader, void *buffer, size_t size)
   return readsize;
 }
 
+static ssize_t memory_pread_raw(FileReader *reader, void *buffer, size_t size, off64_t offset)
+{
+  MemoryReader *mem = (MemoryReader *)reader;
+
+  if (offset < 0 || offset > mem->length) {
+    return -1;
+  }
+  size_t readsize = MIN2(size, (size_t)(mem->length - offset));
+
+  memcpy(buffer, mem->data + offset, readsize);
+
+  return readsize;
+}
+
 static off64_t memory_seek(FileReader *reader, off64_t offset, int whence)
 {
   MemoryReader *mem = (MemoryReader *)reader;
@@ -76,6 +90,7 @@ FileReader *BLI_filereader_new_memory(const void *data, size_t len)
   mem->reader.read = memory_read_raw;
   mem->reader.seek = memory_seek;
   mem->reader.close = memory_close_raw;
+  mem->reader.pread = memory_pread_raw;
 
   return (FileReader *)mem;
 }
@@ -102,6 +117,23 @@ static ssize_t memory_read_mmap(FileReader *reader, void *buffer, size_t size)
   return readsize;
 }
 
+static ssize_t memory_pread_mmap(FileReader *reader, void *buffer, size_t size, off64_t offset)
+{
+  MemoryReader *mem = (MemoryReader *)reader;
+
+  if (offset < 0 || offset > mem->length) {
+    return -1;
+  }
+  size_t readsize = MIN2(size, (size_t)(mem->length - offset));
+
+  /* #BLI_mmap_read only reads from the mapping, so it is safe to call from multiple threads. */
+  if (!BLI_mmap_read(mem->mmap, buffer, (size_t)offset, readsize)) {
+    return 0;
+  }
+
+  return readsize;
+}
+
 static void memory_close_mmap(FileReader *reader)
 {
   MemoryReader *mem = (MemoryReader *)reader;
@@ -124,6 +156,7 @@ FileReader *BLI_filereader_new_mmap(int filedes)
   mem->reader.read = memory_read_mmap;
   mem->reader.seek = memory_seek;
   mem->reader.close = memory_close_mmap;
+  mem->reader.pread = memory_pread_mmap;
 
   return (FileReader *)mem;
 }
@@ -12,9 +12,16 @@
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
 
 #include "MEM_guardedalloc.h"
 
+/**
+ * When frames are read in order, decompress up to this many of the following frames at once,
+ * on multiple threads. Random access (e.g. reading delayed data) only decompresses one frame.
+ */
+#define ZSTD_PREFETCH_FRAMES_MAX 16
+
 typedef struct {
   FileReader reader;
 
@@ -29,8 +36,10 @@ typedef struct {
     size_t *compressed_ofs;
     size_t *uncompressed_ofs;
 
+    /** Decompressed content of the frames `cached_frame` to `cached_frame + cached_len - 1`. */
     char *cached_content;
     int cached_frame;
+    int cached_len;
   } seek;
 } ZstdReader;
 
@@ -127,6 +136,7 @@ static bool zstd_read_seek_table(ZstdReader *zstd)
   }
 
   zstd->seek.cached_frame = -1;
+  zstd->seek.cached_len = 0;
 
   return true;
 }
@@ -154,19 +164,76 @@ static int zstd_frame_from_pos(ZstdReader *zstd, size_t pos)
   return low;
 }
 
-/* Ensure that the currently loaded frame is the correct one. */
+typedef struct ZstdDecompressFramesData {
+  ZstdReader *zstd;
+  int first_frame;
+  const char *compressed_data;
+  char *uncompressed_data;
+  bool *frame_errors;
+} ZstdDecompressFramesData;
+
+static void zstd_decompress_frame_fn(void *__restrict userdata,
+                                     const int i,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ZstdDecompressFramesData *data = userdata;
+  ZstdReader *zstd = data->zstd;
+  const int frame = data->first_frame + i;
+
+  const size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] -
+                                 zstd->seek.compressed_ofs[frame];
+  const size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+                                   zstd->seek.uncompressed_ofs[frame];
+  const char *compressed = data->compressed_data + (zstd->seek.compressed_ofs[frame] -
+                                                    zstd->seek.compressed_ofs[data->first_frame]);
+  char *uncompressed = data->uncompressed_data + (zstd->seek.uncompressed_ofs[frame] -
+                                                  zstd->seek.uncompressed_ofs[data->first_frame]);
+
+  /* Frames are independent, so they can be decompressed in any order. The shared context can
+   * only be used by one thread, use a temporary one for the other frames. */
+  size_t res = (i == 0) ?
+                   ZSTD_decompressDCtx(
+                       zstd->ctx, uncompressed, uncompressed_size, compressed, compressed_size) :
+                   ZSTD_decompress(uncompressed, uncompressed_size, compressed, compressed_size);
+  if (ZSTD_isError(res) || res < uncompressed_size) {
+    data->frame_errors[i] = true;
+  }
+}
+
+/**
+ * Ensure that the frame is loaded in the cache, returns the decompressed content of the frame.
+ *
+ * When reading sequentially, the following frames are decompressed at the same time, in parallel,
+ * so the reader does not have to wait on single-threaded decompression for every frame.
+ */
 static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
 {
-  if (zstd->seek.cached_frame == frame) {
-    /* Cached frame matches, so just return it. */
-    return zstd->seek.cached_content;
+  if (frame >= zstd->seek.cached_frame &&
+      frame < zstd->seek.cached_frame + zstd->seek.cached_len) {
+    /* Cached frames contain the requested one, so just return it. */
+    return zstd->seek.cached_content +
+           (zstd->seek.uncompressed_ofs[frame] -
+            zstd->seek.uncompressed_ofs[zstd->seek.cached_frame]);
   }
 
-  /* Cached frame doesn't match, so discard it and cache the wanted one instead. */
+  const bool is_sequential = (zstd->seek.cached_len != 0 &&
+                              frame == zstd->seek.cached_frame + zstd->seek.cached_len);
+
+  /* Cached frames don't match, so discard them and cache the wanted ones instead. */
   MEM_SAFE_FREE(zstd->seek.cached_content);
+  zstd->seek.cached_frame = -1;
+  zstd->seek.cached_len = 0;
+
+  int frames_len = 1;
+  if (is_sequential) {
+    frames_len = min_ii(min_ii(BLI_task_scheduler_num_threads(), ZSTD_PREFETCH_FRAMES_MAX),
+                        zstd->seek.frames_num - frame);
+    frames_len = max_ii(frames_len, 1);
+  }
+  const int frame_end = frame + frames_len;
 
-  size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - zstd->seek.compressed_ofs[frame];
-  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] -
+  size_t compressed_size = zstd->seek.compressed_ofs[frame_end] - zstd->seek.compressed_ofs[frame];
+  size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame_end] -
                              zstd->seek.uncompressed_ofs[frame];
 
   char *uncompressed_data = MEM_mallocN(uncompressed_size, __func__);
@@ -178,15 +245,34 @@ static const char *zstd_ensure_cache(ZstdReader *zstd, int frame)
     return NULL;
   }
 
-  size_t res = ZSTD_decompressDCtx(
-      zstd->ctx, uncompressed_data, uncompressed_size, compressed_data, compressed_size);
+  bool frame_errors[ZSTD_PREFETCH_FRAMES_MAX] = {false};
+  ZstdDecompressFramesData data = {
+      .zstd = zstd,
+      .first_frame = frame,
+      .compressed_data = compressed_data,
+      .uncompressed_data = uncompressed_data,
+      .frame_errors = frame_errors,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (frames_len > 1);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, frames_len, &data, zstd_decompress_frame_fn, &settings);
   MEM_freeN(compressed_data);
-  if (ZSTD_isError(res) || res < uncompressed_size) {
+
+  /* Only keep the frames up to the first one that failed to decompress. */
+  int frames_valid_len = 0;
+  while (frames_valid_len < frames_len && !frame_errors[frames_valid_len]) {
+    frames_valid_len++;
+  }
+  if (frames_valid_len == 0) {
     MEM_freeN(uncompressed_data);
     return NULL;
   }
 
   zstd->seek.cached_frame = frame;
+  zstd->seek.cached_len = frames_valid_len;
   zstd->seek.cached_content = uncompressed_data;
   return uncompressed_data;
 }
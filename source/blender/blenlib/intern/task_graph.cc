@@ -9,6 +9,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_task.h"
+#include "BLI_task_trace.h"
 
 #include <memory>
 #include <vector>
@@ -77,6 +78,7 @@ struct TaskNode {
 #ifdef WITH_TBB
   tbb::flow::continue_msg run(const tbb::flow::continue_msg UNUSED(input))
   {
+    blender::threading::TaskTraceScope trace_scope("task_graph", "TaskNode");
     run_func(task_data);
     return tbb::flow::continue_msg();
   }
@@ -17,6 +17,7 @@
 #include "BLI_math.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
+#include "BLI_task_trace.h"
 #include "BLI_threads.h"
 
 #ifdef WITH_TBB
@@ -161,6 +162,7 @@ struct TaskPool {
 /* Execute task. */
 void Task::operator()() const
 {
+  blender::threading::TaskTraceScope trace_scope("task_pool", "Task");
   run(pool, taskdata);
 }
 
@@ -13,6 +13,7 @@
 #include "DNA_listBase.h"
 
 #include "BLI_task.h"
+#include "BLI_task_trace.h"
 #include "BLI_threads.h"
 
 #include "atomic_ops.h"
@@ -76,6 +77,7 @@ struct RangeTask {
 
   void operator()(const tbb::blocked_range<int> &r) const
   {
+    blender::threading::TaskTraceScope trace_scope("parallel_range", "BLI_task_parallel_range");
     TaskParallelTLS tls;
     tls.userdata_chunk = userdata_chunk;
     for (int i = r.begin(); i != r.end(); ++i) {
@@ -0,0 +1,213 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * Task tracing, written as Chrome trace JSON.
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "BLI_fileops.h"
+#include "BLI_task_trace.h"
+#include "BLI_timeit.hh"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+namespace blender::threading::trace {
+
+using timeit::Clock;
+using timeit::TimePoint;
+
+struct TraceEvent {
+  const char *category;
+  /** Static string, or null when #name_copy is used. */
+  const char *name;
+  std::string name_copy;
+  TimePoint time_begin;
+  TimePoint time_end;
+};
+
+/** Events of one thread, only accessed by that thread while tracing is enabled. */
+struct ThreadTrace {
+  int thread_index;
+  Vector<TraceEvent> events;
+  /** Indices of events that have begun but not ended yet. */
+  Vector<int64_t> open_events;
+};
+
+static std::atomic<bool> is_enabled = false;
+/** Incremented for every new trace, so threads know when their buffer is outdated. */
+static std::atomic<int> trace_generation = 0;
+
+static std::mutex trace_mutex;
+static std::string trace_filepath;
+static TimePoint trace_time_begin;
+static Vector<std::unique_ptr<ThreadTrace>> thread_traces;
+
+static ThreadTrace &thread_trace_get()
+{
+  thread_local ThreadTrace *thread_trace = nullptr;
+  thread_local int thread_trace_generation = -1;
+
+  const int generation = trace_generation.load(std::memory_order_acquire);
+  if (thread_trace_generation != generation) {
+    std::lock_guard lock{trace_mutex};
+    std::unique_ptr<ThreadTrace> new_trace = std::make_unique<ThreadTrace>();
+    new_trace->thread_index = int(thread_traces.size());
+    thread_trace = new_trace.get();
+    thread_traces.append(std::move(new_trace));
+    thread_trace_generation = generation;
+  }
+  return *thread_trace;
+}
+
+static void event_begin(const char *category, const char *name, const bool copy_name)
+{
+  ThreadTrace &trace = thread_trace_get();
+  trace.open_events.append(trace.events.size());
+  trace.events.append_as();
+  TraceEvent &event = trace.events.last();
+  event.category = category;
+  if (copy_name) {
+    event.name = nullptr;
+    event.name_copy = name;
+  }
+  else {
+    event.name = name;
+  }
+  event.time_begin = Clock::now();
+}
+
+static void json_write_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c; c++) {
+    if (ELEM(*c, '"', '\\')) {
+      fputc('\\', file);
+      fputc(*c, file);
+    }
+    else if (uchar(*c) < 0x20) {
+      fprintf(file, "\\u%04x", uint(uchar(*c)));
+    }
+    else {
+      fputc(*c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+static double time_to_microseconds(const TimePoint time)
+{
+  return std::chrono::duration<double, std::micro>(time - trace_time_begin).count();
+}
+
+static bool trace_write(const char *filepath)
+{
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  bool is_first = true;
+  for (const std::unique_ptr<ThreadTrace> &trace : thread_traces) {
+    fprintf(file,
+            "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+            "\"args\": {\"name\": \"Thread %d\"}}",
+            is_first ? "" : ",\n",
+            trace->thread_index,
+            trace->thread_index);
+    is_first = false;
+
+    for (const int64_t i : trace->events.index_range()) {
+      const TraceEvent &event = trace->events[i];
+      if (trace->open_events.contains(i)) {
+        continue;
+      }
+      const double begin = time_to_microseconds(event.time_begin);
+      const double end = time_to_microseconds(event.time_end);
+      fprintf(file, ",\n{\"name\": ");
+      json_write_string(file, event.name ? event.name : event.name_copy.c_str());
+      fprintf(file, ", \"cat\": ");
+      json_write_string(file, event.category);
+      fprintf(file,
+              ", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+              trace->thread_index,
+              begin,
+              end - begin);
+    }
+  }
+  fprintf(file, "\n]}\n");
+
+  const bool success = !ferror(file);
+  fclose(file);
+  return success;
+}
+
+}  // namespace blender::threading::trace
+
+using namespace blender::threading::trace;
+
+void BLI_task_trace_begin(const char *filepath)
+{
+  std::lock_guard lock{trace_mutex};
+  thread_traces.clear();
+  trace_filepath = filepath;
+  trace_time_begin = Clock::now();
+  trace_generation.fetch_add(1, std::memory_order_release);
+  is_enabled.store(true, std::memory_order_release);
+}
+
+bool BLI_task_trace_end(void)
+{
+  if (!is_enabled.exchange(false)) {
+    return false;
+  }
+
+  std::lock_guard lock{trace_mutex};
+  const bool success = trace_write(trace_filepath.c_str());
+  if (success) {
+    printf("Task trace written to '%s'\n", trace_filepath.c_str());
+  }
+  else {
+    fprintf(stderr, "Unable to write task trace to '%s'\n", trace_filepath.c_str());
+  }
+  /* Threads notice the new generation before they use their (freed) buffer again. */
+  trace_generation.fetch_add(1, std::memory_order_release);
+  thread_traces.clear();
+  return success;
+}
+
+bool BLI_task_trace_is_enabled(void)
+{
+  return is_enabled.load(std::memory_order_relaxed);
+}
+
+void BLI_task_trace_event_begin(const char *category, const char *name)
+{
+  event_begin(category, name, false);
+}
+
+void BLI_task_trace_event_begin_copy(const char *category, const char *name)
+{
+  event_begin(category, name, true);
+}
+
+void BLI_task_trace_event_end(void)
+{
+  const TimePoint time = Clock::now();
+  if (!BLI_task_trace_is_enabled()) {
+    return;
+  }
+  ThreadTrace &trace = thread_trace_get();
+  if (trace.open_events.is_empty()) {
+    /* The event began before tracing was restarted. */
+    return;
+  }
+  trace.events[trace.open_events.pop_last()].time_end = time;
+}
@@ -0,0 +1,169 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <atomic>
+#include <thread>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_concurrent_ghash.h"
+#include "BLI_concurrent_map.hh"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+#include "testing/testing.h"
+
+namespace blender::tests {
+
+TEST(concurrent_map, DefaultConstructor)
+{
+  ConcurrentMap<int, float> map;
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_TRUE(map.is_empty());
+}
+
+TEST(concurrent_map, AddLookupRemove)
+{
+  ConcurrentMap<int, float> map;
+  EXPECT_TRUE(map.add(3, 5.0f));
+  EXPECT_FALSE(map.add(3, 6.0f));
+  EXPECT_TRUE(map.add(4, 1.0f));
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_TRUE(map.contains(3));
+  EXPECT_FALSE(map.contains(5));
+  EXPECT_EQ(map.lookup_default(3, 0.0f), 5.0f);
+  EXPECT_EQ(map.lookup_default(5, 2.0f), 2.0f);
+  EXPECT_FALSE(map.lookup_try(5).has_value());
+  EXPECT_FALSE(map.add_overwrite(3, 7.0f));
+  EXPECT_EQ(*map.lookup_try(3), 7.0f);
+  EXPECT_TRUE(map.remove(3));
+  EXPECT_FALSE(map.remove(3));
+  EXPECT_EQ(map.pop_try(4), 1.0f);
+  EXPECT_FALSE(map.pop_try(4).has_value());
+  EXPECT_TRUE(map.is_empty());
+}
+
+TEST(concurrent_map, Modify)
+{
+  ConcurrentMap<int, int> map;
+  EXPECT_FALSE(map.modify(1, [](int &value) { value++; }));
+  map.add(1, 10);
+  EXPECT_TRUE(map.modify(1, [](int &value) { value++; }));
+  EXPECT_EQ(map.lookup_default(1, 0), 11);
+}
+
+TEST(concurrent_map, ForeachItemAndClear)
+{
+  ConcurrentMap<int, int> map;
+  for (int i = 0; i < 1000; i++) {
+    map.add(i, i * 2);
+  }
+  int64_t sum = 0;
+  map.foreach_item([&](const int key, const int value) {
+    EXPECT_EQ(key * 2, value);
+    sum += key;
+  });
+  EXPECT_EQ(sum, 999 * 1000 / 2);
+  map.clear();
+  EXPECT_TRUE(map.is_empty());
+}
+
+TEST(concurrent_map, MultiThreadedAdd)
+{
+  ConcurrentMap<int, int> map;
+  const int threads_num = 8;
+  const int keys_per_thread = 10000;
+  Vector<std::thread> threads;
+  for (int thread_i = 0; thread_i < threads_num; thread_i++) {
+    threads.append(std::thread([&, thread_i]() {
+      for (int i = 0; i < keys_per_thread; i++) {
+        const int key = thread_i * keys_per_thread + i;
+        map.add(key, -key);
+        EXPECT_EQ(map.lookup_default(key, 0), -key);
+      }
+    }));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(map.size(), threads_num * keys_per_thread);
+}
+
+TEST(concurrent_map, MultiThreadedLookupOrAddCreatesOnce)
+{
+  ConcurrentMap<int, int> map;
+  std::atomic<int> create_count = 0;
+  const int keys_num = 1000;
+  Vector<std::thread> threads;
+  for (int thread_i = 0; thread_i < 8; thread_i++) {
+    threads.append(std::thread([&]() {
+      for (int key = 0; key < keys_num; key++) {
+        const int value = map.lookup_or_add_cb(key, [&]() {
+          create_count++;
+          return key + 1;
+        });
+        EXPECT_EQ(value, key + 1);
+      }
+    }));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(create_count, keys_num);
+  EXPECT_EQ(map.size(), keys_num);
+}
+
+static void *concurrent_ghash_create_value(const void *UNUSED(key), void *user_data)
+{
+  (*static_cast<int *>(user_data))++;
+  return POINTER_FROM_INT(42);
+}
+
+TEST(concurrent_ghash, Basic)
+{
+  ConcurrentGHash *cgh = BLI_concurrent_ghash_str_new(__func__);
+  char key_a[] = "a";
+  char key_b[] = "b";
+  EXPECT_TRUE(BLI_concurrent_ghash_add(cgh, key_a, POINTER_FROM_INT(1)));
+  EXPECT_FALSE(BLI_concurrent_ghash_add(cgh, key_a, POINTER_FROM_INT(2)));
+  /* String keys are compared by content. */
+  EXPECT_EQ(BLI_concurrent_ghash_lookup(cgh, "a"), POINTER_FROM_INT(1));
+  EXPECT_EQ(BLI_concurrent_ghash_lookup(cgh, "b"), nullptr);
+  EXPECT_FALSE(BLI_concurrent_ghash_haskey(cgh, "b"));
+
+  int create_count = 0;
+  void *value = BLI_concurrent_ghash_ensure(
+      cgh, key_b, concurrent_ghash_create_value, &create_count);
+  EXPECT_EQ(value, POINTER_FROM_INT(42));
+  value = BLI_concurrent_ghash_ensure(cgh, key_b, concurrent_ghash_create_value, &create_count);
+  EXPECT_EQ(value, POINTER_FROM_INT(42));
+  EXPECT_EQ(create_count, 1);
+  EXPECT_EQ(BLI_concurrent_ghash_len(cgh), 2u);
+
+  EXPECT_TRUE(BLI_concurrent_ghash_remove(cgh, "a", nullptr, nullptr));
+  EXPECT_FALSE(BLI_concurrent_ghash_remove(cgh, "a", nullptr, nullptr));
+  EXPECT_EQ(BLI_concurrent_ghash_len(cgh), 1u);
+  BLI_concurrent_ghash_free(cgh, nullptr, nullptr);
+}
+
+TEST(concurrent_ghash, FreeCallbacks)
+{
+  ConcurrentGHash *cgh = BLI_concurrent_ghash_ptr_new(__func__);
+  for (int i = 0; i < 100; i++) {
+    int *key = static_cast<int *>(MEM_mallocN(sizeof(int), __func__));
+    int *value = static_cast<int *>(MEM_mallocN(sizeof(int), __func__));
+    *key = *value = i;
+    BLI_concurrent_ghash_add(cgh, key, value);
+  }
+  EXPECT_EQ(BLI_concurrent_ghash_len(cgh), 100u);
+  int sum = 0;
+  BLI_concurrent_ghash_foreach(
+      cgh,
+      [](void *key, void *value, void *user_data) {
+        EXPECT_EQ(*static_cast<int *>(key), *static_cast<int *>(value));
+        *static_cast<int *>(user_data) += *static_cast<int *>(value);
+      },
+      &sum);
+  EXPECT_EQ(sum, 99 * 100 / 2);
+  BLI_concurrent_ghash_free(cgh, MEM_freeN, MEM_freeN);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,58 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "BLI_fileops.h"
+#include "BLI_task.hh"
+#include "BLI_task_trace.h"
+
+namespace blender::threading::tests {
+
+static std::string read_file(const std::string &filepath)
+{
+  std::ifstream file(filepath);
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+TEST(task_trace, WriteChromeTrace)
+{
+  const std::string filepath = ::testing::TempDir() + "task_trace_test.json";
+
+  EXPECT_FALSE(BLI_task_trace_is_enabled());
+  BLI_task_trace_begin(filepath.c_str());
+  EXPECT_TRUE(BLI_task_trace_is_enabled());
+
+  {
+    TaskTraceScope scope("test", "outer");
+    std::string name = "inner \"quoted\"";
+    BLI_task_trace_event_begin_copy("test", name.c_str());
+    name.clear();
+    parallel_for(IndexRange(1000), 10, [](const IndexRange range) {
+      for (const int64_t i : range) {
+        UNUSED_VARS(i);
+      }
+    });
+    BLI_task_trace_event_end();
+  }
+
+  EXPECT_TRUE(BLI_task_trace_end());
+  EXPECT_FALSE(BLI_task_trace_is_enabled());
+  /* Nothing to write anymore. */
+  EXPECT_FALSE(BLI_task_trace_end());
+
+  const std::string trace = read_file(filepath);
+  EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(trace.find("\"name\": \"outer\", \"cat\": \"test\", \"ph\": \"X\""),
+            std::string::npos);
+  EXPECT_NE(trace.find("\"name\": \"inner \\\"quoted\\\"\""), std::string::npos);
+  EXPECT_NE(trace.find("\"thread_name\""), std::string::npos);
+
+  BLI_delete(filepath.c_str(), false, false);
+}
+
+}  // namespace blender::threading::tests
@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <thread>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_concurrent_ghash.h"
+#include "BLI_concurrent_map.hh"
+#include "BLI_ghash.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+#include "BLI_vector.hh"
+
+#include "PIL_time.h"
+
+/* Number of keys the map contains before the threads start. */
+#define KEYS_NUM 100000
+/* Number of operations done by every thread. */
+#define OPS_PER_THREAD 1000000
+/* One in this many operations adds a new key, all others are lookups. */
+#define ADD_FREQUENCY 16
+
+namespace blender::tests {
+
+static uint hash_number(uint num)
+{
+  /* NOTE: this is taken from BLI_ghashutil_uinthash(), so that the keys accessed by different
+   * threads are spread over the whole map. */
+  num += ~(num << 16);
+  num ^= (num >> 5);
+  num += (num << 3);
+  num ^= (num >> 13);
+  num += ~(num << 9);
+  num ^= (num >> 17);
+  return num;
+}
+
+/**
+ * Run `op(thread_index, op_index)` #OPS_PER_THREAD times on every thread and print the time it
+ * took for all threads to finish.
+ */
+template<typename OpFn> static double run_threads(const int threads_num, const OpFn &op)
+{
+  Vector<std::thread> threads;
+  const double time_start = PIL_check_seconds_timer();
+  for (int thread_i = 0; thread_i < threads_num; thread_i++) {
+    threads.append(std::thread([&, thread_i]() {
+      for (uint op_i = 0; op_i < OPS_PER_THREAD; op_i++) {
+        op(uint(thread_i), op_i);
+      }
+    }));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  return PIL_check_seconds_timer() - time_start;
+}
+
+static uintptr_t op_key(const uint thread_i, const uint op_i)
+{
+  if (op_i % ADD_FREQUENCY == 0) {
+    /* New keys, unique per thread. */
+    return KEYS_NUM + 1 + uintptr_t(thread_i) * OPS_PER_THREAD + op_i;
+  }
+  /* Existing keys, keys are offset by one to not use null pointers. */
+  return hash_number(thread_i * OPS_PER_THREAD + op_i) % KEYS_NUM + 1;
+}
+
+static double ghash_mutex_run(const int threads_num)
+{
+  GHash *gh = BLI_ghash_ptr_new(__func__);
+  ThreadMutex mutex;
+  BLI_mutex_init(&mutex);
+  for (uintptr_t key = 1; key <= KEYS_NUM; key++) {
+    BLI_ghash_insert(gh, POINTER_FROM_UINT(key), POINTER_FROM_UINT(key));
+  }
+  const double time = run_threads(threads_num, [&](const uint thread_i, const uint op_i) {
+    const uintptr_t key = op_key(thread_i, op_i);
+    BLI_mutex_lock(&mutex);
+    if (op_i % ADD_FREQUENCY == 0) {
+      BLI_ghash_insert(gh, POINTER_FROM_UINT(key), POINTER_FROM_UINT(key));
+    }
+    else {
+      void *value = BLI_ghash_lookup(gh, POINTER_FROM_UINT(key));
+      EXPECT_EQ(value, POINTER_FROM_UINT(key));
+    }
+    BLI_mutex_unlock(&mutex);
+  });
+  BLI_mutex_end(&mutex);
+  BLI_ghash_free(gh, nullptr, nullptr);
+  return time;
+}
+
+static double concurrent_ghash_run(const int threads_num)
+{
+  ConcurrentGHash *cgh = BLI_concurrent_ghash_ptr_new(__func__);
+  for (uintptr_t key = 1; key <= KEYS_NUM; key++) {
+    BLI_concurrent_ghash_add(cgh, POINTER_FROM_UINT(key), POINTER_FROM_UINT(key));
+  }
+  const double time = run_threads(threads_num, [&](const uint thread_i, const uint op_i) {
+    const uintptr_t key = op_key(thread_i, op_i);
+    if (op_i % ADD_FREQUENCY == 0) {
+      BLI_concurrent_ghash_add(cgh, POINTER_FROM_UINT(key), POINTER_FROM_UINT(key));
+    }
+    else {
+      void *value = BLI_concurrent_ghash_lookup(cgh, POINTER_FROM_UINT(key));
+      EXPECT_EQ(value, POINTER_FROM_UINT(key));
+    }
+  });
+  BLI_concurrent_ghash_free(cgh, nullptr, nullptr);
+  return time;
+}
+
+static double concurrent_map_run(const int threads_num)
+{
+  ConcurrentMap<uintptr_t, uintptr_t> map;
+  for (uintptr_t key = 1; key <= KEYS_NUM; key++) {
+    map.add(key, key);
+  }
+  const double time = run_threads(threads_num, [&](const uint thread_i, const uint op_i) {
+    const uintptr_t key = op_key(thread_i, op_i);
+    if (op_i % ADD_FREQUENCY == 0) {
+      map.add(key, key);
+    }
+    else {
+      EXPECT_EQ(map.lookup_default(key, 0), key);
+    }
+  });
+  return time;
+}
+
+TEST(concurrent_map, GHashMutexComparison)
+{
+  const char *id = "ConcurrentMap vs. GHash + mutex";
+  printf("\n========== STARTING %s ==========\n", id);
+  printf("%8s %16s %16s %16s\n", "threads", "GHash + mutex", "ConcurrentGHash", "ConcurrentMap");
+  for (int threads_num = 1; threads_num <= 64; threads_num *= 2) {
+    const double time_ghash = ghash_mutex_run(threads_num);
+    const double time_concurrent_ghash = concurrent_ghash_run(threads_num);
+    const double time_concurrent_map = concurrent_map_run(threads_num);
+    printf("%8d %15.3fs %15.3fs %15.3fs\n",
+           threads_num,
+           time_ghash,
+           time_concurrent_ghash,
+           time_concurrent_map);
+  }
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+}  // namespace blender::tests
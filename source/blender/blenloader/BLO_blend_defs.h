@@ -50,6 +50,11 @@ enum {
    * (written to #BLENDER_STARTUP_FILE & #BLENDER_USERPREF_FILE).
    */
   USER = BLEND_MAKE_ID('U', 'S', 'E', 'R'),
+  /**
+   * Index of the blocks making up the content of an incrementally saved file,
+   * appended after its first #ENDB, so it's ignored by readers that stop there.
+   */
+  INDX = BLEND_MAKE_ID('I', 'N', 'D', 'X'),
   /**
    * Terminate reading (no data).
    */
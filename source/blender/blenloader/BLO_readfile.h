@@ -270,6 +270,12 @@ struct LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh);
  */
 void BLO_blendhandle_close(BlendHandle *bh);
 
+/**
+ * Free the #BHead lists of library files kept in memory to speed up linking from them again.
+ * Files opened with #BLO_blendhandle_from_file and libraries read when loading a file are cached.
+ */
+void BLO_bhead_index_cache_clear(void);
+
 /** \} */
 
 #define BLO_GROUP_MAX 32
@@ -20,6 +20,12 @@ typedef struct {
   size_t size;
   /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
   bool is_identical;
+  /**
+   * When true, this chunk doesn't own the memory either, it's shared with a #MemFileChunk of the
+   * previous step that has the same content, but is not the matching chunk of the same ID
+   * (so unlike #is_identical, this does not mean that the data is unchanged).
+   */
+  bool is_shared;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -27,6 +33,8 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** Hash of the content, only computed for chunks large enough to be shared by content. */
+  uint hash;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -43,6 +51,8 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /** Maps content hashes to a reference MemFileChunk with that hash, if existing. */
+  struct GHash *content_hash_mapping;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -83,6 +93,12 @@ extern void BLO_memfile_free(MemFile *memfile);
  * to keep list of memfiles consistent, 'first' is always first in list.
  */
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
+/**
+ * Copy all chunks of \a memfile_src into the empty \a memfile_dst, which owns all of its
+ * buffers afterwards and can therefore outlive \a memfile_src (and the undo steps sharing its
+ * memory).
+ */
+extern void BLO_memfile_copy(const MemFile *memfile_src, MemFile *memfile_dst);
 /**
  * Clear is_identical_future before adding next memfile.
  */
@@ -45,6 +45,15 @@ struct BlendFileWriteParams {
   /** On write, restore paths after editing them (see #BLO_WRITE_PATH_REMAP_RELATIVE). */
   uint use_save_as_copy : 1;
   uint use_userdef : 1;
+  /**
+   * Only append the data-blocks that changed since the previous save of this file in this
+   * session, along with an index of the blocks to read. The whole file is written when it can't
+   * be appended to (first save, compressed file, too much unused data in it...).
+   *
+   * Appending is done in place and makes no version backups. Older Blender versions only read
+   * the content of the file from its last complete write.
+   */
+  uint use_incremental : 1;
   const struct BlendThumbnail *thumb;
 };
 
@@ -57,6 +66,11 @@ extern bool BLO_write_file(struct Main *mainvar,
                            const struct BlendFileWriteParams *params,
                            struct ReportList *reports);
 
+/**
+ * Free what is kept about the last saved file for incremental saves.
+ */
+extern void BLO_write_file_incremental_clear(void);
+
 /**
  * \return Success.
  */
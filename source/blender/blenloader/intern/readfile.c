@@ -53,6 +53,7 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "PIL_time.h"
@@ -165,9 +166,24 @@
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
+/**
+ * Decode the data blocks of large data-blocks (reading, endian switching and DNA reconstruction)
+ * on multiple threads, when the #FileReader supports thread-safe positional reads.
+ * Only the insertion into #FileData.datamap and the linking itself stay single threaded.
+ */
+#define USE_PARALLEL_DATA_READ
+
 /** Use #GHash for #BHead name-based lookups (speeds up linking). */
 #define USE_GHASH_BHEAD
 
+/**
+ * Keep the #BHead list of files opened for linking in memory, so linking from the same library
+ * again doesn't scan (and possibly decompress) the whole file. See #bhead_index_cache_store.
+ *
+ * \note Requires #USE_BHEAD_READ_ON_DEMAND, since the content of data blocks is not cached.
+ */
+#define USE_BHEAD_INDEX_CACHE
+
 /** Use #GHash for restoring pointers by name. */
 #define USE_GHASH_RESTORE_POINTER
 
@@ -663,6 +679,216 @@ static Main *blo_find_main(FileData *fd, const char *filepath, const char *relab
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BHead Index Cache
+ *
+ * Linking needs the list of all #BHead's of a library file to find IDs by name, building it
+ * requires reading through the whole file, even when only a single ID is linked from it.
+ * For compressed files this even means decompressing the entire file.
+ *
+ * The #BHead list of files opened for linking is therefore kept in memory once it has been read
+ * completely, and reused the next time the same (unmodified) file is opened. Only the content of
+ * non-#DATA blocks is stored (ID structs, DNA, ...), the content of #DATA blocks is read from the
+ * file when needed, so linking only touches the bytes of the IDs that are actually read.
+ * \{ */
+
+#ifdef USE_BHEAD_INDEX_CACHE
+
+/** Memory limit for all cached #BHead lists, least recently used files are removed first. */
+#  define BHEAD_INDEX_CACHE_SIZE_MAX ((size_t)256 << 20)
+
+typedef struct BHeadIndexCacheEntry {
+  struct BHeadIndexCacheEntry *next, *prev;
+
+  char filepath[FILE_MAX];
+  /** Used to detect files that have been modified since they were cached. */
+  BlendFileStat file_stat;
+
+  /** Copies of all #BHeadN of the file, followed by their content when they have data. */
+  void *data;
+  size_t data_size;
+} BHeadIndexCacheEntry;
+
+static struct {
+  /** Most recently used entries come first. */
+  ListBase entries;
+  size_t size;
+  ThreadMutex mutex;
+} bhead_index_cache = {{NULL, NULL}, 0, BLI_MUTEX_INITIALIZER};
+
+/** Size of the #BHeadN allocation, including its content when it has been read. */
+BLI_INLINE size_t bheadn_alloc_size(const BHeadN *bheadn)
+{
+  return sizeof(BHeadN) + (bheadn->has_data ? (size_t)bheadn->bhead.len : 0);
+}
+
+/** Size of a #BHeadN in #BHeadIndexCacheEntry.data, padded to keep the next one aligned. */
+BLI_INLINE size_t bhead_index_cache_item_size(const BHeadN *bheadn)
+{
+  return (bheadn_alloc_size(bheadn) + 7) & ~(size_t)7;
+}
+
+static void bhead_index_cache_entry_free(BHeadIndexCacheEntry *entry)
+{
+  BLI_remlink(&bhead_index_cache.entries, entry);
+  bhead_index_cache.size -= entry->data_size;
+  MEM_freeN(entry->data);
+  MEM_freeN(entry);
+}
+
+static BHeadIndexCacheEntry *bhead_index_cache_entry_find(const char *filepath)
+{
+  LISTBASE_FOREACH (BHeadIndexCacheEntry *, entry, &bhead_index_cache.entries) {
+    if (BLI_path_cmp(entry->filepath, filepath) == 0) {
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Get the identity of the file, to validate cached entries. The modification time alone only
+ * has a resolution of a second on some platforms.
+ */
+static bool bhead_index_cache_file_stat(const char *filepath, BlendFileStat *r_stat)
+{
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) == -1) {
+    return false;
+  }
+  memset(r_stat, 0, sizeof(*r_stat));
+  r_stat->size = (int64_t)st.st_size;
+  r_stat->mtime = (int64_t)st.st_mtime;
+#  if defined(__APPLE__)
+  r_stat->mtime_nsec = (int64_t)st.st_mtimespec.tv_nsec;
+#  elif !defined(WIN32)
+  r_stat->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+#  endif
+  r_stat->inode = (uint64_t)st.st_ino;
+  return true;
+}
+
+static bool bhead_index_cache_file_stat_equal(const BlendFileStat *a, const BlendFileStat *b)
+{
+  return a->size == b->size && a->mtime == b->mtime && a->mtime_nsec == b->mtime_nsec &&
+         a->inode == b->inode;
+}
+
+/**
+ * Fill the #BHead list of \a fd from the cache, when its file has been cached before.
+ * Otherwise, tag \a fd so that its #BHead list is cached once it has been read completely.
+ */
+static void bhead_index_cache_restore_or_tag(FileData *fd)
+{
+  BLI_assert(BLI_listbase_is_empty(&fd->bhead_list));
+
+  if (fd->file->seek == NULL || !bhead_index_cache_file_stat(fd->relabase, &fd->file_stat)) {
+    /* Data of files that can't seek is not read on demand, so it would have to be cached too. */
+    return;
+  }
+
+  BLI_mutex_lock(&bhead_index_cache.mutex);
+
+  BHeadIndexCacheEntry *entry = bhead_index_cache_entry_find(fd->relabase);
+  if (entry != NULL && !bhead_index_cache_file_stat_equal(&entry->file_stat, &fd->file_stat)) {
+    /* The file changed on disk. */
+    bhead_index_cache_entry_free(entry);
+    entry = NULL;
+  }
+
+  if (entry == NULL) {
+    BLI_mutex_unlock(&bhead_index_cache.mutex);
+    fd->use_bhead_index_cache = true;
+    return;
+  }
+
+  /* Move to the front, so that it is removed last. */
+  BLI_remlink(&bhead_index_cache.entries, entry);
+  BLI_addhead(&bhead_index_cache.entries, entry);
+
+  const char *data = entry->data;
+  const char *data_end = data + entry->data_size;
+  while (data < data_end) {
+    const BHeadN *bheadn_cached = (const BHeadN *)data;
+    const size_t item_size = bhead_index_cache_item_size(bheadn_cached);
+    BHeadN *new_bhead = MEM_mallocN(bheadn_alloc_size(bheadn_cached), "new_bhead");
+    memcpy(new_bhead, bheadn_cached, bheadn_alloc_size(bheadn_cached));
+    new_bhead->next = new_bhead->prev = NULL;
+    BLI_addtail(&fd->bhead_list, new_bhead);
+    data += item_size;
+  }
+
+  BLI_mutex_unlock(&bhead_index_cache.mutex);
+
+  /* The list is complete, nothing has to be read from the file anymore. */
+  fd->is_eof = true;
+}
+
+/**
+ * Store a copy of the complete #BHead list of \a fd in the cache.
+ */
+static void bhead_index_cache_store(FileData *fd)
+{
+  BLI_assert(fd->is_eof);
+
+  if (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_IS_MEMFILE)) {
+    /* Reading structs switches the endianness of the #BHead content in-place. */
+    return;
+  }
+
+  size_t data_size = 0;
+  LISTBASE_FOREACH (const BHeadN *, bheadn, &fd->bhead_list) {
+    data_size += bhead_index_cache_item_size(bheadn);
+  }
+  if (data_size == 0 || data_size > BHEAD_INDEX_CACHE_SIZE_MAX / 4) {
+    return;
+  }
+
+  BHeadIndexCacheEntry *new_entry = MEM_callocN(sizeof(*new_entry), __func__);
+  STRNCPY(new_entry->filepath, fd->relabase);
+  new_entry->file_stat = fd->file_stat;
+  new_entry->data = MEM_mallocN(data_size, __func__);
+  new_entry->data_size = data_size;
+
+  char *data = new_entry->data;
+  LISTBASE_FOREACH (const BHeadN *, bheadn, &fd->bhead_list) {
+    const size_t item_size = bhead_index_cache_item_size(bheadn);
+    memcpy(data, bheadn, bheadn_alloc_size(bheadn));
+    data += item_size;
+  }
+
+  BLI_mutex_lock(&bhead_index_cache.mutex);
+
+  BHeadIndexCacheEntry *entry = bhead_index_cache_entry_find(fd->relabase);
+  if (entry != NULL) {
+    bhead_index_cache_entry_free(entry);
+  }
+  while (bhead_index_cache.entries.last != NULL &&
+         bhead_index_cache.size + data_size > BHEAD_INDEX_CACHE_SIZE_MAX) {
+    bhead_index_cache_entry_free(bhead_index_cache.entries.last);
+  }
+  BLI_addhead(&bhead_index_cache.entries, new_entry);
+  bhead_index_cache.size += data_size;
+
+  BLI_mutex_unlock(&bhead_index_cache.mutex);
+}
+
+#endif /* USE_BHEAD_INDEX_CACHE */
+
+void BLO_bhead_index_cache_clear(void)
+{
+#ifdef USE_BHEAD_INDEX_CACHE
+  BLI_mutex_lock(&bhead_index_cache.mutex);
+  while (bhead_index_cache.entries.first != NULL) {
+    bhead_index_cache_entry_free(bhead_index_cache.entries.first);
+  }
+  BLI_assert(bhead_index_cache.size == 0);
+  BLI_mutex_unlock(&bhead_index_cache.mutex);
+#endif
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name File Parsing
  * \{ */
@@ -749,11 +975,100 @@ static void bh8_from_bh4(BHead *bhead, BHead4 *bhead4)
   }
 }
 
+/**
+ * Incrementally saved files (see #BlendFileWriteParams.use_incremental) keep their originally
+ * saved content, followed by segments that only contain the blocks of data-blocks that changed.
+ * The file ends with an #INDX block listing the groups of blocks making up its current content,
+ * and an #ENDB block whose old address is the file offset of that #INDX block.
+ *
+ * Readers unaware of this stop at the first #ENDB and see the originally saved content.
+ */
+static void file_index_read(FileData *fd)
+{
+  FileReader *file = fd->file;
+  if (file->seek == NULL ||
+      (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS | FD_FLAGS_IS_MEMFILE))) {
+    /* Incremental saves are only written to uncompressed files, in native format. */
+    return;
+  }
+
+  const off64_t header_end = file->offset;
+  const off64_t file_size = file->seek(file, 0, SEEK_END);
+  BHead bhead;
+  if (file_size < header_end + (off64_t)sizeof(BHead) ||
+      file->seek(file, file_size - (off64_t)sizeof(BHead), SEEK_SET) == -1 ||
+      file->read(file, &bhead, sizeof(bhead)) != sizeof(bhead) || bhead.code != ENDB ||
+      bhead.old == NULL) {
+    file->seek(file, header_end, SEEK_SET);
+    return;
+  }
+
+  const off64_t index_offset = (off64_t)(uintptr_t)bhead.old;
+  BlendFileIndexGroup *groups = NULL;
+  int groups_num = 0;
+  if (index_offset >= header_end && index_offset < file_size &&
+      file->seek(file, index_offset, SEEK_SET) != -1 &&
+      file->read(file, &bhead, sizeof(bhead)) == sizeof(bhead) && bhead.code == INDX &&
+      bhead.len > 0 && (bhead.len % sizeof(BlendFileIndexGroup)) == 0 &&
+      index_offset + (off64_t)sizeof(BHead) + bhead.len <= file_size) {
+    groups = MEM_mallocN((size_t)bhead.len, __func__);
+    groups_num = bhead.len / (int)sizeof(BlendFileIndexGroup);
+    if (file->read(file, groups, (size_t)bhead.len) != bhead.len) {
+      groups_num = 0;
+    }
+    for (int i = 0; i < groups_num; i++) {
+      if (groups[i].offset < (uint64_t)header_end || groups[i].len < sizeof(BHead) ||
+          groups[i].offset + groups[i].len > (uint64_t)file_size) {
+        groups_num = 0;
+        break;
+      }
+    }
+  }
+
+  if (groups_num != 0) {
+    fd->file_index.groups = groups;
+    fd->file_index.groups_num = groups_num;
+    fd->file_index.group_next = 0;
+    /* Jump to the first group right after the header. */
+    fd->file_index.group_end = header_end;
+  }
+  else {
+    CLOG_WARN(&LOG, "Invalid index of incrementally saved file '%s', ignoring it", fd->relabase);
+    MEM_SAFE_FREE(groups);
+  }
+
+  file->seek(file, header_end, SEEK_SET);
+}
+
+/**
+ * Move to the next group of blocks of an incrementally saved file once the current one has
+ * been read, so the blocks are read as if the file had been written in one go.
+ */
+static bool file_index_seek_next_group(FileData *fd)
+{
+  if (fd->file->offset != fd->file_index.group_end ||
+      fd->file_index.group_next == fd->file_index.groups_num) {
+    return true;
+  }
+  const BlendFileIndexGroup *group = &fd->file_index.groups[fd->file_index.group_next++];
+  if (fd->file->seek(fd->file, (off64_t)group->offset, SEEK_SET) == -1) {
+    return false;
+  }
+  fd->file_index.group_end = (int64_t)(group->offset + group->len);
+  return true;
+}
+
 static BHeadN *get_bhead(FileData *fd)
 {
   BHeadN *new_bhead = NULL;
   ssize_t readsize;
 
+  if (fd && !fd->is_eof && fd->file_index.groups != NULL) {
+    if (!file_index_seek_next_group(fd)) {
+      fd->is_eof = true;
+    }
+  }
+
   if (fd) {
     if (!fd->is_eof) {
       /* initializing to zero isn't strictly needed but shuts valgrind up
@@ -886,6 +1201,13 @@ static BHeadN *get_bhead(FileData *fd)
   if (new_bhead) {
     BLI_addtail(&fd->bhead_list, new_bhead);
   }
+#ifdef USE_BHEAD_INDEX_CACHE
+  else if (fd && fd->is_eof && fd->use_bhead_index_cache) {
+    /* The whole list has been read, store it for the next time this file is opened. */
+    fd->use_bhead_index_cache = false;
+    bhead_index_cache_store(fd);
+  }
+#endif
 
   return new_bhead;
 }
@@ -968,7 +1290,20 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
-static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
+/**
+ * Same as #blo_bhead_read_data, but uses #FileReader.pread so the file position is left as is,
+ * which makes it safe to call from multiple threads at once.
+ */
+static bool blo_bhead_pread_data(FileData *fd, BHead *thisblock, void *buf)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  BLI_assert((fd->flags & FD_FLAGS_IS_MEMFILE) == 0);
+  return fd->file->pread(fd->file, buf, (size_t)new_bhead->bhead.len, new_bhead->file_offset) ==
+         new_bhead->bhead.len;
+}
+
+static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock, const bool use_pread)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BHeadN *new_bhead_data = MEM_mallocN(sizeof(BHeadN) + new_bhead->bhead.len, "new_bhead");
@@ -976,7 +1311,9 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
   new_bhead_data->is_memchunk_identical = false;
-  if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
+  const bool success = use_pread ? blo_bhead_pread_data(fd, thisblock, new_bhead_data + 1) :
+                                   blo_bhead_read_data(fd, thisblock, new_bhead_data + 1);
+  if (!success) {
     MEM_freeN(new_bhead_data);
     return NULL;
   }
@@ -1159,6 +1496,8 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
   decode_blender_header(fd);
 
   if (fd->flags & FD_FLAGS_FILE_OK) {
+    file_index_read(fd);
+
     const char *error_message = NULL;
     if (read_file_dna(fd, &error_message) == false) {
       BKE_reportf(
@@ -1270,6 +1609,22 @@ FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *repo
   return NULL;
 }
 
+FileData *blo_filedata_from_file_cached(const char *filepath, BlendFileReadReport *reports)
+{
+  FileData *fd = blo_filedata_from_file_open(filepath, reports);
+  if (fd != NULL) {
+    /* needed for library_append and read_libraries */
+    BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
+
+#ifdef USE_BHEAD_INDEX_CACHE
+    bhead_index_cache_restore_or_tag(fd);
+#endif
+
+    return blo_decode_and_check(fd, reports->reports);
+  }
+  return NULL;
+}
+
 /**
  * Same as blo_filedata_from_file(), but does not reads DNA data, only header.
  * Use it for light access (e.g. thumbnail reading).
@@ -1280,6 +1635,7 @@ static FileData *blo_filedata_from_file_minimal(const char *filepath)
   if (fd != NULL) {
     decode_blender_header(fd);
     if (fd->flags & FD_FLAGS_FILE_OK) {
+      file_index_read(fd);
       return fd;
     }
     blo_filedata_free(fd);
@@ -1352,6 +1708,8 @@ void blo_filedata_free(FileData *fd)
 #endif
     fd->file->close(fd->file);
 
+    MEM_SAFE_FREE(fd->file_index.groups);
+
     if (fd->filesdna) {
       DNA_sdna_free(fd->filesdna);
     }
@@ -1857,7 +2215,15 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Read and convert the data of \a bh to the current DNA.
+ *
+ * \param use_pread: Read delayed data with #FileReader.pread, the #FileData is then only read
+ * from, so this may be called from multiple threads.
+ * \param r_read_error: Set when the data could not be read from the file.
+ */
+static void *read_struct_ex(
+    FileData *fd, BHead *bh, const char *blockname, const bool use_pread, bool *r_read_error)
 {
   void *temp = NULL;
 
@@ -1870,9 +2236,9 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
     if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-        bh = blo_bhead_read_full(fd, bh);
+        bh = blo_bhead_read_full(fd, bh, use_pread);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_read_error = true;
           return NULL;
         }
       }
@@ -1884,9 +2250,9 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
+          bh = blo_bhead_read_full(fd, bh, use_pread);
           if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_read_error = true;
             return NULL;
           }
         }
@@ -1903,13 +2269,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
         else {
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
-          if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+          const bool success = use_pread ? blo_bhead_pread_data(fd, bh, temp) :
+                                           blo_bhead_read_data(fd, bh, temp);
+          if (UNLIKELY(!success)) {
+            *r_read_error = true;
             MEM_freeN(temp);
             temp = NULL;
           }
         }
 #else
+        UNUSED_VARS(use_pread);
         memcpy(temp, (bh + 1), bh->len);
 #endif
       }
@@ -1925,6 +2294,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  bool read_error = false;
+  void *temp = read_struct_ex(fd, bh, blockname, false, &read_error);
+  if (UNLIKELY(read_error)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -3049,11 +3428,104 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+#ifdef USE_PARALLEL_DATA_READ
+
+/** Below this amount of bytes, decoding the data of a data-block is not worth the threading. */
+#  define PARALLEL_DATA_READ_MIN_SIZE (1 << 20)
+
+typedef struct ParallelDataReadData {
+  FileData *fd;
+  BHead **bheads;
+  void **datas;
+  bool *read_errors;
+  const char *allocname;
+} ParallelDataReadData;
+
+static void read_data_into_datamap_parallel_fn(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ParallelDataReadData *data = userdata;
+  data->datas[i] = read_struct_ex(
+      data->fd, data->bheads[i], data->allocname, true, &data->read_errors[i]);
+}
+
+/**
+ * Gather all data blocks of a data-block first (this only reads the #BHead headers, the actual
+ * data is delayed, see #USE_BHEAD_READ_ON_DEMAND), then read and decode them in parallel.
+ * Insertion into the data-map is done afterwards, in file order.
+ */
+static BHead *read_data_into_datamap_parallel(FileData *fd, BHead *bhead, const char *allocname)
+{
+  int bheads_len = 0;
+  int bheads_capacity = 32;
+  BHead **bheads = MEM_mallocN(sizeof(*bheads) * (size_t)bheads_capacity, __func__);
+  size_t data_size = 0;
+
+  while (bhead && bhead->code == DATA) {
+    if (bheads_len == bheads_capacity) {
+      bheads_capacity *= 2;
+      bheads = MEM_reallocN(bheads, sizeof(*bheads) * (size_t)bheads_capacity);
+    }
+    bheads[bheads_len++] = bhead;
+    data_size += (size_t)bhead->len;
+
+    bhead = blo_bhead_next(fd, bhead);
+  }
+
+  if (bheads_len < 2 || data_size < PARALLEL_DATA_READ_MIN_SIZE) {
+    for (int i = 0; i < bheads_len; i++) {
+      void *data = read_struct(fd, bheads[i], allocname);
+      if (data) {
+        oldnewmap_insert(fd->datamap, bheads[i]->old, data, 0);
+      }
+    }
+    MEM_freeN(bheads);
+    return bhead;
+  }
+
+  ParallelDataReadData data = {
+      .fd = fd,
+      .bheads = bheads,
+      .datas = MEM_malloc_arrayN((size_t)bheads_len, sizeof(void *), __func__),
+      .read_errors = MEM_calloc_arrayN((size_t)bheads_len, sizeof(bool), __func__),
+      .allocname = allocname,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, bheads_len, &data, read_data_into_datamap_parallel_fn, &settings);
+
+  for (int i = 0; i < bheads_len; i++) {
+    if (UNLIKELY(data.read_errors[i])) {
+      fd->flags &= ~FD_FLAGS_FILE_OK;
+    }
+    if (data.datas[i]) {
+      oldnewmap_insert(fd->datamap, bheads[i]->old, data.datas[i], 0);
+    }
+  }
+
+  MEM_freeN(data.read_errors);
+  MEM_freeN(data.datas);
+  MEM_freeN(bheads);
+
+  return bhead;
+}
+
+#endif /* USE_PARALLEL_DATA_READ */
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
   bhead = blo_bhead_next(fd, bhead);
 
+#ifdef USE_PARALLEL_DATA_READ
+  if (fd->file->pread != NULL) {
+    return read_data_into_datamap_parallel(fd, bhead, allocname);
+  }
+#endif
+
   while (bhead && bhead->code == DATA) {
     /* The code below is useful for debugging leaks in data read from the blend file.
      * Without this the messages only tell us what ID-type the memory came from,
@@ -3556,6 +4028,19 @@ static void do_versions_userdef(FileData *UNUSED(fd), BlendFileData *bfd)
   blo_do_versions_userdef(user);
 }
 
+/**
+ * Call a versioning function, printing the time spent in it with `--debug-io`.
+ */
+#define DO_VERSIONS_TIMED(fn, args) \
+  { \
+    const double _time_start = PIL_check_seconds_timer(); \
+    fn args; \
+    if (G.debug & G_DEBUG_IO) { \
+      printf("  %-34s %.4fs\n", #fn, PIL_check_seconds_timer() - _time_start); \
+    } \
+  } \
+  ((void)0)
+
 static void do_versions(FileData *fd, Library *lib, Main *main)
 {
   /* WATCH IT!!!: pointers from libdata have not been converted */
@@ -3584,14 +4069,21 @@ static void do_versions(FileData *fd, Library *lib, Main *main)
               main->build_hash);
   }
 
-  blo_do_versions_pre250(fd, lib, main);
-  blo_do_versions_250(fd, lib, main);
-  blo_do_versions_260(fd, lib, main);
-  blo_do_versions_270(fd, lib, main);
-  blo_do_versions_280(fd, lib, main);
-  blo_do_versions_290(fd, lib, main);
-  blo_do_versions_300(fd, lib, main);
-  blo_do_versions_cycles(fd, lib, main);
+  if (G.debug & G_DEBUG_IO) {
+    printf("Versioning '%s' (%d.%d):\n",
+           main->curlib ? main->curlib->filepath : fd->relabase,
+           main->versionfile,
+           main->subversionfile);
+  }
+
+  DO_VERSIONS_TIMED(blo_do_versions_pre250, (fd, lib, main));
+  DO_VERSIONS_TIMED(blo_do_versions_250, (fd, lib, main));
+  DO_VERSIONS_TIMED(blo_do_versions_260, (fd, lib, main));
+  DO_VERSIONS_TIMED(blo_do_versions_270, (fd, lib, main));
+  DO_VERSIONS_TIMED(blo_do_versions_280, (fd, lib, main));
+  DO_VERSIONS_TIMED(blo_do_versions_290, (fd, lib, main));
+  DO_VERSIONS_TIMED(blo_do_versions_300, (fd, lib, main));
+  DO_VERSIONS_TIMED(blo_do_versions_cycles, (fd, lib, main));
 
   /* WATCH IT!!!: pointers from libdata have not been converted yet here! */
   /* WATCH IT 2!: Userdef struct init see do_versions_userdef() above! */
@@ -3614,13 +4106,20 @@ static void do_versions_after_linking(Main *main, ReportList *reports)
   /* Don't allow versioning to create new data-blocks. */
   main->is_locked_for_linking = true;
 
-  do_versions_after_linking_250(main);
-  do_versions_after_linking_260(main);
-  do_versions_after_linking_270(main);
-  do_versions_after_linking_280(main, reports);
-  do_versions_after_linking_290(main, reports);
-  do_versions_after_linking_300(main, reports);
-  do_versions_after_linking_cycles(main);
+  if (G.debug & G_DEBUG_IO) {
+    printf("Versioning after linking '%s' (%d.%d):\n",
+           main->curlib ? main->curlib->filepath : main->filepath,
+           main->versionfile,
+           main->subversionfile);
+  }
+
+  DO_VERSIONS_TIMED(do_versions_after_linking_250, (main));
+  DO_VERSIONS_TIMED(do_versions_after_linking_260, (main));
+  DO_VERSIONS_TIMED(do_versions_after_linking_270, (main));
+  DO_VERSIONS_TIMED(do_versions_after_linking_280, (main, reports));
+  DO_VERSIONS_TIMED(do_versions_after_linking_290, (main, reports));
+  DO_VERSIONS_TIMED(do_versions_after_linking_300, (main, reports));
+  DO_VERSIONS_TIMED(do_versions_after_linking_cycles, (main));
 
   main->is_locked_for_linking = false;
 }
@@ -3824,6 +4323,37 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 /** \name Read File (Internal)
  * \{ */
 
+static void read_file_id_type_stats_add(FileData *fd, const short idcode, const double duration)
+{
+  const int index = BKE_idtype_idcode_to_index(idcode);
+  if (index < 0 || index >= INDEX_ID_MAX) {
+    return;
+  }
+  fd->id_type_stats.duration[index] += duration;
+  fd->id_type_stats.count[index]++;
+}
+
+/** Print the time spent reading local data-blocks per ID type, used with `--debug-io`. */
+static void read_file_id_type_stats_print(FileData *fd)
+{
+  double duration_total = 0.0;
+  for (int i = 0; i < INDEX_ID_MAX; i++) {
+    duration_total += fd->id_type_stats.duration[i];
+  }
+
+  printf("Read data-blocks of '%s' in %.4fs:\n", fd->relabase, duration_total);
+  for (int i = 0; i < INDEX_ID_MAX; i++) {
+    if (fd->id_type_stats.count[i] == 0) {
+      continue;
+    }
+    const short idcode = BKE_idtype_idcode_from_index(i);
+    printf("  %-16s %8d in %.4fs\n",
+           BKE_idtype_idcode_to_name_plural(idcode),
+           fd->id_type_stats.count[i],
+           fd->id_type_stats.duration[i]);
+  }
+}
+
 BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 {
   BHead *bhead = blo_bhead_first(fd);
@@ -3914,12 +4444,22 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
         if (fd->skip_flags & BLO_READ_SKIP_DATA) {
           bhead = blo_bhead_next(fd, bhead);
         }
+        else if (G.debug & G_DEBUG_IO) {
+          const short idcode = (short)bhead->code;
+          const double time_start = PIL_check_seconds_timer();
+          bhead = read_libblock(fd, bfd->main, bhead, LIB_TAG_LOCAL, false, NULL);
+          read_file_id_type_stats_add(fd, idcode, PIL_check_seconds_timer() - time_start);
+        }
         else {
           bhead = read_libblock(fd, bfd->main, bhead, LIB_TAG_LOCAL, false, NULL);
         }
     }
   }
 
+  if ((G.debug & G_DEBUG_IO) && (fd->flags & FD_FLAGS_IS_MEMFILE) == 0) {
+    read_file_id_type_stats_print(fd);
+  }
+
   /* do before read_libraries, but skip undo case */
   if ((fd->flags & FD_FLAGS_IS_MEMFILE) == 0) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
@@ -4804,7 +5344,7 @@ static FileData *read_library_file_data(FileData *basefd,
                      mainptr->curlib->filepath_abs,
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, basefd->reports);
+    fd = blo_filedata_from_file_cached(mainptr->curlib->filepath_abs, basefd->reports);
   }
 
   if (fd) {
@@ -44,6 +44,30 @@ enum eFileDataFlag {
 #  pragma GCC poison off_t
 #endif
 
+/**
+ * Element of the #INDX block at the end of incrementally saved files
+ * (see #BlendFileWriteParams.use_incremental):
+ * a non-#DATA block followed by its #DATA blocks, in the order they have to be read.
+ */
+typedef struct BlendFileIndexGroup {
+  uint64_t offset;
+  uint64_t len;
+} BlendFileIndexGroup;
+
+/**
+ * Identifies the content of a file on disk, to validate its entry in the #BHead index cache.
+ * Blender replaces files when saving them (giving them a new inode) or appends to them, so
+ * a file with the same identity can be assumed to be unmodified.
+ */
+typedef struct BlendFileStat {
+  int64_t size;
+  int64_t mtime;
+  /** Sub-second part of the modification time, zero when the platform doesn't provide it. */
+  int64_t mtime_nsec;
+  /** Zero when the file system doesn't provide it. */
+  uint64_t inode;
+} BlendFileStat;
+
 typedef struct FileData {
   /** Linked list of BHeadN's. */
   ListBase bhead_list;
@@ -104,6 +128,26 @@ typedef struct FileData {
   struct IDNameLib_Map *old_idmap;
 
   struct BlendFileReadReport *reports;
+
+  /** Store the #BHead list in the #BHead index cache once it has been read completely. */
+  bool use_bhead_index_cache;
+  /** Identity of the file, to validate its entry in the #BHead index cache. */
+  BlendFileStat file_stat;
+
+  /** Groups of blocks to read from an incrementally saved file, NULL for regular files. */
+  struct {
+    BlendFileIndexGroup *groups;
+    int groups_num;
+    int group_next;
+    /** Offset at which the group being read ends, the next group is read from there. */
+    int64_t group_end;
+  } file_index;
+
+  /** Time spent and number of data-blocks read per ID type, only gathered with `--debug-io`. */
+  struct {
+    double duration[INDEX_ID_MAX];
+    int count[INDEX_ID_MAX];
+  } id_type_stats;
 } FileData;
 
 #define SIZEOFBLENDERHEADER 12
@@ -121,6 +165,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath);
  * cannot be called with relative paths anymore!
  */
 FileData *blo_filedata_from_file(const char *filepath, struct BlendFileReadReport *reports);
+/**
+ * Same as #blo_filedata_from_file, but for files opened to link data from:
+ * the list of #BHead's is kept in memory after the file has been read entirely,
+ * and reused when the same file is opened again, instead of reading through the whole file.
+ */
+FileData *blo_filedata_from_file_cached(const char *filepath,
+                                        struct BlendFileReadReport *reports);
 FileData *blo_filedata_from_memory(const void *mem,
                                    int memsize,
                                    struct BlendFileReadReport *reports);
@@ -25,6 +25,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -38,12 +39,24 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/**
+ * Chunks smaller than this are not shared by content with chunks of the previous step,
+ * hashing them costs more than the memory it could save.
+ */
+#define MEMFILE_CHUNK_SHARE_MIN_SIZE 256
+
+/** Whether the chunk owns its buffer, i.e. it is not shared with a chunk of a previous step. */
+BLI_INLINE bool memfile_chunk_owns_buf(const MemFileChunk *chunk)
+{
+  return !(chunk->is_identical || chunk->is_shared);
+}
+
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
+    if (memfile_chunk_owns_buf(chunk)) {
       MEM_freeN((void *)chunk->buf);
     }
     MEM_freeN(chunk);
@@ -58,21 +71,26 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   GHash *buffer_to_second_memchunk = BLI_ghash_new(
       BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* First, detect all memchunks in second memfile that are not owned by it. Several of them may
+   * share the same buffer when they have the same content, one of them is enough. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (!memfile_chunk_owns_buf(sc)) {
+      void **entry;
+      if (!BLI_ghash_ensure_p(buffer_to_second_memchunk, (void *)sc->buf, &entry)) {
+        *entry = sc;
+      }
     }
   }
 
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
+    if (memfile_chunk_owns_buf(fc)) {
       MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
       if (sc != NULL) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(!memfile_chunk_owns_buf(sc));
         sc->is_identical = false;
+        sc->is_shared = false;
         fc->is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -86,6 +104,22 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   BLO_memfile_free(first);
 }
 
+void BLO_memfile_copy(const MemFile *memfile_src, MemFile *memfile_dst)
+{
+  BLI_assert(BLI_listbase_is_empty(&memfile_dst->chunks));
+
+  LISTBASE_FOREACH (const MemFileChunk *, chunk_src, &memfile_src->chunks) {
+    MemFileChunk *chunk_dst = MEM_callocN(sizeof(*chunk_dst), __func__);
+    char *buf = MEM_mallocN(chunk_src->size, __func__);
+    memcpy(buf, chunk_src->buf, chunk_src->size);
+    chunk_dst->buf = buf;
+    chunk_dst->size = chunk_src->size;
+    chunk_dst->id_session_uuid = chunk_src->id_session_uuid;
+    BLI_addtail(&memfile_dst->chunks, chunk_dst);
+    memfile_dst->size += chunk_dst->size;
+  }
+}
+
 void BLO_memfile_clear_future(MemFile *memfile)
 {
   LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
@@ -124,6 +158,21 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
         }
       }
     }
+
+    /* Also map the content of the chunks, to share memory with any chunk of the reference step
+     * that has the same content, not only the one at the matching position. This happens e.g. when
+     * data is moved to another ID, or with unchanged arrays of an ID that is re-created. */
+    mem_data->content_hash_mapping = BLI_ghash_new(
+        BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
+    LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &reference_memfile->chunks) {
+      if (mem_chunk->size >= MEMFILE_CHUNK_SHARE_MIN_SIZE) {
+        void **entry;
+        if (!BLI_ghash_ensure_p(
+                mem_data->content_hash_mapping, POINTER_FROM_UINT(mem_chunk->hash), &entry)) {
+          *entry = mem_chunk;
+        }
+      }
+    }
   }
 }
 
@@ -132,6 +181,9 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->content_hash_mapping != NULL) {
+    BLI_ghash_free(mem_data->content_hash_mapping, NULL, NULL);
+  }
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -143,6 +195,8 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->size = size;
   curchunk->buf = NULL;
   curchunk->is_identical = false;
+  curchunk->is_shared = false;
+  curchunk->hash = 0;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
@@ -157,12 +211,26 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
+        curchunk->hash = compchunk->hash;
         compchunk->is_identical_future = true;
       }
     }
     *compchunk_step = compchunk->next;
   }
 
+  /* Not equal, but there may be another chunk with the same content in the reference step. */
+  if (curchunk->buf == NULL && size >= MEMFILE_CHUNK_SHARE_MIN_SIZE) {
+    curchunk->hash = BLI_hash_mm2((const uchar *)buf, size, 0);
+    if (mem_data->content_hash_mapping != NULL) {
+      MemFileChunk *compchunk = BLI_ghash_lookup(mem_data->content_hash_mapping,
+                                                 POINTER_FROM_UINT(curchunk->hash));
+      if (compchunk != NULL && compchunk->size == size && memcmp(compchunk->buf, buf, size) == 0) {
+        curchunk->buf = compchunk->buf;
+        curchunk->is_shared = true;
+      }
+    }
+  }
+
   /* not equal... */
   if (curchunk->buf == NULL) {
     char *buf_new = MEM_mallocN(size, "Chunk buffer");
@@ -338,6 +406,7 @@ FileReader *BLO_memfile_new_filereader(MemFile *memfile, int undo_direction)
 
   undo->reader.read = undo_read;
   undo->reader.seek = NULL;
+  undo->reader.pread = NULL;
   undo->reader.close = undo_close;
 
   return (FileReader *)undo;
@@ -1167,6 +1167,19 @@ static void do_version_fcurve_hide_viewport_fix(struct ID *UNUSED(id),
   fcu->rna_path = BLI_strdupn("hide_viewport", 13);
 }
 
+static void do_versions_mesh_convert_mfaces_to_mpolys(ID *id, void *UNUSED(user_data))
+{
+  Mesh *me = (Mesh *)id;
+
+  /* Check if we need to convert mfaces to mpolys. */
+  if (me->totface && !me->totpoly) {
+    BKE_mesh_do_versions_convert_mfaces_to_mpolys(me);
+  }
+
+  /* Deprecated, only kept for conversion. */
+  BKE_mesh_tessface_clear(me);
+}
+
 void do_versions_after_linking_280(Main *bmain, ReportList *UNUSED(reports))
 {
   bool use_collection_compat_28 = true;
@@ -1605,22 +1618,14 @@ void do_versions_after_linking_280(Main *bmain, ReportList *UNUSED(reports))
     /* This versioning could probably be done only on earlier versions, not sure however
      * which exact version fully deprecated tessfaces, so think we can keep that one here, no
      * harm to be expected anyway for being over-conservative. */
-    for (Mesh *me = bmain->meshes.first; me != NULL; me = me->id.next) {
-      /* Check if we need to convert mfaces to mpolys. */
-      if (me->totface && !me->totpoly) {
-        /* temporarily switch main so that reading from
-         * external CustomData works */
-        Main *gmain = G_MAIN;
-        G_MAIN = bmain;
+    /* temporarily switch main so that reading from
+     * external CustomData works */
+    Main *gmain = G_MAIN;
+    G_MAIN = bmain;
 
-        BKE_mesh_do_versions_convert_mfaces_to_mpolys(me);
+    version_foreach_id_parallel(&bmain->meshes, do_versions_mesh_convert_mfaces_to_mpolys, NULL);
 
-        G_MAIN = gmain;
-      }
-
-      /* Deprecated, only kept for conversion. */
-      BKE_mesh_tessface_clear(me);
-    }
+    G_MAIN = gmain;
   }
 
   if (!MAIN_VERSION_ATLEAST(bmain, 282, 2)) {
@@ -14,6 +14,8 @@
 #include "BLI_listbase.h"
 #include "BLI_string.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "BKE_animsys.h"
 #include "BKE_lib_id.h"
@@ -24,7 +26,9 @@
 
 #include "versioning_common.h"
 
+using blender::IndexRange;
 using blender::StringRef;
+using blender::Vector;
 
 ARegion *do_versions_add_region_if_not_found(ListBase *regionbase,
                                              int region_type,
@@ -232,3 +236,20 @@ ARegion *do_versions_add_region(int regiontype, const char *name)
   region->regiontype = regiontype;
   return region;
 }
+
+void version_foreach_id_parallel(ListBase *lb,
+                                 void (*fn)(ID *id, void *user_data),
+                                 void *user_data)
+{
+  Vector<ID *> ids;
+  LISTBASE_FOREACH (ID *, id, lb) {
+    ids.append(id);
+  }
+
+  /* Versioning a single ID can be expensive (e.g. a large mesh), use the smallest grain size. */
+  blender::threading::parallel_for(ids.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      fn(ids[i], user_data);
+    }
+  });
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 struct ARegion;
+struct ID;
 struct ListBase;
 struct Main;
 struct bNodeTree;
@@ -88,6 +89,17 @@ struct bNodeSocket *version_node_add_socket_if_not_exist(struct bNodeTree *ntree
  * the flag on all sockets after changes to the node tree.
  */
 void version_socket_update_is_used(bNodeTree *ntree);
+
+/**
+ * Call \a fn for all IDs of \a lb in parallel, for versioning of large data.
+ *
+ * Only usable for versioning that is local to each ID: \a fn must not access other IDs, nor add
+ * or remove any. All calls are done when this returns, so versioning done before and after can
+ * depend on it as with a regular loop over \a lb.
+ */
+void version_foreach_id_parallel(struct ListBase *lb,
+                                 void (*fn)(struct ID *id, void *user_data),
+                                 void *user_data);
 ARegion *do_versions_add_region(int regiontype, const char *name);
 
 #ifdef __cplusplus
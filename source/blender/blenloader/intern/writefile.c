@@ -85,6 +85,8 @@
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
+#include "BLI_ghash.h"
+#include "BLI_hash_md5.h"
 #include "BLI_link_utils.h"
 #include "BLI_linklist.h"
 #include "BLI_math_base.h"
@@ -143,6 +145,8 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZSTD,
+  /** Append to an existing uncompressed file in place, for incremental saves. */
+  WW_WRAP_APPEND,
 } eWriteWrapType;
 
 typedef struct ZstdFrame {
@@ -202,6 +206,49 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
   return write(ww->file_handle, buf, buf_len);
 }
 
+/* append */
+static bool ww_open_append(WriteWrap *ww, const char *filepath)
+{
+  const int file = BLI_open(filepath, O_BINARY + O_WRONLY, 0666);
+  if (file == -1) {
+    return false;
+  }
+
+  if (BLI_lseek(file, 0, SEEK_END) == -1) {
+    close(file);
+    return false;
+  }
+
+  ww->file_handle = file;
+  return true;
+}
+
+/** Flush the data written so far to the disk, to order it before what is written next. */
+static bool ww_sync_append(WriteWrap *ww)
+{
+#ifdef WIN32
+  return (_commit(ww->file_handle) == 0);
+#else
+  return (fsync(ww->file_handle) == 0);
+#endif
+}
+
+/** Restore the original size of a file appended to, dropping everything written to it. */
+static bool ww_truncate_append(const char *filepath, const int64_t size)
+{
+  const int file = BLI_open(filepath, O_BINARY + O_WRONLY, 0666);
+  if (file == -1) {
+    return false;
+  }
+#ifdef WIN32
+  const bool ok = (_chsize_s(file, size) == 0);
+#else
+  const bool ok = (ftruncate(file, size) == 0);
+#endif
+  close(file);
+  return ok;
+}
+
 /* zstd */
 
 typedef struct {
@@ -374,6 +421,13 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = true;
       break;
     }
+    case WW_WRAP_APPEND: {
+      r_ww->open = ww_open_append;
+      r_ww->close = ww_close_none;
+      r_ww->write = ww_write_none;
+      r_ww->use_buf = true;
+      break;
+    }
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -386,6 +440,319 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Incremental File Writing
+ *
+ * Incremental saves (see #BlendFileWriteParams.use_incremental) only append the blocks of the
+ * data-blocks that changed since the previous save of the same file, followed by an #INDX block
+ * listing the groups of blocks making up the whole file, and an #ENDB block pointing to it
+ * (see `file_index_read` in `readfile.c`).
+ *
+ * Appending is done in place: the new blocks and the #INDX block are synced to the disk before
+ * the final #ENDB block is written. Until then the file doesn't end with a valid #ENDB block,
+ * so readers ignore the index and read the file as it was before the save.
+ *
+ * Data-blocks are matched with the previous save by session UUID and compared using a digest
+ * of their written blocks. Blocks written outside of data-blocks (#GLOB, #DNA1, libraries...)
+ * are small and always appended.
+ * \{ */
+
+/**
+ * Once more than this fraction of the file is taken by blocks that are not used anymore,
+ * the next incremental save rewrites the whole file instead.
+ */
+#define INCREMENTAL_GARBAGE_RATIO_MAX 0.5
+
+/** Written blocks of a data-block, a range of #IncrementalFileState.groups. */
+typedef struct IncrementalIDEntry {
+  uchar digest[16];
+  int groups_start;
+  int groups_num;
+} IncrementalIDEntry;
+
+/** What the last save of a file wrote, used by the next incremental save of the same file. */
+typedef struct IncrementalFileState {
+  char filepath[FILE_MAX];
+  /** Size and modification time of the file, to detect it being written by someone else. */
+  int64_t file_size;
+  int64_t file_mtime;
+  /** Size of the blocks still used by the file, the rest can be reclaimed by a full save. */
+  uint64_t used_size;
+
+  /** All groups of blocks of the file, in read order. */
+  BlendFileIndexGroup *groups;
+  int groups_num;
+  int groups_num_alloc;
+  /** #IncrementalIDEntry by ID session UUID. */
+  GHash *id_entries;
+} IncrementalFileState;
+
+/** Only the last saved file is tracked, saving is only done from the main thread. */
+static IncrementalFileState *incremental_state = NULL;
+
+typedef struct WriteIncremental {
+  /** State of the previous save when appending to the file, NULL when writing all of it. */
+  const IncrementalFileState *prev;
+  /** State of the file being written. */
+  IncrementalFileState *state;
+
+  /** Blocks written since the last data-block boundary. */
+  char *buf;
+  size_t buf_len;
+  size_t buf_len_alloc;
+
+  /** File offset of the next byte written. */
+  uint64_t offset;
+  bool is_header_done;
+} WriteIncremental;
+
+static IncrementalFileState *incremental_state_new(const char *filepath)
+{
+  IncrementalFileState *state = MEM_callocN(sizeof(*state), __func__);
+  STRNCPY(state->filepath, filepath);
+  state->id_entries = BLI_ghash_int_new(__func__);
+  return state;
+}
+
+static void incremental_state_free(IncrementalFileState *state)
+{
+  BLI_ghash_free(state->id_entries, NULL, MEM_freeN);
+  MEM_SAFE_FREE(state->groups);
+  MEM_freeN(state);
+}
+
+static bool incremental_file_stat(const char *filepath, int64_t *r_file_size, int64_t *r_mtime)
+{
+  BLI_stat_t st;
+  if (BLI_stat(filepath, &st) == -1) {
+    return false;
+  }
+  *r_file_size = (int64_t)st.st_size;
+  *r_mtime = (int64_t)st.st_mtime;
+  return true;
+}
+
+/**
+ * \return The state of the last save of \a filepath, when the file can be appended to.
+ */
+static const IncrementalFileState *incremental_state_find(const char *filepath)
+{
+  const IncrementalFileState *state = incremental_state;
+  if (state == NULL || BLI_path_cmp(state->filepath, filepath) != 0) {
+    return NULL;
+  }
+
+  int64_t file_size, file_mtime;
+  if (!incremental_file_stat(filepath, &file_size, &file_mtime) ||
+      file_size != state->file_size || file_mtime != state->file_mtime) {
+    /* Written by someone else since. */
+    return NULL;
+  }
+
+  if ((double)(state->file_size - (int64_t)state->used_size) >
+      (double)state->file_size * INCREMENTAL_GARBAGE_RATIO_MAX) {
+    /* Compact the file. */
+    return NULL;
+  }
+
+  return state;
+}
+
+static void incremental_state_set(IncrementalFileState *state)
+{
+  if (incremental_state != NULL) {
+    incremental_state_free(incremental_state);
+  }
+  incremental_state = state;
+}
+
+static void incremental_group_add(IncrementalFileState *state, uint64_t offset, uint64_t len)
+{
+  if (state->groups_num == state->groups_num_alloc) {
+    state->groups_num_alloc = max_ii(1024, state->groups_num_alloc * 2);
+    state->groups = MEM_reallocN(state->groups,
+                                 sizeof(*state->groups) * (size_t)state->groups_num_alloc);
+  }
+  BlendFileIndexGroup *group = &state->groups[state->groups_num++];
+  group->offset = offset;
+  group->len = len;
+}
+
+static void incremental_buffer_append(WriteIncremental *inc, const void *data, size_t len)
+{
+  if (inc->buf_len + len > inc->buf_len_alloc) {
+    inc->buf_len_alloc = max_zz(MEM_SIZE_OPTIMAL(1 << 20), (inc->buf_len + len) * 2);
+    inc->buf = MEM_reallocN(inc->buf, inc->buf_len_alloc);
+  }
+  memcpy(inc->buf + inc->buf_len, data, len);
+  inc->buf_len += len;
+}
+
+static bool incremental_file_write(WriteIncremental *inc,
+                                   WriteWrap *ww,
+                                   const char *data,
+                                   size_t len)
+{
+  /* Don't rely on large writes being done at once. */
+  const size_t chunk_size = ZSTD_BUFFER_SIZE;
+  for (size_t written = 0; written < len; written += chunk_size) {
+    const size_t write_len = MIN2(chunk_size, len - written);
+    if (ww->write(ww, data + written, write_len) != write_len) {
+      return false;
+    }
+  }
+  inc->offset += len;
+  return true;
+}
+
+/**
+ * Write the blocks buffered since the last data-block boundary, unless they belong to \a id
+ * and didn't change since the previous save, then the blocks already in the file are used.
+ */
+static bool incremental_write_buffered(WriteIncremental *inc, WriteWrap *ww, const ID *id)
+{
+  IncrementalFileState *state = inc->state;
+  const char *buf = inc->buf;
+  size_t len = inc->buf_len;
+  inc->buf_len = 0;
+
+  if (!inc->is_header_done) {
+    BLI_assert(len >= SIZEOFBLENDERHEADER);
+    /* The header is kept when appending. */
+    if (inc->prev == NULL && !incremental_file_write(inc, ww, buf, SIZEOFBLENDERHEADER)) {
+      return false;
+    }
+    buf += SIZEOFBLENDERHEADER;
+    len -= SIZEOFBLENDERHEADER;
+    inc->is_header_done = true;
+  }
+
+  if (len == 0) {
+    return true;
+  }
+
+  IncrementalIDEntry *entry = NULL;
+  if (id != NULL && id->session_uuid != MAIN_ID_SESSION_UUID_UNSET) {
+    entry = MEM_mallocN(sizeof(*entry), __func__);
+    BLI_hash_md5_buffer(buf, len, entry->digest);
+    entry->groups_start = state->groups_num;
+    entry->groups_num = 0;
+    BLI_ghash_reinsert(
+        state->id_entries, POINTER_FROM_UINT(id->session_uuid), entry, NULL, MEM_freeN);
+
+    const IncrementalIDEntry *prev_entry =
+        inc->prev ? BLI_ghash_lookup(inc->prev->id_entries, POINTER_FROM_UINT(id->session_uuid)) :
+                    NULL;
+    if (prev_entry != NULL &&
+        memcmp(prev_entry->digest, entry->digest, sizeof(entry->digest)) == 0) {
+      /* Unchanged, reuse the blocks written before. */
+      for (int i = 0; i < prev_entry->groups_num; i++) {
+        const BlendFileIndexGroup *group = &inc->prev->groups[prev_entry->groups_start + i];
+        incremental_group_add(state, group->offset, group->len);
+      }
+      entry->groups_num = prev_entry->groups_num;
+      return true;
+    }
+  }
+
+  /* Split the blocks into groups, each starting with a non-#DATA block. */
+  const int groups_start = state->groups_num;
+  size_t write_len = 0;
+  while (write_len < len) {
+    BHead bhead;
+    memcpy(&bhead, buf + write_len, sizeof(bhead));
+    if (bhead.code == ENDB && inc->prev != NULL) {
+      /* Written after the index, see #incremental_write_index. */
+      break;
+    }
+    const size_t block_len = sizeof(BHead) + (size_t)bhead.len;
+    if (bhead.code != DATA || state->groups_num == groups_start) {
+      incremental_group_add(state, inc->offset + write_len, block_len);
+    }
+    else {
+      state->groups[state->groups_num - 1].len += block_len;
+    }
+    write_len += block_len;
+  }
+  BLI_assert(write_len <= len);
+
+  if (entry != NULL) {
+    entry->groups_num = state->groups_num - groups_start;
+  }
+
+  return incremental_file_write(inc, ww, buf, write_len);
+}
+
+/**
+ * Write the #INDX block listing all groups of blocks of the file and the final #ENDB block
+ * pointing to it, when appending to a file. Everything is synced to the disk before writing
+ * the #ENDB block, so it can't be stored before the blocks it points to.
+ */
+static bool incremental_write_index(WriteIncremental *inc, WriteWrap *ww)
+{
+  IncrementalFileState *state = inc->state;
+  const uint64_t index_offset = inc->offset;
+
+  /* The index includes the #ENDB block written right after it. */
+  const size_t index_len = sizeof(*state->groups) * (size_t)(state->groups_num + 1);
+  incremental_group_add(state, index_offset + sizeof(BHead) + index_len, sizeof(BHead));
+
+  BHead bhead;
+  memset(&bhead, 0, sizeof(bhead));
+  bhead.code = INDX;
+  bhead.len = (int)index_len;
+  bhead.old = state->groups;
+  bhead.nr = 1;
+  if (!incremental_file_write(inc, ww, (const char *)&bhead, sizeof(bhead)) ||
+      !incremental_file_write(inc, ww, (const char *)state->groups, index_len) ||
+      !ww_sync_append(ww)) {
+    return false;
+  }
+
+  memset(&bhead, 0, sizeof(bhead));
+  bhead.code = ENDB;
+  bhead.old = (const void *)(uintptr_t)index_offset;
+  return incremental_file_write(inc, ww, (const char *)&bhead, sizeof(bhead));
+}
+
+static WriteIncremental *incremental_begin(const char *filepath)
+{
+  WriteIncremental *inc = MEM_callocN(sizeof(*inc), __func__);
+  inc->prev = incremental_state_find(filepath);
+  inc->state = incremental_state_new(filepath);
+  inc->offset = inc->prev ? (uint64_t)inc->prev->file_size : 0;
+  return inc;
+}
+
+/**
+ * Keep the state of the written file for the next incremental save, on success.
+ */
+static void incremental_end(WriteIncremental *inc, const char *filepath, const bool success)
+{
+  IncrementalFileState *state = inc->state;
+  if (success && incremental_file_stat(filepath, &state->file_size, &state->file_mtime)) {
+    BLI_assert((uint64_t)state->file_size == inc->offset);
+    state->used_size = SIZEOFBLENDERHEADER;
+    for (int i = 0; i < state->groups_num; i++) {
+      state->used_size += state->groups[i].len;
+    }
+    incremental_state_set(state);
+  }
+  else {
+    /* On failure the file is left as it was, so the previous state remains valid. */
+    incremental_state_free(state);
+  }
+  MEM_SAFE_FREE(inc->buf);
+  MEM_freeN(inc);
+}
+
+void BLO_write_file_incremental_clear(void)
+{
+  incremental_state_set(NULL);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Write Data Type & Functions
  * \{ */
@@ -424,6 +791,9 @@ typedef struct {
    * Will be NULL for UNDO.
    */
   WriteWrap *ww;
+
+  /** Incremental file writing, NULL unless requested. */
+  WriteIncremental *inc;
 } WriteData;
 
 typedef struct BlendWriter {
@@ -468,8 +838,12 @@ static void writedata_do_write(WriteData *wd, const void *mem, size_t memlen)
     return;
   }
 
+  if (wd->inc != NULL) {
+    /* Written to the file once the current data-block is complete. */
+    incremental_buffer_append(wd->inc, mem, memlen);
+  }
   /* memory based save */
-  if (wd->use_memfile) {
+  else if (wd->use_memfile) {
     BLO_memfile_chunk_add(&wd->mem, mem, memlen);
   }
   else {
@@ -505,6 +879,17 @@ static void mywrite_flush(WriteData *wd)
   }
 }
 
+/**
+ * Write the blocks buffered for incremental writing, see #incremental_write_buffered.
+ */
+static void mywrite_incremental_flush(WriteData *wd, const ID *id)
+{
+  mywrite_flush(wd);
+  if (!wd->error && !incremental_write_buffered(wd->inc, wd->ww, id)) {
+    wd->error = true;
+  }
+}
+
 /**
  * Low level WRITE(2) wrapper that buffers data
  * \param adr: Pointer to new chunk of data
@@ -564,9 +949,13 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
  * \param ww: File write wrapper.
  * \param compare: Previous memory file (can be NULL).
  * \param current: The current memory file (can be NULL).
+ * \param inc: Incremental file writing state (can be NULL).
  * \warning Talks to other functions with global parameters
  */
-static WriteData *mywrite_begin(WriteWrap *ww, MemFile *compare, MemFile *current)
+static WriteData *mywrite_begin(WriteWrap *ww,
+                                MemFile *compare,
+                                MemFile *current,
+                                WriteIncremental *inc)
 {
   WriteData *wd = writedata_new(ww);
 
@@ -574,6 +963,9 @@ static WriteData *mywrite_begin(WriteWrap *ww, MemFile *compare, MemFile *curren
     BLO_memfile_write_init(&wd->mem, current, compare);
     wd->use_memfile = true;
   }
+  else {
+    wd->inc = inc;
+  }
 
   return wd;
 }
@@ -595,6 +987,13 @@ static bool mywrite_end(WriteData *wd)
     BLO_memfile_write_finalize(&wd->mem);
   }
 
+  if (wd->inc != NULL) {
+    mywrite_incremental_flush(wd, NULL);
+    if (wd->inc->prev != NULL && !wd->error && !incremental_write_index(wd->inc, wd->ww)) {
+      wd->error = true;
+    }
+  }
+
   const bool err = wd->error;
   writedata_free(wd);
 
@@ -604,10 +1003,15 @@ static bool mywrite_end(WriteData *wd)
 /**
  * Start writing of data related to a single ID.
  *
- * Only does something when storing an undo step.
+ * Only does something when storing an undo step or writing incrementally.
  */
 static void mywrite_id_begin(WriteData *wd, ID *id)
 {
+  if (wd->inc != NULL) {
+    /* Blocks written so far are not part of this ID. */
+    mywrite_incremental_flush(wd, NULL);
+  }
+
   if (wd->use_memfile) {
     wd->mem.current_id_session_uuid = id->session_uuid;
 
@@ -634,10 +1038,14 @@ static void mywrite_id_begin(WriteData *wd, ID *id)
 /**
  * Start writing of data related to a single ID.
  *
- * Only does something when storing an undo step.
+ * Only does something when storing an undo step or writing incrementally.
  */
-static void mywrite_id_end(WriteData *wd, ID *UNUSED(id))
+static void mywrite_id_end(WriteData *wd, ID *id)
 {
+  if (wd->inc != NULL) {
+    mywrite_incremental_flush(wd, id);
+  }
+
   if (wd->use_memfile) {
     /* Very important to do it after every ID write now, otherwise we cannot know whether a
      * specific ID changed or not. */
@@ -1078,6 +1486,7 @@ static bool write_file_handle(Main *mainvar,
                               WriteWrap *ww,
                               MemFile *compare,
                               MemFile *current,
+                              WriteIncremental *inc,
                               int write_flags,
                               bool use_userdef,
                               const BlendThumbnail *thumb)
@@ -1089,7 +1498,7 @@ static bool write_file_handle(Main *mainvar,
 
   blo_split_main(&mainlist, mainvar);
 
-  wd = mywrite_begin(ww, compare, current);
+  wd = mywrite_begin(ww, compare, current, inc);
   BlendWriter writer = {wd};
 
   sprintf(buf,
@@ -1329,14 +1738,33 @@ bool BLO_write_file(Main *mainvar,
     BLO_main_validate_shapekeys(mainvar, reports);
   }
 
-  /* open temporary file, so we preserve the original in case we crash */
-  BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
+  /* Incremental saves are only done for uncompressed files. */
+  WriteIncremental *inc = (params->use_incremental && !(write_flags & G_FILE_COMPRESS)) ?
+                              incremental_begin(filepath) :
+                              NULL;
+  /* Append to the existing file when possible, otherwise all of it is written. */
+  const bool use_append = (inc != NULL) && (inc->prev != NULL);
 
-  ww_handle_init((write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD : WW_WRAP_NONE, &ww);
+  /* open temporary file, so we preserve the original in case we crash,
+   * appending is done in place as the original stays readable until it's done. */
+  if (use_append) {
+    STRNCPY(tempname, filepath);
+  }
+  else {
+    BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
+  }
+
+  ww_handle_init(use_append ? WW_WRAP_APPEND :
+                 (write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD :
+                                                   WW_WRAP_NONE,
+                 &ww);
 
   if (ww.open(&ww, tempname) == false) {
     BKE_reportf(
         reports, RPT_ERROR, "Cannot open file %s for writing: %s", tempname, strerror(errno));
+    if (inc != NULL) {
+      incremental_end(inc, filepath, false);
+    }
     return false;
   }
 
@@ -1424,7 +1852,8 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  const bool err = write_file_handle(
+      mainvar, &ww, NULL, NULL, inc, write_flags, use_userdef, thumb);
 
   ww.close(&ww);
 
@@ -1435,26 +1864,48 @@ bool BLO_write_file(Main *mainvar,
 
   if (err) {
     BKE_report(reports, RPT_ERROR, strerror(errno));
-    remove(tempname);
+    if (use_append) {
+      /* Drop the partially appended blocks, the file ends with its previous #ENDB again. */
+      if (!ww_truncate_append(filepath, inc->prev->file_size)) {
+        BKE_reportf(reports, RPT_ERROR, "Cannot restore file %s after failed append", filepath);
+      }
+    }
+    else {
+      remove(tempname);
+    }
+    if (inc != NULL) {
+      incremental_end(inc, filepath, false);
+    }
 
     return false;
   }
 
   /* file save to temporary file was successful */
-  /* now do reverse file history (move .blend1 -> .blend2, .blend -> .blend1) */
-  if (use_save_versions) {
+  /* now do reverse file history (move .blend1 -> .blend2, .blend -> .blend1),
+   * not when appending as the previous file can't be moved aside without copying it. */
+  if (use_save_versions && !use_append) {
     const bool err_hist = do_history(filepath, reports);
     if (err_hist) {
       BKE_report(reports, RPT_ERROR, "Version backup failed (file saved with @)");
+      if (inc != NULL) {
+        incremental_end(inc, filepath, false);
+      }
       return false;
     }
   }
 
-  if (BLI_rename(tempname, filepath) != 0) {
+  if (!use_append && BLI_rename(tempname, filepath) != 0) {
     BKE_report(reports, RPT_ERROR, "Cannot change old file (file saved with @)");
+    if (inc != NULL) {
+      incremental_end(inc, filepath, false);
+    }
     return false;
   }
 
+  if (inc != NULL) {
+    incremental_end(inc, filepath, true);
+  }
+
   if (G.debug & G_DEBUG_IO && mainvar->lock != NULL) {
     BKE_report(reports, RPT_INFO, "Checking sanity of current .blend file *AFTER* save to disk");
     BLO_main_validate_libraries(mainvar, reports);
@@ -1468,7 +1919,7 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int w
   bool use_userdef = false;
 
   const bool err = write_file_handle(
-      mainvar, NULL, compare, current, write_flags, use_userdef, NULL);
+      mainvar, NULL, compare, current, NULL, write_flags, use_userdef, NULL);
 
   return (err == 0);
 }
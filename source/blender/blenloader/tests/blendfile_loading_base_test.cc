@@ -87,6 +87,7 @@ void BlendfileLoadingBaseTest::TearDownTestCase()
 
   DEG_free_node_types();
   GHOST_DisposeSystemPaths();
+  BLO_bhead_index_cache_clear();
   DNA_sdna_current_free();
   BLI_threadapi_exit();
 
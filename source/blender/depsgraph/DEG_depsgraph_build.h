@@ -67,6 +67,15 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /** Tag all relations in the database for update. */
 void DEG_relations_tag_update(struct Main *bmain);
 
+/**
+ * Tag relations of the given ID for update, in all graphs which contain it.
+ *
+ * Use when only the relations of this ID changed (for example, a modifier or a constraint was
+ * added to an object). This allows graphs to update their relations incrementally instead of
+ * rebuilding them from scratch.
+ */
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /**
@@ -314,19 +314,19 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   OperationNode *find_node(const OperationKey &key) const;
   bool has_node(const OperationKey &key) const;
 
-  Relation *add_time_relation(TimeSourceNode *timesrc,
-                              Node *node_to,
-                              const char *description,
-                              int flags = 0);
+  virtual Relation *add_time_relation(TimeSourceNode *timesrc,
+                                      Node *node_to,
+                                      const char *description,
+                                      int flags = 0);
 
   /* Add relation which ensures visibility of `id_from` when `id_to` is visible.
    * For the more detailed explanation see comment for `NodeType::VISIBILITY`. */
   void add_visibility_relation(ID *id_from, ID *id_to);
 
-  Relation *add_operation_relation(OperationNode *node_from,
-                                   OperationNode *node_to,
-                                   const char *description,
-                                   int flags = 0);
+  virtual Relation *add_operation_relation(OperationNode *node_from,
+                                           OperationNode *node_to,
+                                           const char *description,
+                                           int flags = 0);
 
   template<typename KeyType>
   DepsNodeHandle create_node_handle(const KeyType &key, const char *default_name = "");
@@ -346,6 +346,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   template<typename KeyFrom, typename KeyTo>
   bool is_same_nodetree_node_dependency(const KeyFrom &key_from, const KeyTo &key_to);
 
+  /* State which demotes currently built entities. */
+  Scene *scene_;
+
+  BuilderMap built_map_;
+
  private:
   struct BuilderWalkUserData {
     DepsgraphRelationBuilder *builder;
@@ -358,10 +363,6 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   static void constraint_walk(bConstraint *con, ID **idpoin, bool is_reference, void *user_data);
 
-  /* State which demotes currently built entities. */
-  Scene *scene_;
-
-  BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
 };
 
@@ -49,7 +49,8 @@ void deg_graph_remove_unused_noops(Depsgraph *graph)
       Relation *rel_in = to_remove->inlinks[0];
       Node *dependency = rel_in->from;
 
-      /* Remove the relation. */
+      /* Remove the relation, keeping enough information to restore it. */
+      graph->removed_noop_relations.append({dependency, to_remove, rel_in->name, rel_in->flag});
       rel_in->unlink();
       delete rel_in;
       num_removed_relations++;
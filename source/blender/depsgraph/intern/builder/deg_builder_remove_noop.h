@@ -12,7 +12,8 @@ namespace deg {
 
 struct Depsgraph;
 
-/* Remove all no-op nodes that have zero outgoing relations. */
+/* Remove all no-op nodes that have zero outgoing relations.
+ * The removed relations are stored in #Depsgraph::removed_noop_relations. */
 void deg_graph_remove_unused_noops(Depsgraph *graph);
 
 }  // namespace deg
@@ -14,6 +14,8 @@
 #include "deg_builder_relations.h"
 #include "deg_builder_transitive.h"
 
+#include "intern/eval/deg_eval_stats.h"
+
 namespace blender::deg {
 
 AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
@@ -26,19 +28,15 @@ AbstractBuilderPipeline::AbstractBuilderPipeline(::Depsgraph *graph)
 
 void AbstractBuilderPipeline::build()
 {
-  double start_time = 0.0;
-  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
-    start_time = PIL_check_seconds_timer();
-  }
+  const double start_time = PIL_check_seconds_timer();
 
   build_step_sanity_check();
   build_step_nodes();
   build_step_relations();
   build_step_finalize();
 
-  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
-    printf("Depsgraph built in %f seconds.\n", PIL_check_seconds_timer() - start_time);
-  }
+  deg_build_stats_add(
+      deg_graph_, false, deg_graph_->id_nodes.size(), PIL_check_seconds_timer() - start_time);
 }
 
 void AbstractBuilderPipeline::build_step_sanity_check()
@@ -91,6 +89,13 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  deg_graph_->need_full_update = !supports_incremental_update();
+  deg_graph_->id_relations_updates.clear();
+}
+
+bool AbstractBuilderPipeline::supports_incremental_update() const
+{
+  return false;
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
@@ -48,6 +48,10 @@ class AbstractBuilderPipeline {
   virtual unique_ptr<DepsgraphNodeBuilder> construct_node_builder();
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder();
 
+  /* Whether the graph can be updated by #IncrementalBuilderPipeline after it has been built.
+   * Other graphs are rebuilt from scratch on every relations update. */
+  virtual bool supports_incremental_update() const;
+
   virtual void build_step_sanity_check();
   void build_step_nodes();
   void build_step_relations();
@@ -0,0 +1,497 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "pipeline_incremental.h"
+
+#include <algorithm>
+
+#include "MEM_guardedalloc.h"
+
+#include "PIL_time.h"
+
+#include "BLI_listbase.h"
+#include "BLI_map.hh"
+
+#include "BKE_layer.h"
+#include "BKE_modifier.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_physics.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/eval/deg_eval_stats.h"
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+namespace {
+
+class IncrementalNodeBuilder : public DepsgraphNodeBuilder {
+ public:
+  IncrementalNodeBuilder(Main *bmain,
+                         Depsgraph *graph,
+                         DepsgraphBuilderCache *cache,
+                         const Set<ID *> &rebuild_ids)
+      : DepsgraphNodeBuilder(bmain, graph, cache), rebuild_ids_(rebuild_ids)
+  {
+  }
+
+  /* Unlike the regular build, only nodes of the rebuilt IDs are removed from the graph. All
+   * other IDs are considered built already. */
+  void begin_build() override
+  {
+    scene_ = graph_->scene;
+    view_layer_ = graph_->view_layer;
+    /* NOTE: Pass view layer index of 0 since after scene CoW there is
+     * only one view layer in there. */
+    view_layer_index_ = 0;
+
+    Set<OperationNode *> removed_operations;
+    for (IDNode *id_node : graph_->id_nodes) {
+      /* Visibility of all components is flushed again when the build is finalized. */
+      for (ComponentNode *comp_node : id_node->components.values()) {
+        comp_node->affects_directly_visible = false;
+      }
+      id_node->previously_visible_components_mask = id_node->visible_components_mask;
+      id_node->previous_eval_flags = id_node->eval_flags;
+      id_node->previous_customdata_masks = id_node->customdata_masks;
+
+      if (!rebuild_ids_.contains(id_node->id_orig)) {
+        built_map_.tagBuild(id_node->id_orig);
+        continue;
+      }
+
+      clear_id_node(id_node, removed_operations);
+
+      /* Keep the copy-on-write datablock and the previous state of the node, see #add_id_node.
+       * The datablock is still owned by the node, so it is not stored in the ID info. */
+      IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
+      id_info->id_cow = nullptr;
+      id_info->previously_visible_components_mask = id_node->previously_visible_components_mask;
+      id_info->previous_eval_flags = id_node->previous_eval_flags;
+      id_info->previous_customdata_masks = id_node->previous_customdata_masks;
+      id_info_hash_.add_new(id_node->id_orig_session_uuid, id_info);
+    }
+
+    Vector<OperationNode *> &operations = graph_->operations;
+    OperationNode **operations_end = std::remove_if(
+        operations.begin(), operations.end(), [&](OperationNode *op_node) {
+          return removed_operations.contains(op_node);
+        });
+    operations.resize(operations_end - operations.begin());
+
+    restore_noop_relations(removed_operations);
+  }
+
+  void end_build() override
+  {
+    tag_previously_tagged_nodes();
+    /* Copy-on-write datablocks of the rebuilt IDs are updated with the regular recalc flags of
+     * the edit which changed their relations, so there is no need to detect invalid pointers in
+     * the whole graph. */
+  }
+
+ protected:
+  /* Remove all components of the ID node, and all relations of its operations. */
+  void clear_id_node(IDNode *id_node, Set<OperationNode *> &removed_operations)
+  {
+    Set<Relation *> relations;
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        removed_operations.add_new(op_node);
+        relations.add_multiple(op_node->inlinks);
+        relations.add_multiple(op_node->outlinks);
+
+        if (graph_->entry_tags.remove(op_node)) {
+          SavedEntryTag entry_tag;
+          entry_tag.id_orig = id_node->id_orig;
+          entry_tag.component_type = comp_node->type;
+          entry_tag.opcode = op_node->opcode;
+          entry_tag.name = op_node->name;
+          entry_tag.name_tag = op_node->name_tag;
+          saved_entry_tags_.append(entry_tag);
+        }
+      }
+    }
+    for (Relation *rel : relations) {
+      rel->unlink();
+      delete rel;
+    }
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      delete comp_node;
+    }
+    id_node->components.clear();
+    /* Both are accumulated again by the relations builder. */
+    id_node->eval_flags = 0;
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+  }
+
+  /* Kept IDs are not built again, so relations to their no-op nodes which were removed when the
+   * graph was finalized are restored before relations to the no-op nodes get added. The no-op
+   * nodes which are still unused get removed again when the graph is finalized. */
+  void restore_noop_relations(const Set<OperationNode *> &removed_operations)
+  {
+    for (const Depsgraph::RemovedRelation &rel : graph_->removed_noop_relations) {
+      if (removed_operations.contains(rel.to)) {
+        continue;
+      }
+      if (rel.from->type == NodeType::OPERATION &&
+          removed_operations.contains(static_cast<OperationNode *>(rel.from))) {
+        continue;
+      }
+      graph_->add_new_relation(rel.from, rel.to, rel.name, rel.flag);
+    }
+    graph_->removed_noop_relations.clear();
+  }
+
+  const Set<ID *> &rebuild_ids_;
+};
+
+class IncrementalRelationBuilder : public DepsgraphRelationBuilder {
+ public:
+  IncrementalRelationBuilder(Main *bmain,
+                             Depsgraph *graph,
+                             DepsgraphBuilderCache *cache,
+                             const Set<ID *> &relink_ids)
+      : DepsgraphRelationBuilder(bmain, graph, cache)
+  {
+    scene_ = graph->scene;
+    for (IDNode *id_node : graph->id_nodes) {
+      if (!relink_ids.contains(id_node->id_orig)) {
+        built_map_.tagBuild(id_node->id_orig);
+      }
+    }
+  }
+
+  /* Relations between operations which were kept are still in the graph. */
+  Relation *add_time_relation(TimeSourceNode *timesrc,
+                              Node *node_to,
+                              const char *description,
+                              int flags = 0) override
+  {
+    return DepsgraphRelationBuilder::add_time_relation(
+        timesrc, node_to, description, flags | RELATION_CHECK_BEFORE_ADD);
+  }
+
+  Relation *add_operation_relation(OperationNode *node_from,
+                                   OperationNode *node_to,
+                                   const char *description,
+                                   int flags = 0) override
+  {
+    return DepsgraphRelationBuilder::add_operation_relation(
+        node_from, node_to, description, flags | RELATION_CHECK_BEFORE_ADD);
+  }
+
+  /* Relations within the kept IDs are still in the graph, so only handle IDs which nodes were
+   * built. */
+  void build_copy_on_write_relations() override
+  {
+    for (IDNode *id_node : graph_->id_nodes) {
+      if (is_rebuilt(id_node)) {
+        DepsgraphRelationBuilder::build_copy_on_write_relations(id_node);
+      }
+    }
+  }
+
+  void build_driver_relations() override
+  {
+    for (IDNode *id_node : graph_->id_nodes) {
+      if (is_rebuilt(id_node)) {
+        DepsgraphRelationBuilder::build_driver_relations(id_node);
+      }
+    }
+  }
+
+ protected:
+  static bool is_rebuilt(const IDNode *id_node)
+  {
+    /* Components of kept IDs are finalized already. */
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      if (comp_node->operations_map != nullptr) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/* Identifier of a node which does not depend on its address, so nodes of different graphs can be
+ * compared. */
+string node_identifier(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const OperationNode *op_node = static_cast<const OperationNode *>(node);
+  const ComponentNode *comp_node = op_node->owner;
+  return comp_node->owner->name + " / " + nodeTypeAsString(comp_node->type) + comp_node->name +
+         " / " + op_node->identifier() + "[" + to_string(op_node->name_tag) + "]";
+}
+
+Set<string> relation_identifiers(const Depsgraph *graph)
+{
+  Set<string> result;
+  for (const OperationNode *op_node : graph->operations) {
+    for (const Relation *rel : op_node->inlinks) {
+      result.add(node_identifier(rel->from) + " -> " + node_identifier(rel->to) + " (" +
+                 rel->name + ")");
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+IncrementalBuilderPipeline::IncrementalBuilderPipeline(::Depsgraph *graph)
+    : AbstractBuilderPipeline(graph), is_nodes_build_local_(true)
+{
+}
+
+bool IncrementalBuilderPipeline::build_incremental()
+{
+  const double start_time = PIL_check_seconds_timer();
+
+  if (!collect_ids()) {
+    return false;
+  }
+
+  build_step_sanity_check();
+  build_step_nodes();
+  if (!is_nodes_build_local_) {
+    /* The graph is consistent at this point, it only lacks relations of the new nodes. */
+    return false;
+  }
+  build_step_relations();
+  build_step_finalize();
+
+#ifndef NDEBUG
+  if (!validate_against_full_build()) {
+    return false;
+  }
+#endif
+
+  deg_build_stats_add(
+      deg_graph_, true, rebuild_ids_.size(), PIL_check_seconds_timer() - start_time);
+  return true;
+}
+
+bool IncrementalBuilderPipeline::can_rebuild_id(const ID *id) const
+{
+  if (GS(id->name) != ID_OB) {
+    return false;
+  }
+  const Object *object = (const Object *)id;
+  /* Pose channels are referenced by other objects. Speakers are part of the scene audio. */
+  if (ELEM(object->type, OB_ARMATURE, OB_SPEAKER)) {
+    return false;
+  }
+  /* Objects which take part in physics are collected into the scene wide relations. */
+  if ((object->pd != nullptr && object->pd->forcefield != 0) ||
+      !BLI_listbase_is_empty(&object->particlesystem) || object->rigidbody_object != nullptr ||
+      object->rigidbody_constraint != nullptr) {
+    return false;
+  }
+  for (const ModifierType type : {eModifierType_Collision,
+                                  eModifierType_Fluid,
+                                  eModifierType_DynamicPaint,
+                                  eModifierType_Surface}) {
+    if (BKE_modifiers_findby_type(object, type) != nullptr) {
+      return false;
+    }
+  }
+  if (physics_relations_contain_object(deg_graph_, object)) {
+    return false;
+  }
+  return true;
+}
+
+bool IncrementalBuilderPipeline::collect_ids()
+{
+  if (deg_graph_->is_render_pipeline_depsgraph) {
+    return false;
+  }
+  for (ID *id : deg_graph_->id_relations_updates) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr) {
+      /* Nothing in the graph depends on the ID. */
+      continue;
+    }
+    if (!can_rebuild_id(id)) {
+      return false;
+    }
+    if (id_node->has_base && BKE_view_layer_base_find(view_layer_, (Object *)id) == nullptr) {
+      /* Object is pulled in from a set scene. */
+      return false;
+    }
+    rebuild_ids_.add(id);
+  }
+  if (rebuild_ids_.is_empty()) {
+    return false;
+  }
+
+  for (ID *id : rebuild_ids_) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        for (Relation *rel : op_node->inlinks) {
+          if (rel->from->type == NodeType::OPERATION) {
+            neighbor_ids_.add(static_cast<OperationNode *>(rel->from)->owner->owner->id_orig);
+          }
+        }
+        for (Relation *rel : op_node->outlinks) {
+          if (rel->to->type == NodeType::OPERATION) {
+            neighbor_ids_.add(static_cast<OperationNode *>(rel->to)->owner->owner->id_orig);
+          }
+        }
+      }
+    }
+  }
+  for (ID *id : rebuild_ids_) {
+    neighbor_ids_.remove(id);
+  }
+  /* Relations from the scene to its objects are built together with the objects, see
+   * #DepsgraphRelationBuilder::build_object_from_view_layer_base. Rebuilding the scene would
+   * rebuild the whole view layer. */
+  neighbor_ids_.remove(&scene_->id);
+  for (ID *id : neighbor_ids_) {
+    /* Relations of particle settings are built from the objects using them. */
+    if (ELEM(GS(id->name), ID_SCE, ID_PA)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+unique_ptr<DepsgraphNodeBuilder> IncrementalBuilderPipeline::construct_node_builder()
+{
+  return std::make_unique<IncrementalNodeBuilder>(
+      bmain_, deg_graph_, &builder_cache_, rebuild_ids_);
+}
+
+unique_ptr<DepsgraphRelationBuilder> IncrementalBuilderPipeline::construct_relation_builder()
+{
+  Set<ID *> relink_ids = rebuild_ids_;
+  for (ID *id : neighbor_ids_) {
+    relink_ids.add(id);
+  }
+  relink_ids.add_multiple(new_ids_);
+  return std::make_unique<IncrementalRelationBuilder>(
+      bmain_, deg_graph_, &builder_cache_, relink_ids);
+}
+
+bool IncrementalBuilderPipeline::supports_incremental_update() const
+{
+  return true;
+}
+
+void IncrementalBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  const int64_t id_nodes_num = deg_graph_->id_nodes.size();
+  const int64_t operations_num = deg_graph_->operations.size();
+
+  /* Same indices as used by #DepsgraphNodeBuilder::build_view_layer. */
+  Map<ID *, int> base_indices;
+  int base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer_->object_bases) {
+    if (node_builder.need_pull_base_into_graph(base)) {
+      if (rebuild_ids_.contains(&base->object->id)) {
+        base_indices.add(&base->object->id, base_index);
+      }
+      base_index++;
+    }
+  }
+
+  for (ID *id : rebuild_ids_) {
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    const eDepsNode_LinkedState_Type linked_state = id_node->linked_state;
+    const bool is_directly_visible = id_node->is_directly_visible;
+    const bool has_base = id_node->has_base;
+
+    node_builder.build_object(
+        base_indices.lookup_default(id, -1), (Object *)id, linked_state, is_directly_visible);
+
+    /* Other IDs which pulled the object into the graph are not built again. */
+    id_node->linked_state = max(id_node->linked_state, linked_state);
+    id_node->is_directly_visible |= is_directly_visible;
+    id_node->has_base |= has_base;
+  }
+
+  for (const int64_t i : deg_graph_->id_nodes.index_range().drop_front(id_nodes_num)) {
+    new_ids_.append(deg_graph_->id_nodes[i]->id_orig);
+  }
+  for (const int64_t i : deg_graph_->operations.index_range().drop_front(operations_num)) {
+    const IDNode *id_node = deg_graph_->operations[i]->owner->owner;
+    if (!rebuild_ids_.contains(id_node->id_orig) && !new_ids_.contains(id_node->id_orig)) {
+      is_nodes_build_local_ = false;
+    }
+  }
+}
+
+void IncrementalBuilderPipeline::build_relations(DepsgraphRelationBuilder &relation_builder)
+{
+  auto build_id_relations = [&](ID *id) {
+    if (GS(id->name) == ID_OB) {
+      Base *base = BKE_view_layer_base_find(view_layer_, (Object *)id);
+      if (base != nullptr && relation_builder.need_pull_base_into_graph(base)) {
+        relation_builder.build_object_from_view_layer_base((Object *)id);
+        return;
+      }
+    }
+    relation_builder.build_id(id);
+  };
+
+  for (ID *id : rebuild_ids_) {
+    build_id_relations(id);
+  }
+  for (ID *id : neighbor_ids_) {
+    build_id_relations(id);
+  }
+  for (ID *id : new_ids_) {
+    build_id_relations(id);
+  }
+}
+
+bool IncrementalBuilderPipeline::validate_against_full_build() const
+{
+  ::Depsgraph *reference_graph = DEG_graph_new(bmain_, scene_, view_layer_, deg_graph_->mode);
+  DEG_graph_build_from_view_layer(reference_graph);
+
+  const Set<string> relations = relation_identifiers(deg_graph_);
+  const Set<string> reference_relations = relation_identifiers(
+      reinterpret_cast<const Depsgraph *>(reference_graph));
+  DEG_graph_free(reference_graph);
+
+  bool is_valid = true;
+  for (const string &relation : reference_relations) {
+    if (!relations.contains(relation)) {
+      DEG_ERROR_PRINTF("Incremental update is missing relation %s\n", relation.c_str());
+      is_valid = false;
+    }
+  }
+  for (const string &relation : relations) {
+    if (!reference_relations.contains(relation)) {
+      DEG_ERROR_PRINTF("Incremental update has extra relation %s\n", relation.c_str());
+      is_valid = false;
+    }
+  }
+  return is_valid;
+}
+
+}  // namespace blender::deg
@@ -0,0 +1,69 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "pipeline.h"
+
+struct ID;
+
+namespace blender {
+namespace deg {
+
+struct IDNode;
+
+/* Update relations of a graph which was built from a view layer, when only relations of a few
+ * IDs changed (for example, a modifier or a constraint was added to an object).
+ *
+ * General notes:
+ *
+ * - Nodes of the changed IDs are rebuilt, and relations are rebuilt for the changed IDs, IDs
+ *   which are newly pulled into the graph, and IDs which had relations to the changed IDs.
+ *   Everything else is kept as-is.
+ *
+ * - Only objects are handled. Changes which might affect the scene, physics or armatures fall
+ *   back to a full rebuild. IDs which are not needed anymore are kept in the graph until the
+ *   next full rebuild.
+ *
+ * - In debug builds the result is compared against a graph built from scratch, and any
+ *   difference falls back to a full rebuild.
+ */
+class IncrementalBuilderPipeline : public AbstractBuilderPipeline {
+ public:
+  IncrementalBuilderPipeline(::Depsgraph *graph);
+
+  /* Returns false if the graph can not be updated incrementally, in which case it is to be
+   * rebuilt from scratch. */
+  bool build_incremental();
+
+ protected:
+  virtual unique_ptr<DepsgraphNodeBuilder> construct_node_builder() override;
+  virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder() override;
+  virtual bool supports_incremental_update() const override;
+
+  virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
+  virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
+
+ private:
+  bool can_rebuild_id(const ID *id) const;
+  bool collect_ids();
+  bool validate_against_full_build() const;
+
+  /* IDs which nodes and relations are rebuilt. */
+  Set<ID *> rebuild_ids_;
+  /* IDs which had relations to or from the rebuilt ones, only their relations are rebuilt. */
+  Set<ID *> neighbor_ids_;
+  /* IDs which were not in the graph before the update. */
+  Vector<ID *> new_ids_;
+  /* False when building nodes of the rebuilt IDs added operations to other existing IDs. */
+  bool is_nodes_build_local_;
+};
+
+}  // namespace deg
+}  // namespace blender
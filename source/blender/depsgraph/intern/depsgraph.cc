@@ -46,6 +46,7 @@ namespace blender::deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      need_full_update(true),
       need_visibility_update(true),
       need_visibility_time_update(false),
       bmain(bmain),
@@ -162,6 +163,7 @@ void Depsgraph::clear_id_nodes()
   /* Clear containers. */
   id_hash.clear();
   id_nodes.clear();
+  removed_noop_relations.clear();
   /* Clear physics relation caches. */
   clear_physics_relations(this);
 }
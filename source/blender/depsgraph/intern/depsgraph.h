@@ -26,6 +26,7 @@
 
 #include "intern/debug/deg_debug.h"
 #include "intern/depsgraph_type.h"
+#include "intern/eval/deg_eval_stats.h"
 
 struct ID;
 struct Scene;
@@ -92,6 +93,12 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Relations of the whole graph are to be rebuilt. When this is false and `need_update` is set,
+   * only relations of the IDs in `id_relations_updates` changed, which allows to update the
+   * graph incrementally. Always set for graphs which are not built from a view layer. */
+  bool need_full_update;
+  Set<ID *> id_relations_updates;
+
   /* Indicated whether IDs in this graph are to be tagged as if they first appear visible, with
    * an optional tag for their animation (time) update. */
   bool need_visibility_update;
@@ -108,6 +115,17 @@ struct Depsgraph {
   /* Nodes which have been tagged as "directly modified". */
   Set<OperationNode *> entry_tags;
 
+  /* Relations to no-op nodes which were removed because nothing used the nodes, see
+   * #deg_graph_remove_unused_noops. They are restored by incremental relation updates, as the
+   * rebuilt IDs might use the no-op nodes again. */
+  struct RemovedRelation {
+    Node *from;
+    OperationNode *to;
+    const char *name;
+    int flag;
+  };
+  Vector<RemovedRelation> removed_noop_relations;
+
   /* Convenience Data ................... */
 
   /* XXX: should be collected after building (if actually needed?) */
@@ -144,6 +162,8 @@ struct Depsgraph {
 
   DepsgraphDebug debug;
 
+  BuildStats build_stats;
+
   bool is_evaluating;
 
   /* Is set to truth for dependency graph which are used for post-processing (compositor and
@@ -34,6 +34,7 @@
 #include "builder/pipeline_all_objects.h"
 #include "builder/pipeline_compositor.h"
 #include "builder/pipeline_from_ids.h"
+#include "builder/pipeline_incremental.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
 
@@ -48,6 +49,7 @@
 #include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_tag.h"
 #include "intern/depsgraph_type.h"
+#include "intern/eval/deg_eval_stats.h"
 
 /* ****************** */
 /* External Build API */
@@ -271,6 +273,7 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg_graph->need_update = true;
+  deg_graph->need_full_update = true;
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -290,6 +293,13 @@ void DEG_graph_relations_update(Depsgraph *graph)
     /* Graph is up to date, nothing to do. */
     return;
   }
+  if (!deg_graph->need_full_update) {
+    deg::IncrementalBuilderPipeline builder(graph);
+    if (builder.build_incremental()) {
+      return;
+    }
+    deg::deg_build_stats_add_incremental_fallback(deg_graph);
+  }
   DEG_graph_build_from_view_layer(graph);
 }
 
@@ -300,3 +310,18 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    if (depsgraph->find_id_node(id) == nullptr) {
+      /* Nothing in the graph depends on relations of the ID. */
+      continue;
+    }
+    depsgraph->need_update = true;
+    if (!depsgraph->need_full_update) {
+      depsgraph->id_relations_updates.add(id);
+    }
+  }
+}
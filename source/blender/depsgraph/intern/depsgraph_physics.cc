@@ -228,4 +228,31 @@ void clear_physics_relations(Depsgraph *graph)
   }
 }
 
+bool physics_relations_contain_object(const Depsgraph *graph, const Object *object)
+{
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    const Map<const ID *, ListBase *> *hash = graph->physics_relations[i];
+    if (hash == nullptr) {
+      continue;
+    }
+    for (const ListBase *list : hash->values()) {
+      if (i == DEG_PHYSICS_EFFECTOR) {
+        LISTBASE_FOREACH (const EffectorRelation *, relation, list) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+      else {
+        LISTBASE_FOREACH (const CollisionRelation *, relation, list) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
 }  // namespace blender::deg
@@ -9,6 +9,7 @@
 
 struct Collection;
 struct ListBase;
+struct Object;
 
 namespace blender {
 namespace deg {
@@ -20,6 +21,8 @@ ListBase *build_collision_relations(Depsgraph *graph,
                                     Collection *collection,
                                     unsigned int modifier_type);
 void clear_physics_relations(Depsgraph *graph);
+/* Check whether the object is a collider or an effector in any of the cached relations. */
+bool physics_relations_contain_object(const Depsgraph *graph, const Object *object);
 
 }  // namespace deg
 }  // namespace blender
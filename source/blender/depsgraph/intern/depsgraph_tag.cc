@@ -148,6 +148,7 @@ void depsgraph_tag_to_component_opcode(const ID *id,
   }
   switch (tag) {
     case ID_RECALC_TRANSFORM:
+    case ID_RECALC_TRANSFORM_CHANNELS:
       *component_type = NodeType::TRANSFORM;
       break;
     case ID_RECALC_GEOMETRY:
@@ -291,6 +292,23 @@ void depsgraph_tag_component(Depsgraph *graph,
   }
 }
 
+/* Tag transform of an object which only had its transform channels changed. The channels are
+ * copied to the evaluated object right away, so there is no need to copy the whole data-block. */
+void depsgraph_tag_transform_channels(Depsgraph *graph,
+                                      IDNode *id_node,
+                                      eUpdateSource update_source)
+{
+  if (!deg_update_copy_on_write_transform(id_node)) {
+    depsgraph_tag_component(
+        graph, id_node, NodeType::TRANSFORM, OperationCode::OPERATION, update_source);
+    return;
+  }
+  ComponentNode *component_node = id_node->find_component(NodeType::TRANSFORM);
+  if (component_node != nullptr) {
+    component_node->tag_update(graph, update_source);
+  }
+}
+
 /* This is a tag compatibility with legacy code.
  *
  * Mainly, old code was tagging object with ID_RECALC_GEOMETRY tag to inform
@@ -385,6 +403,9 @@ void graph_id_tag_update_single_flag(Main *bmain,
   if (component_type == NodeType::ID_REF) {
     id_node->tag_update(graph, update_source);
   }
+  else if (tag == ID_RECALC_TRANSFORM_CHANNELS) {
+    depsgraph_tag_transform_channels(graph, id_node, update_source);
+  }
   else {
     depsgraph_tag_component(graph, id_node, component_type, operation_code, update_source);
   }
@@ -689,6 +710,8 @@ const char *DEG_update_tag_as_string(IDRecalcFlag flag)
   switch (flag) {
     case ID_RECALC_TRANSFORM:
       return "TRANSFORM";
+    case ID_RECALC_TRANSFORM_CHANNELS:
+      return "TRANSFORM_CHANNELS";
     case ID_RECALC_GEOMETRY:
       return "GEOMETRY";
     case ID_RECALC_GEOMETRY_ALL_MODES:
@@ -9,12 +9,17 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
+#include "BLI_task_trace.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -57,11 +62,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -79,27 +79,87 @@ enum class EvaluationStage {
   SINGLE_THREADED_WORKAROUND,
 };
 
+/* Operations which are ready to be evaluated, ordered by their priority.
+ *
+ * Every operation pushed to the queue is paired with a task in the task pool. The task evaluates
+ * the operation with the highest priority at the time it runs, which is not necessarily the one
+ * it was pushed for. */
+class ReadyQueue {
+ public:
+  ReadyQueue()
+  {
+    BLI_spin_init(&lock_);
+  }
+
+  ~ReadyQueue()
+  {
+    BLI_spin_end(&lock_);
+  }
+
+  void push(OperationNode *node)
+  {
+    BLI_spin_lock(&lock_);
+    heap_.append(node);
+    std::push_heap(heap_.begin(), heap_.end(), compare_priority);
+    BLI_spin_unlock(&lock_);
+  }
+
+  OperationNode *pop()
+  {
+    BLI_spin_lock(&lock_);
+    BLI_assert(!heap_.is_empty());
+    std::pop_heap(heap_.begin(), heap_.end(), compare_priority);
+    OperationNode *node = heap_.pop_last();
+    BLI_spin_unlock(&lock_);
+    return node;
+  }
+
+ private:
+  static bool compare_priority(const OperationNode *a, const OperationNode *b)
+  {
+    return a->priority < b->priority;
+  }
+
+  SpinLock lock_;
+  Vector<OperationNode *> heap_;
+};
+
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  ReadyQueue ready_queue;
 };
 
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  state->ready_queue.push(node);
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
+  const bool do_trace = BLI_task_trace_is_enabled();
+  if (do_trace) {
+    BLI_task_trace_event_begin_copy("depsgraph", operation_node->full_identifier().c_str());
+  }
+  /* Perform operation. It is always timed, since the time is used to prioritize operations in
+   * the following evaluations. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double time = PIL_check_seconds_timer() - start_time;
+  operation_node->stats.add_average_time(time);
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    operation_node->stats.current_time += time;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  if (do_trace) {
+    BLI_task_trace_event_end();
   }
 }
 
@@ -108,15 +168,17 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
+  /* Evaluate the most important ready node, see #ReadyQueue. */
+  BLI_assert(taskdata == nullptr);
+  UNUSED_VARS_NDEBUG(taskdata);
+  OperationNode *operation_node = state->ready_queue.pop();
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
   schedule_children(state, operation_node, schedule_node_to_pool, pool);
 }
 
-bool check_operation_node_visible(OperationNode *op_node)
+bool check_operation_node_visible(const OperationNode *op_node)
 {
   const ComponentNode *comp_node = op_node->owner;
   /* Special exception, copy on write component is to be always evaluated,
@@ -166,10 +228,66 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+bool need_evaluate_operation(const OperationNode *node)
+{
+  return check_operation_node_visible(node) && (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0;
+}
+
+/* Priority of an operation is its own average evaluation time plus the highest priority of the
+ * operations depending on it, so it estimates the time of the longest chain which can only start
+ * once this operation is done. Only operations which are to be evaluated are taken into account.
+ *
+ * Operations are visited in reverse topological order, using `custom_flags` to count the
+ * dependent operations which are not visited yet. */
+void calculate_priorities(Depsgraph *graph)
+{
+  /* Makes longer chains more important before any timing is known. */
+  const float min_operation_time = 1e-6f;
+
+  Vector<OperationNode *> ready_nodes;
+  for (OperationNode *node : graph->operations) {
+    node->priority = 0.0f;
+    node->custom_flags = 0;
+    if (!need_evaluate_operation(node)) {
+      continue;
+    }
+    for (Relation *rel : node->outlinks) {
+      if (rel->to->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0 &&
+          need_evaluate_operation((OperationNode *)rel->to)) {
+        node->custom_flags++;
+      }
+    }
+    if (node->custom_flags == 0) {
+      ready_nodes.append(node);
+    }
+  }
+
+  while (!ready_nodes.is_empty()) {
+    OperationNode *node = ready_nodes.pop_last();
+    if (!node->is_noop()) {
+      node->priority += std::max(float(node->stats.average_time), min_operation_time);
+    }
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *from = (OperationNode *)rel->from;
+      if (!need_evaluate_operation(from)) {
+        continue;
+      }
+      from->priority = std::max(from->priority, node->priority);
+      if (--from->custom_flags == 0) {
+        ready_nodes.append(from);
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  calculate_priorities(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -20,6 +20,8 @@
 #include <cstring>
 
 #include "BLI_listbase.h"
+#include "BLI_math_rotation.h"
+#include "BLI_math_vector.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -987,6 +989,25 @@ void discard_edit_mode_pointers(ID *id_cow)
 
 }  // namespace
 
+bool deg_update_copy_on_write_transform(const IDNode *id_node)
+{
+  const ID *id_orig = id_node->id_orig;
+  ID *id_cow = id_node->id_cow;
+  if (GS(id_orig->name) != ID_OB || !deg_copy_on_write_is_expanded(id_cow)) {
+    return false;
+  }
+  const Object *object_orig = (const Object *)id_orig;
+  Object *object_cow = (Object *)id_cow;
+  BKE_object_transform_copy(object_cow, object_orig);
+  copy_v3_v3(object_cow->dloc, object_orig->dloc);
+  copy_v3_v3(object_cow->drot, object_orig->drot);
+  copy_qt_qt(object_cow->dquat, object_orig->dquat);
+  copy_v3_v3(object_cow->drotAxis, object_orig->drotAxis);
+  object_cow->drotAngle = object_orig->drotAngle;
+  copy_v3_v3(object_cow->dscale, object_orig->dscale);
+  return true;
+}
+
 /**
  *  Free content of the CoW data-block.
  * Notes:
@@ -41,6 +41,14 @@ struct IDNode;
 ID *deg_update_copy_on_write_datablock(const struct Depsgraph *depsgraph, const IDNode *id_node);
 ID *deg_update_copy_on_write_datablock(const struct Depsgraph *depsgraph, struct ID *id_orig);
 
+/**
+ * Copy transform channels of the original object to its already expanded copy-on-write
+ * data-block, without copying the rest of the data-block.
+ * Returns false when the ID is not an object or its copy is not expanded yet, in which case the
+ * whole data-block is to be copied.
+ */
+bool deg_update_copy_on_write_transform(const IDNode *id_node);
+
 /** Helper function which frees memory used by copy-on-written data-block. */
 void deg_free_copy_on_write_datablock(struct ID *id_cow);
 
@@ -7,8 +7,12 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include <cstdio>
+
 #include "BLI_utildefines.h"
 
+#include "BKE_global.h"
+
 #include "intern/depsgraph.h"
 
 #include "intern/node/deg_node.h"
@@ -38,4 +42,36 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_build_stats_add(Depsgraph *graph,
+                         const bool is_incremental,
+                         const int ids_num,
+                         const double time)
+{
+  BuildStats &stats = graph->build_stats;
+  if (is_incremental) {
+    stats.incremental_updates_num++;
+    stats.incremental_updates_time += time;
+  }
+  else {
+    stats.full_updates_num++;
+    stats.full_updates_time += time;
+  }
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    if (is_incremental) {
+      printf("Depsgraph relations of %d IDs updated in %f seconds.\n", ids_num, time);
+    }
+    else {
+      printf("Depsgraph built in %f seconds.\n", time);
+    }
+  }
+}
+
+void deg_build_stats_add_incremental_fallback(Depsgraph *graph)
+{
+  graph->build_stats.incremental_fallbacks_num++;
+  if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+    printf("Depsgraph relations can not be updated incrementally, rebuilding the graph.\n");
+  }
+}
+
 }  // namespace blender::deg
@@ -12,8 +12,25 @@ namespace deg {
 
 struct Depsgraph;
 
+/* Statistics of relations updates of a dependency graph. */
+struct BuildStats {
+  /* Number of updates since the graph was created. */
+  int full_updates_num = 0;
+  int incremental_updates_num = 0;
+  /* Incremental updates which were not possible, and were done as full update instead. */
+  int incremental_fallbacks_num = 0;
+  /* Accumulated time of the updates, in seconds. */
+  double full_updates_time = 0.0;
+  double incremental_updates_time = 0.0;
+};
+
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Accumulate the time it took to update relations of the given number of IDs.
+ * The time is printed when depsgraph build or time debugging is enabled. */
+void deg_build_stats_add(Depsgraph *graph, bool is_incremental, int ids_num, double time);
+void deg_build_stats_add_incremental_fallback(Depsgraph *graph);
+
 }  // namespace deg
 }  // namespace blender
@@ -265,6 +265,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -272,6 +273,18 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::add_average_time(const double time)
+{
+  if (average_time == 0.0) {
+    average_time = time;
+  }
+  else {
+    /* Exponential moving average, to follow changes in the evaluated data within a few frames
+     * while smoothing out noise. */
+    average_time += (time - average_time) * 0.25;
+  }
+}
+
 /*******************************************************************************
  * Node itself.
  */
@@ -160,8 +160,13 @@ struct Node {
     /* Reset counters needed for the current graph evaluation, does not
      * touch averaging accumulators. */
     void reset_current();
+    /* Accumulate time spent on evaluation of this node into the running average. */
+    void add_average_time(double time);
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Running average of the evaluation time, over the evaluations this node was part of.
+     * Zero when the node was never evaluated. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -256,6 +256,11 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated evaluation time of the longest chain of operations starting at this one, in
+   * seconds. Ready operations with a higher priority are evaluated first, so that long chains
+   * start as early as possible. */
+  float priority;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
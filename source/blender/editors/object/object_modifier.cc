@@ -227,7 +227,7 @@ ModifierData *ED_object_modifier_add(
   BKE_object_modifier_set_active(ob, new_md);
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_relations_update(bmain, &ob->id);
 
   return new_md;
 }
@@ -324,6 +324,7 @@ static bool object_modifier_remove(
   /* special cases */
   if (md->type == eModifierType_ParticleSystem) {
     object_remove_particle_system(bmain, scene, ob, ((ParticleSystemModifierData *)md)->psys);
+    *r_sort_depsgraph = true;
     return true;
   }
 
@@ -381,7 +382,12 @@ bool ED_object_modifier_remove(
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  if (sort_depsgraph) {
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_tag_relations_update(bmain, &ob->id);
+  }
 
   return true;
 }
@@ -404,7 +410,12 @@ void ED_object_modifier_clear(Main *bmain, Scene *scene, Object *ob)
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  if (sort_depsgraph) {
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_tag_relations_update(bmain, &ob->id);
+  }
 }
 
 bool ED_object_modifier_move_up(ReportList *reports, Object *ob, ModifierData *md)
@@ -1581,10 +1581,29 @@ static void node_add_error_message_button(
   UI_block_emboss_set(&block, UI_EMBOSS);
 }
 
+/** Execution time and cache usage of one or more nodes from the latest evaluation. */
+struct NodeExecutionStats {
+  std::chrono::microseconds exec_time = std::chrono::microseconds::zero();
+  int node_count = 0;
+  int cache_hits = 0;
+  int cache_misses = 0;
+
+  void add(const geo_log::NodeLog &node_log)
+  {
+    exec_time += node_log.execution_time();
+    node_count++;
+    if (node_log.cache_usage() == geo_log::NodeCacheUsage::Hit) {
+      cache_hits++;
+    }
+    else if (node_log.cache_usage() == geo_log::NodeCacheUsage::Miss) {
+      cache_misses++;
+    }
+  }
+};
+
 static void get_exec_time_other_nodes(const bNode &node,
                                       const SpaceNode &snode,
-                                      std::chrono::microseconds &exec_time,
-                                      int &node_count)
+                                      NodeExecutionStats &stats)
 {
   if (node.type == NODE_GROUP) {
     const geo_log::TreeLog *root_tree_log = geo_log::ModifierLog::find_tree_by_node_editor_context(
@@ -1596,38 +1615,30 @@ static void get_exec_time_other_nodes(const bNode &node,
     if (tree_log == nullptr) {
       return;
     }
-    tree_log->foreach_node_log([&](const geo_log::NodeLog &node_log) {
-      exec_time += node_log.execution_time();
-      node_count++;
-    });
+    tree_log->foreach_node_log([&](const geo_log::NodeLog &node_log) { stats.add(node_log); });
   }
   else {
     const geo_log::NodeLog *node_log = geo_log::ModifierLog::find_node_by_node_editor_context(
         snode, node);
     if (node_log) {
-      exec_time += node_log->execution_time();
-      node_count++;
+      stats.add(*node_log);
     }
   }
 }
 
-static std::chrono::microseconds node_get_execution_time(const bNodeTree &ntree,
-                                                         const bNode &node,
-                                                         const SpaceNode &snode,
-                                                         int &node_count)
+static void node_get_execution_stats(const bNodeTree &ntree,
+                                     const bNode &node,
+                                     const SpaceNode &snode,
+                                     NodeExecutionStats &stats)
 {
-  std::chrono::microseconds exec_time = std::chrono::microseconds::zero();
   if (node.type == NODE_GROUP_OUTPUT) {
     const geo_log::TreeLog *tree_log = geo_log::ModifierLog::find_tree_by_node_editor_context(
         snode);
 
     if (tree_log == nullptr) {
-      return exec_time;
+      return;
     }
-    tree_log->foreach_node_log([&](const geo_log::NodeLog &node_log) {
-      exec_time += node_log.execution_time();
-      node_count++;
-    });
+    tree_log->foreach_node_log([&](const geo_log::NodeLog &node_log) { stats.add(node_log); });
   }
   else if (node.type == NODE_FRAME) {
     /* Could be cached in the future if this recursive code turns out to be slow. */
@@ -1637,37 +1648,46 @@ static std::chrono::microseconds node_get_execution_time(const bNodeTree &ntree,
       }
 
       if (tnode->type == NODE_FRAME) {
-        exec_time += node_get_execution_time(ntree, *tnode, snode, node_count);
+        node_get_execution_stats(ntree, *tnode, snode, stats);
       }
       else {
-        get_exec_time_other_nodes(*tnode, snode, exec_time, node_count);
+        get_exec_time_other_nodes(*tnode, snode, stats);
       }
     }
   }
   else {
-    get_exec_time_other_nodes(node, snode, exec_time, node_count);
+    get_exec_time_other_nodes(node, snode, stats);
   }
-  return exec_time;
 }
 
 static std::string node_get_execution_time_label(const SpaceNode &snode, const bNode &node)
 {
-  int node_count = 0;
-  std::chrono::microseconds exec_time = node_get_execution_time(
-      *snode.nodetree, node, snode, node_count);
+  NodeExecutionStats stats;
+  node_get_execution_stats(*snode.nodetree, node, snode, stats);
 
-  if (node_count == 0) {
+  if (stats.node_count == 0) {
     return std::string("");
   }
 
-  uint64_t exec_time_us = exec_time.count();
+  if (stats.node_count == 1 && stats.cache_hits == 1) {
+    /* The node was not executed, because its outputs were cached. */
+    return TIP_("Cached");
+  }
+  /* For multiple nodes, show how many of the cacheable nodes did not have to be executed. */
+  std::string cache_label;
+  if (stats.node_count > 1 && stats.cache_hits > 0) {
+    cache_label = " (" + std::to_string(stats.cache_hits) + "/" +
+                  std::to_string(stats.cache_hits + stats.cache_misses) + TIP_(" cached") + ")";
+  }
+
+  uint64_t exec_time_us = stats.exec_time.count();
 
   /* Don't show time if execution time is 0 microseconds. */
   if (exec_time_us == 0) {
-    return std::string("-");
+    return std::string("-") + cache_label;
   }
   if (exec_time_us < 100) {
-    return std::string("< 0.1 ms");
+    return std::string("< 0.1 ms") + cache_label;
   }
 
   int precision = 0;
@@ -1681,7 +1701,7 @@ static std::string node_get_execution_time_label(const SpaceNode &snode, const b
 
   std::stringstream stream;
   stream << std::fixed << std::setprecision(precision) << (exec_time_us / 1000.0f);
-  return stream.str() + " ms";
+  return stream.str() + " ms" + cache_label;
 }
 
 struct NodeExtraInfoRow {
@@ -1843,7 +1863,8 @@ static Vector<NodeExtraInfoRow> node_get_extra_info(const SpaceNode &snode, cons
     if (!row.text.empty()) {
       row.tooltip = TIP_(
           "The execution time from the node tree's latest evaluation. For frame and group nodes, "
-          "the time for all sub-nodes");
+          "the time for all sub-nodes. Cached nodes reused their outputs from an earlier "
+          "evaluation, because their inputs did not change");
       row.icon = ICON_PREVIEW_RANGE;
       rows.append(std::move(row));
     }
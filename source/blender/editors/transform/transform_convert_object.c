@@ -890,10 +890,9 @@ void recalcData_objects(TransInfo *t)
 
       motionpath_update |= motionpath_need_update_object(t->scene, ob);
 
-      /* sets recalc flags fully, instead of flushing existing ones
-       * otherwise proxies don't function correctly
-       */
-      DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM);
+      /* Only the transform channels change while transforming, so avoid copying the whole
+       * object to its evaluated version on every step. */
+      DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM_CHANNELS);
     }
   }
 
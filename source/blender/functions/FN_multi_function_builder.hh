@@ -150,11 +150,11 @@ template<typename ParamTag> struct ArgInfo {
 /**
  * Similar to #execute_array but accepts two mask inputs, one for inputs and one for outputs.
  */
-template<typename... ParamTags, typename ElementFn, typename... Chunks>
+template<typename... ParamTags, typename OutMaskT, typename ElementFn, typename... Chunks>
 void execute_materialized_impl(TypeSequence<ParamTags...> /* param_tags */,
                                const ElementFn element_fn,
                                const IndexRange in_mask,
-                               const IndexMask out_mask,
+                               const OutMaskT out_mask,
                                Chunks &&__restrict... chunks)
 {
   BLI_assert(in_mask.size() == out_mask.size());
@@ -174,6 +174,28 @@ void execute_materialized_impl(TypeSequence<ParamTags...> /* param_tags */,
   }
 }
 
+/**
+ * Calls #execute_materialized_impl, but when there are no gaps in the output mask, it is passed on
+ * as a range. Then all memory accesses in the loop are contiguous and the compiler can vectorize
+ * it.
+ */
+template<typename... ParamTags, typename ElementFn, typename... Chunks>
+void execute_materialized_chunk(TypeSequence<ParamTags...> param_tags,
+                                const ElementFn element_fn,
+                                const IndexRange in_mask,
+                                const IndexMask out_mask,
+                                Chunks &&...chunks)
+{
+  if (out_mask.is_range()) {
+    execute_materialized_impl(
+        param_tags, element_fn, in_mask, out_mask.as_range(), std::forward<Chunks>(chunks)...);
+  }
+  else {
+    execute_materialized_impl(
+        param_tags, element_fn, in_mask, out_mask, std::forward<Chunks>(chunks)...);
+  }
+}
+
 /**
  * Executes #element_fn for all indices in #mask. However, instead of processing every element
  * separately, processing happens in chunks. This allows retrieving from input virtual arrays in
@@ -235,7 +257,7 @@ void execute_materialized(TypeSequence<ParamTags...> /* param_tags */,
     const int64_t chunk_size = sliced_mask.size();
     const bool sliced_mask_is_range = sliced_mask.is_range();
 
-    execute_materialized_impl(
+    execute_materialized_chunk(
         TypeSequence<ParamTags...>(),
         element_fn,
         /* Inputs are "compressed" into contiguous arrays without gaps. */
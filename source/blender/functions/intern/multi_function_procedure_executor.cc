@@ -152,8 +152,15 @@ class ValueAllocator : NonCopyable, NonMovable {
   /** The cached memory buffers can hold #VariableState values. */
   Stack<void *> variable_state_free_list_;
 
+  /**
+   * All span buffers are allocated with this many elements, so that they can be reused when the
+   * procedure is executed multiple times for different chunks.
+   */
+  int64_t span_buffer_size_;
+
  public:
-  ValueAllocator(LinearAllocator<> &linear_allocator) : linear_allocator_(linear_allocator)
+  ValueAllocator(LinearAllocator<> &linear_allocator, const int64_t span_buffer_size)
+      : linear_allocator_(linear_allocator), span_buffer_size_(span_buffer_size)
   {
   }
 
@@ -178,6 +185,8 @@ class ValueAllocator : NonCopyable, NonMovable {
 
   VariableValue_Span *obtain_Span(const CPPType &type, int size)
   {
+    BLI_assert(size <= span_buffer_size_);
+    UNUSED_VARS_NDEBUG(size);
     void *buffer = nullptr;
 
     const int64_t element_size = type.size();
@@ -185,12 +194,12 @@ class ValueAllocator : NonCopyable, NonMovable {
 
     if (alignment > min_alignment) {
       /* In this rare case we fallback to not reusing existing buffers. */
-      buffer = linear_allocator_.allocate(element_size * size, alignment);
+      buffer = linear_allocator_.allocate(element_size * span_buffer_size_, alignment);
     }
     else {
       Stack<void *> *stack = span_buffers_free_list_.lookup_ptr(element_size);
       if (stack == nullptr || stack->is_empty()) {
-        buffer = linear_allocator_.allocate(element_size * size, min_alignment);
+        buffer = linear_allocator_.allocate(element_size * span_buffer_size_, min_alignment);
       }
       else {
         /* Reuse existing buffer. */
@@ -807,13 +816,13 @@ void ValueAllocator::release_variable_state(VariableState *state)
 /** Keeps track of the states of all variables during evaluation. */
 class VariableStates {
  private:
-  ValueAllocator value_allocator_;
+  ValueAllocator &value_allocator_;
   Map<const MFVariable *, VariableState *> variable_states_;
   IndexMask full_mask_;
 
  public:
-  VariableStates(LinearAllocator<> &linear_allocator, IndexMask full_mask)
-      : value_allocator_(linear_allocator), full_mask_(full_mask)
+  VariableStates(ValueAllocator &value_allocator, IndexMask full_mask)
+      : value_allocator_(value_allocator), full_mask_(full_mask)
   {
   }
 
@@ -1156,17 +1165,18 @@ class InstructionScheduler {
   }
 };
 
-void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext context) const
+static void execute_procedure(const MFProcedureExecutor &fn,
+                              const MFProcedure &procedure,
+                              ValueAllocator &value_allocator,
+                              IndexMask full_mask,
+                              MFParams params,
+                              MFContext context)
 {
-  BLI_assert(procedure_.validate());
-
-  LinearAllocator<> linear_allocator;
-
-  VariableStates variable_states{linear_allocator, full_mask};
-  variable_states.add_initial_variable_states(*this, procedure_, params);
+  VariableStates variable_states{value_allocator, full_mask};
+  variable_states.add_initial_variable_states(fn, procedure, params);
 
   InstructionScheduler scheduler;
-  scheduler.add_referenced_indices(*procedure_.entry(), full_mask);
+  scheduler.add_referenced_indices(*procedure.entry(), full_mask);
 
   /* Loop until all indices got to a return instruction. */
   while (NextInstructionInfo instr_info = scheduler.pop_next()) {
@@ -1212,9 +1222,9 @@ void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext c
     }
   }
 
-  for (const int param_index : this->param_indices()) {
-    const MFParamType param_type = this->param_type(param_index);
-    const MFVariable *variable = procedure_.params()[param_index].variable;
+  for (const int param_index : fn.param_indices()) {
+    const MFParamType param_type = fn.param_type(param_index);
+    const MFVariable *variable = procedure.params()[param_index].variable;
     VariableState &variable_state = variable_states.get_variable_state(*variable);
     switch (param_type.interface_type()) {
       case MFParamType::Input: {
@@ -1235,6 +1245,99 @@ void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext c
   }
 }
 
+/**
+ * Executing the procedure on all indices at once requires buffers for all intermediate values that
+ * are as large as the mask. For long chains of functions, most time is then spent on moving those
+ * buffers through memory. Processing smaller chunks one after another keeps the intermediate
+ * values in the CPU cache and allows reusing the same buffers for every chunk.
+ */
+static constexpr int64_t chunk_size = 4096;
+
+static bool supports_chunked_execution(const MultiFunction &fn)
+{
+  for (const int param_index : fn.param_indices()) {
+    if (fn.param_type(param_index).data_type().is_vector()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static IndexRange get_chunk_range(const IndexMask full_mask, const int64_t chunk_index)
+{
+  const int64_t start = chunk_index * chunk_size;
+  return IndexRange(start, std::min(chunk_size, full_mask.size() - start));
+}
+
+void MFProcedureExecutor::call(IndexMask full_mask, MFParams params, MFContext context) const
+{
+  BLI_assert(procedure_.validate());
+
+  LinearAllocator<> linear_allocator;
+
+  if (full_mask.size() <= chunk_size || !supports_chunked_execution(*this)) {
+    ValueAllocator value_allocator{linear_allocator, full_mask.min_array_size()};
+    execute_procedure(*this, procedure_, value_allocator, full_mask, params, context);
+    return;
+  }
+
+  const int64_t chunks_num = (full_mask.size() + chunk_size - 1) / chunk_size;
+
+  /* The same buffers are used for all chunks, so they have to be large enough for every chunk.
+   * This is only larger than the chunk size when the mask has gaps. */
+  int64_t max_chunk_array_size = 0;
+  for (const int64_t chunk_index : IndexRange(chunks_num)) {
+    const IndexRange chunk_range = get_chunk_range(full_mask, chunk_index);
+    max_chunk_array_size = std::max(
+        max_chunk_array_size, full_mask[chunk_range.last()] - full_mask[chunk_range.first()] + 1);
+  }
+  ValueAllocator value_allocator{linear_allocator, max_chunk_array_size};
+
+  Vector<int64_t> offset_mask_indices;
+  for (const int64_t chunk_index : IndexRange(chunks_num)) {
+    const IndexRange chunk_range = get_chunk_range(full_mask, chunk_index);
+    const IndexMask offset_mask = full_mask.slice_and_offset(chunk_range, offset_mask_indices);
+    const int64_t array_start = full_mask[chunk_range.first()];
+    const IndexRange array_range{array_start, full_mask[chunk_range.last()] - array_start + 1};
+
+    /* Slice all parameters so that the procedure only sees the current chunk. */
+    MFParamsBuilder chunk_params{*this, offset_mask.min_array_size()};
+    for (const int param_index : this->param_indices()) {
+      const MFParamType param_type = this->param_type(param_index);
+      switch (param_type.category()) {
+        case MFParamCategory::SingleInput: {
+          const GVArray &varray = params.readonly_single_input(param_index);
+          chunk_params.add_readonly_single_input(varray.slice(array_range));
+          break;
+        }
+        case MFParamCategory::SingleMutable: {
+          const GMutableSpan span = params.single_mutable(param_index);
+          chunk_params.add_single_mutable(span.slice(array_range));
+          break;
+        }
+        case MFParamCategory::SingleOutput: {
+          const GMutableSpan span = params.uninitialized_single_output_if_required(param_index);
+          if (span.is_empty()) {
+            chunk_params.add_ignored_single_output();
+          }
+          else {
+            chunk_params.add_uninitialized_single_output(span.slice(array_range));
+          }
+          break;
+        }
+        case MFParamCategory::VectorInput:
+        case MFParamCategory::VectorMutable:
+        case MFParamCategory::VectorOutput: {
+          BLI_assert_unreachable();
+          break;
+        }
+      }
+    }
+
+    execute_procedure(*this, procedure_, value_allocator, offset_mask, chunk_params, context);
+  }
+}
+
 MultiFunction::ExecutionHints MFProcedureExecutor::get_execution_hints() const
 {
   ExecutionHints hints;
@@ -3,6 +3,7 @@
 #include "testing/testing.h"
 
 #include "BLI_cpp_type.hh"
+#include "BLI_timeit.hh"
 #include "FN_field.hh"
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_test_common.hh"
@@ -289,4 +290,45 @@ TEST(field, IgnoredOutput)
   EXPECT_EQ(results.get(3), 5);
 }
 
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it takes a while
+ * and needs a lot of memory.
+ */
+#if 0
+TEST(field, BenchmarkLongChain)
+{
+  /* Evaluate a long chain of math functions on many points, which is bound by memory bandwidth
+   * when all intermediate values are stored in arrays that are as large as the input. */
+  const int size = 50000000;
+  const int chain_length = 20;
+
+  static CustomMF_SI_SO<int, float> to_float_fn{"to float", [](int a) { return float(a); }};
+  static CustomMF_SI_SO<float, float> scale_fn{"scale", [](float a) { return a * 0.5f; }};
+  static CustomMF_SI_SI_SO<float, float, float> add_fn{"add",
+                                                       [](float a, float b) { return a + b; }};
+
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  Field<float> input_field{
+      std::make_shared<FieldOperation>(to_float_fn, Vector<GField>{index_field}), 0};
+  Field<float> field = input_field;
+  for (int i = 0; i < chain_length; i++) {
+    field = Field<float>{
+        std::make_shared<FieldOperation>(add_fn, Vector<GField>{field, input_field}), 0};
+    field = Field<float>{std::make_shared<FieldOperation>(scale_fn, Vector<GField>{field}), 0};
+  }
+
+  Array<float> result(size);
+  FieldContext context;
+  for (int i = 0; i < 3; i++) {
+    SCOPED_TIMER("Long Chain");
+    FieldEvaluator evaluator{context, size};
+    evaluator.add_with_destination(field, result.as_mutable_span());
+    evaluator.evaluate();
+  }
+
+  /* Print the value for simple error checking and to avoid some compiler optimizations. */
+  std::cout << "Result: " << result[size / 2] << "\n";
+}
+#endif
+
 }  // namespace blender::fn::tests
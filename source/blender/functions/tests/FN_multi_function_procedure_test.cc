@@ -408,4 +408,69 @@ TEST(multi_function_procedure, OutputBufferReplaced)
   EXPECT_EQ(output[2], output_value);
 }
 
+TEST(multi_function_procedure, ChunkedExecution)
+{
+  /**
+   * procedure(int a, int *b, int *out) {
+   *   int c = a + 10;
+   *   b += 10;
+   *   out = c + b;
+   * }
+   */
+
+  CustomMF_SI_SO<int, int> add_10_fn{"add 10", [](int a) { return a + 10; }};
+  CustomMF_SM<int> add_10_mutable_fn{"add 10", [](int &a) { a += 10; }};
+  CustomMF_SI_SI_SO<int, int, int> add_fn{"add", [](int a, int b) { return a + b; }};
+
+  MFProcedure procedure;
+  MFProcedureBuilder builder{procedure};
+
+  MFVariable *var_a = &builder.add_single_input_parameter<int>();
+  MFVariable *var_b = &builder.add_single_mutable_parameter<int>();
+  auto [var_c] = builder.add_call<1>(add_10_fn, {var_a});
+  builder.add_destruct(*var_a);
+  builder.add_call(add_10_mutable_fn, {var_b});
+  auto [var_out] = builder.add_call<1>(add_fn, {var_c, var_b});
+  builder.add_destruct(*var_c);
+  builder.add_return();
+  builder.add_output_parameter(*var_out);
+
+  EXPECT_TRUE(procedure.validate());
+
+  MFProcedureExecutor procedure_fn{procedure};
+
+  /* Use a mask with gaps that is large enough to be split into multiple chunks. */
+  const int size = 100000;
+  Vector<int64_t> indices;
+  for (int i = 0; i < size; i += 3) {
+    indices.append(i);
+  }
+  Array<int> inputs(size);
+  Array<int> mutables(size);
+  for (const int i : IndexRange(size)) {
+    inputs[i] = i;
+    mutables[i] = 2 * i;
+  }
+  Array<int> results(size, -1);
+
+  MFParamsBuilder params{procedure_fn, size};
+  params.add_readonly_single_input(inputs.as_span());
+  params.add_single_mutable(mutables.as_mutable_span());
+  params.add_uninitialized_single_output(results.as_mutable_span());
+
+  MFContextBuilder context;
+  procedure_fn.call(indices.as_span(), params, context);
+
+  for (const int i : IndexRange(size)) {
+    if (i % 3 == 0) {
+      EXPECT_EQ(mutables[i], 2 * i + 10);
+      EXPECT_EQ(results[i], 3 * i + 20);
+    }
+    else {
+      EXPECT_EQ(mutables[i], 2 * i);
+      EXPECT_EQ(results[i], -1);
+    }
+  }
+}
+
 }  // namespace blender::fn::tests
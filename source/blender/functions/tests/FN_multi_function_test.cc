@@ -2,6 +2,10 @@
 
 #include "testing/testing.h"
 
+#include "BLI_function_ref.hh"
+#include "BLI_math_vec_types.hh"
+#include "BLI_timeit.hh"
+
 #include "FN_multi_function.hh"
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_test_common.hh"
@@ -334,5 +338,74 @@ TEST(multi_function, IgnoredOutputs)
   }
 }
 
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
+ */
+#if 0
+static void benchmark_throughput(StringRef name,
+                                 const MultiFunction &fn,
+                                 const IndexMask mask,
+                                 FunctionRef<void(MFParamsBuilder &params)> add_params)
+{
+  MFContextBuilder context;
+  timeit::Nanoseconds min_time = timeit::Nanoseconds::max();
+  for (int i = 0; i < 10; i++) {
+    MFParamsBuilder params{fn, mask.min_array_size()};
+    add_params(params);
+    const timeit::TimePoint start = timeit::Clock::now();
+    fn.call(mask, params, context);
+    min_time = std::min(min_time, timeit::Clock::now() - start);
+  }
+  std::cout << name << ": " << double(min_time.count()) / double(mask.size())
+            << " ns per element\n";
+}
+
+TEST(multi_function, BenchmarkMathThroughput)
+{
+  const int size = 1000000;
+  Array<float3> a(size, float3(1.0f, 2.0f, 3.0f));
+  Array<float3> b(size, float3(4.0f, 5.0f, 6.0f));
+  Array<float3> result(size);
+  const VArray<float3> a_span = VArray<float3>::ForSpan(a);
+  const VArray<float3> b_span = VArray<float3>::ForSpan(b);
+  const VArray<float3> b_single = VArray<float3>::ForSingle(float3(4.0f, 5.0f, 6.0f), size);
+  const VArray<float3> b_func = VArray<float3>::ForFunc(
+      size, [](const int64_t i) { return float3(float(i)); });
+
+  Vector<int64_t> every_other_indices;
+  for (int i = 0; i < size; i += 2) {
+    every_other_indices.append(i);
+  }
+  const IndexMask every_other = every_other_indices.as_span();
+
+  CustomMF_SI_SI_SO<float3, float3, float3> add_fast{
+      "Add", [](float3 a, float3 b) { return a + b; }, CustomMF_presets::AllSpanOrSingle()};
+  CustomMF_SI_SI_SO<float3, float3, float3> add_slow{
+      "Add", [](float3 a, float3 b) { return a + b; }, CustomMF_presets::Materialized()};
+
+  const Vector<std::pair<std::string, const MultiFunction *>> functions = {
+      {"Devirtualized", &add_fast}, {"Materialized", &add_slow}};
+  const Vector<std::pair<std::string, const VArray<float3> *>> inputs = {
+      {"Span", &b_span}, {"Single", &b_single}, {"Virtual", &b_func}};
+  const Vector<std::pair<std::string, IndexMask>> masks = {{"Range", IndexMask(size)},
+                                                           {"Every Other", every_other}};
+
+  for (const auto &[fn_name, fn] : functions) {
+    for (const auto &[input_name, b_varray] : inputs) {
+      for (const auto &[mask_name, mask] : masks) {
+        benchmark_throughput(fn_name + ", " + input_name + ", " + mask_name,
+                             *fn,
+                             mask,
+                             [&, b_varray = b_varray](MFParamsBuilder &params) {
+                               params.add_readonly_single_input(a_span);
+                               params.add_readonly_single_input(*b_varray);
+                               params.add_uninitialized_single_output(result.as_mutable_span());
+                             });
+      }
+    }
+  }
+}
+#endif
+
 }  // namespace
 }  // namespace blender::fn::tests
@@ -89,6 +89,15 @@ struct MeshElementStartIndices {
   int edge = 0;
   int poly = 0;
   int loop = 0;
+
+  MeshElementStartIndices &operator+=(const MeshElementStartIndices &other)
+  {
+    vertex += other.vertex;
+    edge += other.edge;
+    poly += other.poly;
+    loop += other.loop;
+    return *this;
+  }
 };
 
 struct MeshRealizeInfo {
@@ -140,6 +149,13 @@ struct RealizeCurveInfo {
 struct CurvesElementStartIndices {
   int point = 0;
   int curve = 0;
+
+  CurvesElementStartIndices &operator+=(const CurvesElementStartIndices &other)
+  {
+    point += other.point;
+    curve += other.curve;
+    return *this;
+  }
 };
 
 struct RealizeCurveTask {
@@ -198,13 +214,6 @@ struct GatherTasks {
   UserCounter<VolumeComponent> first_volume;
 };
 
-/** Current offsets while during the gather operation. */
-struct GatherOffsets {
-  int pointcloud_offset = 0;
-  MeshElementStartIndices mesh_offsets;
-  CurvesElementStartIndices curves_offsets;
-};
-
 struct GatherTasksInfo {
   /** Static information about all geometries that are joined. */
   const AllPointCloudsInfo &pointclouds;
@@ -220,10 +229,11 @@ struct GatherTasksInfo {
    */
   Vector<std::unique_ptr<GArray<>>> &r_temporary_arrays;
 
-  /** All gathered tasks. */
+  /**
+   * All gathered tasks. Their start indices in the output are only computed once all tasks are
+   * known, see #accumulate_task_start_indices.
+   */
   GatherTasks r_tasks;
-  /** Current offsets while gathering tasks. */
-  GatherOffsets r_offsets;
 };
 
 /**
@@ -262,8 +272,14 @@ static void threaded_copy(const GSpan src, GMutableSpan dst)
 {
   BLI_assert(src.size() == dst.size());
   BLI_assert(src.type() == dst.type());
+  const CPPType &type = src.type();
   threading::parallel_for(IndexRange(src.size()), 1024, [&](const IndexRange range) {
-    src.type().copy_construct_n(src.slice(range).data(), dst.slice(range).data(), range.size());
+    if (type.is_trivial()) {
+      memcpy(dst.slice(range).data(), src.slice(range).data(), type.size() * range.size());
+    }
+    else {
+      type.copy_construct_n(src.slice(range).data(), dst.slice(range).data(), range.size());
+    }
   });
 }
 
@@ -333,6 +349,51 @@ static void create_result_ids(const RealizeInstancesOptions &options,
   }
 }
 
+/**
+ * Compute where the elements of every task start in the realized geometry, which is a prefix sum
+ * over the sizes of all tasks. The tasks are split into chunks whose sizes are summed up in
+ * parallel first, so that the start indices can be written in parallel as well. Realizing many
+ * small instances is not held up by a single thread that way.
+ *
+ * \return The total size of all tasks.
+ */
+template<typename T, typename SizeFn, typename SetStartFn>
+static T accumulate_task_start_indices(const int64_t tasks_num,
+                                       const SizeFn &size_fn,
+                                       const SetStartFn &set_start_fn)
+{
+  const int64_t chunk_size = 4096;
+  const int64_t chunks_num = (tasks_num + chunk_size - 1) / chunk_size;
+  auto chunk_tasks = [&](const int64_t chunk) {
+    const int64_t start = chunk * chunk_size;
+    return IndexRange(start, std::min(chunk_size, tasks_num - start));
+  };
+
+  Array<T> chunk_starts(chunks_num + 1, T());
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunk_range) {
+    for (const int64_t chunk : chunk_range) {
+      T chunk_total = T();
+      for (const int64_t task_index : chunk_tasks(chunk)) {
+        chunk_total += size_fn(task_index);
+      }
+      chunk_starts[chunk + 1] = chunk_total;
+    }
+  });
+  for (const int64_t chunk : IndexRange(chunks_num)) {
+    chunk_starts[chunk + 1] += chunk_starts[chunk];
+  }
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunk_range) {
+    for (const int64_t chunk : chunk_range) {
+      T start = chunk_starts[chunk];
+      for (const int64_t task_index : chunk_tasks(chunk)) {
+        set_start_fn(task_index, start);
+        start += size_fn(task_index);
+      }
+    }
+  });
+  return chunk_starts.last();
+}
+
 /* -------------------------------------------------------------------- */
 /** \name Gather Realize Tasks
  * \{ */
@@ -516,15 +577,11 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
         if (mesh != nullptr && mesh->totvert > 0) {
           const int mesh_index = gather_info.meshes.order.index_of(mesh);
           const MeshRealizeInfo &mesh_info = gather_info.meshes.realize_info[mesh_index];
-          gather_info.r_tasks.mesh_tasks.append({gather_info.r_offsets.mesh_offsets,
+          gather_info.r_tasks.mesh_tasks.append({{},
                                                  &mesh_info,
                                                  base_transform,
                                                  base_instance_context.meshes,
                                                  base_instance_context.id});
-          gather_info.r_offsets.mesh_offsets.vertex += mesh->totvert;
-          gather_info.r_offsets.mesh_offsets.edge += mesh->totedge;
-          gather_info.r_offsets.mesh_offsets.loop += mesh->totloop;
-          gather_info.r_offsets.mesh_offsets.poly += mesh->totpoly;
         }
         break;
       }
@@ -536,12 +593,11 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
           const int pointcloud_index = gather_info.pointclouds.order.index_of(pointcloud);
           const PointCloudRealizeInfo &pointcloud_info =
               gather_info.pointclouds.realize_info[pointcloud_index];
-          gather_info.r_tasks.pointcloud_tasks.append({gather_info.r_offsets.pointcloud_offset,
+          gather_info.r_tasks.pointcloud_tasks.append({0,
                                                        &pointcloud_info,
                                                        base_transform,
                                                        base_instance_context.pointclouds,
                                                        base_instance_context.id});
-          gather_info.r_offsets.pointcloud_offset += pointcloud->totpoint;
         }
         break;
       }
@@ -551,13 +607,11 @@ static void gather_realize_tasks_recursive(GatherTasksInfo &gather_info,
         if (curves != nullptr && curves->geometry.curve_size > 0) {
           const int curve_index = gather_info.curves.order.index_of(curves);
           const RealizeCurveInfo &curve_info = gather_info.curves.realize_info[curve_index];
-          gather_info.r_tasks.curve_tasks.append({gather_info.r_offsets.curves_offsets,
+          gather_info.r_tasks.curve_tasks.append({{},
                                                   &curve_info,
                                                   base_transform,
                                                   base_instance_context.curves,
                                                   base_instance_context.id});
-          gather_info.r_offsets.curves_offsets.point += curves->geometry.point_size;
-          gather_info.r_offsets.curves_offsets.curve += curves->geometry.curve_size;
         }
         break;
       }
@@ -697,7 +751,7 @@ static void execute_realize_pointcloud_task(const RealizeInstancesOptions &optio
 
 static void execute_realize_pointcloud_tasks(const RealizeInstancesOptions &options,
                                              const AllPointCloudsInfo &all_pointclouds_info,
-                                             const Span<RealizePointCloudTask> tasks,
+                                             const MutableSpan<RealizePointCloudTask> tasks,
                                              const OrderedAttributes &ordered_attributes,
                                              GeometrySet &r_realized_geometry)
 {
@@ -705,9 +759,10 @@ static void execute_realize_pointcloud_tasks(const RealizeInstancesOptions &opti
     return;
   }
 
-  const RealizePointCloudTask &last_task = tasks.last();
-  const PointCloud &last_pointcloud = *last_task.pointcloud_info->pointcloud;
-  const int tot_points = last_task.start_index + last_pointcloud.totpoint;
+  const int tot_points = accumulate_task_start_indices<int>(
+      tasks.size(),
+      [&](const int64_t i) { return tasks[i].pointcloud_info->pointcloud->totpoint; },
+      [&](const int64_t i, const int start) { tasks[i].start_index = start; });
 
   /* Allocate new point cloud. */
   PointCloud *dst_pointcloud = BKE_pointcloud_new_nomain(tot_points);
@@ -947,7 +1002,7 @@ static void execute_realize_mesh_task(const RealizeInstancesOptions &options,
 
 static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
                                        const AllMeshesInfo &all_meshes_info,
-                                       const Span<RealizeMeshTask> tasks,
+                                       const MutableSpan<RealizeMeshTask> tasks,
                                        const OrderedAttributes &ordered_attributes,
                                        const VectorSet<Material *> &ordered_materials,
                                        GeometrySet &r_realized_geometry)
@@ -956,12 +1011,19 @@ static void execute_realize_mesh_tasks(const RealizeInstancesOptions &options,
     return;
   }
 
-  const RealizeMeshTask &last_task = tasks.last();
-  const Mesh &last_mesh = *last_task.mesh_info->mesh;
-  const int tot_vertices = last_task.start_indices.vertex + last_mesh.totvert;
-  const int tot_edges = last_task.start_indices.edge + last_mesh.totedge;
-  const int tot_loops = last_task.start_indices.loop + last_mesh.totloop;
-  const int tot_poly = last_task.start_indices.poly + last_mesh.totpoly;
+  const MeshElementStartIndices totals = accumulate_task_start_indices<MeshElementStartIndices>(
+      tasks.size(),
+      [&](const int64_t i) {
+        const Mesh &mesh = *tasks[i].mesh_info->mesh;
+        return MeshElementStartIndices{mesh.totvert, mesh.totedge, mesh.totpoly, mesh.totloop};
+      },
+      [&](const int64_t i, const MeshElementStartIndices &start) {
+        tasks[i].start_indices = start;
+      });
+  const int tot_vertices = totals.vertex;
+  const int tot_edges = totals.edge;
+  const int tot_loops = totals.loop;
+  const int tot_poly = totals.poly;
 
   Mesh *dst_mesh = BKE_mesh_new_nomain(tot_vertices, tot_edges, 0, tot_loops, tot_poly);
   MeshComponent &dst_component = r_realized_geometry.get_component_for_write<MeshComponent>();
@@ -1205,7 +1267,7 @@ static void execute_realize_curve_task(const RealizeInstancesOptions &options,
 
 static void execute_realize_curve_tasks(const RealizeInstancesOptions &options,
                                         const AllCurvesInfo &all_curves_info,
-                                        const Span<RealizeCurveTask> tasks,
+                                        const MutableSpan<RealizeCurveTask> tasks,
                                         const OrderedAttributes &ordered_attributes,
                                         GeometrySet &r_realized_geometry)
 {
@@ -1213,10 +1275,19 @@ static void execute_realize_curve_tasks(const RealizeInstancesOptions &options,
     return;
   }
 
-  const RealizeCurveTask &last_task = tasks.last();
-  const Curves &last_curves = *last_task.curve_info->curves;
-  const int points_size = last_task.start_indices.point + last_curves.geometry.point_size;
-  const int curves_size = last_task.start_indices.curve + last_curves.geometry.curve_size;
+  const CurvesElementStartIndices totals =
+      accumulate_task_start_indices<CurvesElementStartIndices>(
+          tasks.size(),
+          [&](const int64_t i) {
+            const Curves &curves = *tasks[i].curve_info->curves;
+            return CurvesElementStartIndices{curves.geometry.point_size,
+                                             curves.geometry.curve_size};
+          },
+          [&](const int64_t i, const CurvesElementStartIndices &start) {
+            tasks[i].start_indices = start;
+          });
+  const int points_size = totals.point;
+  const int curves_size = totals.curve;
 
   /* Allocate new curves data-block. */
   Curves *dst_curves_id = bke::curves_new_nomain(points_size, curves_size);
@@ -1319,11 +1390,12 @@ static void remove_id_attribute_from_instances(GeometrySet &geometry_set)
 
 GeometrySet realize_instances(GeometrySet geometry_set, const RealizeInstancesOptions &options)
 {
-  /* The algorithm works in three steps:
+  /* The algorithm works in four steps:
    * 1. Preprocess each unique geometry that is instanced (e.g. each `Mesh`).
    * 2. Gather "tasks" that need to be executed to realize the instances. Each task corresponds to
    *    instances of the previously preprocessed geometry.
-   * 3. Execute all tasks in parallel.
+   * 3. Compute where the elements of each task start in the output with a parallel prefix sum.
+   * 4. Execute all tasks in parallel.
    */
 
   if (!geometry_set.has_instances()) {
@@ -862,6 +862,12 @@ typedef enum IDRecalcFlag {
   /* The node tree has changed in a way that affects its output nodes. */
   ID_RECALC_NTREE_OUTPUT = (1 << 25),
 
+  /* Only the transform channels (location, rotation, scale and their deltas) of the object have
+   * changed. The channels are copied to the evaluated object in place, without copying the whole
+   * data-block, which keeps interactive transform of objects with heavy data cheap.
+   * Falls back to #ID_RECALC_TRANSFORM when the evaluated copy is not created yet. */
+  ID_RECALC_TRANSFORM_CHANNELS = (1 << 26),
+
   /***************************************************************************
    * Pseudonyms, to have more semantic meaning in the actual code without
    * using too much low-level and implementation specific tags. */
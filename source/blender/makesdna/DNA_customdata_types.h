@@ -46,6 +46,11 @@ typedef struct CustomDataLayer {
    * automatically.
    */
   const struct AnonymousAttributeID *anonymous_id;
+  /**
+   * Run-time user count of #data, when it is shared with layers of other #CustomData (see
+   * #CD_SHARE). Null when the data is owned by this layer only, or when it is referenced.
+   */
+  struct CustomDataLayerSharing *sharing_info;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
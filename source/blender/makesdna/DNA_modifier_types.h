@@ -2292,7 +2292,11 @@ typedef struct NodesModifierData {
    * This can be used to help the user to debug a node tree.
    */
   void *runtime_eval_log;
-  void *_pad1;
+  /**
+   * Output values of nodes from the last evaluation, which are reused when their inputs did not
+   * change. Only used for the active depsgraph.
+   */
+  void *runtime_cache;
 } NodesModifierData;
 
 typedef struct MeshToVolumeModifierData {
@@ -21,6 +21,7 @@
 #include "BLI_utildefines.h"
 
 #include "DNA_collection_types.h"
+#include "DNA_curves_types.h"
 #include "DNA_defaults.h"
 #include "DNA_material_types.h"
 #include "DNA_mesh_types.h"
@@ -118,6 +119,8 @@ using blender::nodes::InputSocketFieldType;
 using blender::threading::EnumerableThreadSpecific;
 using namespace blender::fn::multi_function_types;
 using namespace blender::nodes::derived_node_tree_types;
+using blender::modifiers::geometry_nodes::CacheKeyHasher;
+using blender::modifiers::geometry_nodes::GeometryNodesCache;
 using geo_log::GeometryAttributeInfo;
 using geo_log::NamedAttributeUsage;
 
@@ -802,6 +805,175 @@ static void initialize_group_input(NodesModifierData &nmd,
   }
 }
 
+/**
+ * \return False when the property contains data that can't be hashed.
+ */
+static bool add_id_property_to_cache_key(CacheKeyHasher &hasher, const IDProperty *property)
+{
+  if (property == nullptr) {
+    hasher.add(0);
+    return true;
+  }
+  hasher.add(uint64_t(property->type) + 1);
+  switch (property->type) {
+    case IDP_INT:
+    case IDP_FLOAT:
+    case IDP_DOUBLE:
+      /* Doubles are stored in both integers. */
+      hasher.add_bytes(&property->data.val, sizeof(property->data.val) * 2);
+      return true;
+    case IDP_STRING:
+      hasher.add_string(IDP_String(property));
+      return true;
+    case IDP_ID:
+      hasher.add(uint64_t(uintptr_t(IDP_Id(property))));
+      return true;
+    case IDP_ARRAY:
+      hasher.add(uint64_t(property->subtype));
+      switch (property->subtype) {
+        case IDP_INT:
+        case IDP_FLOAT:
+          hasher.add_bytes(IDP_Array(property), int64_t(sizeof(int)) * property->len);
+          return true;
+        case IDP_DOUBLE:
+          hasher.add_bytes(IDP_Array(property), int64_t(sizeof(double)) * property->len);
+          return true;
+      }
+      return false;
+  }
+  return false;
+}
+
+/**
+ * Hash everything that #initialize_group_input uses to compute the value of the group input.
+ */
+static std::optional<uint64_t> hash_group_input(const NodesModifierData &nmd,
+                                                const OutputSocketRef &socket)
+{
+  CacheKeyHasher hasher;
+  hasher.add_string(socket.identifier());
+  const bNodeSocket &bsocket = *socket.bsocket();
+  if (bsocket.default_value != nullptr) {
+    hasher.add_bytes(bsocket.default_value, MEM_allocN_len(bsocket.default_value));
+  }
+  if (nmd.settings.properties != nullptr) {
+    for (const std::string &suffix :
+         {std::string(), use_attribute_suffix, attribute_name_suffix}) {
+      const IDProperty *property = IDP_GetPropertyFromGroup(
+          nmd.settings.properties, (socket.identifier() + suffix).c_str());
+      if (!add_id_property_to_cache_key(hasher, property)) {
+        return std::nullopt;
+      }
+    }
+  }
+  return hasher.get();
+}
+
+/**
+ * \return False when the layers contain data that can't be hashed.
+ */
+static bool add_custom_data_to_cache_key(CacheKeyHasher &hasher,
+                                         const CustomData &data,
+                                         const int size)
+{
+  hasher.add(uint64_t(size));
+  for (const CustomDataLayer &layer : Span<CustomDataLayer>(data.layers, data.totlayer)) {
+    hasher.add(uint64_t(layer.type));
+    hasher.add_string(layer.name);
+    hasher.add(uint64_t(uintptr_t(layer.anonymous_id)));
+    hasher.add(uint64_t(layer.active));
+    hasher.add(uint64_t(layer.active_rnd));
+    if (layer.data == nullptr) {
+      continue;
+    }
+    switch (layer.type) {
+      case CD_MDEFORMVERT: {
+        /* The weights are stored in separate arrays. */
+        for (const MDeformVert &dvert :
+             Span<MDeformVert>(static_cast<const MDeformVert *>(layer.data), size)) {
+          hasher.add(uint64_t(dvert.totweight));
+          for (const MDeformWeight &weight : Span<MDeformWeight>(dvert.dw, dvert.totweight)) {
+            uint64_t word;
+            static_assert(sizeof(MDeformWeight) == sizeof(word));
+            memcpy(&word, &weight, sizeof(word));
+            hasher.add(word);
+          }
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+        return false;
+      default:
+        hasher.add_bytes(layer.data, int64_t(CustomData_sizeof(layer.type)) * size);
+        break;
+    }
+  }
+  return true;
+}
+
+/**
+ * Hash the contents of the geometry passed to the modifier, so that nodes can be cached when it
+ * did not change. Hashing is much cheaper than the evaluation of most node trees that would be
+ * repeated otherwise.
+ */
+static std::optional<uint64_t> hash_input_geometry(const GeometrySet &geometry_set)
+{
+  CacheKeyHasher hasher;
+  for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+    hasher.add(uint64_t(component->type()));
+    switch (component->type()) {
+      case GEO_COMPONENT_TYPE_MESH: {
+        const Mesh &mesh = *geometry_set.get_mesh_for_read();
+        if (mesh.runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+          return std::nullopt;
+        }
+        hasher.add(uint64_t(mesh.flag));
+        hasher.add_bytes(&mesh.smoothresh, sizeof(mesh.smoothresh));
+        hasher.add_bytes(mesh.mat, int64_t(sizeof(Material *)) * mesh.totcol);
+        /* Vertex group attributes are looked up by these names. */
+        LISTBASE_FOREACH (const bDeformGroup *, group, &mesh.vertex_group_names) {
+          hasher.add_string(group->name);
+        }
+        if (!add_custom_data_to_cache_key(hasher, mesh.vdata, mesh.totvert) ||
+            !add_custom_data_to_cache_key(hasher, mesh.edata, mesh.totedge) ||
+            !add_custom_data_to_cache_key(hasher, mesh.pdata, mesh.totpoly) ||
+            !add_custom_data_to_cache_key(hasher, mesh.ldata, mesh.totloop)) {
+          return std::nullopt;
+        }
+        break;
+      }
+      case GEO_COMPONENT_TYPE_POINT_CLOUD: {
+        const PointCloud &pointcloud = *geometry_set.get_pointcloud_for_read();
+        hasher.add_bytes(pointcloud.mat, int64_t(sizeof(Material *)) * pointcloud.totcol);
+        if (!add_custom_data_to_cache_key(hasher, pointcloud.pdata, pointcloud.totpoint)) {
+          return std::nullopt;
+        }
+        break;
+      }
+      case GEO_COMPONENT_TYPE_CURVE: {
+        const Curves &curves = *geometry_set.get_curves_for_read();
+        const CurvesGeometry &geometry = curves.geometry;
+        hasher.add_bytes(curves.mat, int64_t(sizeof(Material *)) * curves.totcol);
+        if (geometry.curve_offsets != nullptr) {
+          hasher.add_bytes(geometry.curve_offsets,
+                           int64_t(sizeof(int)) * (int64_t(geometry.curve_size) + 1));
+        }
+        if (!add_custom_data_to_cache_key(hasher, geometry.point_data, geometry.point_size) ||
+            !add_custom_data_to_cache_key(hasher, geometry.curve_data, geometry.curve_size)) {
+          return std::nullopt;
+        }
+        break;
+      }
+      case GEO_COMPONENT_TYPE_INSTANCES:
+      case GEO_COMPONENT_TYPE_VOLUME:
+        /* These reference data that is not hashed, like other objects or volume grids. */
+        return std::nullopt;
+    }
+  }
+  return hasher.get();
+}
+
 static Vector<SpaceSpreadsheet *> find_spreadsheet_editors(Main *bmain)
 {
   wmWindowManager *wm = (wmWindowManager *)bmain->wm.first;
@@ -910,6 +1082,14 @@ static void clear_runtime_data(NodesModifierData *nmd)
   }
 }
 
+static void clear_runtime_cache(NodesModifierData *nmd)
+{
+  if (nmd->runtime_cache != nullptr) {
+    delete (GeometryNodesCache *)nmd->runtime_cache;
+    nmd->runtime_cache = nullptr;
+  }
+}
+
 struct OutputAttributeInfo {
   GField field;
   StringRefNull name;
@@ -1073,6 +1253,20 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   blender::nodes::NodeMultiFunctions mf_by_node{tree};
 
   Map<DOutputSocket, GMutablePointer> group_inputs;
+  Map<DOutputSocket, uint64_t> group_input_hashes;
+
+  NodesModifierData *nmd_orig = (NodesModifierData *)BKE_modifier_get_original(ctx->object,
+                                                                               &nmd->modifier);
+  /* Node outputs are only cached for the active depsgraph, which is updated interactively. */
+  GeometryNodesCache *cache = nullptr;
+  std::optional<uint64_t> input_geometry_hash;
+  if (logging_enabled(ctx)) {
+    if (nmd_orig->runtime_cache == nullptr) {
+      nmd_orig->runtime_cache = new GeometryNodesCache();
+    }
+    cache = static_cast<GeometryNodesCache *>(nmd_orig->runtime_cache);
+    input_geometry_hash = hash_input_geometry(input_geometry_set);
+  }
 
   const DTreeContext *root_context = &tree.root_context();
   for (const NodeRef *group_input_node : group_input_nodes) {
@@ -1090,6 +1284,9 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
       GeometrySet *geometry_set_in =
           allocator.construct<GeometrySet>(input_geometry_set).release();
       group_inputs.add_new({root_context, first_input_socket}, geometry_set_in);
+      if (input_geometry_hash) {
+        group_input_hashes.add_new({root_context, first_input_socket}, *input_geometry_hash);
+      }
       remaining_input_sockets = remaining_input_sockets.drop_front(1);
     }
 
@@ -1099,6 +1296,11 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
       void *value_in = allocator.allocate(cpp_type.size(), cpp_type.alignment());
       initialize_group_input(*nmd, *socket, value_in);
       group_inputs.add_new({root_context, socket}, {cpp_type, value_in});
+      if (cache != nullptr) {
+        if (const std::optional<uint64_t> hash = hash_group_input(*nmd, *socket)) {
+          group_input_hashes.add_new({root_context, socket}, *hash);
+        }
+      }
     }
   }
 
@@ -1130,14 +1332,14 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   eval_params.depsgraph = ctx->depsgraph;
   eval_params.self_object = ctx->object;
   eval_params.geo_logger = geo_logger.has_value() ? &*geo_logger : nullptr;
+  eval_params.cache = cache;
+  eval_params.input_hashes = std::move(group_input_hashes);
   blender::modifiers::geometry_nodes::evaluate_geometry_nodes(eval_params);
 
   GeometrySet output_geometry_set = std::move(*eval_params.r_output_values[0].get<GeometrySet>());
 
   if (geo_logger.has_value()) {
     geo_logger->log_output_geometry(output_geometry_set);
-    NodesModifierData *nmd_orig = (NodesModifierData *)BKE_modifier_get_original(ctx->object,
-                                                                                 &nmd->modifier);
     clear_runtime_data(nmd_orig);
     nmd_orig->runtime_eval_log = new geo_log::ModifierLog(*geo_logger);
   }
@@ -1751,6 +1953,7 @@ static void blendRead(BlendDataReader *reader, ModifierData *md)
     IDP_BlendDataRead(reader, &nmd->settings.properties);
   }
   nmd->runtime_eval_log = nullptr;
+  nmd->runtime_cache = nullptr;
 }
 
 static void copyData(const ModifierData *md, ModifierData *target, const int flag)
@@ -1761,6 +1964,7 @@ static void copyData(const ModifierData *md, ModifierData *target, const int fla
   BKE_modifier_copydata_generic(md, target, flag);
 
   tnmd->runtime_eval_log = nullptr;
+  tnmd->runtime_cache = nullptr;
 
   if (nmd->settings.properties != nullptr) {
     tnmd->settings.properties = IDP_CopyProperty_ex(nmd->settings.properties, flag);
@@ -1776,6 +1980,7 @@ static void freeData(ModifierData *md)
   }
 
   clear_runtime_data(nmd);
+  clear_runtime_cache(nmd);
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -2,8 +2,16 @@
 
 #include "MOD_nodes_evaluator.hh"
 
+#include "MEM_guardedalloc.h"
+
+#include "BKE_geometry_set.hh"
+#include "BKE_node.h"
+#include "BKE_scene.h"
 #include "BKE_type_conversions.hh"
 
+#include "DNA_color_types.h"
+#include "DNA_scene_types.h"
+
 #include "NOD_geometry_exec.hh"
 #include "NOD_socket_declarations.hh"
 
@@ -22,7 +30,9 @@
 #include "BLI_task.hh"
 #include "BLI_vector_set.hh"
 
+#include <atomic>
 #include <chrono>
+#include <cstring>
 
 namespace blender::modifiers::geometry_nodes {
 
@@ -100,6 +110,31 @@ struct MultiInputValue {
   }
 };
 
+struct NodeWithState;
+
+/**
+ * A socket that provides the value for an input socket. Links are resolved once before the
+ * evaluation starts, because following them through node groups and reroutes is relatively
+ * expensive and would otherwise be done many times for every link.
+ */
+struct InputOrigin {
+  DSocket socket;
+  /**
+   * The origin node and its state. This is null when the value is loaded from an unlinked input
+   * socket directly, or when the origin node is not evaluated.
+   */
+  const NodeWithState *node_with_state;
+};
+
+/** An input socket that the value of an output socket is forwarded to. */
+struct OutputTarget {
+  DInputSocket socket;
+  /** The target node and its state, only targets that are evaluated are stored. */
+  const NodeWithState *node_with_state;
+  /** The sockets on the way to the target, see #DOutputSocket::TargetSocketPathInfo. */
+  Span<DSocket> path;
+};
+
 struct InputState {
 
   /**
@@ -119,13 +154,22 @@ struct InputState {
     MultiInputValue *multi;
   } value;
 
+  /**
+   * Sockets that provide the value for this input. Empty when the socket is not linked, in which
+   * case the value is loaded from the socket itself.
+   */
+  Span<InputOrigin> origins;
+
   /**
    * How the node intends to use this input. By default all inputs may be used. Based on which
    * outputs are used, a node can tell the evaluator that an input will definitely be used or is
    * never used. This allows the evaluator to free values early, avoid copies and other unnecessary
    * computations.
+   *
+   * This is only changed while the node is locked, but it is atomic so that other nodes can check
+   * if they should forward a value to this input without locking.
    */
-  ValueUsage usage = ValueUsage::Maybe;
+  std::atomic<ValueUsage> usage = ValueUsage::Maybe;
 
   /**
    * True when this input is/was used for an execution. While a node is running, only the inputs
@@ -147,6 +191,11 @@ struct InputState {
 };
 
 struct OutputState {
+  /**
+   * Inputs of evaluated nodes that are linked to this output. This can be accessed without a lock.
+   */
+  Span<OutputTarget> targets;
+
   /**
    * If this output has been computed and forwarded already. If this is true, the value is not
    * computed/forwarded again.
@@ -247,6 +296,19 @@ struct NodeState {
    * not run twice at the same time accidentally.
    */
   NodeScheduleState schedule_state = NodeScheduleState::NotScheduled;
+
+  /**
+   * True when the outputs of the node are loaded from the #GeometryNodesCache, in which case the
+   * node is not executed. This is set before any node runs, so it can be read without a lock.
+   */
+  bool is_loaded_from_cache = false;
+
+  /**
+   * True for nodes that don't process geometry. Those only compute single values or build fields,
+   * which is usually faster than scheduling them in the task pool, so they are run on the thread
+   * that scheduled them. This can be read without a lock.
+   */
+  bool is_trivial = false;
 };
 
 /**
@@ -310,8 +372,8 @@ class LockedNode : NonCopyable, NonMovable {
    *
    * The notifications will be send right after the node is not locked anymore.
    */
-  Vector<DOutputSocket> delayed_required_outputs;
-  Vector<DOutputSocket> delayed_unused_outputs;
+  Vector<InputOrigin> delayed_required_outputs;
+  Vector<InputOrigin> delayed_unused_outputs;
   Vector<DNode> delayed_scheduled_nodes;
 
   LockedNode(const DNode node, NodeState &node_state) : node(node), node_state(node_state)
@@ -400,9 +462,80 @@ static bool node_supports_laziness(const DNode node)
   return node->typeinfo()->geometry_node_execute_supports_laziness;
 }
 
+/**
+ * Nodes whose outputs depend on data outside of the node tree, like other objects or images,
+ * can't be cached. Neither can the nodes that depend on them.
+ */
+static bool node_is_cacheable(const DNode node)
+{
+  if (node->is_group_input_node() || node->is_group_output_node()) {
+    return false;
+  }
+  if (node->outputs().is_empty()) {
+    return false;
+  }
+  switch (node->bnode()->type) {
+    case GEO_NODE_OBJECT_INFO:
+    case GEO_NODE_COLLECTION_INFO:
+    case GEO_NODE_IMAGE_TEXTURE:
+      return false;
+  }
+  return true;
+}
+
+static void add_curve_mapping_to_cache_key(CacheKeyHasher &hasher, const CurveMapping &mapping)
+{
+  /* The evaluation tables are computed from the points, so they are not hashed. */
+  hasher.add(uint64_t(mapping.flag));
+  hasher.add(uint64_t(mapping.preset));
+  hasher.add(uint64_t(mapping.tone));
+  hasher.add_bytes(&mapping.clipr, sizeof(mapping.clipr));
+  hasher.add_bytes(mapping.black, sizeof(mapping.black));
+  hasher.add_bytes(mapping.white, sizeof(mapping.white));
+  for (const CurveMap &curve_map : mapping.cm) {
+    hasher.add(uint64_t(curve_map.totpoint));
+    if (curve_map.curve != nullptr) {
+      hasher.add_bytes(curve_map.curve, int64_t(sizeof(CurveMapPoint)) * curve_map.totpoint);
+    }
+  }
+}
+
+void add_node_storage_to_cache_key(CacheKeyHasher &hasher, const bNode &node)
+{
+  if (node.storage == nullptr) {
+    return;
+  }
+  switch (node.type) {
+    case SH_NODE_CURVE_FLOAT:
+    case SH_NODE_CURVE_VEC:
+    case SH_NODE_CURVE_RGB:
+      /* The curve points are stored in separate arrays. */
+      add_curve_mapping_to_cache_key(hasher, *static_cast<const CurveMapping *>(node.storage));
+      break;
+    case FN_NODE_INPUT_STRING: {
+      /* The string is allocated separately, its address changes when the node is copied. */
+      const NodeInputString &storage = *static_cast<const NodeInputString *>(node.storage);
+      hasher.add_string(storage.string ? storage.string : "");
+      break;
+    }
+    default:
+      hasher.add_bytes(node.storage, MEM_allocN_len(node.storage));
+      break;
+  }
+}
+
+static void add_socket_value_to_cache_key(CacheKeyHasher &hasher, const bNodeSocket &socket)
+{
+  if (socket.default_value != nullptr) {
+    hasher.add_bytes(socket.default_value, MEM_allocN_len(socket.default_value));
+  }
+}
+
 struct NodeTaskRunState {
   /** The node that should be run on the same thread after the current node finished. */
   DNode next_node_to_run;
+  /** Trivial nodes that should be run on the same thread, see #NodeState::is_trivial. */
+  Vector<DNode, 16> trivial_nodes_to_run;
 };
 
 /** Implements the callbacks that might be called when a node is executed. */
@@ -465,6 +598,18 @@ class GeometryNodesEvaluator {
   GeometryNodesEvaluationParams &params_;
   const blender::bke::DataTypeConversions &conversions_;
 
+  /**
+   * Cache keys of the reachable nodes and the nodes they depend on. The key is empty when the
+   * outputs of the node can't be cached. Only used when there is a #GeometryNodesCache. Once all
+   * node states have been constructed, this map can be used for lookups from multiple threads.
+   */
+  Map<DNode, std::optional<uint64_t>> cache_keys_;
+  /**
+   * Nodes whose outputs are loaded from the cache. The nodes they depend on don't have a state,
+   * unless they are used by other nodes as well.
+   */
+  Vector<DNode> cached_nodes_;
+
   friend NodeParamsProvider;
 
  public:
@@ -480,7 +625,11 @@ class GeometryNodesEvaluator {
     task_pool_ = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
 
     this->create_states_for_reachable_nodes();
+    /* The keys of all nodes are known now. Remove values that won't be used anymore before new
+     * values are added, so that they don't count towards the memory limit. */
+    this->remove_unused_cache_values();
     this->forward_group_inputs();
+    this->forward_cached_outputs();
     this->schedule_initial_nodes();
 
     /* This runs until all initially requested inputs have been computed. */
@@ -515,6 +664,12 @@ class GeometryNodesEvaluator {
       NodeState &node_state = *allocator.construct<NodeState>().release();
       node_states_.add_new({node, &node_state});
 
+      if (this->node_outputs_are_cached(node)) {
+        /* The nodes to the left don't have to be evaluated, unless they are used elsewhere. */
+        cached_nodes_.append(node);
+        continue;
+      }
+
       /* Push all linked origins on the stack. */
       for (const InputSocketRef *input_ref : node->inputs()) {
         const DInputSocket input{node.context(), input_ref};
@@ -549,6 +704,9 @@ class GeometryNodesEvaluator {
     node_state.inputs = allocator.construct_array<InputState>(node->inputs().size());
     node_state.outputs = allocator.construct_array<OutputState>(node->outputs().size());
 
+    const CPPType &geometry_type = CPPType::get<GeometrySet>();
+    bool uses_geometry = false;
+
     /* Initialize input states. */
     for (const int i : node->inputs().index_range()) {
       InputState &input_state = node_state.inputs[i];
@@ -566,12 +724,26 @@ class GeometryNodesEvaluator {
         input_state.usage = ValueUsage::Unused;
         continue;
       }
+      uses_geometry |= *type == geometry_type;
+
+      Vector<InputOrigin, 16> origins;
+      socket.foreach_origin_socket([&](const DSocket origin) {
+        const NodeWithState *origin_node_with_state = origin->is_input() ?
+                                                          nullptr :
+                                                          node_states_.lookup_key_ptr_as(
+                                                              origin.node());
+        origins.append({origin, origin_node_with_state});
+      });
+      input_state.origins = allocator.construct_array_copy(origins.as_span());
+
       /* Construct the correct struct that can hold the input(s). */
       if (socket->is_multi_input_socket()) {
         input_state.value.multi = allocator.construct<MultiInputValue>().release();
         MultiInputValue &multi_value = *input_state.value.multi;
         /* Count how many values should be added until the socket is complete. */
-        socket.foreach_origin_socket([&](DSocket origin) { multi_value.origins.append(origin); });
+        for (const InputOrigin &origin : origins) {
+          multi_value.origins.append(origin.socket);
+        }
         /* If no links are connected, we do read the value from socket itself. */
         if (multi_value.origins.is_empty()) {
           multi_value.origins.append(socket);
@@ -597,23 +769,33 @@ class GeometryNodesEvaluator {
         output_state.output_usage = ValueUsage::Unused;
         continue;
       }
-      /* Count the number of potential users for this socket. */
+      uses_geometry |= *type == geometry_type;
+
+      Vector<OutputTarget, 16> targets;
       socket.foreach_target_socket(
           [&, this](const DInputSocket target_socket,
-                    const DOutputSocket::TargetSocketPathInfo &UNUSED(path_info)) {
-            const DNode target_node = target_socket.node();
-            if (!this->node_states_.contains_as(target_node)) {
+                    const DOutputSocket::TargetSocketPathInfo &path_info) {
+            const NodeWithState *target_node_with_state = node_states_.lookup_key_ptr_as(
+                target_socket.node());
+            if (target_node_with_state == nullptr) {
               /* The target node is not computed because it is not computed to the output. */
               return;
             }
-            output_state.potential_users += 1;
+            targets.append({target_socket,
+                            target_node_with_state,
+                            allocator.construct_array_copy(path_info.sockets.as_span())});
           });
+      output_state.targets = allocator.construct_array_copy(targets.as_span());
+      /* Count the number of potential users for this socket. */
+      output_state.potential_users = targets.size();
       if (output_state.potential_users == 0) {
         /* If it does not have any potential users, it is unused. It might become required again in
          * `schedule_initial_nodes`. */
         output_state.output_usage = ValueUsage::Unused;
       }
     }
+
+    node_state.is_trivial = !uses_geometry;
   }
 
   void destruct_node_states()
@@ -677,6 +859,202 @@ class GeometryNodesEvaluator {
     }
   }
 
+  /**
+   * Computes a key that identifies the output values of the node, by combining everything that
+   * the outputs depend on. This includes the keys of all nodes to the left.
+   */
+  std::optional<uint64_t> compute_cache_key(const DNode node)
+  {
+    if (const std::optional<uint64_t> *key = cache_keys_.lookup_ptr(node)) {
+      return *key;
+    }
+
+    CacheKeyHasher hasher;
+    /* Compute the keys of all origin nodes, even when this node can't be cached. That way their
+     * cached values are kept when only this node changes. */
+    bool inputs_are_cacheable = true;
+    for (const InputSocketRef *socket_ref : node->inputs()) {
+      if (!socket_ref->is_available()) {
+        continue;
+      }
+      const DInputSocket socket{node.context(), socket_ref};
+      hasher.add(uint64_t(socket->index()));
+      bool has_origin = false;
+      socket.foreach_origin_socket([&](const DSocket origin) {
+        has_origin = true;
+        if (!this->add_origin_to_cache_key(hasher, origin)) {
+          inputs_are_cacheable = false;
+        }
+      });
+      if (!has_origin) {
+        add_socket_value_to_cache_key(hasher, *socket->bsocket());
+      }
+    }
+
+    std::optional<uint64_t> key;
+    if (inputs_are_cacheable && node_is_cacheable(node)) {
+      const bNode &bnode = *node->bnode();
+      hasher.add_string(node->idname());
+      hasher.add(uint64_t(bnode.custom1));
+      hasher.add(uint64_t(bnode.custom2));
+      hasher.add_bytes(&bnode.custom3, sizeof(bnode.custom3));
+      hasher.add_bytes(&bnode.custom4, sizeof(bnode.custom4));
+      hasher.add(uint64_t(uintptr_t(bnode.id)));
+      add_node_storage_to_cache_key(hasher, bnode);
+      /* Input nodes that depend on the evaluation context, their outputs can be reused as long
+       * as the values they read are the same. */
+      if (bnode.type == GEO_NODE_INPUT_SCENE_TIME) {
+        const Scene *scene = DEG_get_input_scene(params_.depsgraph);
+        const float scene_ctime = BKE_scene_ctime_get(scene);
+        hasher.add_bytes(&scene_ctime, sizeof(scene_ctime));
+        hasher.add(uint64_t(scene->r.frs_sec));
+        hasher.add_bytes(&scene->r.frs_sec_base, sizeof(scene->r.frs_sec_base));
+      }
+      else if (bnode.type == GEO_NODE_IS_VIEWPORT) {
+        hasher.add(uint64_t(DEG_get_mode(params_.depsgraph)));
+      }
+      key = hasher.get();
+    }
+    cache_keys_.add_new(node, key);
+    return key;
+  }
+
+  /**
+   * \return False when the value from the origin socket can't be cached.
+   */
+  bool add_origin_to_cache_key(CacheKeyHasher &hasher, const DSocket origin)
+  {
+    hasher.add_string(origin->idname());
+    if (origin->is_input()) {
+      /* The value is loaded from an unlinked socket, e.g. from a group node. */
+      add_socket_value_to_cache_key(hasher, *origin->bsocket());
+      return true;
+    }
+    hasher.add(uint64_t(origin->index()));
+    const DNode origin_node = origin.node();
+    if (origin_node->is_group_input_node()) {
+      const uint64_t *input_hash = params_.input_hashes.lookup_ptr(DOutputSocket(origin));
+      if (input_hash == nullptr) {
+        return false;
+      }
+      hasher.add(*input_hash);
+      return true;
+    }
+    const std::optional<uint64_t> origin_key = this->compute_cache_key(origin_node);
+    if (!origin_key) {
+      return false;
+    }
+    hasher.add(*origin_key);
+    return true;
+  }
+
+  /**
+   * Check if all outputs of the node that are used by other nodes have been cached in an earlier
+   * evaluation with the same inputs.
+   */
+  bool node_outputs_are_cached(const DNode node)
+  {
+    if (params_.cache == nullptr) {
+      return false;
+    }
+    const std::optional<uint64_t> key = this->compute_cache_key(node);
+    if (!key) {
+      return false;
+    }
+    for (const DSocket &socket : params_.force_compute_sockets) {
+      if (socket.node() == node) {
+        /* The node is executed so that the values of these sockets can be logged. */
+        return false;
+      }
+    }
+    for (const OutputSocketRef *socket_ref : node->outputs()) {
+      if (!socket_ref->is_available() || get_socket_cpp_type(*socket_ref) == nullptr) {
+        continue;
+      }
+      const DOutputSocket socket{node.context(), socket_ref};
+      bool is_linked = false;
+      socket.foreach_target_socket(
+          [&](const DInputSocket UNUSED(target_socket),
+              const DOutputSocket::TargetSocketPathInfo &UNUSED(path_info)) { is_linked = true; });
+      if (is_linked && params_.cache->lookup(*key, socket->index()).get() == nullptr) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Forward copies of the cached values of nodes that don't have to be executed. Their inputs are
+   * never used, which may allow nodes to the left to skip work as well.
+   */
+  void forward_cached_outputs()
+  {
+    LinearAllocator<> &allocator = local_allocators_.local();
+    for (const DNode node : cached_nodes_) {
+      NodeState &node_state = this->get_node_state(node);
+      this->with_locked_node(node, node_state, nullptr, [&](LockedNode &locked_node) {
+        node_state.is_loaded_from_cache = true;
+        node_state.node_has_finished = true;
+        for (OutputState &output_state : node_state.outputs) {
+          output_state.has_been_computed = true;
+        }
+        for (const int i : node->inputs().index_range()) {
+          InputState &input_state = node_state.inputs[i];
+          if (input_state.usage == ValueUsage::Unused) {
+            continue;
+          }
+          input_state.usage = ValueUsage::Unused;
+          for (const InputOrigin &origin : input_state.origins) {
+            /* Origin nodes that are only used by this node don't have a state. */
+            if (origin.node_with_state != nullptr) {
+              locked_node.delayed_unused_outputs.append(origin);
+            }
+          }
+        }
+      });
+
+      const uint64_t key = *cache_keys_.lookup(node);
+      for (const OutputSocketRef *socket_ref : node->outputs()) {
+        const GPointer cached_value = params_.cache->lookup(key, socket_ref->index());
+        if (cached_value.get() == nullptr) {
+          continue;
+        }
+        const CPPType &type = *cached_value.type();
+        void *buffer = allocator.allocate(type.size(), type.alignment());
+        type.copy_construct(cached_value.get(), buffer);
+        this->forward_output({node.context(), socket_ref}, {type, buffer}, nullptr);
+      }
+      this->log_cache_usage(node, geo_log::NodeCacheUsage::Hit);
+    }
+  }
+
+  void add_output_to_cache(const DOutputSocket socket, const GPointer value)
+  {
+    const DNode node = socket.node();
+    const std::optional<uint64_t> *key = cache_keys_.lookup_ptr(node);
+    if (key == nullptr || !key->has_value()) {
+      return;
+    }
+    if (this->get_node_state(node).is_loaded_from_cache) {
+      return;
+    }
+    params_.cache->add(**key, node->outputs().size(), socket->index(), value);
+  }
+
+  void remove_unused_cache_values()
+  {
+    if (params_.cache == nullptr) {
+      return;
+    }
+    Set<uint64_t> used_keys;
+    for (const std::optional<uint64_t> &key : cache_keys_.values()) {
+      if (key) {
+        used_keys.add(*key);
+      }
+    }
+    params_.cache->remove_unused(used_keys);
+  }
+
   void schedule_initial_nodes()
   {
     for (const DInputSocket &socket : params_.output_sockets) {
@@ -744,11 +1122,23 @@ class GeometryNodesEvaluator {
      * - Helps with cpu cache efficiency, because a thread is more likely to process data that it
      *   has processed shortly before.
      */
-    DNode next_node_to_run = root_node_with_state->node;
-    while (next_node_to_run) {
-      NodeTaskRunState run_state;
-      evaluator.node_task_run(next_node_to_run, &run_state);
-      next_node_to_run = run_state.next_node_to_run;
+    /* Trivial nodes that are scheduled in the process are run on this thread first, because
+     * pushing them to the task pool costs more than executing them. */
+    NodeTaskRunState run_state;
+    run_state.next_node_to_run = root_node_with_state->node;
+    while (true) {
+      DNode node_to_run;
+      if (!run_state.trivial_nodes_to_run.is_empty()) {
+        node_to_run = run_state.trivial_nodes_to_run.pop_last();
+      }
+      else if (run_state.next_node_to_run) {
+        node_to_run = run_state.next_node_to_run;
+        run_state.next_node_to_run = {};
+      }
+      else {
+        break;
+      }
+      evaluator.node_task_run(node_to_run, &run_state);
     }
   }
 
@@ -959,6 +1349,13 @@ class GeometryNodesEvaluator {
     }
     node_state.has_been_executed = true;
 
+    if (params_.cache != nullptr) {
+      const std::optional<uint64_t> *key = cache_keys_.lookup_ptr(node);
+      if (key != nullptr && key->has_value()) {
+        this->log_cache_usage(node, geo_log::NodeCacheUsage::Miss);
+      }
+    }
+
     /* Use the geometry node execute callback if it exists. */
     if (bnode.typeinfo->geometry_node_execute != nullptr) {
       this->execute_geometry_node(node, node_state, run_state);
@@ -1272,30 +1669,28 @@ class GeometryNodesEvaluator {
      * scheduled correctly when all inputs have been provided. */
     locked_node.node_state.missing_required_inputs += missing_values;
 
-    /* Get all origin sockets, because we have to tag those as required as well. */
-    Vector<DSocket> origin_sockets;
-    input_socket.foreach_origin_socket(
-        [&](const DSocket origin_socket) { origin_sockets.append(origin_socket); });
-
-    if (origin_sockets.is_empty()) {
+    /* All origin sockets have to be tagged as required as well. */
+    const Span<InputOrigin> origins = input_state.origins;
+    if (origins.is_empty()) {
       /* If there are no origin sockets, just load the value from the socket directly. */
       this->load_unlinked_input_value(locked_node, input_socket, input_state, input_socket);
       locked_node.node_state.missing_required_inputs -= 1;
       return false;
     }
     bool requested_from_other_node = false;
-    for (const DSocket &origin_socket : origin_sockets) {
-      if (origin_socket->is_input()) {
+    for (const InputOrigin &origin : origins) {
+      if (origin.socket->is_input()) {
         /* Load the value directly from the origin socket. In most cases this is an unlinked
          * group input. */
-        this->load_unlinked_input_value(locked_node, input_socket, input_state, origin_socket);
+        this->load_unlinked_input_value(locked_node, input_socket, input_state, origin.socket);
         locked_node.node_state.missing_required_inputs -= 1;
       }
       else {
         /* The value has not been computed yet, so when it will be forwarded by another node, this
          * node will be triggered. */
+        BLI_assert(origin.node_with_state != nullptr);
         requested_from_other_node = true;
-        locked_node.delayed_required_outputs.append(DOutputSocket(origin_socket));
+        locked_node.delayed_required_outputs.append(origin);
       }
     }
     /* If this node will be triggered by another node, we don't have to schedule it now. */
@@ -1327,22 +1722,22 @@ class GeometryNodesEvaluator {
     }
 
     /* Notify origin nodes that might want to set its inputs as unused as well. */
-    socket.foreach_origin_socket([&](const DSocket origin_socket) {
-      if (origin_socket->is_input()) {
-        /* Values from these sockets are loaded directly from the sockets, so there is no node to
+    for (const InputOrigin &origin : input_state.origins) {
+      if (origin.node_with_state == nullptr) {
+        /* Values from input sockets are loaded directly from the sockets, so there is no node to
          * notify. */
-        return;
+        continue;
       }
       /* Delay notification of the other node until this node is not locked anymore. */
-      locked_node.delayed_unused_outputs.append(DOutputSocket(origin_socket));
-    });
+      locked_node.delayed_unused_outputs.append(origin);
+    }
   }
 
-  void send_output_required_notification(const DOutputSocket socket, NodeTaskRunState *run_state)
+  void send_output_required_notification(const InputOrigin &origin, NodeTaskRunState *run_state)
   {
-    const DNode node = socket.node();
-    NodeState &node_state = this->get_node_state(node);
-    OutputState &output_state = node_state.outputs[socket->index()];
+    const DNode node = origin.node_with_state->node;
+    NodeState &node_state = *origin.node_with_state->state;
+    OutputState &output_state = node_state.outputs[origin.socket->index()];
 
     this->with_locked_node(node, node_state, run_state, [&](LockedNode &locked_node) {
       if (output_state.output_usage == ValueUsage::Required) {
@@ -1356,11 +1751,11 @@ class GeometryNodesEvaluator {
     });
   }
 
-  void send_output_unused_notification(const DOutputSocket socket, NodeTaskRunState *run_state)
+  void send_output_unused_notification(const InputOrigin &origin, NodeTaskRunState *run_state)
   {
-    const DNode node = socket.node();
-    NodeState &node_state = this->get_node_state(node);
-    OutputState &output_state = node_state.outputs[socket->index()];
+    const DNode node = origin.node_with_state->node;
+    NodeState &node_state = *origin.node_with_state->state;
+    OutputState &output_state = node_state.outputs[origin.socket->index()];
 
     this->with_locked_node(node, node_state, run_state, [&](LockedNode &locked_node) {
       output_state.potential_users -= 1;
@@ -1377,11 +1772,10 @@ class GeometryNodesEvaluator {
     });
   }
 
-  void add_node_to_task_pool(const DNode node)
+  void add_node_to_task_pool(const NodeWithState *node_with_state)
   {
     /* Push the task to the pool while it is not locked to avoid a deadlock in case when the task
      * is executed immediately. */
-    const NodeWithState *node_with_state = node_states_.lookup_key_ptr_as(node);
     BLI_task_pool_push(
         task_pool_, run_node_from_task_pool, (void *)node_with_state, false, nullptr);
   }
@@ -1398,120 +1792,125 @@ class GeometryNodesEvaluator {
 
     LinearAllocator<> &allocator = local_allocators_.local();
 
+    if (params_.cache != nullptr) {
+      this->add_output_to_cache(from_socket, value_to_forward);
+    }
+
     Vector<DSocket> log_original_value_sockets;
-    Vector<DInputSocket> forward_original_value_sockets;
+    Vector<const OutputTarget *> forward_original_value_targets;
     log_original_value_sockets.append(from_socket);
 
-    from_socket.foreach_target_socket(
-        [&](const DInputSocket to_socket, const DOutputSocket::TargetSocketPathInfo &path_info) {
-          if (!this->should_forward_to_socket(to_socket)) {
-            return;
-          }
-          BLI_assert(to_socket == path_info.sockets.last());
-          GMutablePointer current_value = value_to_forward;
-          for (const DSocket &next_socket : path_info.sockets) {
-            const DNode next_node = next_socket.node();
-            const bool is_last_socket = to_socket == next_socket;
-            const bool do_conversion_if_necessary = is_last_socket ||
-                                                    next_node->is_group_output_node() ||
-                                                    (next_node->is_group_node() &&
-                                                     !next_node->is_muted());
-            if (do_conversion_if_necessary) {
-              const CPPType &next_type = *get_socket_cpp_type(next_socket);
-              if (*current_value.type() != next_type) {
-                void *buffer = allocator.allocate(next_type.size(), next_type.alignment());
-                this->convert_value(*current_value.type(), next_type, current_value.get(), buffer);
-                if (current_value.get() != value_to_forward.get()) {
-                  current_value.destruct();
-                }
-                current_value = {next_type, buffer};
-              }
-            }
-            if (current_value.get() == value_to_forward.get()) {
-              /* Log the original value at the current socket. */
-              log_original_value_sockets.append(next_socket);
-            }
-            else {
-              /* Multi-input sockets are logged when all values are available. */
-              if (!(next_socket->is_input() && next_socket->as_input().is_multi_input_socket())) {
-                /* Log the converted value at the socket. */
-                this->log_socket_value({next_socket}, current_value);
-              }
+    const OutputState &output_state = this->get_node_state(from_socket.node())
+                                          .outputs[from_socket->index()];
+    for (const OutputTarget &target : output_state.targets) {
+      if (!this->should_forward_to_target(target)) {
+        continue;
+      }
+      const DInputSocket to_socket = target.socket;
+      BLI_assert(to_socket == target.path.last());
+      GMutablePointer current_value = value_to_forward;
+      for (const DSocket &next_socket : target.path) {
+        const DNode next_node = next_socket.node();
+        const bool is_last_socket = to_socket == next_socket;
+        const bool do_conversion_if_necessary = is_last_socket ||
+                                                next_node->is_group_output_node() ||
+                                                (next_node->is_group_node() &&
+                                                 !next_node->is_muted());
+        if (do_conversion_if_necessary) {
+          const CPPType &next_type = *get_socket_cpp_type(next_socket);
+          if (*current_value.type() != next_type) {
+            void *buffer = allocator.allocate(next_type.size(), next_type.alignment());
+            this->convert_value(*current_value.type(), next_type, current_value.get(), buffer);
+            if (current_value.get() != value_to_forward.get()) {
+              current_value.destruct();
             }
+            current_value = {next_type, buffer};
           }
-          if (current_value.get() == value_to_forward.get()) {
-            /* The value has not been converted, so forward the original value. */
-            forward_original_value_sockets.append(to_socket);
-          }
-          else {
-            /* The value has been converted. */
-            this->add_value_to_input_socket(to_socket, from_socket, current_value, run_state);
+        }
+        if (current_value.get() == value_to_forward.get()) {
+          /* Log the original value at the current socket. */
+          log_original_value_sockets.append(next_socket);
+        }
+        else {
+          /* Multi-input sockets are logged when all values are available. */
+          if (!(next_socket->is_input() && next_socket->as_input().is_multi_input_socket())) {
+            /* Log the converted value at the socket. */
+            this->log_socket_value({next_socket}, current_value);
           }
-        });
+        }
+      }
+      if (current_value.get() == value_to_forward.get()) {
+        /* The value has not been converted, so forward the original value. */
+        forward_original_value_targets.append(&target);
+      }
+      else {
+        /* The value has been converted. */
+        this->add_value_to_input_socket(target, from_socket, current_value, run_state);
+      }
+    }
     this->log_socket_value(log_original_value_sockets, value_to_forward);
     this->forward_to_sockets_with_same_type(
-        allocator, forward_original_value_sockets, value_to_forward, from_socket, run_state);
+        allocator, forward_original_value_targets, value_to_forward, from_socket, run_state);
   }
 
-  bool should_forward_to_socket(const DInputSocket socket)
+  bool should_forward_to_target(const OutputTarget &target)
   {
-    const DNode to_node = socket.node();
-    const NodeWithState *target_node_with_state = node_states_.lookup_key_ptr_as(to_node);
-    if (target_node_with_state == nullptr) {
-      /* If the socket belongs to a node that has no state, the entire node is not used. */
-      return false;
-    }
-    NodeState &target_node_state = *target_node_with_state->state;
-    InputState &target_input_state = target_node_state.inputs[socket->index()];
-
-    std::lock_guard lock{target_node_state.mutex};
-    /* Do not forward to an input socket whose value won't be used. */
-    return target_input_state.usage != ValueUsage::Unused;
+    const InputState &target_input_state =
+        target.node_with_state->state->inputs[target.socket->index()];
+    /* Do not forward to an input socket whose value won't be used. Reading the usage does not
+     * require a lock. The usage may still change before the value is added, so it is checked
+     * again in #add_value_to_input_socket while the node is locked. */
+    return target_input_state.usage.load(std::memory_order_relaxed) != ValueUsage::Unused;
   }
 
   void forward_to_sockets_with_same_type(LinearAllocator<> &allocator,
-                                         Span<DInputSocket> to_sockets,
+                                         Span<const OutputTarget *> targets,
                                          GMutablePointer value_to_forward,
                                          const DOutputSocket from_socket,
                                          NodeTaskRunState *run_state)
   {
-    if (to_sockets.is_empty()) {
+    if (targets.is_empty()) {
       /* Value is not used anymore, so it can be destructed. */
       value_to_forward.destruct();
     }
-    else if (to_sockets.size() == 1) {
+    else if (targets.size() == 1) {
       /* Value is only used by one input socket, no need to copy it. */
-      const DInputSocket to_socket = to_sockets[0];
-      this->add_value_to_input_socket(to_socket, from_socket, value_to_forward, run_state);
+      this->add_value_to_input_socket(*targets[0], from_socket, value_to_forward, run_state);
     }
     else {
       /* Multiple inputs use the value, make a copy for every input except for one. */
       /* First make the copies, so that the next node does not start modifying the value while we
        * are still making copies. */
       const CPPType &type = *value_to_forward.type();
-      for (const DInputSocket &to_socket : to_sockets.drop_front(1)) {
+      for (const OutputTarget *target : targets.drop_front(1)) {
         void *buffer = allocator.allocate(type.size(), type.alignment());
         type.copy_construct(value_to_forward.get(), buffer);
-        this->add_value_to_input_socket(to_socket, from_socket, {type, buffer}, run_state);
+        this->add_value_to_input_socket(*target, from_socket, {type, buffer}, run_state);
       }
       /* Forward the original value to one of the targets. */
-      const DInputSocket to_socket = to_sockets[0];
-      this->add_value_to_input_socket(to_socket, from_socket, value_to_forward, run_state);
+      this->add_value_to_input_socket(*targets[0], from_socket, value_to_forward, run_state);
     }
   }
 
-  void add_value_to_input_socket(const DInputSocket socket,
+  void add_value_to_input_socket(const OutputTarget &target,
                                  const DOutputSocket origin,
                                  GMutablePointer value,
                                  NodeTaskRunState *run_state)
   {
+    const DInputSocket socket = target.socket;
     BLI_assert(socket->is_available());
 
-    const DNode node = socket.node();
-    NodeState &node_state = this->get_node_state(node);
+    const DNode node = target.node_with_state->node;
+    NodeState &node_state = *target.node_with_state->state;
     InputState &input_state = node_state.inputs[socket->index()];
 
+    /* Adding the value modifies the node state, so this does require the lock. */
     this->with_locked_node(node, node_state, run_state, [&](LockedNode &locked_node) {
+      if (input_state.usage == ValueUsage::Unused) {
+        /* The input has been marked as unused after #should_forward_to_target checked it. */
+        value.destruct();
+        return;
+      }
       if (socket->is_multi_input_socket()) {
         /* Add a new value to the multi-input. */
         MultiInputValue &multi_value = *input_state.value.multi;
@@ -1699,6 +2098,14 @@ class GeometryNodesEvaluator {
     params_.geo_logger->local().log_debug_message(node, std::move(message));
   }
 
+  void log_cache_usage(DNode node, geo_log::NodeCacheUsage usage)
+  {
+    if (params_.geo_logger == nullptr) {
+      return;
+    }
+    params_.geo_logger->local().log_cache_usage(node, usage);
+  }
+
   /* In most cases when `NodeState` is accessed, the node has to be locked first to avoid race
    * conditions. */
   template<typename Function>
@@ -1717,14 +2124,19 @@ class GeometryNodesEvaluator {
 
     /* Then send notifications to the other nodes after the node state is unlocked. This avoids
      * locking two nodes at the same time on this thread and helps to prevent deadlocks. */
-    for (const DOutputSocket &socket : locked_node.delayed_required_outputs) {
-      this->send_output_required_notification(socket, run_state);
+    for (const InputOrigin &origin : locked_node.delayed_required_outputs) {
+      this->send_output_required_notification(origin, run_state);
     }
-    for (const DOutputSocket &socket : locked_node.delayed_unused_outputs) {
-      this->send_output_unused_notification(socket, run_state);
+    for (const InputOrigin &origin : locked_node.delayed_unused_outputs) {
+      this->send_output_unused_notification(origin, run_state);
     }
     for (const DNode &node_to_schedule : locked_node.delayed_scheduled_nodes) {
-      if (run_state != nullptr && !run_state->next_node_to_run) {
+      const NodeWithState &node_with_state = node_states_.lookup_key_as(node_to_schedule);
+      if (run_state != nullptr && node_with_state.state->is_trivial) {
+        /* Executing the node is cheaper than sending it to another thread. */
+        run_state->trivial_nodes_to_run.append(node_to_schedule);
+      }
+      else if (run_state != nullptr && !run_state->next_node_to_run) {
         /* Execute the node on the same thread after the current node finished. */
         /* Currently, this assumes that it is always best to run the first node that is scheduled
          * on the same thread. That is usually correct, because the geometry socket which carries
@@ -1733,7 +2145,7 @@ class GeometryNodesEvaluator {
       }
       else {
         /* Push the node to the task pool so that another thread can start working on it. */
-        this->add_node_to_task_pool(node_to_schedule);
+        this->add_node_to_task_pool(&node_with_state);
       }
     }
   }
@@ -1919,6 +2331,149 @@ void NodeParamsProvider::set_default_remaining_outputs()
   }
 }
 
+void CacheKeyHasher::add(const uint64_t value)
+{
+  /* Finalization step of the 64 bit MurmurHash3. */
+  uint64_t h = hash_ ^ value;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdLLU;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53LLU;
+  h ^= h >> 33;
+  hash_ = h;
+}
+
+void CacheKeyHasher::add_bytes(const void *data, const int64_t size)
+{
+  this->add(uint64_t(size));
+  const uchar *bytes = static_cast<const uchar *>(data);
+  /* Large buffers like geometry attributes are hashed in four independent lanes, which is much
+   * faster than mixing every word into the hash sequentially. */
+  uint64_t lanes[4] = {hash_, hash_ + 1, hash_ + 2, hash_ + 3};
+  int64_t offset = 0;
+  for (; offset + int64_t(sizeof(lanes)) <= size; offset += int64_t(sizeof(lanes))) {
+    for (const int lane : IndexRange(4)) {
+      uint64_t word;
+      memcpy(&word, bytes + offset + lane * sizeof(uint64_t), sizeof(uint64_t));
+      lanes[lane] = (lanes[lane] ^ word) * 0x9fb21c651e98df25LLU;
+      lanes[lane] ^= lanes[lane] >> 29;
+    }
+  }
+  for (const uint64_t lane : lanes) {
+    this->add(lane);
+  }
+  for (; offset < size; offset += int64_t(sizeof(uint64_t))) {
+    uint64_t word = 0;
+    memcpy(&word, bytes + offset, std::min<int64_t>(sizeof(uint64_t), size - offset));
+    this->add(word);
+  }
+}
+
+void CacheKeyHasher::add_string(const StringRef str)
+{
+  this->add_bytes(str.data(), str.size());
+}
+
+GeometryNodesCache::CachedNode::~CachedNode()
+{
+  for (GMutablePointer value : outputs) {
+    if (value.get() != nullptr) {
+      value.destruct();
+      MEM_freeN(value.get());
+    }
+  }
+}
+
+GPointer GeometryNodesCache::lookup(const uint64_t node_key, const int output_index) const
+{
+  const std::unique_ptr<CachedNode> *node = nodes_.lookup_ptr(node_key);
+  if (node == nullptr) {
+    return {};
+  }
+  return (*node)->outputs[output_index];
+}
+
+/**
+ * Estimate the memory used by a value, counting the attributes of geometries. Attribute arrays
+ * may be shared with other values, so this is an upper bound.
+ */
+static int64_t estimate_value_memory(const GPointer value)
+{
+  const CPPType &type = *value.type();
+  int64_t memory = type.size();
+  if (type.is<GeometrySet>()) {
+    const GeometrySet &geometry_set = *static_cast<const GeometrySet *>(value.get());
+    for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+      component->attribute_foreach(
+          [&](const bke::AttributeIDRef &UNUSED(attribute_id),
+              const AttributeMetaData &meta_data) {
+            memory += int64_t(component->attribute_domain_size(meta_data.domain)) *
+                      bke::custom_data_type_to_cpp_type(meta_data.data_type)->size();
+            return true;
+          });
+    }
+  }
+  return memory;
+}
+
+void GeometryNodesCache::add(const uint64_t node_key,
+                             const int outputs_num,
+                             const int output_index,
+                             const GPointer value)
+{
+  const int64_t value_memory = estimate_value_memory(value);
+  {
+    /* Reserve the memory, so that values added concurrently don't exceed the limit. */
+    std::lock_guard lock{mutex_};
+    if (memory_ + value_memory > memory_limit) {
+      return;
+    }
+    memory_ += value_memory;
+  }
+
+  /* Copy the value before locking, because it may be expensive. */
+  const CPPType &type = *value.type();
+  void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+  type.copy_construct(value.get(), buffer);
+  if (type.is<GeometrySet>()) {
+    /* The geometry may reference data owned by the depsgraph, like the modifier input, which is
+     * freed before the next evaluation. */
+    static_cast<GeometrySet *>(buffer)->ensure_owns_direct_data();
+  }
+
+  std::lock_guard lock{mutex_};
+  std::unique_ptr<CachedNode> &node = nodes_.lookup_or_add_cb(node_key, [&]() {
+    std::unique_ptr<CachedNode> new_node = std::make_unique<CachedNode>();
+    new_node->outputs.reinitialize(outputs_num);
+    return new_node;
+  });
+  BLI_assert(output_index < node->outputs.size());
+  GMutablePointer &cached_value = node->outputs[output_index];
+  if (cached_value.get() == nullptr) {
+    cached_value = {type, buffer};
+    node->memory += value_memory;
+    return;
+  }
+  /* Another node with the same key stored the value already. */
+  memory_ -= value_memory;
+  type.destruct(buffer);
+  MEM_freeN(buffer);
+}
+
+void GeometryNodesCache::remove_unused(const Set<uint64_t> &used_node_keys)
+{
+  Vector<uint64_t> keys_to_remove;
+  for (const auto item : nodes_.items()) {
+    if (!used_node_keys.contains(item.key)) {
+      keys_to_remove.append(item.key);
+      memory_ -= item.value->memory;
+    }
+  }
+  for (const uint64_t key : keys_to_remove) {
+    nodes_.remove(key);
+  }
+}
+
 void evaluate_geometry_nodes(GeometryNodesEvaluationParams &params)
 {
   GeometryNodesEvaluator evaluator{params};
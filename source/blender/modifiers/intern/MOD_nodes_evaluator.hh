@@ -2,8 +2,13 @@
 
 #pragma once
 
+#include "BLI_array.hh"
 #include "BLI_generic_pointer.hh"
 #include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_utility_mixins.hh"
+
+#include <mutex>
 
 #include "NOD_derived_node_tree.hh"
 #include "NOD_geometry_nodes_eval_log.hh"
@@ -19,6 +24,86 @@ namespace blender::modifiers::geometry_nodes {
 
 using namespace nodes::derived_node_tree_types;
 
+/**
+ * Incrementally computes a 64 bit hash of everything that influences the outputs of a node. The
+ * result is used as key in #GeometryNodesCache, so it has to change whenever the outputs might
+ * change.
+ */
+class CacheKeyHasher {
+ private:
+  uint64_t hash_ = 0x9e3779b97f4a7c15;
+
+ public:
+  void add(uint64_t value);
+  void add_bytes(const void *data, int64_t size);
+  void add_string(StringRef str);
+
+  uint64_t get() const
+  {
+    return hash_;
+  }
+};
+
+/**
+ * Add the settings stored in the node storage to the cache key of the node, including data that
+ * is referenced by the storage, like the points of curve mappings.
+ */
+void add_node_storage_to_cache_key(CacheKeyHasher &hasher, const bNode &node);
+
+/**
+ * Output values of nodes from previous evaluations of the same modifier. Nodes are identified by
+ * their cache key, which combines the node settings, unlinked input values and the keys of all
+ * nodes it depends on. When the key of a node did not change, its cached outputs are used instead
+ * of executing the node and the nodes to the left of it.
+ *
+ * Values are stored for all cacheable nodes, so that a change in one node only invalidates the
+ * nodes that depend on it. Geometry components and layers are shared with the evaluation, so
+ * storing a geometry is cheap until it is modified. The estimated size of the stored values is
+ * limited, once the limit is reached no more values are added until unused ones are removed.
+ */
+class GeometryNodesCache : NonCopyable, NonMovable {
+ public:
+  /** Limit of the estimated size of all cached values. */
+  static constexpr int64_t memory_limit = int64_t(1024) * 1024 * 1024;
+
+ private:
+  struct CachedNode {
+    /** Owned copies of the output values, indexed by socket index. Null when not computed. */
+    Array<GMutablePointer> outputs;
+    /** Estimated size of the output values. */
+    int64_t memory = 0;
+
+    ~CachedNode();
+  };
+
+  /** Values can be added from multiple threads during evaluation. */
+  std::mutex mutex_;
+  Map<uint64_t, std::unique_ptr<CachedNode>> nodes_;
+  /** Estimated size of all cached values, at most #memory_limit. */
+  int64_t memory_ = 0;
+
+ public:
+  /**
+   * \return The cached value of an output of the node with the given key, or null when the output
+   * was not computed in earlier evaluations. Must not be called while values are being added.
+   */
+  GPointer lookup(uint64_t node_key, int output_index) const;
+  /**
+   * Store a copy of the value of an output, unless a value is stored for it already or the memory
+   * limit would be exceeded.
+   */
+  void add(uint64_t node_key, int outputs_num, int output_index, GPointer value);
+  /**
+   * Free the values of nodes that do not exist anymore or whose inputs changed.
+   */
+  void remove_unused(const Set<uint64_t> &used_node_keys);
+
+  int64_t estimated_memory() const
+  {
+    return memory_;
+  }
+};
+
 struct GeometryNodesEvaluationParams {
   blender::LinearAllocator<> allocator;
 
@@ -36,6 +121,13 @@ struct GeometryNodesEvaluationParams {
   Object *self_object;
   geo_log::GeoLogger *geo_logger;
 
+  /**
+   * Optional cache of node outputs from previous evaluations. When it is used, #input_hashes
+   * should contain a hash for every group input value whose nodes may be cached.
+   */
+  GeometryNodesCache *cache = nullptr;
+  Map<DOutputSocket, uint64_t> input_hashes;
+
   Vector<GMutablePointer> r_output_values;
 };
 
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_string.h"
+
+#include "BKE_colortools.h"
+#include "BKE_node.h"
+
+#include "DNA_color_types.h"
+#include "DNA_node_types.h"
+
+#include "MOD_nodes_evaluator.hh"
+
+namespace blender::modifiers::geometry_nodes::tests {
+
+static uint64_t node_storage_cache_key(const bNode &node)
+{
+  CacheKeyHasher hasher;
+  add_node_storage_to_cache_key(hasher, node);
+  return hasher.get();
+}
+
+TEST(geometry_nodes_cache, CurveMappingKey)
+{
+  CurveMapping *mapping = BKE_curvemapping_add(1, 0.0f, 0.0f, 1.0f, 1.0f);
+  bNode node{};
+  node.type = SH_NODE_CURVE_FLOAT;
+  node.storage = mapping;
+
+  const uint64_t key = node_storage_cache_key(node);
+
+  /* Computing the evaluation tables does not change the output of the node. */
+  BKE_curvemapping_init(mapping);
+  EXPECT_EQ(node_storage_cache_key(node), key);
+
+  /* Moving a point changes the output, even though the points are stored in the same array. */
+  CurveMapPoint *points = mapping->cm[0].curve;
+  points[1].y = 0.5f;
+  BKE_curvemapping_changed(mapping, false);
+  EXPECT_EQ(mapping->cm[0].curve, points);
+  const uint64_t moved_key = node_storage_cache_key(node);
+  EXPECT_NE(moved_key, key);
+
+  /* Adding a point changes the output as well. */
+  BKE_curvemap_insert(&mapping->cm[0], 0.25f, 0.75f);
+  EXPECT_NE(node_storage_cache_key(node), moved_key);
+
+  BKE_curvemapping_free(mapping);
+}
+
+TEST(geometry_nodes_cache, StringKey)
+{
+  NodeInputString *storage = MEM_cnew<NodeInputString>(__func__);
+  storage->string = BLI_strdup("Text");
+  bNode node{};
+  node.type = FN_NODE_INPUT_STRING;
+  node.storage = storage;
+
+  const uint64_t key = node_storage_cache_key(node);
+
+  /* The same string at another address gives the same output. */
+  char *string_copy = BLI_strdup("Text");
+  MEM_freeN(storage->string);
+  storage->string = string_copy;
+  EXPECT_EQ(node_storage_cache_key(node), key);
+
+  MEM_freeN(storage->string);
+  storage->string = BLI_strdup("Other");
+  EXPECT_NE(node_storage_cache_key(node), key);
+
+  MEM_freeN(storage->string);
+  MEM_freeN(storage);
+}
+
+TEST(geometry_nodes_cache, MemoryEstimate)
+{
+  GeometryNodesCache cache;
+  const float value = 1.0f;
+  cache.add(1, 1, 0, {CPPType::get<float>(), &value});
+  EXPECT_EQ(*static_cast<const float *>(cache.lookup(1, 0).get()), 1.0f);
+  EXPECT_EQ(cache.estimated_memory(), int64_t(sizeof(float)));
+
+  /* Values of nodes that are not used anymore are freed. */
+  cache.remove_unused({});
+  EXPECT_EQ(cache.lookup(1, 0).get(), nullptr);
+  EXPECT_EQ(cache.estimated_memory(), 0);
+}
+
+}  // namespace blender::modifiers::geometry_nodes::tests
@@ -160,6 +160,21 @@ struct NodeWithExecutionTime {
   std::chrono::microseconds exec_time;
 };
 
+/** How the outputs of a node were computed, when node outputs are cached between evaluations. */
+enum class NodeCacheUsage {
+  /** The outputs of the node are not cached. */
+  None,
+  /** The node was not executed, because its outputs were cached in an earlier evaluation. */
+  Hit,
+  /** The node was executed, because its inputs changed or it was not cached yet. */
+  Miss,
+};
+
+struct NodeWithCacheUsage {
+  DNode node;
+  NodeCacheUsage usage;
+};
+
 struct NodeWithDebugMessage {
   DNode node;
   std::string message;
@@ -204,6 +219,7 @@ class LocalGeoLogger {
   Vector<ValueOfSockets> values_;
   Vector<NodeWithWarning> node_warnings_;
   Vector<NodeWithExecutionTime> node_exec_times_;
+  Vector<NodeWithCacheUsage> node_cache_usages_;
   Vector<NodeWithDebugMessage> node_debug_messages_;
   Vector<NodeWithUsedNamedAttribute> used_named_attributes_;
 
@@ -219,6 +235,7 @@ class LocalGeoLogger {
   void log_multi_value_socket(DSocket socket, Span<GPointer> values);
   void log_node_warning(DNode node, NodeWarningType type, std::string message);
   void log_execution_time(DNode node, std::chrono::microseconds exec_time);
+  void log_cache_usage(DNode node, NodeCacheUsage usage);
   void log_used_named_attribute(DNode node, std::string attribute_name, NamedAttributeUsage usage);
   /**
    * Log a message that will be displayed in the node editor next to the node.
@@ -301,6 +318,7 @@ class NodeLog {
   Vector<std::string, 0> debug_messages_;
   Vector<UsedNamedAttribute, 0> used_named_attributes_;
   std::chrono::microseconds exec_time_;
+  NodeCacheUsage cache_usage_ = NodeCacheUsage::None;
 
   friend ModifierLog;
 
@@ -339,6 +357,11 @@ class NodeLog {
     return exec_time_;
   }
 
+  NodeCacheUsage cache_usage() const
+  {
+    return cache_usage_;
+  }
+
   Vector<const GeometryAttributeInfo *> lookup_available_attributes() const;
 };
 
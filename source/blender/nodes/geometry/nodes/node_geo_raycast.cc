@@ -4,6 +4,8 @@
 
 #include "BKE_attribute_math.hh"
 #include "BKE_bvhutils.h"
+#include "BKE_geometry_set_instances.hh"
+#include "BKE_mesh.h"
 #include "BKE_mesh_sample.hh"
 
 #include "UI_interface.h"
@@ -21,9 +23,7 @@ NODE_STORAGE_FUNCS(NodeGeometryRaycast)
 
 static void node_declare(NodeDeclarationBuilder &b)
 {
-  b.add_input<decl::Geometry>(N_("Target Geometry"))
-      .only_realized_data()
-      .supported_type(GEO_COMPONENT_TYPE_MESH);
+  b.add_input<decl::Geometry>(N_("Target Geometry")).supported_type(GEO_COMPONENT_TYPE_MESH);
 
   b.add_input<decl::Vector>(N_("Attribute")).hide_value().supports_field();
   b.add_input<decl::Float>(N_("Attribute"), "Attribute_001").hide_value().supports_field();
@@ -127,28 +127,82 @@ static eAttributeMapMode get_map_mode(GeometryNodeRaycastMapMode map_mode)
   }
 }
 
-static void raycast_to_mesh(IndexMask mask,
-                            const Mesh &mesh,
-                            const VArray<float3> &ray_origins,
-                            const VArray<float3> &ray_directions,
-                            const VArray<float> &ray_lengths,
-                            const MutableSpan<bool> r_hit,
-                            const MutableSpan<int> r_hit_indices,
-                            const MutableSpan<float3> r_hit_positions,
-                            const MutableSpan<float3> r_hit_normals,
-                            const MutableSpan<float> r_hit_distances,
-                            int &hit_count)
-{
-  BVHTreeFromMesh tree_data;
-  BKE_bvhtree_from_mesh_get(&tree_data, &mesh, BVHTREE_FROM_LOOPTRI, 4);
-  BLI_SCOPED_DEFER([&]() { free_bvhtree_from_mesh(&tree_data); });
+/**
+ * A mesh that rays are cast against. The realized mesh of the target geometry uses the identity
+ * transform, meshes referenced by instances use the transform of the instance.
+ */
+struct MeshInstance {
+  /** Index of the mesh in #RaycastFunction::meshes_. */
+  int mesh_index;
+  /** Transforms positions from the space of the mesh. */
+  float4x4 transform;
+  /** Transforms positions into the space of the mesh. */
+  float4x4 transform_inverse;
+};
 
-  if (tree_data.tree == nullptr) {
+struct InstanceRaycastData {
+  Span<MeshInstance> instances;
+  Span<BVHTreeFromMesh> mesh_trees;
+  /** The closest hit so far, in the space of the mesh that was hit. */
+  int looptri_index = -1;
+  float3 local_position;
+  float3 local_normal;
+};
+
+static void raycast_instance_cb(void *userdata,
+                                int index,
+                                const BVHTreeRay *ray,
+                                BVHTreeRayHit *hit)
+{
+  InstanceRaycastData &data = *static_cast<InstanceRaycastData *>(userdata);
+  const MeshInstance &instance = data.instances[index];
+  const BVHTreeFromMesh &tree_data = data.mesh_trees[instance.mesh_index];
+
+  /* Cast the ray in the space of the mesh, the hit distance is scaled back afterwards. */
+  const float3 local_origin = instance.transform_inverse * float3(ray->origin);
+  float3 local_direction = ray->direction;
+  mul_mat3_m4_v3(instance.transform_inverse.values, local_direction);
+  const float scale = math::length(local_direction);
+  if (scale == 0.0f) {
     return;
   }
-  /* We shouldn't be rebuilding the BVH tree when calling this function in parallel. */
-  BLI_assert(tree_data.cached);
+  local_direction /= scale;
+
+  BVHTreeRayHit local_hit;
+  local_hit.index = -1;
+  local_hit.dist = hit->dist * scale;
+  if (BLI_bvhtree_ray_cast(tree_data.tree,
+                           local_origin,
+                           local_direction,
+                           0.0f,
+                           &local_hit,
+                           tree_data.raycast_callback,
+                           const_cast<BVHTreeFromMesh *>(&tree_data)) == -1) {
+    return;
+  }
+  hit->index = index;
+  hit->dist = local_hit.dist / scale;
+  data.looptri_index = local_hit.index;
+  data.local_position = local_hit.co;
+  data.local_normal = local_hit.no;
+}
 
+static void raycast_to_instances(IndexMask mask,
+                                 BVHTree *instances_tree,
+                                 const Span<MeshInstance> instances,
+                                 const Span<BVHTreeFromMesh> mesh_trees,
+                                 const VArray<float3> &ray_origins,
+                                 const VArray<float3> &ray_directions,
+                                 const VArray<float> &ray_lengths,
+                                 const MutableSpan<bool> r_hit,
+                                 const MutableSpan<int> r_hit_indices,
+                                 const MutableSpan<int> r_hit_mesh_indices,
+                                 const MutableSpan<float3> r_hit_local_positions,
+                                 const MutableSpan<float3> r_hit_positions,
+                                 const MutableSpan<float3> r_hit_normals,
+                                 const MutableSpan<float> r_hit_distances,
+                                 int &hit_count)
+{
   for (const int i : mask) {
     const float ray_length = ray_lengths[i];
     const float3 ray_origin = ray_origins[i];
@@ -157,26 +211,36 @@ static void raycast_to_mesh(IndexMask mask,
     BVHTreeRayHit hit;
     hit.index = -1;
     hit.dist = ray_length;
-    if (BLI_bvhtree_ray_cast(tree_data.tree,
-                             ray_origin,
-                             ray_direction,
-                             0.0f,
-                             &hit,
-                             tree_data.raycast_callback,
-                             &tree_data) != -1) {
+    InstanceRaycastData data{instances, mesh_trees};
+    if (instances_tree != nullptr && BLI_bvhtree_ray_cast(instances_tree,
+                                                          ray_origin,
+                                                          ray_direction,
+                                                          0.0f,
+                                                          &hit,
+                                                          raycast_instance_cb,
+                                                          &data) != -1) {
+      const MeshInstance &instance = instances[hit.index];
       hit_count++;
       if (!r_hit.is_empty()) {
-        r_hit[i] = hit.index >= 0;
+        r_hit[i] = true;
       }
       if (!r_hit_indices.is_empty()) {
         /* The caller must be able to handle invalid indices anyway, so don't clamp this value. */
-        r_hit_indices[i] = hit.index;
+        r_hit_indices[i] = data.looptri_index;
+      }
+      if (!r_hit_mesh_indices.is_empty()) {
+        r_hit_mesh_indices[i] = instance.mesh_index;
+      }
+      if (!r_hit_local_positions.is_empty()) {
+        r_hit_local_positions[i] = data.local_position;
       }
       if (!r_hit_positions.is_empty()) {
-        r_hit_positions[i] = hit.co;
+        r_hit_positions[i] = instance.transform * data.local_position;
       }
       if (!r_hit_normals.is_empty()) {
-        r_hit_normals[i] = hit.no;
+        float3 normal = data.local_normal;
+        mul_transposed_mat3_m4_v3(instance.transform_inverse.values, normal);
+        r_hit_normals[i] = math::normalize(normal);
       }
       if (!r_hit_distances.is_empty()) {
         r_hit_distances[i] = hit.dist;
@@ -207,10 +271,27 @@ class RaycastFunction : public fn::MultiFunction {
   GeometrySet target_;
   GeometryNodeRaycastMapMode mapping_;
 
-  /** The field for data evaluated on the target geometry. */
-  std::optional<GeometryComponentFieldContext> target_context_;
-  std::unique_ptr<FieldEvaluator> target_evaluator_;
-  const GVArray *target_data_ = nullptr;
+  /**
+   * Unique meshes of the target geometry, from its realized mesh and from the geometry that is
+   * instanced directly. Each mesh has a single BVH tree no matter how often it is instanced, so
+   * that large numbers of instances can be used as target without realizing them.
+   */
+  VectorSet<const Mesh *> meshes_;
+  Vector<const MeshComponent *> mesh_components_;
+  Array<BVHTreeFromMesh> mesh_trees_;
+  /** Evaluated geometry of instanced objects, which owns some of the meshes. */
+  Vector<GeometrySet> object_geometries_;
+
+  Vector<MeshInstance> instances_;
+  /** Tree of the bounds of all #instances_, used to find the instances a ray can hit. */
+  BVHTree *instances_tree_ = nullptr;
+  /** True when the target has instances of geometry other than meshes that can't be hit. */
+  bool has_ignored_instances_ = false;
+
+  /** The field for data evaluated on every target mesh. */
+  const CPPType *target_type_ = nullptr;
+  Vector<std::unique_ptr<GeometryComponentFieldContext>> target_contexts_;
+  Vector<std::unique_ptr<FieldEvaluator>> target_evaluators_;
 
   /* Always evaluate the target domain data on the face corner domain because it contains the most
    * information. Eventually this could be exposed as an option or determined automatically from
@@ -224,11 +305,23 @@ class RaycastFunction : public fn::MultiFunction {
       : target_(std::move(target)), mapping_((GeometryNodeRaycastMapMode)mapping)
   {
     target_.ensure_owns_direct_data();
+    this->gather_target_meshes();
+    this->build_trees();
     this->evaluate_target_field(std::move(src_field));
     signature_ = create_signature();
     this->set_signature(&signature_);
   }
 
+  ~RaycastFunction()
+  {
+    for (BVHTreeFromMesh &tree_data : mesh_trees_) {
+      free_bvhtree_from_mesh(&tree_data);
+    }
+    if (instances_tree_ != nullptr) {
+      BLI_bvhtree_free(instances_tree_);
+    }
+  }
+
   fn::MFSignature create_signature()
   {
     blender::fn::MFSignatureBuilder signature{"Geometry Proximity"};
@@ -239,84 +332,203 @@ class RaycastFunction : public fn::MultiFunction {
     signature.single_output<float3>("Hit Position");
     signature.single_output<float3>("Hit Normal");
     signature.single_output<float>("Distance");
-    if (target_data_) {
-      signature.single_output("Attribute", target_data_->type());
+    if (target_type_) {
+      signature.single_output("Attribute", *target_type_);
     }
     return signature.build();
   }
 
-  void call(IndexMask mask, fn::MFParams params, fn::MFContext UNUSED(context)) const override
+  bool has_ignored_instances() const
   {
-    /* Hit positions are always necessary for retrieving the attribute from the target if that
-     * output is required, so always retrieve a span from the evaluator in that case (it's
-     * expected that the evaluator is more likely to have a spare buffer that could be used). */
-    MutableSpan<float3> hit_positions =
-        (target_data_) ? params.uninitialized_single_output<float3>(4, "Hit Position") :
-                         params.uninitialized_single_output_if_required<float3>(4, "Hit Position");
+    return has_ignored_instances_;
+  }
 
+  void call(IndexMask mask, fn::MFParams params, fn::MFContext UNUSED(context)) const override
+  {
+    /* The hit indices and positions in the space of the hit mesh are necessary for retrieving
+     * the attribute from the target if that output is required. */
     Array<int> hit_indices;
-    if (target_data_) {
+    Array<int> hit_mesh_indices;
+    Array<float3> hit_local_positions;
+    if (target_type_) {
       hit_indices.reinitialize(mask.min_array_size());
+      hit_mesh_indices.reinitialize(mask.min_array_size());
+      hit_local_positions.reinitialize(mask.min_array_size());
     }
 
-    BLI_assert(target_.has_mesh());
-    const Mesh &mesh = *target_.get_mesh_for_read();
-
     int hit_count = 0;
-    raycast_to_mesh(mask,
-                    mesh,
-                    params.readonly_single_input<float3>(0, "Source Position"),
-                    params.readonly_single_input<float3>(1, "Ray Direction"),
-                    params.readonly_single_input<float>(2, "Ray Length"),
-                    params.uninitialized_single_output_if_required<bool>(3, "Is Hit"),
-                    hit_indices,
-                    hit_positions,
-                    params.uninitialized_single_output_if_required<float3>(5, "Hit Normal"),
-                    params.uninitialized_single_output_if_required<float>(6, "Distance"),
-                    hit_count);
-
-    if (target_data_) {
-      IndexMask hit_mask;
-      Vector<int64_t> hit_mask_indices;
-      if (hit_count < mask.size()) {
-        /* Not all rays hit the target. Create a corrected mask to avoid transferring attribute
-         * data to invalid indices. An alternative would be handling -1 indices in a separate case
-         * in #MeshAttributeInterpolator, but since it already has an IndexMask in its constructor,
-         * it's simpler to use that. */
-        hit_mask_indices.reserve(hit_count);
-        for (const int64_t i : mask) {
-          if (hit_indices[i] != -1) {
-            hit_mask_indices.append(i);
-          }
-          hit_mask = IndexMask(hit_mask_indices);
-        }
+    raycast_to_instances(mask,
+                         instances_tree_,
+                         instances_,
+                         mesh_trees_,
+                         params.readonly_single_input<float3>(0, "Source Position"),
+                         params.readonly_single_input<float3>(1, "Ray Direction"),
+                         params.readonly_single_input<float>(2, "Ray Length"),
+                         params.uninitialized_single_output_if_required<bool>(3, "Is Hit"),
+                         hit_indices,
+                         hit_mesh_indices,
+                         hit_local_positions,
+                         params.uninitialized_single_output_if_required<float3>(4, "Hit Position"),
+                         params.uninitialized_single_output_if_required<float3>(5, "Hit Normal"),
+                         params.uninitialized_single_output_if_required<float>(6, "Distance"),
+                         hit_count);
+
+    if (target_type_) {
+      GMutableSpan result = params.uninitialized_single_output_if_required(7, "Attribute");
+      if (result.is_empty()) {
+        return;
       }
-      else {
-        hit_mask = mask;
+      result.type().value_initialize_indices(result.data(), mask);
+      if (hit_count == 0) {
+        return;
       }
 
-      GMutableSpan result = params.uninitialized_single_output_if_required(7, "Attribute");
-      if (!result.is_empty()) {
-        MeshAttributeInterpolator interp(&mesh, hit_mask, hit_positions, hit_indices);
-        result.type().value_initialize_indices(result.data(), mask);
-        interp.sample_data(*target_data_, domain_, get_map_mode(mapping_), result);
+      /* Only transfer attribute data to indices of rays that hit the target, grouped by the mesh
+       * they hit. An alternative would be handling -1 indices in a separate case in
+       * #MeshAttributeInterpolator, but since it already has an IndexMask in its constructor,
+       * it's simpler to use that. */
+      Array<Vector<int64_t>> hit_mask_indices(meshes_.size());
+      for (const int64_t i : mask) {
+        if (hit_indices[i] != -1) {
+          hit_mask_indices[hit_mesh_indices[i]].append(i);
+        }
+      }
+      for (const int mesh_index : meshes_.index_range()) {
+        if (hit_mask_indices[mesh_index].is_empty()) {
+          continue;
+        }
+        MeshAttributeInterpolator interp(meshes_[mesh_index],
+                                         IndexMask(hit_mask_indices[mesh_index]),
+                                         hit_local_positions,
+                                         hit_indices);
+        interp.sample_data(target_evaluators_[mesh_index]->get_evaluated(0),
+                           domain_,
+                           get_map_mode(mapping_),
+                           result);
       }
     }
   }
 
  private:
+  const MeshComponent *get_instanced_mesh_component(const InstanceReference &reference)
+  {
+    switch (reference.type()) {
+      case InstanceReference::Type::Object: {
+        object_geometries_.append(bke::object_get_evaluated_geometry_set(reference.object()));
+        return this->get_instanced_mesh_component(object_geometries_.last());
+      }
+      case InstanceReference::Type::GeometrySet: {
+        return this->get_instanced_mesh_component(reference.geometry_set());
+      }
+      case InstanceReference::Type::Collection: {
+        /* Nested instances are not supported. */
+        has_ignored_instances_ = true;
+        break;
+      }
+      case InstanceReference::Type::None: {
+        break;
+      }
+    }
+    return nullptr;
+  }
+
+  const MeshComponent *get_instanced_mesh_component(const GeometrySet &geometry_set)
+  {
+    if (geometry_set.has_instances()) {
+      /* Nested instances are not supported. */
+      has_ignored_instances_ = true;
+    }
+    return geometry_set.get_component_for_read<MeshComponent>();
+  }
+
+  void add_mesh_instance(const MeshComponent &component, const float4x4 &transform)
+  {
+    const Mesh *mesh = component.get_for_read();
+    if (mesh == nullptr || mesh->totpoly == 0) {
+      return;
+    }
+    const int mesh_index = meshes_.index_of_or_add(mesh);
+    if (mesh_index == mesh_components_.size()) {
+      mesh_components_.append(&component);
+    }
+    instances_.append({mesh_index, transform, transform.inverted()});
+  }
+
+  void gather_target_meshes()
+  {
+    if (const MeshComponent *component = target_.get_component_for_read<MeshComponent>()) {
+      this->add_mesh_instance(*component, float4x4::identity());
+    }
+    const InstancesComponent *instances = target_.get_component_for_read<InstancesComponent>();
+    if (instances == nullptr) {
+      return;
+    }
+    const Span<InstanceReference> references = instances->references();
+    Array<const MeshComponent *> reference_components(references.size());
+    for (const int i : references.index_range()) {
+      reference_components[i] = this->get_instanced_mesh_component(references[i]);
+    }
+    const Span<int> handles = instances->instance_reference_handles();
+    const Span<float4x4> transforms = instances->instance_transforms();
+    instances_.reserve(instances_.size() + transforms.size());
+    for (const int i : transforms.index_range()) {
+      if (const MeshComponent *component = reference_components[handles[i]]) {
+        this->add_mesh_instance(*component, transforms[i]);
+      }
+    }
+  }
+
+  void build_trees()
+  {
+    mesh_trees_.reinitialize(meshes_.size());
+    Array<float3> bounds_min(meshes_.size());
+    Array<float3> bounds_max(meshes_.size());
+    for (const int mesh_index : meshes_.index_range()) {
+      BKE_bvhtree_from_mesh_get(
+          &mesh_trees_[mesh_index], meshes_[mesh_index], BVHTREE_FROM_LOOPTRI, 4);
+      bounds_min[mesh_index] = float3(FLT_MAX);
+      bounds_max[mesh_index] = float3(-FLT_MAX);
+      BKE_mesh_minmax(meshes_[mesh_index], bounds_min[mesh_index], bounds_max[mesh_index]);
+    }
+
+    if (instances_.is_empty()) {
+      return;
+    }
+    instances_tree_ = BLI_bvhtree_new(instances_.size(), 0.0f, 4, 6);
+    for (const int i : instances_.index_range()) {
+      const int mesh_index = instances_[i].mesh_index;
+      if (mesh_trees_[mesh_index].tree == nullptr) {
+        continue;
+      }
+      const float3 &min = bounds_min[mesh_index];
+      const float3 &max = bounds_max[mesh_index];
+      const float4x4 &transform = instances_[i].transform;
+      float3 corners[8];
+      for (const int corner : IndexRange(8)) {
+        corners[corner] = transform * float3(corner & 1 ? max.x : min.x,
+                                             corner & 2 ? max.y : min.y,
+                                             corner & 4 ? max.z : min.z);
+      }
+      BLI_bvhtree_insert(instances_tree_, i, (const float *)corners, 8);
+    }
+    BLI_bvhtree_balance(instances_tree_);
+  }
+
   void evaluate_target_field(GField src_field)
   {
     if (!src_field) {
       return;
     }
-    const MeshComponent &mesh_component = *target_.get_component_for_read<MeshComponent>();
-    target_context_.emplace(GeometryComponentFieldContext{mesh_component, domain_});
-    const int domain_size = mesh_component.attribute_domain_size(domain_);
-    target_evaluator_ = std::make_unique<FieldEvaluator>(*target_context_, domain_size);
-    target_evaluator_->add(std::move(src_field));
-    target_evaluator_->evaluate();
-    target_data_ = &target_evaluator_->get_evaluated(0);
+    target_type_ = &src_field.cpp_type();
+    for (const MeshComponent *mesh_component : mesh_components_) {
+      target_contexts_.append(
+          std::make_unique<GeometryComponentFieldContext>(*mesh_component, domain_));
+      const int domain_size = mesh_component->attribute_domain_size(domain_);
+      target_evaluators_.append(
+          std::make_unique<FieldEvaluator>(*target_contexts_.last(), domain_size));
+      target_evaluators_.last()->add(src_field);
+      target_evaluators_.last()->evaluate();
+    }
   }
 };
 
@@ -394,12 +606,12 @@ static void node_geo_exec(GeoNodeExecParams params)
     return;
   }
 
-  if (!target.has_mesh()) {
+  if (!target.has_mesh() && !target.has_instances()) {
     params.set_default_remaining_outputs();
     return;
   }
 
-  if (target.get_mesh_for_read()->totpoly == 0) {
+  if (!target.has_instances() && target.get_mesh_for_read()->totpoly == 0) {
     params.error_message_add(NodeWarningType::Error, TIP_("The target mesh must have faces"));
     params.set_default_remaining_outputs();
     return;
@@ -412,6 +624,10 @@ static void node_geo_exec(GeoNodeExecParams params)
   Field<float> length_field = params.extract_input<Field<float>>("Ray Length");
 
   auto fn = std::make_unique<RaycastFunction>(std::move(target), std::move(field), mapping);
+  if (fn->has_ignored_instances()) {
+    params.error_message_add(NodeWarningType::Info,
+                             TIP_("Nested and collection instances in the target are ignored"));
+  }
   auto op = std::make_shared<FieldOperation>(FieldOperation(
       std::move(fn),
       {std::move(position_field), std::move(direction_field), std::move(length_field)}));
@@ -58,6 +58,12 @@ ModifierLog::ModifierLog(GeoLogger &logger)
       node_log.exec_time_ = node_with_exec_time.exec_time;
     }
 
+    for (NodeWithCacheUsage &node_with_cache_usage : local_logger.node_cache_usages_) {
+      NodeLog &node_log = this->lookup_or_add_node_log(log_by_tree_context,
+                                                       node_with_cache_usage.node);
+      node_log.cache_usage_ = node_with_cache_usage.usage;
+    }
+
     for (NodeWithDebugMessage &debug_message : local_logger.node_debug_messages_) {
       NodeLog &node_log = this->lookup_or_add_node_log(log_by_tree_context, debug_message.node);
       node_log.debug_messages_.append(debug_message.message);
@@ -493,6 +499,11 @@ void LocalGeoLogger::log_execution_time(DNode node, std::chrono::microseconds ex
   node_exec_times_.append({node, exec_time});
 }
 
+void LocalGeoLogger::log_cache_usage(DNode node, NodeCacheUsage usage)
+{
+  node_cache_usages_.append({node, usage});
+}
+
 void LocalGeoLogger::log_used_named_attribute(DNode node,
                                               std::string attribute_name,
                                               NamedAttributeUsage usage)
@@ -1714,6 +1714,7 @@ static bool wm_file_write(bContext *C,
                           int fileflags,
                           eBLO_WritePathRemap remap_mode,
                           bool use_save_as_copy,
+                          bool use_incremental,
                           ReportList *reports)
 {
   Main *bmain = CTX_data_main(C);
@@ -1825,6 +1826,7 @@ static bool wm_file_write(bContext *C,
                          .remap_mode = remap_mode,
                          .use_save_versions = true,
                          .use_save_as_copy = use_save_as_copy,
+                         .use_incremental = use_incremental,
                          .thumb = thumb,
                      },
                      reports)) {
@@ -1916,6 +1918,54 @@ static void wm_autosave_location(char *filepath)
   BLI_join_dirfile(filepath, FILE_MAX, BKE_tempdir_base(), path);
 }
 
+/**
+ * Auto-save runs in two steps: a snapshot of the file is taken in memory on the main thread
+ * (which is fast, it's the same as an undo push or a copy of the last one), writing that snapshot
+ * to disk is then done by a job, so slow drives don't stall interaction.
+ */
+typedef struct AutosaveJob {
+  /** Snapshot of the file, owning all its memory. */
+  MemFile memfile;
+  char filepath[FILE_MAX];
+  bool success;
+} AutosaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     short *UNUSED(stop),
+                                     short *do_update,
+                                     float *progress)
+{
+  AutosaveJob *job = customdata;
+
+  /* Error reporting into console. */
+  job->success = BLO_memfile_write_file(&job->memfile, job->filepath);
+
+  *progress = 1.0f;
+  *do_update = true;
+}
+
+static void wm_autosave_job_endjob(void *customdata)
+{
+  AutosaveJob *job = customdata;
+
+  if (!job->success) {
+    WM_reportf(RPT_WARNING, "Unable to auto-save to '%s'", job->filepath);
+  }
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutosaveJob *job = customdata;
+
+  BLO_memfile_free(&job->memfile);
+  MEM_freeN(job);
+}
+
+static bool wm_autosave_job_is_running(wmWindowManager *wm)
+{
+  return WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE);
+}
+
 static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 {
   char filepath[FILE_MAX];
@@ -1925,10 +1975,7 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
   /* Fast save of last undo-buffer, now with UI. */
   const bool use_memfile = (U.uiflag & USER_GLOBALUNDO) != 0;
   MemFile *memfile = use_memfile ? ED_undosys_stack_memfile_get_active(wm->undo_stack) : NULL;
-  if (memfile != NULL) {
-    BLO_memfile_write_file(memfile, filepath);
-  }
-  else {
+  if (memfile == NULL) {
     if (use_memfile) {
       /* This is very unlikely, alert developers of this unexpected case. */
       CLOG_WARN(&LOG, "undo-data not found for writing, fallback to regular file write!");
@@ -1941,7 +1988,20 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 
     /* Error reporting into console. */
     BLO_write_file(bmain, filepath, fileflags, &(const struct BlendFileWriteParams){0}, NULL);
+    return;
   }
+
+  AutosaveJob *job = MEM_callocN(sizeof(*job), __func__);
+  STRNCPY(job->filepath, filepath);
+  /* The undo stack may free or merge the step while the job is writing, copy it. */
+  BLO_memfile_copy(memfile, &job->memfile);
+
+  wmJob *wm_job = WM_jobs_get(
+      wm, wm->winactive, wm, "Auto-Saving...", WM_JOB_PROGRESS, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, job, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.1, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, wm_autosave_job_endjob);
+  WM_jobs_start(wm, wm_job);
 }
 
 static void wm_autosave_timer_begin_ex(wmWindowManager *wm, double timestep)
@@ -1989,7 +2049,11 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     }
   }
 
-  wm_autosave_write(bmain, wm);
+  /* Don't pile up snapshots when writing to disk is slower than the auto-save interval,
+   * the next timer will save the latest state anyway. */
+  if (!wm_autosave_job_is_running(wm)) {
+    wm_autosave_write(bmain, wm);
+  }
 
   /* Restart the timer after file write, just in case file write takes a long time. */
   wm_autosave_timer_begin(wm);
@@ -3060,6 +3124,10 @@ static int wm_save_as_mainfile_exec(bContext *C, wmOperator *op)
   const bool is_save_as = (op->type->invoke == wm_save_as_mainfile_invoke);
   const bool use_save_as_copy = (RNA_struct_property_is_set(op->ptr, "copy") &&
                                  RNA_boolean_get(op->ptr, "copy"));
+  /* Only defined for #WM_OT_save_mainfile. */
+  PropertyRNA *prop_incremental = RNA_struct_find_property(op->ptr, "incremental");
+  const bool use_incremental = (prop_incremental != NULL) &&
+                               RNA_property_boolean_get(op->ptr, prop_incremental);
 
   /* We could expose all options to the users however in most cases remapping
    * existing relative paths is a good default.
@@ -3103,7 +3171,8 @@ static int wm_save_as_mainfile_exec(bContext *C, wmOperator *op)
   /* set compression flag */
   SET_FLAG_FROM_TEST(fileflags, RNA_boolean_get(op->ptr, "compress"), G_FILE_COMPRESS);
 
-  const bool ok = wm_file_write(C, path, fileflags, remap_mode, use_save_as_copy, op->reports);
+  const bool ok = wm_file_write(
+      C, path, fileflags, remap_mode, use_save_as_copy, use_incremental, op->reports);
 
   if ((op->flag & OP_IS_INVOKE) == 0) {
     /* OP_IS_INVOKE is set when the operator is called from the GUI.
@@ -3258,6 +3327,14 @@ void WM_OT_save_mainfile(wmOperatorType *ot)
                   false,
                   "Remap Relative",
                   "Remap relative paths when saving to a different directory");
+  RNA_def_boolean(ot->srna,
+                  "incremental",
+                  false,
+                  "Incremental",
+                  "Only append the data-blocks that changed since the last save to the file, "
+                  "which is much faster for large files with few changes. No version backups "
+                  "are made when appending. Older Blender versions read the file as it was last "
+                  "fully saved");
 
   prop = RNA_def_boolean(ot->srna, "exit", false, "Exit", "Exit Blender after saving");
   RNA_def_property_flag(prop, PROP_HIDDEN | PROP_SKIP_SAVE);
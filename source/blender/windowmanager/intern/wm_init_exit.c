@@ -29,10 +29,12 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_task.h"
+#include "BLI_task_trace.h"
 #include "BLI_threads.h"
 #include "BLI_timer.h"
 #include "BLI_utildefines.h"
 
+#include "BLO_readfile.h"
 #include "BLO_undofile.h"
 #include "BLO_writefile.h"
 
@@ -615,8 +617,13 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   GHOST_DisposeSystemPaths();
 
+  BLO_bhead_index_cache_clear();
+  BLO_write_file_incremental_clear();
   DNA_sdna_current_free();
 
+  /* Write the trace of `--debug-trace`, all tasks have finished at this point. */
+  BLI_task_trace_end();
+
   BLI_threadapi_exit();
   BLI_task_scheduler_exit();
 
@@ -26,6 +26,7 @@
 #  include "BLI_string.h"
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
+#  include "BLI_task_trace.h"
 #  include "BLI_threads.h"
 #  include "BLI_utildefines.h"
 
@@ -586,6 +587,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 #  endif
   BLI_args_print_arg_doc(ba, "--debug-all");
   BLI_args_print_arg_doc(ba, "--debug-io");
+  BLI_args_print_arg_doc(ba, "--debug-trace");
 
   printf("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
@@ -601,6 +603,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
+  BLI_args_print_arg_doc(ba, "--memory-arena");
   printf("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
   BLI_args_print_arg_doc(ba, "--env-system-scripts");
@@ -738,6 +741,18 @@ static int arg_handle_abort_handler_disable(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_memory_arena_set_doc[] =
+    "\n\t"
+    "Use the memory allocator with per-thread arenas, which scales better when many threads\n"
+    "\tallocate at the same time. Ignored when memory debugging is enabled.";
+static int arg_handle_memory_arena_set(int UNUSED(argc),
+                                       const char **UNUSED(argv),
+                                       void *UNUSED(data))
+{
+  /* Handled in #main, the allocator has to be switched before any allocation. */
+  return 0;
+}
+
 static void clog_abort_on_error_callback(void *fp)
 {
   BLI_system_backtrace(fp);
@@ -1065,6 +1080,21 @@ static int arg_handle_debug_mode_memory_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_trace_set_doc[] =
+    "<filepath>\n"
+    "\tRecord the execution of tasks on all threads and write it to <filepath> on exit.\n"
+    "\tThe file uses the Chrome trace format, it can be opened in 'chrome://tracing' or Perfetto.";
+static int arg_handle_debug_trace_set(int argc, const char **argv, void *UNUSED(data))
+{
+  const char *arg_id = "--debug-trace";
+  if (argc > 1) {
+    BLI_task_trace_begin(argv[1]);
+    return 1;
+  }
+  printf("\nError: '%s' no args given.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_debug_value_set_doc[] =
     "<value>\n"
     "\tSet debug value of <value> on startup.";
@@ -2080,6 +2110,7 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_args_add(ba, NULL, "--disable-crash-handler", CB(arg_handle_crash_handler_disable), NULL);
   BLI_args_add(ba, NULL, "--disable-abort-handler", CB(arg_handle_abort_handler_disable), NULL);
+  BLI_args_add(ba, NULL, "--memory-arena", CB(arg_handle_memory_arena_set), NULL);
 
   BLI_args_add(ba, "-b", "--background", CB(arg_handle_background_mode_set), NULL);
 
@@ -2159,6 +2190,7 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_args_add(ba, NULL, "--debug-memory", CB(arg_handle_debug_mode_memory_set), NULL);
 
   BLI_args_add(ba, NULL, "--debug-value", CB(arg_handle_debug_value_set), NULL);
+  BLI_args_add(ba, NULL, "--debug-trace", CB(arg_handle_debug_trace_set), NULL);
   BLI_args_add(ba,
                NULL,
                "--debug-jobs",